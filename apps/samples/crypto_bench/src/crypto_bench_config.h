@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief mbedTLS user config of the crypto benchmark.
+ * Starts from the OOB service user config and applies the speed/size
+ * options selected with CONFIG_CRYPTO_BENCH_*.
+ */
+
+#ifndef CRYPTO_BENCH_CONFIG_H
+#define CRYPTO_BENCH_CONFIG_H
+
+#include "config-mini-tls1_2-gcm-aes512.h"
+
+/* Key derivation of the OOB security module */
+#ifndef MBEDTLS_HKDF_C
+#define MBEDTLS_HKDF_C
+#endif
+
+#if defined(CONFIG_CRYPTO_BENCH_AES_ROM_TABLES)
+#define MBEDTLS_AES_ROM_TABLES
+#endif
+
+#if defined(CONFIG_CRYPTO_BENCH_AES_FEWER_TABLES)
+#define MBEDTLS_AES_FEWER_TABLES
+#endif
+
+#if defined(CONFIG_CRYPTO_BENCH_SHA256_SMALLER)
+#define MBEDTLS_SHA256_SMALLER
+#endif
+
+#if defined(CONFIG_CRYPTO_BENCH_SHA512_SMALLER)
+#define MBEDTLS_SHA512_SMALLER
+#endif
+
+#undef MBEDTLS_ECP_WINDOW_SIZE
+#define MBEDTLS_ECP_WINDOW_SIZE CONFIG_CRYPTO_BENCH_ECP_WINDOW_SIZE
+
+#undef MBEDTLS_ECP_FIXED_POINT_OPTIM
+#if defined(CONFIG_CRYPTO_BENCH_ECP_FIXED_POINT_OPTIM)
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM 1
+#else
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM 0
+#endif
+
+#endif /* CRYPTO_BENCH_CONFIG_H */
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sample Application for mbedTLS crypto benchmarking.
+ * This example measures the crypto primitives used by the OOB
+ * service: AES-256-GCM and SHA-256/384 across payload sizes,
+ * HKDF-SHA256 key derivation and the ECDHE/ECDSA steps of a TLS
+ * handshake. One JSON object is printed per measurement.
+ * @{
+ */
+
+/**
+ * @brief How to Build sample application.
+ * Please refer “IntelPSE_SDK_Get_Started_Guide” for more details on how to
+ * build the sample codes.
+ */
+
+/* Local Includes */
+#include <sys/printk.h>
+#include <sys/util.h>
+#include <string.h>
+#include <zephyr.h>
+
+#include <mbedtls/gcm.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/sha512.h>
+#include <mbedtls/md.h>
+#include <mbedtls/hkdf.h>
+#include <mbedtls/ecdh.h>
+#include <mbedtls/ecdsa.h>
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+#include <posix_board_if.h>
+#endif
+
+/** Largest measured payload */
+#define BENCH_MAX_LEN 4096
+/** AES-256, as the OOB context encryption */
+#define BENCH_KEY_LEN 32
+#define BENCH_IV_LEN 12
+#define BENCH_TAG_LEN 16
+#define BENCH_HKDF_LEN 32
+
+/** Payload sizes: HECI credential items up to TLS records */
+static const uint32_t bench_len[] = { 16, 64, 256, 1024, BENCH_MAX_LEN };
+
+static uint8_t bench_in[BENCH_MAX_LEN];
+static uint8_t bench_out[BENCH_MAX_LEN];
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+/*
+ * Simulated time does not advance while the CPU is busy, count host
+ * TSC cycles instead. Time per operation is not reported.
+ */
+#define BENCH_CLOCK "tsc"
+typedef uint64_t bench_cycles_t;
+
+static inline bench_cycles_t bench_cycles(void)
+{
+	return __builtin_ia32_rdtsc();
+}
+#else
+#define BENCH_CLOCK "hw"
+typedef uint32_t bench_cycles_t;
+
+static inline bench_cycles_t bench_cycles(void)
+{
+	return k_cycle_get_32();
+}
+#endif
+
+/**
+ * @brief Print one measurement as a JSON object.
+ *
+ * @param alg Name of the measured primitive
+ * @param len Payload length per operation, 0 if not applicable
+ * @param iters Number of timed operations
+ * @param cycles Cycles spent in all operations
+ */
+static void bench_report(const char *alg, uint32_t len, uint32_t iters,
+			 bench_cycles_t cycles)
+{
+	uint32_t per_op = (uint32_t)(cycles / iters);
+
+	printk("{\"alg\":\"%s\",\"len\":%u,\"iters\":%u,"
+	       "\"clock\":\"" BENCH_CLOCK "\",\"cycles_per_op\":%u",
+	       alg, len, iters, per_op);
+#if !defined(CONFIG_BOARD_NATIVE_POSIX)
+	printk(",\"ns_per_op\":%u",
+	       (uint32_t)k_cyc_to_ns_floor64(per_op));
+	if (len != 0U && cycles != 0U) {
+		printk(",\"kib_per_s\":%u",
+		       (uint32_t)((uint64_t)len * iters *
+				  sys_clock_hw_cycles_per_sec() /
+				  cycles / 1024U));
+	}
+#endif
+	printk("}\n");
+}
+
+static void bench_skip(const char *alg)
+{
+	printk("{\"alg\":\"%s\",\"skipped\":true}\n", alg);
+}
+
+static uint32_t bench_iters(uint32_t len)
+{
+	return MAX(CONFIG_CRYPTO_BENCH_BYTES / len, 4U);
+}
+
+/*
+ * Deterministic generator for key and nonce generation, the benchmark
+ * only needs repeatable inputs. Not suitable for any real key.
+ */
+static int bench_rng(void *ctx, unsigned char *buf, size_t len)
+{
+	static uint32_t state = 0x2545F491;
+
+	ARG_UNUSED(ctx);
+
+	for (size_t i = 0; i < len; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		buf[i] = (unsigned char)state;
+	}
+
+	return 0;
+}
+
+static void bench_config(void)
+{
+	printk("{\"config\":{\"aes_rom_tables\":%d,\"aes_fewer_tables\":%d,"
+	       "\"sha256_smaller\":%d,\"sha512_smaller\":%d,"
+	       "\"ecp_window_size\":%d,\"ecp_fixed_point_optim\":%d,"
+	       "\"bytes\":%d,\"pk_iters\":%d},",
+	       IS_ENABLED(CONFIG_CRYPTO_BENCH_AES_ROM_TABLES),
+	       IS_ENABLED(CONFIG_CRYPTO_BENCH_AES_FEWER_TABLES),
+	       IS_ENABLED(CONFIG_CRYPTO_BENCH_SHA256_SMALLER),
+	       IS_ENABLED(CONFIG_CRYPTO_BENCH_SHA512_SMALLER),
+	       MBEDTLS_ECP_WINDOW_SIZE, MBEDTLS_ECP_FIXED_POINT_OPTIM,
+	       CONFIG_CRYPTO_BENCH_BYTES, CONFIG_CRYPTO_BENCH_PK_ITERS);
+	/* RAM taken by each context, the static part of the trade-off */
+	printk("\"ctx_size\":{\"gcm\":%u,\"sha256\":%u,\"sha512\":%u,"
+	       "\"ecp_group\":%u}}\n",
+	       (uint32_t)sizeof(mbedtls_gcm_context),
+	       (uint32_t)sizeof(mbedtls_sha256_context),
+	       (uint32_t)sizeof(mbedtls_sha512_context),
+	       (uint32_t)sizeof(mbedtls_ecp_group));
+}
+
+#if defined(MBEDTLS_GCM_C)
+static void bench_gcm(void)
+{
+	mbedtls_gcm_context gcm;
+	uint8_t key[BENCH_KEY_LEN];
+	uint8_t iv[BENCH_IV_LEN];
+	uint8_t tag[BENCH_TAG_LEN];
+	bench_cycles_t start, cycles;
+	uint32_t iters;
+	int ret = 0;
+
+	bench_rng(NULL, key, sizeof(key));
+	bench_rng(NULL, iv, sizeof(iv));
+
+	/* Key expansion, paid on every call without a context cache */
+	iters = bench_iters(BENCH_MAX_LEN);
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		mbedtls_gcm_init(&gcm);
+		ret |= mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key,
+					  BENCH_KEY_LEN * 8);
+		mbedtls_gcm_free(&gcm);
+	}
+	bench_report("aes256-gcm-setkey", 0, iters, bench_cycles() - start);
+
+	mbedtls_gcm_init(&gcm);
+	ret |= mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key,
+				  BENCH_KEY_LEN * 8);
+
+	for (int n = 0; n < ARRAY_SIZE(bench_len); n++) {
+		iters = bench_iters(bench_len[n]);
+		start = bench_cycles();
+		for (uint32_t i = 0; i < iters; i++) {
+			ret |= mbedtls_gcm_crypt_and_tag(&gcm,
+							 MBEDTLS_GCM_ENCRYPT,
+							 bench_len[n],
+							 iv, BENCH_IV_LEN,
+							 NULL, 0, bench_in,
+							 bench_out,
+							 BENCH_TAG_LEN, tag);
+		}
+		cycles = bench_cycles() - start;
+		bench_report("aes256-gcm-enc", bench_len[n], iters, cycles);
+
+		start = bench_cycles();
+		for (uint32_t i = 0; i < iters; i++) {
+			ret |= mbedtls_gcm_auth_decrypt(&gcm, bench_len[n],
+							iv, BENCH_IV_LEN,
+							NULL, 0, tag,
+							BENCH_TAG_LEN,
+							bench_out, bench_in);
+		}
+		cycles = bench_cycles() - start;
+		bench_report("aes256-gcm-dec", bench_len[n], iters, cycles);
+	}
+
+	mbedtls_gcm_free(&gcm);
+
+	if (ret != 0) {
+		printk("{\"alg\":\"aes256-gcm\",\"error\":%d}\n", ret);
+	}
+}
+#else
+static void bench_gcm(void)
+{
+	bench_skip("aes256-gcm");
+}
+#endif
+
+static void bench_sha(void)
+{
+	uint8_t digest[64];
+	bench_cycles_t start;
+	uint32_t iters;
+
+	for (int n = 0; n < ARRAY_SIZE(bench_len); n++) {
+		iters = bench_iters(bench_len[n]);
+
+#if defined(MBEDTLS_SHA256_C)
+		start = bench_cycles();
+		for (uint32_t i = 0; i < iters; i++) {
+			mbedtls_sha256_ret(bench_in, bench_len[n], digest, 0);
+		}
+		bench_report("sha256", bench_len[n], iters,
+			     bench_cycles() - start);
+#else
+		bench_skip("sha256");
+#endif
+
+#if defined(MBEDTLS_SHA512_C)
+		start = bench_cycles();
+		for (uint32_t i = 0; i < iters; i++) {
+			mbedtls_sha512_ret(bench_in, bench_len[n], digest, 1);
+		}
+		bench_report("sha384", bench_len[n], iters,
+			     bench_cycles() - start);
+#else
+		bench_skip("sha384");
+#endif
+	}
+}
+
+#if defined(MBEDTLS_HKDF_C) && defined(MBEDTLS_SHA256_C)
+static void bench_hkdf(void)
+{
+	const mbedtls_md_info_t *md = mbedtls_md_info_from_type(
+		MBEDTLS_MD_SHA256);
+	/* Same shape as the OOB context key derivation */
+	static const char info[] = "DEV_ID_ENC_KEY";
+	uint8_t salt[32];
+	uint8_t ikm[32];
+	uint8_t okm[BENCH_HKDF_LEN];
+	uint32_t iters = CONFIG_CRYPTO_BENCH_PK_ITERS * 64;
+	bench_cycles_t start;
+
+	bench_rng(NULL, salt, sizeof(salt));
+	bench_rng(NULL, ikm, sizeof(ikm));
+
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		mbedtls_hkdf(md, salt, sizeof(salt), ikm, sizeof(ikm),
+			     (const unsigned char *)info, strlen(info),
+			     okm, sizeof(okm));
+	}
+	bench_report("hkdf-sha256", BENCH_HKDF_LEN, iters,
+		     bench_cycles() - start);
+}
+#else
+static void bench_hkdf(void)
+{
+	bench_skip("hkdf-sha256");
+}
+#endif
+
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDSA_C)
+/**
+ * @brief Time the public key steps of one TLS ECDHE-ECDSA handshake.
+ *
+ * @param id Curve
+ * @param name Curve name used in the reported algorithm names
+ */
+static void bench_ecp(mbedtls_ecp_group_id id, const char *name)
+{
+	mbedtls_ecp_group grp;
+	mbedtls_mpi d, d_peer, z, r, s;
+	mbedtls_ecp_point q, q_peer;
+	uint8_t hash[32];
+	char alg[32];
+	bench_cycles_t start;
+	uint32_t iters = CONFIG_CRYPTO_BENCH_PK_ITERS;
+	int ret;
+
+	mbedtls_ecp_group_init(&grp);
+	mbedtls_mpi_init(&d);
+	mbedtls_mpi_init(&d_peer);
+	mbedtls_mpi_init(&z);
+	mbedtls_mpi_init(&r);
+	mbedtls_mpi_init(&s);
+	mbedtls_ecp_point_init(&q);
+	mbedtls_ecp_point_init(&q_peer);
+
+	ret = mbedtls_ecp_group_load(&grp, id);
+	if (ret != 0) {
+		snprintk(alg, sizeof(alg), "ecp-%s", name);
+		bench_skip(alg);
+		goto out;
+	}
+
+	/* Peer key of the key exchange */
+	ret |= mbedtls_ecdh_gen_public(&grp, &d_peer, &q_peer, bench_rng,
+				       NULL);
+
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		ret |= mbedtls_ecdh_gen_public(&grp, &d, &q, bench_rng, NULL);
+	}
+	snprintk(alg, sizeof(alg), "ecdhe-%s-keygen", name);
+	bench_report(alg, 0, iters, bench_cycles() - start);
+
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		ret |= mbedtls_ecdh_compute_shared(&grp, &z, &q_peer, &d,
+						   bench_rng, NULL);
+	}
+	snprintk(alg, sizeof(alg), "ecdhe-%s-shared", name);
+	bench_report(alg, 0, iters, bench_cycles() - start);
+
+	bench_rng(NULL, hash, sizeof(hash));
+
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		ret |= mbedtls_ecdsa_sign(&grp, &r, &s, &d, hash,
+					  sizeof(hash), bench_rng, NULL);
+	}
+	snprintk(alg, sizeof(alg), "ecdsa-%s-sign", name);
+	bench_report(alg, 0, iters, bench_cycles() - start);
+
+	start = bench_cycles();
+	for (uint32_t i = 0; i < iters; i++) {
+		ret |= mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &q,
+					    &r, &s);
+	}
+	snprintk(alg, sizeof(alg), "ecdsa-%s-verify", name);
+	bench_report(alg, 0, iters, bench_cycles() - start);
+
+	if (ret != 0) {
+		printk("{\"alg\":\"ecp-%s\",\"error\":%d}\n", name, ret);
+	}
+
+out:
+	mbedtls_ecp_point_free(&q_peer);
+	mbedtls_ecp_point_free(&q);
+	mbedtls_mpi_free(&s);
+	mbedtls_mpi_free(&r);
+	mbedtls_mpi_free(&z);
+	mbedtls_mpi_free(&d_peer);
+	mbedtls_mpi_free(&d);
+	mbedtls_ecp_group_free(&grp);
+}
+
+static void bench_handshake(void)
+{
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+	bench_ecp(MBEDTLS_ECP_DP_SECP256R1, "p256");
+#else
+	bench_skip("ecp-p256");
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+	bench_ecp(MBEDTLS_ECP_DP_SECP384R1, "p384");
+#else
+	bench_skip("ecp-p384");
+#endif
+}
+#else
+static void bench_handshake(void)
+{
+	bench_skip("ecp");
+}
+#endif
+
+void main(void)
+{
+	bench_rng(NULL, bench_in, sizeof(bench_in));
+
+	bench_config();
+	bench_gcm();
+	bench_sha();
+	bench_hkdf();
+	bench_handshake();
+
+	printk("{\"bench\":\"done\"}\n");
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+	posix_exit(0);
+#endif
+}
+
+/**
+ * @}
+ */
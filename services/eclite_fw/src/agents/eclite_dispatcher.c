@@ -22,6 +22,7 @@ LOG_MODULE_REGISTER(dispatcher, CONFIG_ECLITE_LOG_LEVEL);
 #define ECLITE_TASK_PRIORITY    K_PRIO_PREEMPT(0)
 #define ECLITE_QUEUE_LEN        sizeof(struct dispatcher_queue_data)
 #define ECLITE_QUEUE_DEPTH      20
+#define ECLITE_CRIT_QUEUE_DEPTH 8
 #define ECLITE_POOL_MIN_SIZE_BLOCK 8
 #define ECLITE_POOL_MAX_SIZE_BLOCK 128
 #define ECLITE_POOL_MAX_BLOCKS 4
@@ -32,11 +33,31 @@ LOG_MODULE_REGISTER(dispatcher, CONFIG_ECLITE_LOG_LEVEL);
 
 __kernel struct k_thread dispatcher_task;
 K_MSGQ_DEFINE(dispatcher_queue, ECLITE_QUEUE_LEN, ECLITE_QUEUE_DEPTH, 4);
+K_MSGQ_DEFINE(dispatcher_crit_queue, ECLITE_QUEUE_LEN, ECLITE_CRIT_QUEUE_DEPTH,
+	      4);
+/* One count per queued critical/host event or newly pending periodic one */
+K_SEM_DEFINE(dispatcher_sem, 0, K_SEM_MAX_LIMIT);
 K_THREAD_STACK_DEFINE(dispatcher_stack, 1600);
 K_HEAP_DEFINE(ecl_pool_name,
 	      ECLITE_POOL_MAX_SIZE_BLOCK * ECLITE_POOL_MAX_BLOCKS);
 
+/* Periodic events pending, bit per enum eclite_events. */
+static APP_GLOBAL_VAR_BSS(1) atomic_t periodic_pending;
+static APP_GLOBAL_VAR_BSS(1) struct dispatcher_stats dispatcher_stats;
+/* Period polling timer currently runs with. */
+static APP_GLOBAL_VAR(1) uint32_t poll_armed_ms =
+	CONFIG_ECLITE_POLLING_TIMER_PERIOD;
+
+/* Periodic events in service order. */
+static const enum eclite_events periodic_events[] = {
+	TIMER_EVENT,
+	CHG_EVENT,
+	FG_EVENT,
+	THERMAL_EVENT,
+};
+
 static void eclite_dispatcher(void *p1, void *p2, void *p3);
+static void eclite_send_ucsi_event(void);
 static int gpio_event_processing(struct eclite_device
 				 *platform_gpio[], uint32_t gpio_number);
 
@@ -151,6 +172,8 @@ static void handle_crit_battery_shutdown(struct eclite_opregion_t *opregion)
 
 	if (capacity < critical_level) {
 		if (capacity < critical_level - delta) {
+			/* Let host see battery level causing shutdown */
+			eclite_flush_events();
 			power_state_change(PMC_SRT_SHUTDOWN);
 		}
 	}
@@ -170,6 +193,8 @@ static void handle_crit_thermal_shutdown(struct eclite_opregion_t *opregion)
 	if (cpu_temp > TEMP_CPU_CRIT_SHUTDOWN) {
 		LOG_ERR("CPU [%d] is too hot, shutting down",
 			opregion->cpu_temperature);
+		/* Let host see temperature causing shutdown */
+		eclite_flush_events();
 		power_state_change(PMC_SRT_SHUTDOWN);
 	}
 #endif
@@ -178,6 +203,7 @@ static void handle_crit_thermal_shutdown(struct eclite_opregion_t *opregion)
 	    (skin_temp[2] > TEMP_SYS_CRIT_SHUTDOWN) ||
 	    (skin_temp[3] > TEMP_SYS_CRIT_SHUTDOWN)) {
 		LOG_ERR("Platform sensor too hot, shutting down\n");
+		eclite_flush_events();
 		power_state_change(PMC_SRT_SHUTDOWN);
 	}
 
@@ -187,7 +213,7 @@ static inline void eclite_check_thermal_event(uint16_t sensor_condition,
 					      uint16_t host_event_id)
 {
 	if (sensor_condition) {
-		eclite_send_event(host_event_id);
+		eclite_post_event(host_event_id);
 	}
 }
 
@@ -214,9 +240,9 @@ static void eclite_send_charger_event(uint16_t *charger_status)
 	/* charger status change.*/
 	if (*charger_status & BIT1) {
 		if (*charger_status & BIT0) {
-			eclite_send_event(ECLITE_EVENT_CHARGER_CONNECT);
+			eclite_post_event(ECLITE_EVENT_CHARGER_CONNECT);
 		} else {
-			eclite_send_event(ECLITE_EVENT_CHARGER_DISCONNECT);
+			eclite_post_event(ECLITE_EVENT_CHARGER_DISCONNECT);
 		}
 	}
 }
@@ -299,7 +325,12 @@ static void process_ucsi_command(uint8_t event)
 		ECLITE_LOG_DEBUG("Wrong event = %d", event);
 		break;
 	}
-	ucsi_framework(USBC_MSG_IN);
+	/* Driver may complete command itself, e.g. with error when it could
+	 * not be written to PD controller.
+	 */
+	if (ucsi_framework(USBC_MSG_IN) == UCSI_CCI_UPDATED) {
+		eclite_send_ucsi_event();
+	}
 }
 
 static void eclite_send_ucsi_event(void)
@@ -334,7 +365,7 @@ static void eclite_send_ucsi_event(void)
 	ECLITE_LOG_DEBUG("ucsi_version: %x",
 			 eclite_opregion.ucsi_in_data.ucsi_version);
 
-	eclite_send_event(ECLITE_EVENT_UCSI_UPDATE);
+	eclite_post_event(ECLITE_EVENT_UCSI_UPDATE);
 }
 
 static void timer_event_process(void)
@@ -346,6 +377,74 @@ static void timer_event_process(void)
 	event_data.data = 0;
 	eclite_post_dispatcher_event(&event_data);
 
+#ifdef CONFIG_ECLITE_UCSI_FRAMEWORK
+	/* Reports failed command and recovers lost command completion. */
+	if (ucsi_poll() == UCSI_CCI_UPDATED) {
+		eclite_send_ucsi_event();
+	}
+#endif
+}
+
+void thermal_poll_start(void)
+{
+	poll_armed_ms = CONFIG_ECLITE_POLLING_TIMER_PERIOD;
+	k_timer_start(&dispatcher_timer, K_NO_WAIT, K_MSEC(poll_armed_ms));
+}
+
+/* Re-arm polling timer with interval chosen by thermal framework. Timer
+ * stopped for S0ix/Sx or HECI disconnect is left stopped. Restarting
+ * pushes next poll back, so running timer is only touched when interval
+ * changed, alerts and host requests leave poll schedule alone.
+ */
+static void thermal_poll_rearm(void)
+{
+	uint32_t period = thermal_poll_interval();
+
+	if (period == poll_armed_ms ||
+	    !k_timer_remaining_get(&dispatcher_timer)) {
+		return;
+	}
+
+	poll_armed_ms = period;
+	k_timer_start(&dispatcher_timer, K_MSEC(period), K_MSEC(period));
+}
+
+/* Pick highest priority pending event. */
+static bool dispatcher_next_event(struct dispatcher_queue_data *event_data)
+{
+	if (!k_msgq_get(&dispatcher_crit_queue, event_data, K_NO_WAIT)) {
+		return true;
+	}
+
+	if (!k_msgq_get(&dispatcher_queue, event_data, K_NO_WAIT)) {
+		return true;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(periodic_events); i++) {
+		if (atomic_test_and_clear_bit(&periodic_pending,
+					      periodic_events[i])) {
+			event_data->event_type = periodic_events[i];
+			event_data->data = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void dispatcher_account(enum eclite_events event, uint32_t cycles)
+{
+	uint32_t usec = k_cyc_to_us_floor32(cycles);
+
+	if (event >= NUM_OF_ECLITE_EVENTS) {
+		return;
+	}
+
+	dispatcher_stats.handled[event]++;
+	dispatcher_stats.busy_us[event] += usec;
+	if (usec > dispatcher_stats.max_us[event]) {
+		dispatcher_stats.max_us[event] = usec;
+	}
 }
 
 static void eclite_dispatcher(void *p1, void *p2, void *p3)
@@ -357,6 +456,7 @@ static void eclite_dispatcher(void *p1, void *p2, void *p3)
 	struct dispatcher_queue_data queue_data;
 	uint16_t thermal_status;
 	uint16_t charger_status;
+	uint32_t start;
 
 	while (1) {
 		/**
@@ -366,9 +466,14 @@ static void eclite_dispatcher(void *p1, void *p2, void *p3)
 		 * 3. if thermal event call thermalframework_process_event()
 		 * 4. if HECI event call heci_process_event(event);
 		 */
-		k_msgq_get(&dispatcher_queue, &queue_data, K_FOREVER);
+		k_sem_take(&dispatcher_sem, K_FOREVER);
+		if (!dispatcher_next_event(&queue_data)) {
+			/* Event purged after it was signalled */
+			continue;
+		}
 		ECLITE_LOG_DEBUG("Queue event_type = %d",
 				 queue_data.event_type);
+		start = k_cycle_get_32();
 		switch (queue_data.event_type) {
 		case HECI_EVENT:
 			ECLITE_LOG_DEBUG("Dispatcher HECI Event");
@@ -407,7 +512,7 @@ static void eclite_dispatcher(void *p1, void *p2, void *p3)
 			update_opregion(DEV_CHG);
 			eclite_send_charger_event(&charger_status);
 			if (charger_status & BIT2) {
-				eclite_send_event(ECLITE_EVENT_BATTERY);
+				eclite_post_event(ECLITE_EVENT_BATTERY);
 			}
 			handle_low_battery_wake(&eclite_opregion);
 			handle_crit_battery_shutdown(&eclite_opregion);
@@ -425,6 +530,7 @@ static void eclite_dispatcher(void *p1, void *p2, void *p3)
 			}
 			/* Callback processing */
 			thermal_callback(&thermal_status);
+			thermal_poll_rearm();
 			update_opregion(DEV_THERMAL);
 			update_opregion(DEV_FAN);
 			update_opregion(DEV_THERMAL_CPU);
@@ -445,21 +551,101 @@ static void eclite_dispatcher(void *p1, void *p2, void *p3)
 					 queue_data.event_type);
 			break;
 		}
+		dispatcher_account(queue_data.event_type,
+				   k_cycle_get_32() - start);
+
+		/* Notify host once queue drains, merging events raised by
+		 * back to back events into one notification each.
+		 */
+		if (!k_sem_count_get(&dispatcher_sem)) {
+			eclite_flush_events();
+		}
 	}
 }
 
-int eclite_post_dispatcher_event(struct dispatcher_queue_data *event_data)
+static enum dispatcher_prio
+dispatcher_event_prio(struct dispatcher_queue_data *event_data)
 {
+	switch (event_data->event_type) {
+	case GPIO_EVENT:
+		return DISPATCHER_PRIO_CRITICAL;
+	case TIMER_EVENT:
+		return DISPATCHER_PRIO_PERIODIC;
+	case CHG_EVENT:
+	case FG_EVENT:
+	case THERMAL_EVENT:
+		/* Non zero data carries a host command */
+		return event_data->data ? DISPATCHER_PRIO_HOST :
+		       DISPATCHER_PRIO_PERIODIC;
+	default:
+		return DISPATCHER_PRIO_HOST;
+	}
+}
+
+int eclite_post_dispatcher_event_prio(struct dispatcher_queue_data *event_data,
+				      enum dispatcher_prio prio)
+{
+	struct k_msgq *queue = &dispatcher_queue;
+	uint32_t pending;
 	int ret;
 
-	ret = k_msgq_put(&dispatcher_queue, event_data, K_NO_WAIT);
-	return ret;
+	if (prio == DISPATCHER_PRIO_PERIODIC) {
+		if (atomic_test_and_set_bit(&periodic_pending,
+					    event_data->event_type)) {
+			dispatcher_stats.coalesced++;
+			return 0;
+		}
+		pending = __builtin_popcount(atomic_get(&periodic_pending));
+		if (pending > dispatcher_stats.high_water[prio]) {
+			dispatcher_stats.high_water[prio] = pending;
+		}
+		k_sem_give(&dispatcher_sem);
+		return 0;
+	}
+
+	if (prio == DISPATCHER_PRIO_CRITICAL) {
+		queue = &dispatcher_crit_queue;
+	}
+
+	ret = k_msgq_put(queue, event_data, K_NO_WAIT);
+	if (ret) {
+		dispatcher_stats.dropped[prio]++;
+		return ret;
+	}
+
+	pending = k_msgq_num_used_get(queue);
+	if (pending > dispatcher_stats.high_water[prio]) {
+		dispatcher_stats.high_water[prio] = pending;
+	}
+	k_sem_give(&dispatcher_sem);
+
+	return 0;
+}
+
+int eclite_post_dispatcher_event(struct dispatcher_queue_data *event_data)
+{
+	return eclite_post_dispatcher_event_prio(
+		       event_data, dispatcher_event_prio(event_data));
+}
+
+void eclite_purge_dispatcher_events(void)
+{
+	k_msgq_purge(&dispatcher_crit_queue);
+	k_msgq_purge(&dispatcher_queue);
+	atomic_clear(&periodic_pending);
+}
+
+void eclite_get_dispatcher_stats(struct dispatcher_stats *stats)
+{
+	memcpy(stats, &dispatcher_stats, sizeof(*stats));
 }
 
 static int gpio_event_processing(struct eclite_device
 				 *platform_gpio[], uint32_t gpio_number)
 {
 	struct dispatcher_queue_data event_data;
+	/* Event types already queued for this interrupt */
+	uint32_t posted = 0;
 
 	for (int i = 0; i < no_of_devices; i++) {
 		void *gpio_dev = platform_gpio[i]->hw_interface->gpio_dev;
@@ -467,7 +653,14 @@ static int gpio_event_processing(struct eclite_device
 			(struct platform_gpio_config *)
 			platform_gpio[i]->hw_interface->gpio_config;
 
+		/* CPU and fan have no interrupt line */
+		if (!gpio_cfg) {
+			continue;
+		}
+
 		if (gpio_number == gpio_cfg->gpio_no) {
+			bool post = true;
+
 			ECLITE_LOG_DEBUG("gpio_number:%d", gpio_number);
 			if (platform_gpio[i]->isr != NULL) {
 				if (platform_gpio[i]->isr((void *)
@@ -490,14 +683,29 @@ static int gpio_event_processing(struct eclite_device
 				event_data.event_type = THERMAL_EVENT;
 				break;
 			case DEV_UCSI:
-				event_data.event_type = UCSI_EVENT;
+				/* CCI and MSG IN already read by ISR, notify
+				 * host without another trip through queue.
+				 */
+				eclite_send_ucsi_event();
+				post = false;
 				break;
 			default:        /* unknown device type */
 				ECLITE_LOG_DEBUG("UNKNOWN EVENT");
 				break;
 			}
 			event_data.data = 0;
-			eclite_post_dispatcher_event(&event_data);
+			/* Devices sharing an alert line are all served by one
+			 * framework pass, queue it once.
+			 */
+			if (post && (posted & BIT(event_data.event_type))) {
+				post = false;
+			}
+			/* Device interrupt, serve ahead of periodic polls */
+			if (post) {
+				posted |= BIT(event_data.event_type);
+				eclite_post_dispatcher_event_prio(
+					&event_data, DISPATCHER_PRIO_CRITICAL);
+			}
 		} else {
 			continue;
 		}
@@ -17,6 +17,7 @@
 LOG_MODULE_REGISTER(hostcomm, CONFIG_ECLITE_LOG_LEVEL);
 
 #define EVENT_NOTIFY_CONFIG 333
+#define BITS_PER_EVENT_MAP 32
 
 #ifdef CONFIG_HECI
 APP_GLOBAL_VAR(1) static heci_rx_msg_t eclite_rx_msg;
@@ -29,6 +30,23 @@ APP_GLOBAL_VAR(1) k_tid_t thread_using_heci[] = { &dispatcher_task };
 
 APP_GLOBAL_VAR_BSS(1) static struct message_buffer eclite_tx_buffer;
 
+/* Opregion write permission, block index + 1 per byte, 0 if read only. */
+APP_GLOBAL_VAR_BSS(1) static uint8_t opregion_wr_map[MAX_OPR_LENGTH];
+APP_GLOBAL_VAR_BSS(1) static bool opregion_wr_map_ready;
+
+#ifdef CONFIG_HECI
+/* Opregion change tracking for delta reads. */
+APP_GLOBAL_VAR_BSS(1) static uint8_t opregion_shadow[MAX_OPR_LENGTH];
+APP_GLOBAL_VAR_BSS(1) static uint32_t
+	opregion_chunk_gen[ECLITE_OPR_GEN_CHUNKS];
+APP_GLOBAL_VAR_BSS(1) static uint32_t opregion_gen;
+APP_GLOBAL_VAR_BSS(1) static struct eclite_delta_buffer
+	eclite_delta_tx_buffer;
+#endif
+
+/* Host events waiting for aggregated notification, bit per event. */
+APP_GLOBAL_VAR_BSS(1) static uint32_t pending_events;
+
 APP_GLOBAL_VAR(1) struct eclite_opregion_t eclite_opregion;
 
 APP_GLOBAL_VAR(1) static struct eclite_opreg_wr_attr_tbl
@@ -133,32 +151,123 @@ static int eclite_process_event_message(struct message_header_type
 	return 0;
 }
 #endif
+/* Build per byte map of writable opregion blocks, 0 for read only bytes
+ * and block index + 1 otherwise.
+ */
+static void eclite_build_opreg_wr_map(void)
+{
+	for (uint8_t blockid = 0x0; blockid < NUM_OF_OPR_WR_BLKS; blockid++) {
+		for (uint16_t offset = opregion_wr_chk_tbl[blockid].offset_start;
+		     offset <= opregion_wr_chk_tbl[blockid].offset_end;
+		     offset++) {
+			opregion_wr_map[offset] = blockid + 1;
+		}
+	}
+	opregion_wr_map_ready = true;
+}
+
 static int eclite_verify_opreg_wr_access(uint16_t offset, uint16_t blocksz)
 {
-	uint8_t blockid = 0x0;
-
-	for (blockid = 0x0; blockid < NUM_OF_OPR_WR_BLKS; blockid++) {
-		/* Verify write allowed in the Op-Region block */
-		if (offset >= opregion_wr_chk_tbl[blockid].offset_start &&
-		    blocksz <= opregion_wr_chk_tbl[blockid].block_sz &&
-		    (offset + blocksz - 1) <=
-		    opregion_wr_chk_tbl[blockid].offset_end) {
-			ECLITE_LOG_DEBUG(
-				"offset_start:%d offset_end:%d block_sz:%d",
-				opregion_wr_chk_tbl[blockid].offset_start,
-				opregion_wr_chk_tbl[blockid].offset_end,
-				opregion_wr_chk_tbl[blockid].block_sz);
+	uint16_t last = offset + MAX(blocksz, 1) - 1;
 
-			return SUCCESS;
-		}
+	if (!opregion_wr_map_ready) {
+		eclite_build_opreg_wr_map();
 	}
+
+	/* Blocks are contiguous, so write stays within one block if both
+	 * ends map to same block.
+	 */
+	if (last < MAX_OPR_LENGTH && opregion_wr_map[offset] &&
+	    opregion_wr_map[offset] == opregion_wr_map[last]) {
+		return SUCCESS;
+	}
+
 	LOG_ERR("offset(%d)  blocksz(%d) write denied",
 		offset, blocksz);
 	return ERROR;
 }
 
 #ifdef CONFIG_HECI
-static int eclite_process_data_message(struct message_buffer *buffer)
+/* Stamp opregion chunks changed since last sync with a new generation. */
+static void eclite_sync_opreg_gen(void)
+{
+	uint8_t *opregion_buffer = (uint8_t *)&eclite_opregion;
+	bool changed = false;
+
+	for (int i = 0; i < ECLITE_OPR_GEN_CHUNKS; i++) {
+		uint16_t offset = i * ECLITE_OPR_GEN_CHUNK;
+
+		if (!memcmp(opregion_shadow + offset, opregion_buffer + offset,
+			    ECLITE_OPR_GEN_CHUNK)) {
+			continue;
+		}
+
+		if (!changed) {
+			opregion_gen++;
+			changed = true;
+		}
+		memcpy(opregion_shadow + offset, opregion_buffer + offset,
+		       ECLITE_OPR_GEN_CHUNK);
+		opregion_chunk_gen[i] = opregion_gen;
+	}
+}
+
+/* Serve delta read: chunks of [offset, offset + length) changed after
+ * requested generation, all chunks for generation 0.
+ */
+static int eclite_process_delta_read(uint16_t offset, uint16_t length,
+				     uint32_t since)
+{
+	uint8_t *opregion_buffer = (uint8_t *)&eclite_opregion;
+	struct eclite_delta_buffer *send_buf = &eclite_delta_tx_buffer;
+	struct message_header_type *message_header2;
+	uint16_t end = offset + length;
+	uint16_t pos = 0;
+	mrd_t mrd_message = { 0 };
+	int ret;
+
+	eclite_sync_opreg_gen();
+
+	message_header2 = (struct message_header_type *)
+			  &send_buf->message_header;
+	message_header2->revision = ECLITE_OPR_REVISION;
+	message_header2->data_type = ECLITE_HEADER_TYPE_DATA;
+	message_header2->read_write = ECLITE_HEADER_OPR_READ_DELTA;
+	message_header2->offset = offset;
+	message_header2->length = length;
+	send_buf->generation = opregion_gen;
+	send_buf->chunk_map = 0;
+
+	for (int i = offset / ECLITE_OPR_GEN_CHUNK;
+	     i * ECLITE_OPR_GEN_CHUNK < end; i++) {
+		uint16_t from = MAX(i * ECLITE_OPR_GEN_CHUNK, offset);
+		uint16_t to = MIN((i + 1) * ECLITE_OPR_GEN_CHUNK, end);
+
+		if (since && opregion_chunk_gen[i] <= since) {
+			continue;
+		}
+
+		send_buf->chunk_map |= BIT(i);
+		memcpy(send_buf->data + pos, opregion_buffer + from, to - from);
+		pos += to - from;
+	}
+
+	ECLITE_LOG_DEBUG("Delta read gen: %u map: %x bytes: %u",
+			 opregion_gen, send_buf->chunk_map, pos);
+
+	mrd_message.buf = send_buf;
+	mrd_message.len = offsetof(struct eclite_delta_buffer, data) + pos;
+	ret = heci_send(heci_connection_id, &mrd_message);
+	if (ret == false) {
+		LOG_ERR("delta read heci_send failed\n");
+		data_msg_heci_send_stat = FAILURE;
+	}
+
+	return 0;
+}
+
+static int eclite_process_data_message(struct message_buffer *buffer,
+				       uint16_t msg_len)
 {
 	uint8_t *opregion_buffer = (uint8_t *)&eclite_opregion;
 	uint16_t offset;
@@ -204,6 +313,24 @@ static int eclite_process_data_message(struct message_buffer *buffer)
 			data_msg_heci_send_stat = FAILURE;
 		}
 		ECLITE_LOG_DEBUG("Heci send ret val %d", ret);
+	} else if (message_header->read_write ==
+		   ECLITE_HEADER_OPR_READ_DELTA) {
+		uint32_t since;
+
+		/* Request carries generation to diff against as payload */
+		if (msg_len < offsetof(struct message_buffer, data) +
+			      sizeof(since)) {
+			LOG_ERR("Delta read request too short: %u", msg_len);
+			return ERROR;
+		}
+
+		memcpy(&since, buffer->data, sizeof(since));
+		ECLITE_LOG_DEBUG(
+			"ECLITE_HEADER_OPR_READ_DELTA offset: %d, length: %d",
+			offset,
+			length);
+
+		return eclite_process_delta_read(offset, length, since);
 	} else if (message_header->read_write == ECLITE_HEADER_OPR_WRITE) {
 		uint8_t *receive_buffer = buffer->data;
 		int ret;
@@ -232,7 +359,8 @@ static int eclite_process_data_message(struct message_buffer *buffer)
 #endif
 
 #ifdef CONFIG_HECI
-static int eclite_process_msg(struct message_buffer *buffer)
+static int eclite_process_msg(struct message_buffer *buffer,
+			      uint16_t msg_len)
 {
 	struct message_header_type *message_header = NULL;
 	int ret = ERROR;
@@ -244,7 +372,7 @@ static int eclite_process_msg(struct message_buffer *buffer)
 
 	message_header = (struct message_header_type *)&buffer->message_header;
 	if (message_header->data_type == ECLITE_HEADER_TYPE_DATA) {
-		ret = eclite_process_data_message(buffer);
+		ret = eclite_process_data_message(buffer, msg_len);
 		ECLITE_LOG_DEBUG("Process data msg ret: %d", ret);
 	}
 
@@ -296,6 +424,37 @@ int eclite_send_event(uint32_t event)
 	return 0;
 }
 
+int eclite_flush_events(void)
+{
+	uint32_t events = pending_events;
+	int ret = 0;
+
+	pending_events = 0;
+
+	for (uint32_t event = 0; events; event++, events >>= 1) {
+		if (events & BIT0) {
+			ret |= eclite_send_event(event);
+		}
+	}
+
+	return ret ? ERROR : 0;
+}
+
+int eclite_post_event(uint32_t event)
+{
+	if (event >= BITS_PER_EVENT_MAP) {
+		return eclite_send_event(event);
+	}
+
+	pending_events |= BIT(event);
+
+	if (BIT(event) & ECLITE_EVENT_URGENT_MASK) {
+		return eclite_flush_events();
+	}
+
+	return 0;
+}
+
 #ifdef CONFIG_HECI
 void check_events_config_request(uint32_t event)
 {
@@ -372,14 +531,14 @@ int eclite_heci_event_process(uint32_t event)
 			heci_connection_id = eclite_rx_msg.connection_id;
 			ECLITE_LOG_DEBUG("New conn: %u", heci_connection_id);
 			if (cpu_thermal_enable) {
-				k_timer_start(&dispatcher_timer, K_NO_WAIT,
-				    K_MSEC(CONFIG_ECLITE_POLLING_TIMER_PERIOD));
+				thermal_poll_start();
 			}
 		} else if (eclite_rx_msg.type == HECI_REQUEST) {
 			ECLITE_LOG_DEBUG(
 				"Eclite process msg HECI Request");
 			ret = eclite_process_msg((struct message_buffer *)
-						 eclite_rx_msg.buffer);
+						 eclite_rx_msg.buffer,
+						 eclite_rx_msg.length);
 			ECLITE_LOG_DEBUG("Eclite process msg sts ret:%d", ret);
 			if (data_msg_heci_send_stat == FAILURE) {
 				LOG_ERR("process data message failed\n");
@@ -405,7 +564,7 @@ int eclite_heci_event_process(uint32_t event)
 			heci_connection_id = ECLITE_HECI_INVALID_CONN_ID;
 			if (cpu_thermal_enable) {
 				k_timer_stop(&dispatcher_timer);
-				k_msgq_purge(&dispatcher_queue);
+				eclite_purge_dispatcher_events();
 			}
 
 			ret = SUCCESS;
@@ -32,16 +32,22 @@ static void update_charger_region(void)
 			 eclite_opregion.psrc,
 			 charger_data->ac_present);
 }
+/* Opregion battery_info field backed by each battery cache reading. */
+static const uint8_t battery_region_map[SBS_CACHE_MAX] = {
+	[SBS_CACHE_VOLTAGE] = offsetof(struct battery, battery_voltage),
+	[SBS_CACHE_AT_RATE] = offsetof(struct battery, preset_rate),
+	[SBS_CACHE_REMAINING_CAPACITY] =
+		offsetof(struct battery, remaining_capacity),
+	[SBS_CACHE_FULL_CHARGE_CAPACITY] =
+		offsetof(struct battery, full_charge_capacity),
+	[SBS_CACHE_CYCLE_COUNT] = offsetof(struct battery, cycle_count),
+	[SBS_CACHE_DESIGN_CAPACITY] =
+		offsetof(struct battery, design_capacity),
+	[SBS_CACHE_DESIGN_VOLTAGE] = offsetof(struct battery, design_voltage),
+};
+
 static void update_battery_region(void)
 {
-	struct eclite_device *charger_dev = find_dev_by_type(DEV_CHG);
-
-	/* Look for charger device, if not found return error */
-	if (!charger_dev) {
-		LOG_ERR("No charger device");
-		return;
-	}
-
 	struct eclite_device *sbs_dev = find_dev_by_type(DEV_FG);
 
 	/* Look for sbs_dev device, if not found return error */
@@ -51,50 +57,37 @@ static void update_battery_region(void)
 	}
 
 	struct sbs_driver_data *battery_data = sbs_dev->driver_data;
-	const struct sbs_driver_api *battery_api = sbs_dev->driver_api;
+	struct sbs_battery_cache *cache = &battery_data->cache;
+	uint8_t *region = (uint8_t *)&eclite_opregion.battery_info;
+	uint32_t changed = 0;
+	int ret;
 
-	const struct charger_driver_api *charger_api = charger_dev->driver_api;
-
-	uint8_t ret = 0;
-
-	ARG_UNUSED(charger_dev);
-	ARG_UNUSED(charger_api);
 	eclite_opregion.battery_info.state =
 		battery_data->chargering_status;
 
-	ret = battery_api->voltage(
-		sbs_dev,
-		&eclite_opregion.battery_info.battery_voltage);
-
-	ret |= battery_api->at_rate(sbs_dev,
-				    &eclite_opregion.battery_info.preset_rate);
-
-	ret |= battery_api->remaining_capacity(
-		sbs_dev,
-		&eclite_opregion.battery_info.remaining_capacity);
-
-	ret |= battery_api->design_capacity(
-		sbs_dev,
-		&eclite_opregion.battery_info.design_capacity);
+	ret = sbs_cache_refresh(sbs_dev);
 
-	ret |= battery_api->full_charge_capacity(
-		sbs_dev,
-		&eclite_opregion.battery_info.full_charge_capacity);
+	/* Only touch opregion fields whose reading changed */
+	for (int i = 0; i < SBS_CACHE_MAX; i++) {
+		uint16_t *field = (uint16_t *)(region + battery_region_map[i]);
 
-	ret |= battery_api->design_voltage(
-		sbs_dev,
-		&eclite_opregion.battery_info.design_voltage);
+		if (!(cache->valid & BIT(i)) || *field == cache->value[i]) {
+			continue;
+		}
 
-	ret |= battery_api->cycle_count(
-		sbs_dev,
-		&eclite_opregion.battery_info.cycle_count);
+		*field = cache->value[i];
+		changed |= BIT(i);
+	}
 
 	/* discharge_rate */
-	if ((int16_t)eclite_opregion.battery_info.preset_rate < 0) {
+	if ((changed & BIT(SBS_CACHE_AT_RATE)) &&
+	    (int16_t)eclite_opregion.battery_info.preset_rate < 0) {
 		eclite_opregion.battery_info.discharge_rate =
 			eclite_opregion.battery_info.preset_rate;
 	}
 
+	ECLITE_LOG_DEBUG("Battery fields changed: %x", changed);
+
 	if (ret) {
 		LOG_WRN("Error-%d updating opregion", ret);
 	}
@@ -40,6 +40,37 @@ void eclite_service_isr(const struct device *port,
 	}
 }
 
+static bool gpio_listed_before(struct platform_gpio_list plt_gpio_list[],
+			       int idx)
+{
+	for (int j = 0; j < idx; j++) {
+		if (plt_gpio_list[j].gpio_no == plt_gpio_list[idx].gpio_no) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool gpio_shared_before(struct eclite_device *eclite_dev_list[],
+			       int idx)
+{
+	const struct hw_configuration *hw = eclite_dev_list[idx]->hw_interface;
+	const struct platform_gpio_config *cfg = hw->gpio_config;
+
+	for (int i = 0; i < idx; i++) {
+		const struct hw_configuration *prev =
+			eclite_dev_list[i]->hw_interface;
+		const struct platform_gpio_config *prev_cfg =
+			prev->gpio_config;
+
+		if (prev->gpio_dev == hw->gpio_dev && prev_cfg &&
+		    prev_cfg->gpio_no == cfg->gpio_no) {
+			return true;
+		}
+	}
+	return false;
+}
+
 int eclite_service_gpio_config(struct eclite_device *eclite_dev_list[],
 			       struct platform_gpio_list plt_gpio_list[],
 			       uint32_t no_of_devices, uint32_t no_plt_gpio)
@@ -55,6 +86,9 @@ int eclite_service_gpio_config(struct eclite_device *eclite_dev_list[],
 
 	/* Run through the global list. */
 	for (int j = 0; j < no_plt_gpio; j++) {
+		if (gpio_listed_before(plt_gpio_list, j)) {
+			continue;
+		}
 		for (int i = 0; i < no_of_devices; i++) {
 			void *gpio_dev =
 				eclite_dev_list[i]->hw_interface->gpio_dev;
@@ -67,6 +101,12 @@ int eclite_service_gpio_config(struct eclite_device *eclite_dev_list[],
 						 eclite_dev_list[i]->name);
 				continue;
 			}
+			/* Devices on a shared line are all served from
+			 * first device's callback.
+			 */
+			if (gpio_shared_before(eclite_dev_list, i)) {
+				continue;
+			}
 			gpio_pin_num = gpio_cfg->gpio_no;
 			gpio_pin_flag = gpio_cfg->gpio_config.dir |
 					gpio_cfg->gpio_config.pull_down_en;
@@ -35,6 +35,8 @@ enum eclite_events {
 	THERMAL_EVENT,
 	/** UCSI Event */
 	UCSI_EVENT,
+	/** Number of event types */
+	NUM_OF_ECLITE_EVENTS,
 };
 
 /** @brief eclite queue data table.
@@ -48,9 +50,48 @@ struct dispatcher_queue_data {
 	uint32_t data;
 };
 
+/** @brief dispatcher priority classes.
+ *
+ * Dispatcher always serves critical events first, then host requests and
+ * then periodic events.
+ */
+enum dispatcher_prio {
+	/** Interrupt driven events, may lead to critical shutdown */
+	DISPATCHER_PRIO_CRITICAL,
+	/** HECI messages and host commands */
+	DISPATCHER_PRIO_HOST,
+	/** Periodic polling, identical pending events coalesce */
+	DISPATCHER_PRIO_PERIODIC,
+	/** Number of priority classes */
+	DISPATCHER_PRIO_MAX,
+};
+
+/** @brief dispatcher queue statistics.
+ *
+ * Statistics per dispatcher priority class.
+ */
+struct dispatcher_stats {
+	/** Highest number of events pending in queue */
+	uint32_t high_water[DISPATCHER_PRIO_MAX];
+	/** Events dropped as queue was full */
+	uint32_t dropped[DISPATCHER_PRIO_MAX];
+	/** Periodic events merged into an already pending one */
+	uint32_t coalesced;
+	/** Events handled per event type */
+	uint32_t handled[NUM_OF_ECLITE_EVENTS];
+	/** Total handling time in usec per event type */
+	uint32_t busy_us[NUM_OF_ECLITE_EVENTS];
+	/** Longest handling time in usec per event type */
+	uint32_t max_us[NUM_OF_ECLITE_EVENTS];
+};
+
 /**
  * @brief This routine insert event for EClite dispatcher processing.
  *
+ * Priority class is derived from event: GPIO events are critical, timer
+ * and polling events without command data are periodic, rest are host
+ * requests.
+ *
  * @note Can be called by ISRs.
  *
  * @param event_data data for event.
@@ -61,6 +102,33 @@ struct dispatcher_queue_data {
  */
 int eclite_post_dispatcher_event(struct dispatcher_queue_data *event_data);
 
+/**
+ * @brief This routine insert event for EClite dispatcher processing in
+ * given priority class.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param event_data data for event.
+ * @param prio priority class of event.
+ *
+ * @retval 0 Event inserted or coalesced successfully.
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ */
+int eclite_post_dispatcher_event_prio(struct dispatcher_queue_data *event_data,
+				      enum dispatcher_prio prio);
+
+/**
+ * @brief This routine drops all events pending for dispatcher.
+ */
+void eclite_purge_dispatcher_events(void);
+
+/**
+ * @brief This routine reads dispatcher queue statistics.
+ *
+ * @param stats copy of statistics.
+ */
+void eclite_get_dispatcher_stats(struct dispatcher_stats *stats);
+
 /**
  * @brief This routine initialize and starts dispatcher services.
  *
@@ -69,12 +137,22 @@ int eclite_post_dispatcher_event(struct dispatcher_queue_data *event_data);
  */
 int dispatcher_init(void);
 
+/**
+ * @brief Start thermal polling timer, first poll is immediate.
+ *
+ * Polling continues at CONFIG_ECLITE_POLLING_TIMER_PERIOD until thermal
+ * framework picks another interval.
+ */
+void thermal_poll_start(void);
+
 /**
  * @brief @brief Kernel objects used by dispatcher.
  *
  */
 extern struct k_thread dispatcher_task;
 extern struct k_msgq dispatcher_queue;
+extern struct k_msgq dispatcher_crit_queue;
+extern struct k_sem dispatcher_sem;
 extern struct k_timer dispatcher_timer;
 
 /**
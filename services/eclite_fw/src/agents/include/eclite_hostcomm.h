@@ -69,6 +69,11 @@
 #define ECLITE_HEADER_TYPE_EVENT                0x2
 #define ECLITE_HEADER_OPR_READ                  0x1
 #define ECLITE_HEADER_OPR_WRITE                 0x2
+#define ECLITE_HEADER_OPR_READ_DELTA            0x3
+
+/* Opregion change tracking granularity for delta reads */
+#define ECLITE_OPR_GEN_CHUNK                    16
+#define ECLITE_OPR_GEN_CHUNKS   (MAX_OPR_LENGTH / ECLITE_OPR_GEN_CHUNK)
 
 #define ECLITE_BTP1_START_OFFSET \
 	offsetof(struct eclite_opregion_t, battery_info.trip_point[0])
@@ -401,6 +406,28 @@ struct message_buffer {
 	uint8_t data[MAX_OPR_LENGTH];
 };
 
+/** @brief Delta read response buffer for host communication.
+ *
+ * Response to ECLITE_HEADER_OPR_READ_DELTA request. Request carries
+ * generation returned by previous delta read in its first 4 data bytes,
+ * 0 to read whole range. Response data holds the changed chunks of the
+ * requested range in ascending order.
+ */
+struct eclite_delta_buffer {
+
+	/** message header */
+	struct message_header_type message_header;
+
+	/** current opregion generation */
+	uint32_t generation;
+
+	/** bit per ECLITE_OPR_GEN_CHUNK bytes chunk included in data */
+	uint32_t chunk_map;
+
+	/** changed chunks clipped to requested range */
+	uint8_t data[MAX_OPR_LENGTH];
+};
+
 /** @brief Write permission lookup table for opregion.
  *
  * Write permission lookup table for operegion variables.
@@ -438,6 +465,37 @@ int eclite_heci_event_process(uint32_t event);
  */
 int eclite_send_event(uint32_t event);
 
+/**
+ * Host events sent without waiting for aggregation. Sensor alerts are
+ * left to aggregation, critical temperatures are flushed before
+ * shutdown.
+ */
+#define ECLITE_EVENT_URGENT_MASK (BIT(ECLITE_EVENT_CHARGER_CONNECT) | \
+				  BIT(ECLITE_EVENT_CHARGER_DISCONNECT) | \
+				  BIT(ECLITE_EVENT_UCSI_UPDATE))
+
+/**
+ * @brief This routine queues event notification for host.
+ *
+ * Events are accumulated in a bitmap, so an event raised several times
+ * before flush is notified once. Urgent events flush pending ones and are
+ * sent right away.
+ *
+ * @param event event number for bios.
+ *
+ * @retval 0 event queued or sent successfully.
+ * @retval error in sending event.
+ */
+int eclite_post_event(uint32_t event);
+
+/**
+ * @brief This routine sends all queued event notifications to host.
+ *
+ * @retval 0 events sent successfully.
+ * @retval error in sending one or more events.
+ */
+int eclite_flush_events(void);
+
 /**
  * @brief eclite operation region table
  */
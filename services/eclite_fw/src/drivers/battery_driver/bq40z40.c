@@ -401,10 +401,14 @@ static int bq40z40_check_battery_presence(void *bq40z40_eclite_device)
 	int ret;
 	uint16_t voltage;
 
-	/* battery read failure indicates battery is not present */
+	/* battery read failure indicates battery is not present, -EAGAIN
+	 * leaves it to caller to keep last known presence
+	 */
 	ret = bq40z40_get_battery_voltage(bq40z40_eclite_device, &voltage);
 	if (ret) {
-		LOG_WRN("Battery not present");
+		if (ret != -EAGAIN) {
+			LOG_WRN("Battery not present");
+		}
 		return ret;
 	}
 
@@ -34,7 +34,7 @@ int bq24610_en_charging(void *device)
 		return SUCCESS;
 	}
 
-	return eclite_set_gpio(dev->hw_interface->gpio_dev, CHARGER_GPIO_CE,
+	return eclite_set_gpio(gpio_dev->gpio_cntlr, CHARGER_GPIO_CE,
 			       ENABLE_CHARGING);
 }
 
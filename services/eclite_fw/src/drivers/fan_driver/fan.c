@@ -19,6 +19,8 @@ struct fan_interface {
 	void *tacho_dev;
 	uint8_t pwm_pin;
 	uint32_t pwm_frequency;
+	/* duty cycle last written, -1 if none */
+	int16_t duty;
 };
 
 static int fan_update_pwm(void *fan_dev, int16_t *data)
@@ -38,12 +40,18 @@ static int fan_update_pwm(void *fan_dev, int16_t *data)
 		return ERROR;
 	}
 
+	/* Skip register write if duty cycle is unchanged */
+	if (fan_hw->duty == *data) {
+		return 0;
+	}
+
 	ret = eclite_write_pwm(fan_hw->pwm_dev, fan_hw->pwm_pin,
 			       fan_hw->pwm_frequency, pulse);
 	if (ret) {
 		LOG_ERR("Fan speed update error: %d", ret);
 		return ret;
 	}
+	fan_hw->duty = *data;
 
 	return 0;
 }
@@ -51,6 +59,7 @@ static int fan_update_pwm(void *fan_dev, int16_t *data)
 static int fan_read_pwm(void *tacho_dev, int16_t *data)
 {
 	int ret;
+	uint32_t rpm;
 
 	if (tacho_dev == NULL) {
 		LOG_ERR("No tacho device");
@@ -66,11 +75,12 @@ static int fan_read_pwm(void *tacho_dev, int16_t *data)
 	}
 
 	if (tacho_data->rotation) {
-		ret = eclite_read_tacho(tacho_hw->tacho_dev, (uint32_t *)data);
+		ret = eclite_read_tacho(tacho_hw->tacho_dev, &rpm);
 		if (ret) {
 			LOG_ERR("Tacho reading failed.%d", ret);
 			return ret;
 		}
+		*data = rpm;
 	} else {
 		ECLITE_LOG_DEBUG("Tacho not updated");
 	}
@@ -137,6 +147,7 @@ static APP_GLOBAL_VAR(1) struct fan_interface fan_dev_interface = {
 #else
 	.pwm_frequency = ECLITE_PWM_FREQ,
 #endif
+	.duty = -1,
 };
 static APP_GLOBAL_VAR(1) struct hw_configuration fan0_interface = {
 	.device = &fan_dev_interface,
@@ -20,6 +20,7 @@ struct cpu_interface {
 static int get_cpu_temperature(void *cpu, int16_t *data)
 {
 	int ret;
+	uint8_t temp;
 
 	if (eclite_sx_state != PM_RESET_TYPE_S0) {
 		LOG_ERR("%s() in non-S0\n", __func__);
@@ -30,12 +31,14 @@ static int get_cpu_temperature(void *cpu, int16_t *data)
 		return ERROR;
 	}
 
-	ret = pmc_command(GET_TEMP, (uint8_t *)data);
+	/* PMC returns 8 bit temperature, keep upper byte of data clean */
+	ret = pmc_command(GET_TEMP, &temp);
 
 	if (ret) {
 		LOG_ERR("Get temp failed: %d", ret);
 		return ret;
 	}
+	*data = temp;
 
 	return 0;
 }
@@ -18,6 +18,9 @@ LOG_MODULE_REGISTER(tmp102, CONFIG_ECLITE_LOG_LEVEL);
 struct tmp102_interface {
 	void *i2c_dev;
 	uint16_t crit_temp;
+	/* alert window programmed in T_HIGH/T_LOW */
+	int16_t alert_high;
+	int16_t alert_low;
 };
 
 static int tmp102_config(void *tmp102_dev, int16_t *data)
@@ -129,7 +132,7 @@ static int tmp102_update_threshold(void *tmp102_dev)
 
 	int16_t temp;
 
-	temp = thermal_data->critical;
+	temp = dev_interface->alert_high;
 	tmp102_convert_temperature(&temp, TMP102_REG_FORMAT,
 				   TMP102_EM_NORAML_MODE);
 	ret = eclite_i2c_write_word(dev_interface->i2c_dev,
@@ -139,7 +142,7 @@ static int tmp102_update_threshold(void *tmp102_dev)
 		LOG_ERR("Failed to update high threshold: %d", ret);
 		return ret;
 	}
-	temp = thermal_data->low_threshold;
+	temp = dev_interface->alert_low;
 	tmp102_convert_temperature(&temp, TMP102_REG_FORMAT,
 				   TMP102_EM_NORAML_MODE);
 	ret = eclite_i2c_write_word(dev_interface->i2c_dev,
@@ -153,10 +156,32 @@ static int tmp102_update_threshold(void *tmp102_dev)
 	return 0;
 }
 
+/* Program ALERT window, data[0] is high and data[1] is low limit. Bus is
+ * untouched if window is already programmed.
+ */
+static int tmp102_set_alert_window(void *tmp102_dev, int16_t *data)
+{
+	struct eclite_device *thermal_device = tmp102_dev;
+	struct tmp102_interface *dev_interface =
+		thermal_device->hw_interface->device;
+
+	if (dev_interface->alert_high == data[0] &&
+	    dev_interface->alert_low == data[1]) {
+		return 0;
+	}
+
+	dev_interface->alert_high = data[0];
+	dev_interface->alert_low = data[1];
+
+	return tmp102_update_threshold(tmp102_dev);
+}
+
 static enum device_err_code tmp102_isr(void *tmp102_dev)
 {
 	struct eclite_device *thermal_device = tmp102_dev;
 	struct thermal_driver_data *thermal_data = thermal_device->driver_data;
+	struct tmp102_interface *dev_interface =
+		thermal_device->hw_interface->device;
 	int ret;
 	int16_t temp = 0;
 
@@ -169,6 +194,9 @@ static enum device_err_code tmp102_isr(void *tmp102_dev)
 	}
 	thermal_data->temperature = temp;
 	ECLITE_LOG_DEBUG("Temp: %d\n", temp);
+	/* Open window to full range until framework re-centres it */
+	dev_interface->alert_high = thermal_data->critical;
+	dev_interface->alert_low = thermal_data->low_threshold;
 	ret = tmp102_update_threshold(tmp102_dev);
 	if (ret) {
 		LOG_ERR("Update threshold failed");
@@ -216,6 +244,8 @@ static enum device_err_code tmp102_init(void *tmp102_dev)
 	thermal_data->high_threshold = THM_HIGH_TEMPERATURE;
 	thermal_data->low_threshold = THM_LOW_TEMPERATURE;
 	thermal_data->critical = dev_interface->crit_temp;
+	dev_interface->alert_high = thermal_data->critical;
+	dev_interface->alert_low = thermal_data->low_threshold;
 	tmp102_update_threshold(tmp102_dev);
 
 	if (thermal_data->temperature >= dev_interface->crit_temp) {
@@ -229,6 +259,7 @@ static APP_GLOBAL_VAR(1) struct thermal_driver_api tmp102_api = {
 	.read_data = tmp102_read_temperature,
 	.configure_data = tmp102_config,
 	.status_data = tmp102_get_status,
+	.alert_window = tmp102_set_alert_window,
 };
 
 /* Thermal sensor 1.*/
@@ -126,6 +126,35 @@ struct ccg_interface {
 
 static APP_GLOBAL_VAR(1) uint8_t version[VERSION_REG];
 
+/* UCSI command waiting for command in progress to complete. */
+struct ccg_ucsi_cmd {
+	struct msg_out_t msg_out;
+	struct control_t control;
+};
+
+/* State of command last issued on behalf of OS. */
+enum ccg_ucsi_state {
+	/* no command outstanding, next one may be issued */
+	UCSI_CMD_IDLE,
+	/* command or ACK_CC_CI written, controller completion pending */
+	UCSI_CMD_BUSY,
+	/* completion passed to OS, waiting for OS to ack it */
+	UCSI_CMD_OS_OWNED,
+	/* command could not be written, error completion not reported yet */
+	UCSI_CMD_FAILED,
+	/* error completion reported by EClite, its ack is answered here */
+	UCSI_CMD_LOCAL,
+};
+
+static APP_GLOBAL_VAR_BSS(1) struct ccg_ucsi_queue {
+	struct ccg_ucsi_cmd cmd[CONFIG_ECLITE_UCSI_CMD_QUEUE_DEPTH];
+	uint8_t head;
+	uint8_t count;
+	enum ccg_ucsi_state state;
+	/* time last write to controller was made, for lost completions */
+	int64_t issued_at;
+} ucsi_queue;
+
 static APP_GLOBAL_VAR(1) struct ccg_port_state {
 	uint8_t data_role;
 	uint8_t pwr_role;
@@ -213,7 +242,7 @@ static int  ccg_block_for_int(struct eclite_device *dev)
 			return buf;
 		}
 		k_sleep(K_MSEC(WAIT_TIME));
-		count++;
+		count--;
 	}
 	ECLITE_LOG_DEBUG("Wait for interrupt timedout");
 
@@ -294,10 +323,143 @@ ucsi_init_error:
 	return ERROR;
 }
 
+static int ccg_issue_ucsi_cmd(struct eclite_device *dev,
+			      struct ccg_ucsi_cmd *cmd)
+{
+	int ret;
+
+	/* Write control and MessageOut to Controller from local memory */
+	ret = ccg_wr(dev, CCG_UCSI_MSG_OUT,
+		     (uint8_t *)&cmd->msg_out, sizeof(cmd->msg_out));
+	if (ret) {
+		LOG_ERR("CCG MSG OUT write failed");
+		return ret;
+	}
+
+	ret = ccg_wr(dev, CCG_UCSI_CONTROL_REG,
+		     (uint8_t *)&cmd->control, sizeof(cmd->control));
+	if (ret) {
+		LOG_ERR("CCG CONTROL write failed");
+		return ret;
+	}
+
+	ucsi_queue.state = UCSI_CMD_BUSY;
+	ucsi_queue.issued_at = k_uptime_get();
+	return 0;
+}
+
+/* Report command that never reached controller to OS as completed with
+ * error, in place of completion controller would have sent.
+ */
+static void ccg_report_ucsi_error(struct eclite_device *dev)
+{
+	struct ucsi_data_t *data = dev->driver_data;
+
+	memset(&data->cci, 0, sizeof(data->cci));
+	memset(&data->msg_in, 0, sizeof(data->msg_in));
+	data->cci.error = 1;
+	data->cci.cmdcompleted = 1;
+	ucsi_queue.state = UCSI_CMD_LOCAL;
+}
+
+/* Issue next queued command, called once previous command was acked. A
+ * command failing to be written is left for ccg_ucsi_poll() to report,
+ * so the completion or ack OS is about to read is not overwritten.
+ */
+static void ccg_issue_next_ucsi_cmd(struct eclite_device *dev)
+{
+	struct ccg_ucsi_cmd *cmd;
+
+	ucsi_queue.state = UCSI_CMD_IDLE;
+	if (!ucsi_queue.count) {
+		return;
+	}
+
+	cmd = &ucsi_queue.cmd[ucsi_queue.head];
+	ucsi_queue.head = (ucsi_queue.head + 1) %
+			  CONFIG_ECLITE_UCSI_CMD_QUEUE_DEPTH;
+	ucsi_queue.count--;
+
+	ECLITE_LOG_DEBUG("Issue queued UCSI cmd: %x", cmd->control.command);
+	if (ccg_issue_ucsi_cmd(dev, cmd)) {
+		LOG_ERR("Queued UCSI command failed");
+		ucsi_queue.state = UCSI_CMD_FAILED;
+	}
+}
+
+/* Read CCI and MSG IN and move command state on. Command completion
+ * stays owned by OS until it is acked, so CCI and MSG IN are not
+ * overwritten before OS has read them. Connector change notifications
+ * leave command state untouched.
+ */
+static int ccg_read_ucsi_cci(struct eclite_device *dev)
+{
+	struct ucsi_data_t *data = dev->driver_data;
+	int ret;
+
+	/* Read CCI from Controller to local memory */
+	ret = ccg_rd(dev, CCG_UCSI_CCI_REG, (uint8_t *)&data->cci,
+		     sizeof(data->cci));
+	if (ret) {
+		LOG_ERR("CCG CCI read failed");
+		return ERROR;
+	}
+
+	ret = ccg_rd(dev, CCG_UCSI_MSG_IN, (uint8_t *)&data->msg_in,
+		     sizeof(data->msg_in));
+	if (ret) {
+		LOG_ERR("CCG MSG IN read failed");
+		return ERROR;
+	}
+
+	if (data->cci.ackcmdcomp || data->cci.resetcompleted) {
+		ccg_issue_next_ucsi_cmd(dev);
+	} else if (data->cci.cmdcompleted &&
+		   ucsi_queue.state == UCSI_CMD_BUSY) {
+		ucsi_queue.state = UCSI_CMD_OS_OWNED;
+	}
+
+	return 0;
+}
+
+/* Completion interrupt of command may be lost. Once controller is past
+ * timeout, check whether it still runs the command, and if not take
+ * CCI as interrupt would have. Returns UCSI_CCI_UPDATED if CCI is to be
+ * passed to OS.
+ */
+static int ccg_resync_ucsi(struct eclite_device *dev)
+{
+	uint8_t status = 0;
+
+	if (ucsi_queue.state != UCSI_CMD_BUSY ||
+	    k_uptime_get() - ucsi_queue.issued_at <
+	    CONFIG_ECLITE_UCSI_CMD_TIMEOUT_MS) {
+		return 0;
+	}
+
+	if (ccg_rd(dev, CCG_HPI_UCSI_STATUS_REG, &status, sizeof(status))) {
+		LOG_ERR("CCG STATUS read failed");
+		return ERROR;
+	}
+
+	if (status & UCSI_STATUS_REG_FLAG_CONNAND_IP) {
+		ucsi_queue.issued_at = k_uptime_get();
+		return 0;
+	}
+
+	LOG_WRN("UCSI completion lost, resync");
+	if (ccg_read_ucsi_cci(dev)) {
+		return ERROR;
+	}
+
+	return UCSI_CCI_UPDATED;
+}
+
 static int ucsi_cmd_from_os(void *ccg_device)
 {
-	uint8_t ret;
-	uint8_t buf = 0;
+	struct ccg_ucsi_cmd cmd;
+	uint8_t tail;
+	int resync;
 	struct eclite_device *dev = find_dev_by_type(DEV_UCSI);
 
 	/* Look for USCI device , if not found return error */
@@ -328,60 +490,93 @@ static int ucsi_cmd_from_os(void *ccg_device)
 				 data->control.cmdspecific[0]);
 	}
 
-	/*Check for command in progress.*/
-	ret = ccg_rd(dev, CCG_HPI_UCSI_STATUS_REG, &buf, sizeof(buf));
-	if (ret) {
-		LOG_ERR("CCG STATUS read failed");
-		return ret;
+	/* Reset and cancel supersede queued commands. ACK_CC_CI is only
+	 * sent while controller waits for it. All three go out right away.
+	 */
+	if (data->control.command == PPM_RSTCMD ||
+	    data->control.command == PPM_CANCELCMD) {
+		ucsi_queue.count = 0;
+	}
+
+	/* Error completion was made up here, so is its ack */
+	if (data->control.command == PPM_ACKCCCICMD &&
+	    ucsi_queue.state == UCSI_CMD_LOCAL) {
+		ccg_issue_next_ucsi_cmd(dev);
+		memset(&data->cci, 0, sizeof(data->cci));
+		data->cci.ackcmdcomp = 1;
+		return UCSI_CCI_UPDATED;
+	}
+
+	if (data->control.command == PPM_RSTCMD ||
+	    data->control.command == PPM_CANCELCMD ||
+	    data->control.command == PPM_ACKCCCICMD) {
+		memcpy(&cmd.msg_out, &data->msg_out, sizeof(data->msg_out));
+		memcpy(&cmd.control, &data->control, sizeof(data->control));
+		if (ccg_issue_ucsi_cmd(dev, &cmd)) {
+			ccg_report_ucsi_error(dev);
+			return UCSI_CCI_UPDATED;
+		}
+		return 0;
 	}
 
-	if (buf & UCSI_STATUS_REG_FLAG_CONNAND_IP) {
-		LOG_ERR("Previous command pending");
+	/* Command stuck behind lost completion would never be issued */
+	resync = ccg_resync_ucsi(dev);
+
+	if (ucsi_queue.count == CONFIG_ECLITE_UCSI_CMD_QUEUE_DEPTH) {
+		LOG_ERR("UCSI command queue full");
 		return ERROR;
 	}
 
-	/* Write control and MessageOut to Controller from local memory */
-	ret = ccg_wr(dev, CCG_UCSI_MSG_OUT,
-		     (uint8_t *)&data->msg_out, sizeof(data->msg_out));
-	if (ret) {
-		LOG_ERR("CCG MSG OUT write failed");
-		return ret;
+	tail = (ucsi_queue.head + ucsi_queue.count) %
+	       CONFIG_ECLITE_UCSI_CMD_QUEUE_DEPTH;
+	memcpy(&ucsi_queue.cmd[tail].msg_out, &data->msg_out,
+	       sizeof(data->msg_out));
+	memcpy(&ucsi_queue.cmd[tail].control, &data->control,
+	       sizeof(data->control));
+	ucsi_queue.count++;
+
+	/* Otherwise issued from PD interrupt once OS acked completion of
+	 * command in progress.
+	 */
+	if (ucsi_queue.state == UCSI_CMD_IDLE) {
+		ccg_issue_next_ucsi_cmd(dev);
 	}
 
-	ret = ccg_wr(dev, CCG_UCSI_CONTROL_REG,
-		     (uint8_t *)&data->control, sizeof(data->control));
-	if (ret) {
-		LOG_ERR("CCG CONTROL write failed");
-		return ret;
+	/* Report failure right away unless resync left CCI for OS to read,
+	 * then it is reported from ccg_ucsi_poll().
+	 */
+	if (resync == UCSI_CCI_UPDATED) {
+		return resync;
+	}
+
+	if (ucsi_queue.state == UCSI_CMD_FAILED) {
+		ccg_report_ucsi_error(dev);
+		return UCSI_CCI_UPDATED;
 	}
 
 	return 0;
 }
 
-static int ucsi_int_handler(struct eclite_device *ccg_device)
+/* Called periodically, reports failed command and recovers from lost
+ * completion interrupt.
+ */
+static int ccg_ucsi_poll(void *ccg_device)
 {
 	struct eclite_device *dev = ccg_device;
-	struct ucsi_data_t *data = dev->driver_data;
-	int ret;
-
-	ECLITE_LOG_DEBUG("UCSI intr handler");
 
-	/* Read CCI from Controller to local memory */
-	ret = ccg_rd(dev, CCG_UCSI_CCI_REG, (uint8_t *)&data->cci,
-		     sizeof(data->cci));
-	if (ret) {
-		LOG_ERR("CCG CCI read failed");
-		return ERROR;
+	if (ucsi_queue.state == UCSI_CMD_FAILED) {
+		ccg_report_ucsi_error(dev);
+		return UCSI_CCI_UPDATED;
 	}
 
-	ret = ccg_rd(dev, CCG_UCSI_MSG_IN, (uint8_t *)&data->msg_in,
-		     sizeof(data->msg_in));
-	if (ret) {
-		LOG_ERR("CCG MSG IN read failed");
-		return ERROR;
-	}
+	return ccg_resync_ucsi(dev);
+}
 
-	return 0;
+static int ucsi_int_handler(struct eclite_device *ccg_device)
+{
+	ECLITE_LOG_DEBUG("UCSI intr handler");
+
+	return ccg_read_ucsi_cci(ccg_device);
 }
 
 static int device_int_handler(struct eclite_device *dev)
@@ -453,7 +648,7 @@ static int port_int_handler(struct eclite_device *dev, uint8_t port)
 
 static enum device_err_code ccg_isr(void *ccg_device)
 {
-	uint8_t ret;
+	uint8_t ret = 0;
 	uint8_t buf = 0;
 	struct eclite_device *dev = find_dev_by_type(DEV_UCSI);
 
@@ -657,6 +852,7 @@ static enum device_err_code ccg_pd_init(void *pd_device)
 /* ucsi interface APIs. */
 static APP_GLOBAL_VAR(1) struct ucsi_api_t ccg_api = {
 	.ucsi_fn = ucsi_cmd_from_os,
+	.ucsi_poll = ccg_ucsi_poll,
 	.get_pd_state = get_port_state,
 };
 
@@ -6,11 +6,123 @@
 
 #include <drivers/i2c.h>
 #include <stdint.h>
+#include <string.h>
 #include "eclite_hw_interface.h"
 #include "common.h"
+#include "platform.h"
 
 LOG_MODULE_REGISTER(eclite_i2c, CONFIG_ECLITE_LOG_LEVEL);
 
+#define I2C_MAX_TARGETS         8
+
+/* Failure history of a failing slave, used to back off from absent or
+ * NAKing devices instead of stalling every poll on them. Slot is taken on
+ * first failure and released on next successful transfer, so table only
+ * holds slaves currently failing.
+ */
+struct i2c_target_state {
+	const void *bus;
+	uint16_t addr;
+	uint8_t failures;
+	uint32_t backoff_ms;
+	int64_t retry_at;
+};
+
+static APP_GLOBAL_VAR_BSS(1) struct i2c_target_state
+	i2c_targets[I2C_MAX_TARGETS];
+static APP_GLOBAL_VAR_BSS(1) struct eclite_i2c_stats i2c_stats;
+
+/* Find failure history of slave, taking free slot for it if alloc is set.
+ * Returns NULL if slave has no history, or table is full.
+ */
+static struct i2c_target_state *i2c_target(const void *bus, uint16_t addr,
+					   bool alloc)
+{
+	struct i2c_target_state *free_slot = NULL;
+
+	for (int i = 0; i < I2C_MAX_TARGETS; i++) {
+		if (i2c_targets[i].bus == bus && i2c_targets[i].addr == addr) {
+			return &i2c_targets[i];
+		}
+		if (!i2c_targets[i].bus && !free_slot) {
+			free_slot = &i2c_targets[i];
+		}
+	}
+
+	if (!alloc) {
+		return NULL;
+	}
+
+	if (free_slot) {
+		free_slot->bus = bus;
+		free_slot->addr = addr;
+	} else {
+		LOG_WRN("I2C slave %x not tracked, table full", addr);
+	}
+
+	return free_slot;
+}
+
+/* Returns -EAGAIN while target is backed off, 0 if bus may be used. */
+static int i2c_xfer_begin(const void *bus, uint16_t addr)
+{
+	struct i2c_target_state *target = i2c_target(bus, addr, false);
+
+	if (target && target->backoff_ms &&
+	    k_uptime_get() < target->retry_at) {
+		i2c_stats.skipped++;
+		return -EAGAIN;
+	}
+
+	i2c_stats.xfers++;
+	return 0;
+}
+
+static int i2c_xfer_end(const void *bus, uint16_t addr, int ret)
+{
+	struct i2c_target_state *target;
+
+	if (!ret) {
+		target = i2c_target(bus, addr, false);
+		if (target) {
+			if (target->backoff_ms) {
+				LOG_INF("I2C slave %x recovered", addr);
+			}
+			memset(target, 0, sizeof(*target));
+		}
+		return ret;
+	}
+
+	i2c_stats.failures++;
+
+	target = i2c_target(bus, addr, true);
+	if (!target) {
+		return ret;
+	}
+
+	if (target->failures < CONFIG_ECLITE_I2C_BACKOFF_THRESHOLD) {
+		target->failures++;
+	}
+
+	if (target->failures == CONFIG_ECLITE_I2C_BACKOFF_THRESHOLD) {
+		/* Double wait on every failed retry */
+		target->backoff_ms = target->backoff_ms ?
+				     MIN(target->backoff_ms * 2,
+					 CONFIG_ECLITE_I2C_BACKOFF_MAX_MS) :
+				     CONFIG_ECLITE_I2C_BACKOFF_MIN_MS;
+		target->retry_at = k_uptime_get() + target->backoff_ms;
+		LOG_WRN("I2C slave %x backoff %u ms", addr,
+			target->backoff_ms);
+	}
+
+	return ret;
+}
+
+void eclite_i2c_get_stats(struct eclite_i2c_stats *stats)
+{
+	memcpy(stats, &i2c_stats, sizeof(*stats));
+}
+
 int eclite_i2c_config(void *dev, uint32_t cfg)
 {
 	const struct device *i2c_dev = (const struct device *)dev;
@@ -27,17 +139,32 @@ int eclite_i2c_read_byte(void *ptr, uint16_t dev_addr, uint8_t reg_addr,
 			 uint8_t *value)
 {
 	const struct device *ptr_device = (const struct device *)ptr;
+	int ret;
+
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
 
-	return i2c_reg_read_byte(ptr_device, dev_addr, reg_addr, value);
+	ret = i2c_reg_read_byte(ptr_device, dev_addr, reg_addr, value);
+
+	return i2c_xfer_end(ptr_device, dev_addr, ret);
 }
 
 int eclite_i2c_write_byte(void *ptr, uint16_t dev_addr,
 			  uint8_t reg_addr, uint8_t value)
 {
 	const struct device *ptr_device = (const struct device *)ptr;
+	int ret;
 
-	return i2c_reg_write_byte(ptr_device, dev_addr, reg_addr, value);
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
 
+	ret = i2c_reg_write_byte(ptr_device, dev_addr, reg_addr, value);
+
+	return i2c_xfer_end(ptr_device, dev_addr, ret);
 }
 
 int eclite_i2c_read_word(void *ptr, uint16_t dev_addr,
@@ -46,8 +173,14 @@ int eclite_i2c_read_word(void *ptr, uint16_t dev_addr,
 	const struct device *ptr_device = (const struct device *)ptr;
 	int ret;
 
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
 	ret = i2c_burst_read(ptr_device, dev_addr, reg_addr,
 			     (uint8_t *)value, 2);
+	i2c_xfer_end(ptr_device, dev_addr, ret);
 
 	ECLITE_LOG_DEBUG(
 		"I2C dev: %d error: %d, data:%d, slave:%d, reg:%d, len:2",
@@ -62,8 +195,14 @@ int eclite_i2c_write_word(void *ptr, uint16_t dev_addr,
 	const struct device *ptr_device = (const struct device *)ptr;
 	int ret;
 
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
 	ret = i2c_burst_write(ptr_device, dev_addr, reg_addr,
 			      (uint8_t *)&value, 2);
+	i2c_xfer_end(ptr_device, dev_addr, ret);
 
 	ECLITE_LOG_DEBUG(
 		"I2C dev: %d error: %d, data:%d, slave:%d, reg:%d, len:2",
@@ -76,16 +215,32 @@ int eclite_i2c_burst_read(void *ptr, uint16_t dev_addr,
 			  uint8_t reg_addr, uint8_t *value, uint32_t len)
 {
 	const struct device *ptr_device = (const struct device *)ptr;
+	int ret;
+
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
+	ret = i2c_burst_read(ptr_device, dev_addr, reg_addr, value, len);
 
-	return i2c_burst_read(ptr_device, dev_addr, reg_addr, value, len);
+	return i2c_xfer_end(ptr_device, dev_addr, ret);
 }
 
 int eclite_i2c_burst_write(void *ptr, uint16_t dev_addr,
 			   uint8_t reg_addr, uint8_t *value, uint32_t len)
 {
 	const struct device *ptr_device = (const struct device *)ptr;
+	int ret;
+
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
+	ret = i2c_burst_write(ptr_device, dev_addr, reg_addr, value, len);
 
-	return i2c_burst_write(ptr_device, dev_addr, reg_addr, value, len);
+	return i2c_xfer_end(ptr_device, dev_addr, ret);
 }
 
 int eclite_i2c_burst_read16(void *ptr, uint16_t dev_addr,
@@ -94,7 +249,13 @@ int eclite_i2c_burst_read16(void *ptr, uint16_t dev_addr,
 	const struct device *ptr_device = (const struct device *)ptr;
 	int ret;
 
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
 	ret = i2c_write_read(ptr_device, dev_addr, &reg_addr, 2, value, len);
+	i2c_xfer_end(ptr_device, dev_addr, ret);
 
 	ECLITE_LOG_DEBUG(
 		"I2C dev: %d error: %d, data:%d, slave:%d, reg:%d, len:%u",
@@ -117,7 +278,13 @@ int eclite_i2c_burst_write16(void *ptr, uint16_t dev_addr,
 	msg[1].len = len;
 	msg[1].flags = I2C_MSG_WRITE | I2C_MSG_STOP;
 
+	ret = i2c_xfer_begin(ptr_device, dev_addr);
+	if (ret) {
+		return ret;
+	}
+
 	ret = i2c_transfer(ptr_device, msg, 2, dev_addr);
+	i2c_xfer_end(ptr_device, dev_addr, ret);
 	ECLITE_LOG_DEBUG(
 		"I2C dev: %d error: %d, data:%d, slave:%d, reg:%d, len:%u",
 		(int)ptr_device, ret, *value, dev_addr, reg_addr, len);
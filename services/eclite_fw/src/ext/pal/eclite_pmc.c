@@ -16,6 +16,20 @@ LOG_MODULE_REGISTER(eclite_pmc, CONFIG_ECLITE_LOG_LEVEL);
 static APP_GLOBAL_VAR_BSS(1) struct pmc_msg_t peci_msg;
 static APP_GLOBAL_VAR_BSS(1) int8_t tj_max;
 
+/* Last CPU temperature sample, shared by readers within sample period */
+static APP_GLOBAL_VAR_BSS(1) struct peci_temp_sample {
+	uint8_t temp;
+	bool valid;
+	int64_t timestamp;
+} peci_temp;
+
+/* Every thermal poll must see a fresh sample, not one reused from the
+ * previous poll.
+ */
+BUILD_ASSERT(CONFIG_ECLITE_PECI_TEMP_SAMPLE_MS <
+	     CONFIG_ECLITE_THERMAL_POLL_MIN_MS,
+	     "PECI sample period must be below minimum thermal poll interval");
+
 #define SHORT_MSG_LEN   4
 #define REQ_LEN         5
 #define RESP_LEN        4
@@ -114,6 +128,12 @@ static int peci_get_temp(uint8_t *temp)
 		.peci_cmd = PECI_GET_TEMP_CMD,
 	};
 
+	if (peci_temp.valid && k_uptime_get() - peci_temp.timestamp <
+	    CONFIG_ECLITE_PECI_TEMP_SAMPLE_MS) {
+		*temp = peci_temp.temp;
+		return 0;
+	}
+
 	LONG_MSG_HEADER(PMC_WAIT_ACK, PMC_MSG_HEADER_SIZE +
 			sizeof(struct get_temp_req_t));
 	memcpy(&peci_msg.u.msg[0], &get_temp, sizeof(struct get_temp_req_t));
@@ -130,6 +150,9 @@ static int peci_get_temp(uint8_t *temp)
 	 */
 	raw_temp = res->res_lsb | (res->res_msb << 8);
 	*temp = TJ_MAX + (raw_temp >> RAW_TO_INT);
+	peci_temp.temp = *temp;
+	peci_temp.timestamp = k_uptime_get();
+	peci_temp.valid = true;
 	ECLITE_LOG_DEBUG("CPU temp: %d, raw_temp: %d, TJ_MAX: %d",
 			 *temp, raw_temp, TJ_MAX);
 
@@ -224,6 +247,8 @@ int pmc_command(uint8_t msg_type, uint8_t *buf)
 	case GET_TJ_MAX:
 		ret = get_tj_max(buf);
 		tj_max = *buf;
+		/* Cached temperature is relative to previous TjMax */
+		peci_temp.valid = false;
 		break;
 	case SEND_POWER_STATE_CHANGE:
 		ret = pmc_send_short_msg(buf);
@@ -233,6 +258,6 @@ int pmc_command(uint8_t msg_type, uint8_t *buf)
 		ret = ERROR;
 		break;
 	}
-	LOG_INF("msg_type: %d, data: %d", msg_type, *buf);
+	ECLITE_LOG_DEBUG("msg_type: %d, data: %d", msg_type, *buf);
 	return ret;
 }
@@ -37,6 +37,7 @@ static APP_GLOBAL_VAR_BSS(1) uint64_t previous_rotation;
 #define ONE_MINUTE        60
 #define PULSE_PER_REV     2
 
+#ifndef CONFIG_ECLITE_TACHO_PERIOD_MODE
 static void tgpio_callback(const struct device *port, uint32_t pin,
 			   struct tgpio_time ts, uint64_t ev_cnt)
 {
@@ -56,6 +57,31 @@ static void tgpio_callback(const struct device *port, uint32_t pin,
 	/* callback occurs at every second. converting to RPM.*/
 	rotation = (rotation * ONE_MINUTE) / PULSE_PER_REV;
 }
+#else
+static APP_GLOBAL_VAR_BSS(1) uint64_t last_edge_ns;
+static APP_GLOBAL_VAR_BSS(1) uint64_t last_edge_cnt;
+static APP_GLOBAL_VAR_BSS(1) int64_t last_edge_uptime;
+
+/* Called every CONFIG_ECLITE_TACHO_AVG_PULSES edges with timestamp of
+ * last edge, RPM follows from time taken by pulses since previous call.
+ */
+static void tgpio_period_callback(const struct device *port, uint32_t pin,
+				  struct tgpio_time ts, uint64_t ev_cnt)
+{
+	uint64_t edge_ns = (uint64_t)ts.sec * NSEC_PER_SEC + ts.nsec;
+	uint64_t pulses = ev_cnt - last_edge_cnt;
+
+	if (is_callbacked && edge_ns > last_edge_ns && pulses) {
+		rotation = (pulses * ONE_MINUTE * NSEC_PER_SEC) /
+			   ((edge_ns - last_edge_ns) * PULSE_PER_REV);
+	}
+
+	is_callbacked = 1;
+	last_edge_ns = edge_ns;
+	last_edge_cnt = ev_cnt;
+	last_edge_uptime = k_uptime_get();
+}
+#endif /* CONFIG_ECLITE_TACHO_PERIOD_MODE */
 
 #endif /* _PSE_ */
 
@@ -66,7 +92,9 @@ struct device *eclite_get_tacho_device(const char *name)
 
 int eclite_init_tacho(void *dev, void *cfg)
 {
+#ifndef CONFIG_ECLITE_TACHO_PERIOD_MODE
 	struct tgpio_time start, interval;
+#endif
 	int ret;
 
 	is_callbacked = false;
@@ -77,6 +105,13 @@ int eclite_init_tacho(void *dev, void *cfg)
 	tgpio_port_set_time(dev, TGPIO_TMT_0, TGPIO_TIMER_START_TIME_SEC,
 			    TGPIO_TIMER_START_TIME_NSEC);
 
+#ifdef CONFIG_ECLITE_TACHO_PERIOD_MODE
+	last_edge_uptime = k_uptime_get();
+	ret = tgpio_pin_timestamp_event(dev, TGPIO_PIN, TGPIO_TIMER,
+					CONFIG_ECLITE_TACHO_AVG_PULSES,
+					TGPIO_RISING_EDGE,
+					tgpio_period_callback);
+#else
 	tgpio_port_get_time(dev, TGPIO_TIMER, &start.sec,
 			    &start.nsec);
 	start.sec++;
@@ -87,6 +122,7 @@ int eclite_init_tacho(void *dev, void *cfg)
 	ret = tgpio_pin_count_events(dev, TGPIO_PIN, TGPIO_TIMER,
 				     start, interval, TGPIO_RISING_EDGE,
 				     tgpio_callback);
+#endif
 	if (ret) {
 		LOG_ERR("TACHO init failed: %d", ret);
 		return ret;
@@ -97,6 +133,23 @@ int eclite_init_tacho(void *dev, void *cfg)
 
 int eclite_read_tacho(void *tgpio_dev, uint32_t *tacho)
 {
+#ifdef CONFIG_ECLITE_TACHO_PERIOD_MODE
+	int64_t idle_ms = k_uptime_get() - last_edge_uptime;
+
+	/* Too slow to complete pulse window, fan can at most be turning
+	 * at rate of one window per idle time.
+	 */
+	if (idle_ms > CONFIG_ECLITE_TACHO_PERIOD_TIMEOUT_MS) {
+		uint32_t bound = (CONFIG_ECLITE_TACHO_AVG_PULSES *
+				  ONE_MINUTE * MSEC_PER_SEC) /
+				 (idle_ms * PULSE_PER_REV);
+
+		/* Below meaningful fan speed, report stall */
+		*tacho = bound < CONFIG_ECLITE_TACHO_MIN_RPM ?
+			 0 : MIN(bound, (uint32_t)rotation);
+		return 0;
+	}
+#endif
 	*tacho = rotation;
 	return 0;
 }
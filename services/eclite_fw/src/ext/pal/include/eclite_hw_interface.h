@@ -21,7 +21,12 @@
 #include <logging/log.h>
 #include <drivers/pwm.h>
 
-/* I2C APIs */
+/* I2C APIs
+ *
+ * Transfers to a slave that failed ECLITE_I2C_BACKOFF_THRESHOLD times in a
+ * row are refused with -EAGAIN until its backoff period ends. -EAGAIN
+ * means no new data, not a device failure, so callers keep last reading.
+ */
 /**
  * @brief  This function configures I2C device.
  *
@@ -98,6 +103,26 @@ int eclite_i2c_burst_write16(void *ptr, uint16_t dev_addr, uint16_t reg_addr,
 int eclite_i2c_burst_read16(void *ptr, uint16_t dev_addr, uint16_t reg_addr,
 			    uint8_t *value, uint32_t len);
 
+/** @brief I2C transfer statistics.
+ *
+ *  Counters for all transfers issued through eclite I2C APIs.
+ */
+struct eclite_i2c_stats {
+	/** transfers issued on bus */
+	uint32_t xfers;
+	/** transfers that failed on bus */
+	uint32_t failures;
+	/** transfers refused as slave was backed off */
+	uint32_t skipped;
+};
+
+/**
+ * @brief  This function reads I2C transfer statistics.
+ *
+ * @param  stats is copy of statistics.
+ */
+void eclite_i2c_get_stats(struct eclite_i2c_stats *stats);
+
 /**
  * @brief  This function retrieves I2C device pointer to access slave device.
  *
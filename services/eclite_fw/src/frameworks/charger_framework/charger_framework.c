@@ -17,8 +17,75 @@
 LOG_MODULE_REGISTER(charger_framework, CONFIG_ECLITE_LOG_LEVEL);
 
 static APP_GLOBAL_VAR(1) uint8_t charger_present_old;
+static APP_GLOBAL_VAR(1) uint8_t battery_present_old;
 static APP_GLOBAL_VAR(1) uint8_t charge_percentage;
 
+/* Charger state machine states. */
+enum charger_sm_state {
+	CHG_SM_INIT,
+	/* battery only, discharging */
+	CHG_SM_AC_OUT,
+	/* AC only, no battery */
+	CHG_SM_AC_IN,
+	CHG_SM_CHARGING,
+	CHG_SM_FULL,
+	/* battery reported critical warning, charging stopped */
+	CHG_SM_FAULT,
+};
+
+static APP_GLOBAL_VAR_BSS(1) uint8_t charger_sm_state;
+
+/* Refresh interval marking a reading static for the battery lifetime. */
+#define SBS_CACHE_STATIC        UINT32_MAX
+
+/* Battery cache reading descriptor. */
+struct sbs_cache_desc {
+	/* reads value from battery device */
+	int (*read)(void *sbs_dev, uint16_t *value);
+	/* refresh interval in msec */
+	uint32_t interval;
+};
+
+/* Define reader calling getter of battery driver API. */
+#define SBS_CACHE_READER(getter)					\
+	static int sbs_cache_read_##getter(void *sbs_dev, uint16_t *value) \
+	{								\
+		struct eclite_device *dev = sbs_dev;			\
+		const struct sbs_driver_api *api = dev->driver_api;	\
+									\
+		return api->getter(sbs_dev, value);			\
+	}
+
+SBS_CACHE_READER(voltage)
+SBS_CACHE_READER(at_rate)
+SBS_CACHE_READER(remaining_capacity)
+SBS_CACHE_READER(full_charge_capacity)
+SBS_CACHE_READER(cycle_count)
+SBS_CACHE_READER(design_capacity)
+SBS_CACHE_READER(design_voltage)
+
+#define SBS_CACHE_ENTRY(getter, period)				\
+	{ sbs_cache_read_##getter, period }
+
+static const struct sbs_cache_desc sbs_cache_tbl[SBS_CACHE_MAX] = {
+	[SBS_CACHE_VOLTAGE] =
+		SBS_CACHE_ENTRY(voltage, CONFIG_ECLITE_SBS_CACHE_FAST_MS),
+	[SBS_CACHE_AT_RATE] =
+		SBS_CACHE_ENTRY(at_rate, CONFIG_ECLITE_SBS_CACHE_FAST_MS),
+	[SBS_CACHE_REMAINING_CAPACITY] =
+		SBS_CACHE_ENTRY(remaining_capacity,
+				CONFIG_ECLITE_SBS_CACHE_FAST_MS),
+	[SBS_CACHE_FULL_CHARGE_CAPACITY] =
+		SBS_CACHE_ENTRY(full_charge_capacity,
+				CONFIG_ECLITE_SBS_CACHE_SLOW_MS),
+	[SBS_CACHE_CYCLE_COUNT] =
+		SBS_CACHE_ENTRY(cycle_count, CONFIG_ECLITE_SBS_CACHE_CYCLE_MS),
+	[SBS_CACHE_DESIGN_CAPACITY] =
+		SBS_CACHE_ENTRY(design_capacity, SBS_CACHE_STATIC),
+	[SBS_CACHE_DESIGN_VOLTAGE] =
+		SBS_CACHE_ENTRY(design_voltage, SBS_CACHE_STATIC),
+};
+
 static void cm_enable_charging(struct eclite_device *charger_dev)
 {
 	const struct charger_driver_api *drv_api = charger_dev->driver_api;
@@ -97,36 +164,144 @@ static void update_chager_status(struct eclite_device *charger_dev,
 	}
 }
 
-static void charger_flow(struct eclite_device *charger_dev,
-			 struct eclite_device *sbs_dev,
-			 uint16_t absolute_state_of_charge)
+static uint8_t charger_sm_next(uint8_t state, int ac_present,
+			       int bat_present, uint16_t soc,
+			       int battery_warning)
 {
-	struct charger_driver_data *charger_data = charger_dev->driver_data;
-	struct sbs_driver_data *sbs_data = sbs_dev->driver_data;
-
-	ARG_UNUSED(sbs_data);
-
-	if (charger_data->ac_present) {
-		if (absolute_state_of_charge >= SOC_FULL_BAT_CAP) {
-			cm_disable_charging(charger_dev);
-			update_chager_status(charger_dev,
-					     sbs_dev,
-					     BATTERY_FULL);
-		} else if ((absolute_state_of_charge <
-			    SOC_BAT_MAINTAINCE_THRS)
-			   && (sbs_data->chargering_status
-			       & BATTERY_CHARGING)) {
-			cm_enable_charging(charger_dev);
-			update_chager_status(charger_dev, sbs_dev,
-					     BATTERY_CHARGING);
-
-		} else {
-			cm_enable_charging(charger_dev);
-			update_chager_status(charger_dev, sbs_dev,
-					     BATTERY_CHARGING);
+	if (bat_present && battery_warning) {
+		return CHG_SM_FAULT;
+	}
+
+	if (!bat_present) {
+		/* No power source at all is not a valid reading, hold */
+		return ac_present ? CHG_SM_AC_IN : state;
+	}
+
+	if (!ac_present) {
+		return CHG_SM_AC_OUT;
+	}
+
+	/* Full battery resumes charging only below maintenance level */
+	if (soc >= SOC_FULL_BAT_CAP ||
+	    (state == CHG_SM_FULL && soc >= SOC_BAT_MAINTAINCE_THRS)) {
+		return CHG_SM_FULL;
+	}
 
+	return CHG_SM_CHARGING;
+}
+
+/* Apply charger control and battery status of a newly entered state. */
+static void charger_sm_enter(struct eclite_device *charger_dev,
+			     struct eclite_device *sbs_dev, uint8_t state)
+{
+	switch (state) {
+	case CHG_SM_AC_OUT:
+		ECLITE_LOG_DEBUG("Power Supply: Battery Only");
+		cm_disable_charging(charger_dev);
+		update_chager_status(charger_dev, sbs_dev, BATTERY_DISCHARGING);
+		break;
+	case CHG_SM_AC_IN:
+		ECLITE_LOG_DEBUG("Power Supply: Charger Only");
+		update_chager_status(charger_dev, sbs_dev, AC_ONLY);
+		break;
+	case CHG_SM_CHARGING:
+		ECLITE_LOG_DEBUG("Power Supply: Charger & Battery");
+		update_charger(charger_dev, sbs_dev);
+		cm_enable_charging(charger_dev);
+		update_chager_status(charger_dev, sbs_dev, BATTERY_CHARGING);
+		break;
+	case CHG_SM_FULL:
+		cm_disable_charging(charger_dev);
+		update_chager_status(charger_dev, sbs_dev, BATTERY_FULL);
+		break;
+	case CHG_SM_FAULT:
+		cm_disable_charging(charger_dev);
+		update_chager_status(charger_dev, sbs_dev, BATTERY_DISCHARGING);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Arm charger GPIO for the opposite level of the current one. Interrupt
+ * configuration is only touched when the pin level changed.
+ */
+static int charger_gpio_rearm(struct eclite_device *charger_dev)
+{
+	struct device *gpio_dev = (struct device *)
+		charger_dev->hw_interface->gpio_dev;
+	struct platform_gpio_config *cfg =
+		(struct platform_gpio_config *)
+		(charger_dev->hw_interface->gpio_config);
+	uint32_t trig;
+	int ret;
+
+	trig = gpio_pin_get_raw(gpio_dev, CHARGER_GPIO) ?
+	       GPIO_INT_TRIG_LOW : GPIO_INT_TRIG_HIGH;
+
+	if ((cfg->gpio_config.intr_type &
+	     (GPIO_INT_TRIG_LOW | GPIO_INT_TRIG_HIGH)) == trig) {
+		return 0;
+	}
+
+	cfg->gpio_config.intr_type &= ~(GPIO_INT_TRIG_LOW | GPIO_INT_TRIG_HIGH);
+	cfg->gpio_config.intr_type |= trig;
+
+	ret = gpio_pin_interrupt_configure(gpio_dev, CHARGER_GPIO,
+					   cfg->gpio_config.dir |
+					   cfg->gpio_config.pull_down_en |
+					   cfg->gpio_config.intr_type);
+	if (ret) {
+		LOG_ERR("GPIO: %u intr configure err", CHARGER_GPIO);
+	}
+
+	return ret;
+}
+
+int sbs_cache_refresh(void *sbs_dev)
+{
+	struct eclite_device *dev = sbs_dev;
+	struct sbs_driver_data *battery_data = dev->driver_data;
+	struct sbs_battery_cache *cache = &battery_data->cache;
+	uint32_t now = k_uptime_get_32();
+	int ret = SUCCESS;
+	uint16_t value;
+
+	for (int i = 0; i < SBS_CACHE_MAX; i++) {
+		const struct sbs_cache_desc *desc = &sbs_cache_tbl[i];
+
+		if ((cache->valid & BIT(i)) &&
+		    (desc->interval == SBS_CACHE_STATIC ||
+		     now - cache->last_read[i] < desc->interval)) {
+			continue;
 		}
+
+		switch (desc->read(sbs_dev, &value)) {
+		case 0:
+			break;
+		case -EAGAIN:
+			/* Gauge backed off, keep last reading */
+			continue;
+		default:
+			cache->valid &= ~BIT(i);
+			ret = FAILURE;
+			continue;
+		}
+
+		cache->value[i] = value;
+		cache->last_read[i] = now;
+		cache->valid |= BIT(i);
 	}
+
+	return ret;
+}
+
+void sbs_cache_invalidate(void *sbs_dev)
+{
+	struct eclite_device *dev = sbs_dev;
+	struct sbs_driver_data *battery_data = dev->driver_data;
+
+	battery_data->cache.valid = 0;
 }
 
 int charging_manager_callback(uint8_t event, uint16_t *status)
@@ -155,7 +330,7 @@ int charging_manager_callback(uint8_t event, uint16_t *status)
 
 	int charger_present;
 	int bat_present;
-	uint8_t power_device;
+	uint8_t next_state;
 	uint16_t btp = 0x0;
 	int ret;
 	uint16_t battery_status = 0, absolute_charge = 0, charger_status = 0;
@@ -165,7 +340,9 @@ int charging_manager_callback(uint8_t event, uint16_t *status)
 
 	ECLITE_LOG_DEBUG("Executing charging framework");
 
-	bat_present = battery_api->check_battery_presence(sbs_dev) ? 0 : 1;
+	/* Gauge backed off on I2C says nothing new about presence */
+	ret = battery_api->check_battery_presence(sbs_dev);
+	bat_present = ret == -EAGAIN ? battery_present_old : !ret;
 	ret = charger_api->check_ac_present(charger_dev);
 	if (ret) {
 		LOG_ERR("Error detecting charger presence");
@@ -173,53 +350,34 @@ int charging_manager_callback(uint8_t event, uint16_t *status)
 
 	charger_present = charger_data->ac_present;
 
-	if (bat_present) {
-		struct device *gpio_dev = (struct device *)
-			charger_dev->hw_interface->gpio_dev;
-		struct platform_gpio_config *cfg =
-			(struct platform_gpio_config *)
-			(charger_dev->hw_interface->gpio_config);
-		uint32_t pin_value;
-
-		pin_value = gpio_pin_get_raw(gpio_dev, CHARGER_GPIO);
-
-		if (pin_value) {
-			/* We got HIGH, set for LOW trigger -
-			 * Clear HIGH, set LOW(Both are separate bits in
-			 * 2px zephyr */
-			cfg->gpio_config.intr_type &= ~(GPIO_INT_TRIG_HIGH);
-			cfg->gpio_config.intr_type |= (GPIO_INT_TRIG_LOW);
-		} else {
-			/* We got LOW, set for HIGH trigger -
-			 * Clear LOW, set HIGH(Both are separate bits in
-			 * 2px zephyr */
-			cfg->gpio_config.intr_type &= ~(GPIO_INT_TRIG_LOW);
-			cfg->gpio_config.intr_type |= (GPIO_INT_TRIG_HIGH);
-		}
-
-		ret = eclite_gpio_configure(gpio_dev, CHARGER_GPIO,
-					    cfg->gpio_config.dir);
-		if (ret) {
-			LOG_ERR("GPIO: %u configure err", CHARGER_GPIO);
-				return ret;
-		}
+	/* Battery swapped, static readings belong to the old pack */
+	if (bat_present != battery_present_old) {
+		sbs_cache_invalidate(sbs_dev);
+		battery_present_old = bat_present;
+	}
 
-		ret = gpio_pin_interrupt_configure(gpio_dev, CHARGER_GPIO,
-					    cfg->gpio_config.dir |
-					    cfg->gpio_config.pull_down_en |
-					    cfg->gpio_config.intr_type);
-		if (ret) {
-			LOG_ERR("GPIO: %u intr configure err", CHARGER_GPIO);
-				return ret;
-		}
+	/* AC line is watched with or without battery, else AC plugged
+	 * into a battery-less system is never seen.
+	 */
+	ret = charger_gpio_rearm(charger_dev);
+	if (ret) {
+		return ret;
 	}
 
 	*status |= charger_present << 0;
 	*status |= ((charger_present ^ charger_present_old) << 1);
 	charger_present_old = charger_present;
 
-	battery_warning = battery_api->battery_status(sbs_dev, &battery_status);
-	battery_api->absolute_state_of_charge(sbs_dev, &absolute_charge);
+	/* Battery registers are only meaningful with battery present */
+	if (bat_present) {
+		battery_warning = battery_api->battery_status(sbs_dev,
+							      &battery_status);
+		if (battery_api->absolute_state_of_charge(sbs_dev,
+							  &absolute_charge) ==
+		    -EAGAIN) {
+			absolute_charge = charge_percentage;
+		}
+	}
 
 	if (absolute_charge != charge_percentage) {
 		*status |= BIT2;
@@ -246,38 +404,19 @@ int charging_manager_callback(uint8_t event, uint16_t *status)
 		break;
 	}
 
-	/* check connected power sources */
-	power_device = charger_present | bat_present << 1;
-
-	switch (power_device) {
-	case CHARGER_ONLY:
-		ECLITE_LOG_DEBUG("Power Supply: Charger Only");
-		update_chager_status(charger_dev, sbs_dev, AC_ONLY);
-		break;
-	case BATTERY_ONLY:
-		ECLITE_LOG_DEBUG("Power Supply: Battery Only");
-		cm_disable_charging(charger_dev);
-		update_chager_status(charger_dev, sbs_dev, BATTERY_DISCHARGING);
-		break;
-	case CHARGER_BATTERY:
-		ECLITE_LOG_DEBUG("Power Supply: Charger & Battery");
-		update_charger(charger_dev, sbs_dev);
-		charger_flow(charger_dev, sbs_dev, absolute_charge);
-		break;
-	default:
-		LOG_WRN("Invalid power source");
-		ret = ERROR;
-		break;
+	/* Charger control and battery status only change on transition */
+	next_state = charger_sm_next(charger_sm_state, charger_present,
+				     bat_present, absolute_charge,
+				     battery_warning);
+	if (next_state != charger_sm_state) {
+		ECLITE_LOG_DEBUG("Charger state %d -> %d", charger_sm_state,
+				 next_state);
+		charger_sm_enter(charger_dev, sbs_dev, next_state);
+		charger_sm_state = next_state;
 	}
 
-
 	/* handle critical errors */
-	if (battery_warning && bat_present) {
-		cm_disable_charging(charger_dev);
-		update_chager_status(charger_dev,
-				     sbs_dev,
-				     BATTERY_DISCHARGING);
-
+	if (charger_sm_state == CHG_SM_FAULT) {
 		LOG_ERR("Charging framework critical error");
 		ret = ERROR;
 	}
@@ -94,6 +94,35 @@ struct charger_driver_data {
 	uint8_t en_charging;
 };
 
+/** @brief Smart battery readings held in the battery cache.
+ *
+ *  Static readings are read once per battery insertion, dynamic ones on
+ *  their own refresh interval.
+ */
+enum sbs_cache_field {
+	SBS_CACHE_VOLTAGE,
+	SBS_CACHE_AT_RATE,
+	SBS_CACHE_REMAINING_CAPACITY,
+	SBS_CACHE_FULL_CHARGE_CAPACITY,
+	SBS_CACHE_CYCLE_COUNT,
+	SBS_CACHE_DESIGN_CAPACITY,
+	SBS_CACHE_DESIGN_VOLTAGE,
+	SBS_CACHE_MAX,
+};
+
+/** @brief Smart battery data cache.
+ *
+ *  Structure holds last value read from fuel gauge per sbs_cache_field.
+ */
+struct sbs_battery_cache {
+	/** cached readings.*/
+	uint16_t value[SBS_CACHE_MAX];
+	/** uptime in msec of last successful read.*/
+	uint32_t last_read[SBS_CACHE_MAX];
+	/** bitmap of readings holding valid data.*/
+	uint32_t valid;
+};
+
 /** @brief This is smart battery driver data.
  *
  *  Structure contains parameter for Charger operation.
@@ -108,6 +137,8 @@ struct sbs_driver_data {
 	uint8_t chargering_status;
 	/** battery trip point value received from OS.*/
 	uint16_t sbs_battery_trip_point;
+	/** battery data cache.*/
+	struct sbs_battery_cache cache;
 };
 
 
@@ -391,6 +422,27 @@ struct sbs_driver_api {
  */
 int charging_manager_callback(uint8_t event, uint16_t *status);
 
+/**
+ * @brief This function refreshes battery cache readings which are due.
+ *
+ * @param  sbs_dev is eclite device pointer for battery.
+ *
+ * @retval SUCCESS if all due readings were read.
+ *	   FAILURE if any reading failed, its cache entry is invalidated.
+ */
+int sbs_cache_refresh(void *sbs_dev);
+
+/**
+ * @brief This function drops all battery cache readings.
+ *
+ * Used on battery insertion/removal so static readings are read again.
+ *
+ * @param  sbs_dev is eclite device pointer for battery.
+ *
+ * @retval None.
+ */
+void sbs_cache_invalidate(void *sbs_dev);
+
 /**
  * @brief This function processes command related to this frame work
  *
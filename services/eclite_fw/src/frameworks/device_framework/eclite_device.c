@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "eclite_device.h"
 #include "common.h"
@@ -16,6 +17,11 @@ LOG_MODULE_REGISTER(eclite_device, CONFIG_ECLITE_LOG_LEVEL);
 APP_GLOBAL_VAR_BSS(1) struct eclite_device **dev_list;
 APP_GLOBAL_VAR_BSS(1) int no_of_devs;
 
+/* Device registry, first device of a type and devices by type/instance. */
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device *dev_by_type[DEV_TYPE_MAX];
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device
+	*dev_registry[DEV_TYPE_MAX][INSTANCE_MAX];
+
 #ifdef CONFIG_DEVICE_DEBUG
 /* Print the list of platform devices. */
 void print_dev_list(void)
@@ -34,93 +40,101 @@ void print_dev_list(void)
 struct eclite_device *find_dev_instance_by_type(enum device_type type,
 						uint8_t instance)
 {
-	struct eclite_device *dev = NULL;
-
 	if (dev_list == NULL) {
 		LOG_ERR("Device list is null");
-		return dev;
+		return NULL;
 	}
 
-	for (int i = 0; i < no_of_devs; i++) {
-		if ((IS_DEV_TYPE_SAME(dev_list[i]->device_typ, type))) {
-			if (dev_list[i]->instance == instance) {
-				return dev_list[i];
-			}
-		}
+	if (type >= DEV_TYPE_MAX || instance >= INSTANCE_MAX) {
+		return NULL;
 	}
 
-	return dev;
+	return dev_registry[type][instance];
 }
 
 /* Find device struct by device type; else returns NULL. */
 struct eclite_device *find_dev_by_type(enum device_type type)
 {
-	struct eclite_device *dev = NULL;
-
 	if (dev_list == NULL) {
 		LOG_ERR("Device list is null");
-		return dev;
+		return NULL;
 	}
 
-	for (int i = 0; i < no_of_devs; i++) {
-		if ((IS_DEV_TYPE_SAME(dev_list[i]->device_typ, type))) {
-			return dev_list[i];
-		}
+	if (type >= DEV_TYPE_MAX) {
+		return NULL;
 	}
 
-	return dev;
+	return dev_by_type[type];
 }
 /* Get device status captured in dev structure. */
 enum device_status get_device_status(enum device_type type)
 {
-	enum device_status sts;
-
 	if (IS_DEV_LIST_NULL(dev_list)) {
 		LOG_ERR("Device not found");
 		return DEV_NOT_FOUND;
 	}
 
-	/* Run through the global list. */
-	for (int i = 0; i < no_of_devs; i++) {
-		if (IS_DEV_TYPE_SAME(dev_list[i]->device_typ, type)) {
-			sts = dev_list[i]->device_sts;
-			return sts;
-		}
+	if (type >= DEV_TYPE_MAX || IS_DEV_NULL(dev_by_type[type])) {
+		return DEV_STATUS_UNKNOWN;
 	}
 
-	return DEV_STATUS_UNKNOWN;
+	return dev_by_type[type]->device_sts;
 }
 
 /* Initialize a device. */
 enum device_err_code init_device(enum device_type type)
 {
-	int sts;
+	struct eclite_device *dev;
 
 	if (IS_DEV_LIST_NULL(dev_list)) {
 		LOG_ERR("Device not found");
 		return DEV_NOT_FOUND;
 	}
 
-	/* Run through the global list. */
-	for (int i = 0; i < no_of_devs; i++) {
-		if (IS_DEV_TYPE_SAME(dev_list[i]->device_typ, type)) {
-			sts =  dev_list[i]->init(dev_list[i]);
-			return sts;
-		}
+	if (type >= DEV_TYPE_MAX || IS_DEV_NULL(dev_by_type[type])) {
+		return DEV_NOT_FOUND;
 	}
 
-	return DEV_NOT_FOUND;
+	dev = dev_by_type[type];
+
+	return dev->init(dev);
 }
 
 /* Initialize device framework by passing platform device list. */
 int init_dev_framework(struct eclite_device *platform_dev_list[],
 		       int num_of_devices)
 {
+	struct eclite_device *dev;
+
 	if (IS_DEV_LIST_NULL(platform_dev_list)) {
 		LOG_ERR("Device not found");
 		return DEV_NOT_FOUND;
 	}
 
+	memset(dev_by_type, 0, sizeof(dev_by_type));
+	memset(dev_registry, 0, sizeof(dev_registry));
+
+	/* Index devices by type and instance, first match in list wins as
+	 * linear lookup used to do.
+	 */
+	for (int i = 0; i < num_of_devices; i++) {
+		dev = platform_dev_list[i];
+
+		if (dev->device_typ >= DEV_TYPE_MAX ||
+		    dev->instance >= INSTANCE_MAX) {
+			LOG_ERR("Device %s out of registry range", dev->name);
+			continue;
+		}
+
+		if (IS_DEV_NULL(dev_by_type[dev->device_typ])) {
+			dev_by_type[dev->device_typ] = dev;
+		}
+
+		if (IS_DEV_NULL(dev_registry[dev->device_typ][dev->instance])) {
+			dev_registry[dev->device_typ][dev->instance] = dev;
+		}
+	}
+
 	/* Assign it to dev size. */
 	no_of_devs = num_of_devices;
 
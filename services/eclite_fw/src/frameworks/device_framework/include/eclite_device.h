@@ -51,6 +51,7 @@ enum device_type {
 	DEV_THERMAL,
 	DEV_THERMAL_CPU,
 	DEV_UCSI,
+	DEV_TYPE_MAX,
 };
 
 /** @brief number of instance of an eclite device.
@@ -68,6 +69,7 @@ enum instance_type {
 	INSTANCE_7,
 	INSTANCE_8,
 	INSTANCE_9,
+	INSTANCE_MAX,
 };
 
 /** @brief Error codes for Device OPS.
@@ -179,7 +181,10 @@ void print_dev_list(void);
 
 /** @brief Callback to initialize device framework.
  *
- *  Called to initialize device management framework.
+ *  Called to initialize device management framework. Builds the device
+ *  registry indexed by type and instance, so device pointers returned by
+ *  lookups stay valid for the lifetime of the application and can be
+ *  resolved once by callers.
  *
  *  @param plat_dev_list array of devices in a platform.
  *  @param num_of_devices number of devices in array.
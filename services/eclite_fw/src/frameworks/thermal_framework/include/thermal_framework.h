@@ -145,6 +145,7 @@ typedef int (*read_data_t)(void *dev, int16_t *data);
 typedef int (*write_data_t)(void *dev, int16_t *data);
 typedef int (*status_data_t)(void *dev, int16_t *data);
 typedef int (*configure_data_t)(void *dev, int16_t *data);
+typedef int (*alert_window_t)(void *dev, int16_t *data);
 
 /**
  * @endcond
@@ -163,6 +164,10 @@ struct thermal_driver_api {
 	status_data_t status_data;
 	/** Configure thermal sensor.*/
 	configure_data_t configure_data;
+	/** Program sensor alert window, data[0] high and data[1] low limit.
+	 *  NULL if sensor has no alert pin.
+	 */
+	alert_window_t alert_window;
 };
 
 /**
@@ -189,6 +194,25 @@ void thermal_command(void *command);
  */
 int thermal_callback(uint16_t *status);
 
+/**
+ * @brief Thermal polling interval
+ *
+ * Interval for next thermal poll, adapted by thermal callback. It stretches
+ * while temperatures are flat and far from thresholds, relying on sensor
+ * alert windows in between, and shrinks near thresholds or on fast slope.
+ *
+ * @retval Polling interval in milliseconds.
+ */
+uint32_t thermal_poll_interval(void);
+
+/**
+ * @brief Host Sx entry notification
+ *
+ * Polling stops while host is in Sx, so thermal callback may not run
+ * before next S0. TjMax is fetched again on first callback after it.
+ */
+void thermal_sx_entry(void);
+
 #ifdef CONFIG_ECLITE_THERMAL_DEBUG
 
 /** EClite thermal framework INFO macro.*/
@@ -9,12 +9,41 @@
 #include "thermal_framework.h"
 #include "platform.h"
 #include "eclite_hw_interface.h"
+#include "eclite_dispatcher.h"
+#include <sedi.h>
 
 LOG_MODULE_REGISTER(thermal_framework, CONFIG_ECLITE_LOG_LEVEL);
 
 static APP_GLOBAL_VAR_BSS(1) uint8_t tj_max;
 static APP_GLOBAL_VAR(1) bool tj_flag;
 
+/* Thermal device handles, resolved from device registry once. */
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device
+	*thermal_devs[MAX_THERMAL_SENSOR];
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device *cpu_dev;
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device *fan_dev;
+static APP_GLOBAL_VAR(1) bool thermal_devs_resolved;
+
+/* Adaptive polling state, last reading per sensor and CPU in last slot. */
+static APP_GLOBAL_VAR_BSS(1) int16_t poll_last_temp[MAX_THERMAL_SENSOR + 1];
+static APP_GLOBAL_VAR(1) uint32_t poll_interval =
+	CONFIG_ECLITE_POLLING_TIMER_PERIOD;
+
+static void resolve_thermal_devs(void)
+{
+	if (thermal_devs_resolved) {
+		return;
+	}
+
+	for (int i = 0; i < MAX_THERMAL_SENSOR; i++) {
+		thermal_devs[i] = find_dev_instance_by_type(DEV_THERMAL, i + 1);
+	}
+	cpu_dev = find_dev_by_type(DEV_THERMAL_CPU);
+	fan_dev = find_dev_by_type(DEV_FAN);
+
+	thermal_devs_resolved = true;
+}
+
 static void update_sensor_status(uint16_t *thermal_status,
 				 uint16_t thermal_dev_type,
 				 uint16_t status)
@@ -137,20 +166,272 @@ static int read_tacho(struct eclite_device *tacho)
 	return 0;
 }
 
+#ifdef CONFIG_ECLITE_FAN_CLOSED_LOOP
+#define FAN_DUTY_MAX            100
+#define FAN_PID_SCALE           1000
+
+/* Closed loop fan controller state. */
+struct fan_loop_state {
+	/* accumulated RPM error */
+	int32_t integral;
+	/* RPM error of previous cycle */
+	int32_t prev_err;
+	/* consecutive cycles driven without tacho feedback */
+	uint8_t stall_cnt;
+	/* fan started by temperature curve or host */
+	bool spinning;
+	/* integral to be seeded from host duty on next cycle */
+	bool host_seed;
+};
+
+static APP_GLOBAL_VAR_BSS(1) struct fan_loop_state fan_loop;
+
+static void fan_loop_reset(void)
+{
+	fan_loop.integral = 0;
+	fan_loop.prev_err = 0;
+	fan_loop.stall_cnt = 0;
+	fan_loop.host_seed = false;
+}
+
+/* Hand host duty over to the loop. Next cycle seeds integral so that
+ * its output equals this duty, loop then moves from it within slew
+ * limit. Nonzero duty keeps the fan running until CPU drops below
+ * CPU_LOW_TEMPERATURE.
+ */
+static void fan_loop_host_duty(int16_t duty)
+{
+	fan_loop_reset();
+	fan_loop.host_seed = true;
+	if (duty) {
+		fan_loop.spinning = true;
+	}
+}
+
+/* RPM target from CPU temperature curve. Fan starts at minimum RPM
+ * above CPU_HIGH_TEMPERATURE and stops below CPU_LOW_TEMPERATURE, from
+ * CPU_HIGH_TEMPERATURE target ramps linearly up to maximum RPM.
+ */
+static int32_t fan_target_rpm(int16_t temp)
+{
+	int32_t span = CONFIG_ECLITE_FAN_CURVE_MAX_TEMP - CPU_HIGH_TEMPERATURE;
+
+	if (temp >= CPU_HIGH_TEMPERATURE) {
+		fan_loop.spinning = true;
+	} else if (temp < CPU_LOW_TEMPERATURE) {
+		fan_loop.spinning = false;
+	}
+
+	if (!fan_loop.spinning) {
+		return 0;
+	}
+
+	if (temp >= CONFIG_ECLITE_FAN_CURVE_MAX_TEMP) {
+		return CONFIG_ECLITE_FAN_MAX_RPM;
+	}
+
+	/* Hysteresis band below fan start temperature holds minimum */
+	if (temp <= CPU_HIGH_TEMPERATURE) {
+		return CONFIG_ECLITE_FAN_MIN_RPM;
+	}
+
+	return CONFIG_ECLITE_FAN_MIN_RPM +
+	       (CONFIG_ECLITE_FAN_MAX_RPM - CONFIG_ECLITE_FAN_MIN_RPM) *
+	       (temp - CPU_HIGH_TEMPERATURE) / span;
+}
+
+/* Compute fan duty from RPM target and current tacho reading. Output
+ * is curve feed-forward plus PID correction, limited to slew window
+ * around last duty. Integration stops while output is held at either
+ * edge of that window in direction of error, and within deadband.
+ * Returns true while loop is settling, i.e. error is outside deadband
+ * or fan is suspected stalled.
+ */
+static bool fan_closed_loop(struct eclite_device *fan, int16_t temp)
+{
+	struct thermal_driver_data *fan_data = fan->driver_data;
+	int32_t target = fan_target_rpm(temp);
+	int32_t err, deriv, ff, out, lo, hi;
+	bool settling;
+
+	/* Stall check below needs reading for duty applied last cycle */
+	read_tacho(fan);
+
+	if (!target) {
+		fan_loop_reset();
+		fan_data->rotation = 0;
+		return false;
+	}
+
+	/* Driven but tacho reports no rotation, kick at full duty */
+	if (fan_data->rotation && !fan_data->tacho) {
+		if (++fan_loop.stall_cnt >= CONFIG_ECLITE_FAN_STALL_CYCLES) {
+			LOG_ERR("Fan stall detected");
+			fan_loop_reset();
+			fan_data->rotation = FAN_DUTY_MAX;
+			return true;
+		}
+	} else {
+		fan_loop.stall_cnt = 0;
+	}
+
+	err = target - fan_data->tacho;
+	ff = target * FAN_DUTY_MAX / CONFIG_ECLITE_FAN_MAX_RPM;
+
+	if (fan_loop.host_seed) {
+		fan_loop.host_seed = false;
+		fan_loop.prev_err = err;
+		if (CONFIG_ECLITE_FAN_PID_KI) {
+			fan_loop.integral = ((fan_data->rotation - ff) *
+					     FAN_PID_SCALE -
+					     CONFIG_ECLITE_FAN_PID_KP * err) /
+					    CONFIG_ECLITE_FAN_PID_KI;
+		}
+	}
+
+	deriv = err - fan_loop.prev_err;
+	fan_loop.prev_err = err;
+
+	out = ff +
+	      (CONFIG_ECLITE_FAN_PID_KP * err +
+	       CONFIG_ECLITE_FAN_PID_KI * fan_loop.integral +
+	       CONFIG_ECLITE_FAN_PID_KD * deriv) / FAN_PID_SCALE;
+
+	lo = MAX(fan_data->rotation - CONFIG_ECLITE_FAN_SLEW, 0);
+	hi = MIN(fan_data->rotation + CONFIG_ECLITE_FAN_SLEW, FAN_DUTY_MAX);
+
+	settling = (err > CONFIG_ECLITE_FAN_LOOP_DEADBAND ||
+		    err < -CONFIG_ECLITE_FAN_LOOP_DEADBAND ||
+		    fan_loop.stall_cnt);
+
+	/* Stop integrating while output is clamped in direction of error */
+	if (settling && (out < hi || err < 0) && (out > lo || err > 0)) {
+		fan_loop.integral += err;
+	}
+
+	out = MIN(MAX(out, lo), hi);
+
+	ECLITE_LOG_DEBUG("Fan target: %d rpm: %d duty: %d", target,
+			 fan_data->tacho, out);
+	fan_data->rotation = out;
+
+	return settling;
+}
+#endif /* CONFIG_ECLITE_FAN_CLOSED_LOOP */
+
+/* Check if sensor reading calls for fast polling. CPU high and low
+ * thresholds track its temperature for delta alerts, so only critical
+ * limit is considered for CPU.
+ */
+static bool thermal_needs_fast_poll(struct eclite_device *thermal_dev,
+				    int16_t *last_temp,
+				    uint16_t thermal_dev_type)
+{
+	struct thermal_driver_data *data = thermal_dev->driver_data;
+	int16_t temp = data->temperature;
+	int16_t margin = CONFIG_ECLITE_THERMAL_POLL_MARGIN;
+	int16_t slope = temp - *last_temp;
+	bool fast;
+
+	*last_temp = temp;
+
+	if (slope < 0) {
+		slope = -slope;
+	}
+
+	fast = (slope >= CONFIG_ECLITE_THERMAL_POLL_SLOPE) ||
+	       (temp + margin >= (int16_t)data->critical);
+
+	if (thermal_dev_type != CPU) {
+		fast |= (temp + margin >= (int16_t)data->high_threshold) ||
+			(temp - margin <= (int16_t)data->low_threshold);
+	}
+
+	return fast;
+}
+
+/* Centre sensor alert window on current reading, so excursions between
+ * polls raise an alert. Window is narrowed to critical and low threshold
+ * but always contains the reading, so high limit never drops below low
+ * limit when reading is already outside that range.
+ */
+static void thermal_arm_alert_window(struct eclite_device *thermal_dev)
+{
+	struct thermal_driver_api *api = thermal_dev->driver_api;
+	struct thermal_driver_data *data = thermal_dev->driver_data;
+	int16_t temp = data->temperature;
+	int16_t window[2];
+
+	if (!api->alert_window) {
+		return;
+	}
+
+	window[0] = MIN(temp + CONFIG_ECLITE_THERMAL_ALERT_WINDOW,
+			(int16_t)data->critical);
+	window[0] = MAX(window[0], temp);
+	window[1] = MAX(temp - CONFIG_ECLITE_THERMAL_ALERT_WINDOW,
+			(int16_t)data->low_threshold);
+	window[1] = MIN(window[1], temp);
+
+	if (api->alert_window(thermal_dev, window)) {
+		LOG_WRN("Alert window update failed");
+	}
+}
+
+static void thermal_adapt_poll(void)
+{
+	bool fast = false;
+
+	for (int i = 0; i < MAX_THERMAL_SENSOR; i++) {
+		if (!thermal_devs[i]) {
+			continue;
+		}
+		fast |= thermal_needs_fast_poll(thermal_devs[i],
+						&poll_last_temp[i], i);
+		thermal_arm_alert_window(thermal_devs[i]);
+	}
+
+	if (cpu_dev) {
+		int16_t *cpu_last_temp = &poll_last_temp[MAX_THERMAL_SENSOR];
+
+		fast |= thermal_needs_fast_poll(cpu_dev, cpu_last_temp, CPU);
+	}
+
+	if (fast) {
+		poll_interval = CONFIG_ECLITE_THERMAL_POLL_MIN_MS;
+	} else {
+		poll_interval = MIN(poll_interval * 2,
+				    CONFIG_ECLITE_THERMAL_POLL_MAX_MS);
+	}
+
+	ECLITE_LOG_DEBUG("Thermal poll interval: %u", poll_interval);
+}
+
+uint32_t thermal_poll_interval(void)
+{
+	return poll_interval;
+}
+
+void thermal_sx_entry(void)
+{
+	tj_flag = false;
+}
+
 int thermal_callback(uint16_t *status)
 {
-	struct eclite_device *thermal;
-	struct eclite_device *cpu = find_dev_by_type(DEV_THERMAL_CPU);
-	struct eclite_device *tacho = find_dev_by_type(DEV_FAN);
-	struct eclite_device *fan = find_dev_by_type(DEV_FAN);
 	int ret = 0;
 
+	resolve_thermal_devs();
+
 	/* reset framework status.*/
 	*status = 0;
 
 	ECLITE_LOG_DEBUG("Executing thermal framework");
 
-	if (!tj_flag) {
+	/* TjMax is fixed for a boot of host, fetch it once per S0 entry */
+	if (eclite_sx_state != PM_RESET_TYPE_S0) {
+		tj_flag = false;
+	} else if (!tj_flag) {
 		int ret;
 
 		ret = pmc_command(GET_TJ_MAX, &tj_max);
@@ -163,17 +444,31 @@ int thermal_callback(uint16_t *status)
 
 	/* run over all possible instance of thermistor */
 	for (int i = 0; i < MAX_THERMAL_SENSOR; i++) {
-		thermal = find_dev_instance_by_type(DEV_THERMAL, i + 1);
 		/* process on board thermal sensors */
-		ret |= process_thermal(thermal, status, i);
+		ret |= process_thermal(thermal_devs[i], status, i);
 	}
 	/* Read CPU temperature */
-	ret |= process_thermal(cpu, status, CPU);
+	ret |= process_thermal(cpu_dev, status, CPU);
+	thermal_adapt_poll();
 	if (!thermal_disable_d0ix) {
+#ifdef CONFIG_ECLITE_FAN_CLOSED_LOOP
+		if (fan_dev && cpu_dev) {
+			struct thermal_driver_data *cpu_data =
+				cpu_dev->driver_data;
+
+			/* PID gains assume minimum poll interval, keep it
+			 * until fan is within deadband of its target.
+			 */
+			if (fan_closed_loop(fan_dev, cpu_data->temperature)) {
+				poll_interval =
+					CONFIG_ECLITE_THERMAL_POLL_MIN_MS;
+			}
+		}
+#endif
 		/* Control FAN */
-		ret |= control_fan(fan);
+		ret |= control_fan(fan_dev);
 		/* Read Tacho */
-		ret |= read_tacho(tacho);
+		ret |= read_tacho(fan_dev);
 	} else {
 		ECLITE_LOG_DEBUG("D0ix entry Fan Disabled");
 	}
@@ -189,7 +484,10 @@ int thermal_callback(uint16_t *status)
 void thermal_command(void *command)
 {
 	struct thermal_command_data *msg = command;
-	struct eclite_device *fan = find_dev_by_type(DEV_FAN);
+	struct eclite_device *fan;
+
+	resolve_thermal_devs();
+	fan = fan_dev;
 
 	/* Look for fan device, if not found return error */
 	if (!fan) {
@@ -205,10 +503,13 @@ void thermal_command(void *command)
 	case ECLITE_OS_EVENT_PWM_UPDATE:
 		fan_data->rotation = msg->data[0];
 		fan_api->write_data(fan, &fan_data->rotation);
+#ifdef CONFIG_ECLITE_FAN_CLOSED_LOOP
+		fan_loop_host_duty(fan_data->rotation);
+#endif
 		break;
 	case ECLITE_OS_EVENT_THERM_ALERT_TH_UPDATE:
 		for (int i = 0; i < MAX_THERMAL_SENSOR; i++) {
-			thermal = find_dev_instance_by_type(DEV_THERMAL, i + 1);
+			thermal = thermal_devs[i];
 			if (!thermal) {
 				continue;
 			}
@@ -223,7 +524,7 @@ void thermal_command(void *command)
 		break;
 	case ECLITE_OS_EVENT_CRIT_TEMP_UPDATE:
 		for (int i = 0; i < MAX_THERMAL_SENSOR; i++) {
-			thermal = find_dev_instance_by_type(DEV_THERMAL, i + 1);
+			thermal = thermal_devs[i];
 			if (!thermal) {
 				continue;
 			}
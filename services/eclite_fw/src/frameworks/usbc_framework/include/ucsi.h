@@ -118,9 +118,16 @@ struct ucsi_data_t {
  */
 struct ucsi_api_t {
 	usbc_fn_t ucsi_fn;
+	usbc_fn_t ucsi_poll;
 	pd_state_t get_pd_state;
 };
 
+/**
+ * Returned by UCSI driver when it updated CCI and MSG IN outside of PD
+ * interrupt, so they are to be passed to OS.
+ */
+#define UCSI_CCI_UPDATED     2
+
 /** UCSI Version number **/
 #define UCSI_VERSION_STR     0x110 /* Version 1.1 */
 
@@ -160,6 +167,16 @@ int ucsi_command(uint8_t cmd, uint8_t len, uint8_t *buf);
  *
  * @retval SUCCESS if correct comamnd is issued.
  *         FAILURE if incorrect command.
+ *         UCSI_CCI_UPDATED if CCI is to be passed to OS.
  */
 int ucsi_framework(uint8_t cmd_id);
 
+/**
+ * @brief This function lets UCSI driver check on command in progress,
+ * called periodically.
+ *
+ * @retval UCSI_CCI_UPDATED if CCI is to be passed to OS.
+ *         SUCCESS if nothing changed, ERROR otherwise.
+ */
+int ucsi_poll(void);
+
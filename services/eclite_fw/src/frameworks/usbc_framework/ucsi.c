@@ -6,14 +6,27 @@
 
 #include <ucsi.h>
 #include <eclite_device.h>
+#include <platform.h>
 
 LOG_MODULE_REGISTER(ucsi, CONFIG_ECLITE_LOG_LEVEL);
 
+/* UCSI device handle, resolved from device registry once. */
+static APP_GLOBAL_VAR_BSS(1) struct eclite_device *ucsi_dev;
+
+static struct eclite_device *get_ucsi_dev(void)
+{
+	if (!ucsi_dev) {
+		ucsi_dev = find_dev_by_type(DEV_UCSI);
+	}
+
+	return ucsi_dev;
+}
+
 /* This framework will be called in PD INT context */
 int ucsi_framework(uint8_t cmd_id)
 {
 	int ret;
-	struct eclite_device *dev = find_dev_by_type(DEV_UCSI);
+	struct eclite_device *dev = get_ucsi_dev();
 
 	/* Look for USCI device, if not found return error */
 	if (!dev) {
@@ -39,6 +52,23 @@ int ucsi_framework(uint8_t cmd_id)
 	return ret;
 }
 
+int ucsi_poll(void)
+{
+	struct eclite_device *dev = get_ucsi_dev();
+	struct ucsi_api_t *api;
+
+	if (!dev) {
+		return ERROR;
+	}
+
+	api = dev->driver_api;
+	if (!api || !api->ucsi_poll) {
+		return SUCCESS;
+	}
+
+	return api->ucsi_poll(dev);
+}
+
 /* This framework will be called in HECI / when framework wants
  * to send data context read and write data to and from HECI buffer
  * framework buffer
@@ -47,7 +77,7 @@ int ucsi_framework(uint8_t cmd_id)
 int ucsi_command(uint8_t cmd, uint8_t len, uint8_t *buf)
 {
 	int ret = 0;
-	struct eclite_device *dev = find_dev_by_type(DEV_UCSI);
+	struct eclite_device *dev = get_ucsi_dev();
 
 	/* Look for USCI device, if not found return error */
 	if (!dev) {
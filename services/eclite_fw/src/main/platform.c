@@ -198,18 +198,17 @@ APP_GLOBAL_VAR(1) uint32_t no_of_devices = sizeof(platform_devices_default) /
 APP_GLOBAL_VAR(1) uint8_t thermal_disable_d0ix = 0;
 
 static void connect_peripherals(void);
+static void service_main(void *p1, void *p2, void *p3);
 
 #if defined(CONFIG_SOC_ELKHART_LAKE_PSE)
 /* Add the required kernel object pointer into list. */
 
 static const void *obj_list[] = {
 	&dispatcher_task, &dispatcher_stack, &dispatcher_queue,
-	&dispatcher_timer,
+	&dispatcher_timer, &dispatcher_crit_queue, &dispatcher_sem,
 };
 
-#define NO_KOBJS 4
-
-static void service_main(void *p1, void *p2, void *p3);
+#define NO_KOBJS 6
 
 /**
  * Define a service which will execute immediately
@@ -261,6 +260,7 @@ void pm_reset_prep_cb(uint32_t prep_type, uint32_t reset_type,
 	}
 
 	k_timer_stop(&dispatcher_timer);
+	thermal_sx_entry();
 	display_sx_state(reset_type);
 }
 
@@ -329,8 +329,7 @@ void s0ix_callback(sedi_pm_s0ix_event_t event, void *ctx)
 			event_data.data = ECLITE_OS_EVENT_PWM_UPDATE;
 			eclite_post_dispatcher_event(&event_data);
 
-			k_timer_start(&dispatcher_timer, K_NO_WAIT,
-				      K_MSEC(CONFIG_ECLITE_POLLING_TIMER_PERIOD));
+			thermal_poll_start();
 		}
 	}
 }
@@ -541,7 +540,7 @@ void eclite_d0ix(uint8_t state)
 {
 	thermal_disable_d0ix = state;
 }
-#if defined(CONFIG_SOC_ELKHART_LAKE_PSE)
+
 static void service_main(void *p1, void *p2, void *p3)
 {
 	if (!eclite_enable) {
@@ -564,10 +563,14 @@ static void service_main(void *p1, void *p2, void *p3)
 	ARG_UNUSED(p3);
 	dispatcher_init();
 }
-#else
+
+#if !defined(CONFIG_SOC_ELKHART_LAKE_PSE)
+/* Without user mode app framework, run config callback and service
+ * main from main in the order the framework would.
+ */
 void main(void)
 {
-	dispatcher_init();
 	connect_peripherals();
+	service_main(NULL, NULL, NULL);
 }
 #endif
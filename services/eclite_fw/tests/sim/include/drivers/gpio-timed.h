@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Subset of the PSE timed GPIO interface used by the EClite fan
+ * tachometer, for the native_posix simulation. Implemented in emul_fan.c.
+ */
+
+#ifndef _SIM_GPIO_TIMED_H_
+#define _SIM_GPIO_TIMED_H_
+
+#include <device.h>
+
+struct tgpio_time {
+	uint32_t sec;
+	uint32_t nsec;
+};
+
+enum tgpio_timer {
+	TGPIO_TMT_0,
+	TGPIO_TMT_1,
+	TGPIO_TMT_2,
+	TGPIO_ART,
+};
+
+typedef void (*tgpio_pin_callback_t)(const struct device *port,
+				     uint32_t pin, struct tgpio_time ts,
+				     uint64_t ev_cnt);
+
+int tgpio_port_set_time(const struct device *dev, enum tgpio_timer timer,
+			uint32_t sec, uint32_t nsec);
+int tgpio_port_get_time(const struct device *dev, enum tgpio_timer timer,
+			uint32_t *sec, uint32_t *nsec);
+int tgpio_pin_timestamp_event(const struct device *dev, uint32_t pin,
+			      enum tgpio_timer timer, uint64_t ceiling,
+			      uint32_t edge, tgpio_pin_callback_t cb);
+int tgpio_pin_count_events(const struct device *dev, uint32_t pin,
+			   enum tgpio_timer timer, struct tgpio_time start,
+			   struct tgpio_time interval, uint32_t edge,
+			   tgpio_pin_callback_t cb);
+
+#endif /* _SIM_GPIO_TIMED_H_ */
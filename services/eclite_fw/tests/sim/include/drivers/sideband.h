@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Sideband raw message layout needed by pmc_service.h, for the
+ * native_posix simulation. EClite sends no raw sideband messages.
+ */
+
+#ifndef _SIM_SIDEBAND_H_
+#define _SIM_SIDEBAND_H_
+
+#include <stdint.h>
+
+struct sb_raw_message {
+	uint32_t opcode;
+	uint32_t address;
+	uint32_t data;
+};
+
+#endif /* _SIM_SIDEBAND_H_ */
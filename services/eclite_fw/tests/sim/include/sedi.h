@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Subset of SEDI config and power management interface used by
+ * EClite, for the native_posix simulation. Implemented in mock_sedi.c.
+ */
+
+#ifndef _SIM_SEDI_H_
+#define _SIM_SEDI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SEDI_DRIVER_OK          0
+
+/** Config ids queried by EClite. */
+typedef enum {
+	SEDI_CONFIG_ECLITE_EN,
+	SEDI_CONFIG_ECLITE_DTS_EN,
+} sedi_config_t;
+
+/** Config state returned by sedi_get_config. */
+#define SEDI_CONFIG_SET         1
+#define SEDI_CONFIG_UNSET       0
+
+/** Reset/Sx types reported by reset prep. */
+typedef enum {
+	PM_RESET_TYPE_S0 = 0,
+	PM_RESET_TYPE_S3 = 3,
+	PM_RESET_TYPE_S4 = 4,
+	PM_RESET_TYPE_S5 = 5,
+	PM_RESET_TYPE_WARM_RESET = 6,
+	PM_RESET_TYPE_COLD_RESET = 7,
+} sedi_pm_reset_type_t;
+
+typedef enum {
+	PM_EVENT_HOST_SX_ENTRY,
+	PM_EVENT_HOST_SX_EXIT,
+} sedi_pm_sx_event_t;
+
+typedef enum {
+	PM_EVENT_HOST_S0IX_ENTRY,
+	PM_EVENT_HOST_S0IX_EXIT,
+} sedi_pm_s0ix_event_t;
+
+typedef enum {
+	PM_WAKE_EVENT_GPIO,
+} sedi_pm_wake_event_t;
+
+typedef union {
+	uint32_t gpio_pin;
+} sedi_wake_event_instance_t;
+
+typedef struct {
+	uint32_t reset_type;
+} sedi_pm_reset_prep_t;
+
+typedef enum {
+	CALLBACK_TYPE_RESET_PREP,
+} sedi_pm_callback_type_t;
+
+typedef enum {
+	CALLBACK_PRI_NORMAL,
+} sedi_pm_callback_pri_t;
+
+typedef void (*sedi_pm_sx_callback_t)(sedi_pm_sx_event_t event,
+				      void *ctx);
+typedef void (*sedi_pm_s0ix_callback_t)(sedi_pm_s0ix_event_t event,
+					void *ctx);
+
+typedef struct {
+	union {
+		void (*rstprep_cb)(uint32_t prep_type, uint32_t reset_type,
+				   void *ctx);
+	} func;
+	void *ctx;
+	sedi_pm_callback_type_t type;
+	sedi_pm_callback_pri_t pri;
+} sedi_pm_callback_config_t;
+
+int sedi_get_config(sedi_config_t id, void *data);
+int sedi_pm_configure_wake_source(sedi_pm_wake_event_t type,
+				  sedi_wake_event_instance_t instance,
+				  bool enable);
+int sedi_pm_register_sx_notification(sedi_pm_sx_callback_t cb, void *ctx);
+int sedi_pm_register_s0ix_notification(sedi_pm_s0ix_callback_t cb,
+				       void *ctx);
+int sedi_pm_register_callback(sedi_pm_callback_config_t *config);
+int sedi_pm_get_reset_prep_info(sedi_pm_reset_prep_t *info);
+
+#endif /* _SIM_SEDI_H_ */
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* CCG PD controller on the UCSI bus. Answers the HPI registers used at
+ * bring-up and runs UCSI commands written to CONTROL, completing them
+ * after CCG_CMD_MS with CCI and MSG IN set and the active low interrupt
+ * line asserted until the interrupt register is cleared. Completion
+ * interrupts can be dropped to model lost interrupts.
+ */
+
+#include <zephyr.h>
+#include <init.h>
+#include <string.h>
+#include "ucsi.h"
+#include "sim.h"
+
+#define CCG_REG_DEVICE_MODE     0x0000
+#define CCG_REG_INTERRUPT       0x0006
+#define CCG_REG_FW2_VERSION     0x0020
+#define CCG_REG_PDPORT_ENABLE   0x002C
+#define CCG_REG_UCSI_STATUS     0x0038
+#define CCG_REG_UCSI_CONTROL    0x0039
+#define CCG_REG_RESPONSE        0x007E
+#define CCG_REG_EVENT_MASK0     0x1024
+#define CCG_REG_PDRESPONSE0     0x1400
+#define CCG_REG_VERSION         0xF000
+#define CCG_REG_CCI             0xF004
+#define CCG_REG_CONTROL         0xF008
+#define CCG_REG_MSG_IN          0xF010
+#define CCG_REG_MSG_OUT         0xF020
+
+#define CCG_INT_DEVICE          BIT(0)
+#define CCG_INT_UCSI_READ       BIT(7)
+#define CCG_STATUS_STARTED      BIT(0)
+#define CCG_STATUS_CMD_IP       BIT(1)
+#define CCG_START_UCSI          BIT(0)
+#define CCG_MODE_FW2            0x02
+#define CCG_RESPONSE_SUCCESS    0x02
+#define CCG_UCSI_VERSION        0x0110
+
+/* Time controller takes to run a UCSI command */
+#define CCG_CMD_MS              20
+
+static struct {
+	struct sim_i2c_slave slave;
+	uint8_t intr;
+	uint8_t status;
+	uint8_t response;
+	struct cci_t cci;
+	struct msg_in_t msg_in;
+	struct msg_out_t msg_out;
+	struct control_t control;
+	/* command runs until remaining_ms is used up */
+	bool running;
+	int32_t remaining_ms;
+	/* command completion reported, ACK_CC_CI not seen yet */
+	bool ack_pending;
+	/* completions to signal without interrupt */
+	uint32_t drop;
+	uint32_t cmds;
+	uint32_t overlaps;
+	uint32_t dropped;
+} ccg;
+
+static void ccg_update_line(void)
+{
+	sim_gpio_drive(CONFIG_ECLITE_UCSI_GPIO_NAME,
+		       CONFIG_ECLITE_UCSI_GPIO_PIN, !ccg.intr);
+}
+
+/* Device command done, HPI response set and device interrupt raised */
+static void ccg_respond(uint8_t code)
+{
+	ccg.response = code;
+	ccg.intr |= CCG_INT_DEVICE;
+}
+
+static void ccg_command(const uint8_t *buf, uint32_t len)
+{
+	memset(&ccg.control, 0, sizeof(ccg.control));
+	memcpy(&ccg.control, buf, MIN(len, sizeof(ccg.control)));
+	ccg.cmds++;
+
+	/* Only reset, cancel and ACK_CC_CI may be sent while a command
+	 * runs or its completion waits for ACK_CC_CI.
+	 */
+	if (ccg.control.command != PPM_RSTCMD &&
+	    ccg.control.command != PPM_CANCELCMD &&
+	    ccg.control.command != PPM_ACKCCCICMD &&
+	    (ccg.running || ccg.ack_pending)) {
+		ccg.overlaps++;
+	}
+
+	ccg.running = true;
+	ccg.remaining_ms = CCG_CMD_MS;
+	ccg.status |= CCG_STATUS_CMD_IP;
+}
+
+static void ccg_complete(void)
+{
+	memset(&ccg.cci, 0, sizeof(ccg.cci));
+	memset(&ccg.msg_in, 0, sizeof(ccg.msg_in));
+
+	switch (ccg.control.command) {
+	case PPM_RSTCMD:
+		ccg.cci.resetcompleted = 1;
+		ccg.ack_pending = false;
+		break;
+	case PPM_ACKCCCICMD:
+		ccg.cci.ackcmdcomp = 1;
+		ccg.ack_pending = false;
+		break;
+	default:
+		/* MSG IN echoes command and its first parameter, so host
+		 * can tell completions apart.
+		 */
+		ccg.msg_in.msg[0] = ccg.control.command;
+		ccg.msg_in.msg[1] = ccg.control.cmdspecific[0];
+		ccg.cci.dataLen = 2;
+		ccg.cci.cancelcompleted =
+			ccg.control.command == PPM_CANCELCMD;
+		ccg.cci.cmdcompleted = 1;
+		ccg.ack_pending = true;
+		break;
+	}
+
+	ccg.running = false;
+	ccg.status &= ~CCG_STATUS_CMD_IP;
+
+	if (ccg.drop) {
+		ccg.drop--;
+		ccg.dropped++;
+		return;
+	}
+
+	ccg.intr |= CCG_INT_UCSI_READ;
+	ccg_update_line();
+}
+
+static int ccg_read(struct sim_i2c_slave *slave, uint16_t reg, uint8_t *buf,
+		    uint32_t len)
+{
+	static const uint8_t mode = CCG_MODE_FW2;
+	static const uint16_t version = CCG_UCSI_VERSION;
+	const void *src = NULL;
+	uint32_t size = 0;
+
+	ARG_UNUSED(slave);
+
+	switch (reg) {
+	case CCG_REG_DEVICE_MODE:
+		src = &mode;
+		size = sizeof(mode);
+		break;
+	case CCG_REG_INTERRUPT:
+		src = &ccg.intr;
+		size = sizeof(ccg.intr);
+		break;
+	case CCG_REG_UCSI_STATUS:
+		src = &ccg.status;
+		size = sizeof(ccg.status);
+		break;
+	case CCG_REG_RESPONSE:
+		src = &ccg.response;
+		size = sizeof(ccg.response);
+		break;
+	case CCG_REG_VERSION:
+		src = &version;
+		size = sizeof(version);
+		break;
+	case CCG_REG_CCI:
+		src = &ccg.cci;
+		size = sizeof(ccg.cci);
+		break;
+	case CCG_REG_MSG_IN:
+		src = &ccg.msg_in;
+		size = sizeof(ccg.msg_in);
+		break;
+	case CCG_REG_FW2_VERSION:
+	case CCG_REG_PDRESPONSE0:
+		/* No port events, version reads 0 */
+		break;
+	default:
+		return -EIO;
+	}
+
+	memset(buf, 0, len);
+	if (src) {
+		memcpy(buf, src, MIN(len, size));
+	}
+
+	return 0;
+}
+
+static int ccg_write(struct sim_i2c_slave *slave, uint16_t reg,
+		     const uint8_t *buf, uint32_t len)
+{
+	ARG_UNUSED(slave);
+
+	switch (reg) {
+	case CCG_REG_INTERRUPT:
+		/* Ones written clear interrupt */
+		if (len) {
+			ccg.intr &= ~buf[0];
+		}
+		break;
+	case CCG_REG_PDPORT_ENABLE:
+		ccg_respond(CCG_RESPONSE_SUCCESS);
+		break;
+	case CCG_REG_UCSI_CONTROL:
+		if (len && (buf[0] & CCG_START_UCSI)) {
+			ccg.status |= CCG_STATUS_STARTED;
+			ccg_respond(CCG_RESPONSE_SUCCESS);
+		}
+		break;
+	case CCG_REG_EVENT_MASK0:
+		break;
+	case CCG_REG_MSG_OUT:
+		memcpy(&ccg.msg_out, buf, MIN(len, sizeof(ccg.msg_out)));
+		break;
+	case CCG_REG_CONTROL:
+		ccg_command(buf, len);
+		break;
+	default:
+		return -EIO;
+	}
+
+	ccg_update_line();
+
+	return 0;
+}
+
+void sim_ccg_drop(uint32_t count)
+{
+	ccg.drop = count;
+}
+
+void sim_ccg_step(uint32_t dt_ms)
+{
+	if (!ccg.running) {
+		return;
+	}
+
+	ccg.remaining_ms -= dt_ms;
+	if (ccg.remaining_ms <= 0) {
+		ccg_complete();
+	}
+}
+
+int sim_ccg_metric(const char *name, int32_t *value)
+{
+	if (!strcmp(name, "ccg.cmds")) {
+		*value = ccg.cmds;
+	} else if (!strcmp(name, "ccg.overlaps")) {
+		*value = ccg.overlaps;
+	} else if (!strcmp(name, "ccg.dropped")) {
+		*value = ccg.dropped;
+	} else if (!strcmp(name, "ccg.running")) {
+		*value = ccg.running;
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_ccg_reset(void)
+{
+	ccg.cmds = 0;
+	ccg.overlaps = 0;
+	ccg.dropped = 0;
+}
+
+static int sim_ccg_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	/* Without UCSI framework bus stays empty */
+	if (!IS_ENABLED(CONFIG_ECLITE_UCSI_FRAMEWORK)) {
+		return 0;
+	}
+
+	ccg.slave.bus = CONFIG_ECLITE_UCSI_I2C_SLAVE_NAME;
+	ccg.slave.addr = CONFIG_ECLITE_UCSI_I2C_SLAVE_ADDR;
+	ccg.slave.reg16 = true;
+	ccg.slave.read = ccg_read;
+	ccg.slave.write = ccg_write;
+	sim_i2c_attach(&ccg.slave);
+
+	/* Interrupt line idles high */
+	ccg_update_line();
+
+	return 0;
+}
+
+SYS_INIT(sim_ccg_init, POST_KERNEL, 60);
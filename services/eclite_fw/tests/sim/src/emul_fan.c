@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Fan model with PWM input and two pulse per revolution tachometer on a
+ * timed GPIO. Speed follows duty cycle with a first order lag, tacho
+ * edges are generated from speed and time stamped on TGPIO time base.
+ */
+
+#include <device.h>
+#include <drivers/pwm.h>
+#include <drivers/gpio-timed.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define FAN_MAX_RPM             6000
+#define FAN_MIN_DUTY            10
+#define FAN_TAU_MS              500
+#define FAN_PULSES_PER_REV      2
+#define FAN_PWM_CLOCK_HZ        1000000
+
+/* Tacho pulse accumulator counts 1/60000 pulse, rpm * pulses per rev
+ * per millisecond.
+ */
+#define FAN_PULSE_UNIT          (60 * MSEC_PER_SEC)
+
+static struct {
+	/* duty cycle in percent */
+	uint32_t duty;
+	uint32_t duty_step;
+	bool duty_set;
+	/* speed in milli rpm */
+	int64_t mrpm;
+	bool stall;
+	uint64_t pulse_acc;
+	uint64_t edges;
+	/* TGPIO time base */
+	uint64_t base_ns;
+	int64_t base_uptime;
+	/* count mode */
+	tgpio_pin_callback_t count_cb;
+	uint64_t next_count_ns;
+	uint64_t interval_ns;
+	/* timestamp mode */
+	tgpio_pin_callback_t ts_cb;
+	uint64_t ceiling;
+	uint64_t ts_edges;
+	uint32_t pin;
+} fan;
+
+static uint64_t tgpio_now_ns(void)
+{
+	return fan.base_ns +
+	       (k_uptime_get() - fan.base_uptime) * NSEC_PER_USEC *
+	       USEC_PER_MSEC;
+}
+
+static struct tgpio_time tgpio_time_of(uint64_t ns)
+{
+	struct tgpio_time t = {
+		.sec = ns / NSEC_PER_SEC,
+		.nsec = ns % NSEC_PER_SEC,
+	};
+
+	return t;
+}
+
+static int sim_pwm_pin_set(const struct device *dev, uint32_t pwm,
+			   uint32_t period_cycles, uint32_t pulse_cycles,
+			   pwm_flags_t flags)
+{
+	uint32_t duty;
+
+	ARG_UNUSED(dev);
+	ARG_UNUSED(pwm);
+	ARG_UNUSED(flags);
+
+	if (!period_cycles || pulse_cycles > period_cycles) {
+		return -EINVAL;
+	}
+
+	duty = pulse_cycles * 100 / period_cycles;
+	if (fan.duty_set) {
+		fan.duty_step = MAX(fan.duty_step,
+				    (uint32_t)abs((int)duty - (int)fan.duty));
+	}
+	fan.duty = duty;
+	fan.duty_set = true;
+
+	return 0;
+}
+
+static int sim_pwm_get_cycles_per_sec(const struct device *dev, uint32_t pwm,
+				      uint64_t *cycles)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(pwm);
+
+	*cycles = FAN_PWM_CLOCK_HZ;
+
+	return 0;
+}
+
+static const struct pwm_driver_api sim_pwm_api = {
+	.pin_set = sim_pwm_pin_set,
+	.get_cycles_per_sec = sim_pwm_get_cycles_per_sec,
+};
+
+static int sim_fan_dev_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(sim_pwm, CONFIG_ECLITE_FAN_PWM_NAME, sim_fan_dev_init,
+		    NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &sim_pwm_api);
+
+/* Timed GPIO functions are not dispatched through the device API, the
+ * device exists only to be found by name.
+ */
+static const uint32_t sim_tgpio_api;
+
+DEVICE_AND_API_INIT(sim_tgpio, CONFIG_ECLITE_FAN_TGPIO_NAME,
+		    sim_fan_dev_init, NULL, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_tgpio_api);
+
+int tgpio_port_set_time(const struct device *dev, enum tgpio_timer timer,
+			uint32_t sec, uint32_t nsec)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(timer);
+
+	fan.base_ns = (uint64_t)sec * NSEC_PER_SEC + nsec;
+	fan.base_uptime = k_uptime_get();
+
+	return 0;
+}
+
+int tgpio_port_get_time(const struct device *dev, enum tgpio_timer timer,
+			uint32_t *sec, uint32_t *nsec)
+{
+	struct tgpio_time t = tgpio_time_of(tgpio_now_ns());
+
+	ARG_UNUSED(dev);
+	ARG_UNUSED(timer);
+
+	*sec = t.sec;
+	*nsec = t.nsec;
+
+	return 0;
+}
+
+int tgpio_pin_timestamp_event(const struct device *dev, uint32_t pin,
+			      enum tgpio_timer timer, uint64_t ceiling,
+			      uint32_t edge, tgpio_pin_callback_t cb)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(timer);
+	ARG_UNUSED(edge);
+
+	if (!ceiling || !cb) {
+		return -EINVAL;
+	}
+
+	fan.pin = pin;
+	fan.ceiling = ceiling;
+	fan.ts_edges = 0;
+	fan.ts_cb = cb;
+
+	return 0;
+}
+
+int tgpio_pin_count_events(const struct device *dev, uint32_t pin,
+			   enum tgpio_timer timer, struct tgpio_time start,
+			   struct tgpio_time interval, uint32_t edge,
+			   tgpio_pin_callback_t cb)
+{
+	ARG_UNUSED(timer);
+	ARG_UNUSED(edge);
+
+	fan.interval_ns = (uint64_t)interval.sec * NSEC_PER_SEC +
+			  interval.nsec;
+	if (!fan.interval_ns || !cb) {
+		return -EINVAL;
+	}
+
+	fan.pin = pin;
+	fan.next_count_ns = (uint64_t)start.sec * NSEC_PER_SEC + start.nsec;
+	fan.count_cb = cb;
+
+	return 0;
+}
+
+void sim_fan_stall(bool stall)
+{
+	fan.stall = stall;
+}
+
+void sim_fan_step(uint32_t dt_ms)
+{
+	const struct device *dev = device_get_binding(
+		CONFIG_ECLITE_FAN_TGPIO_NAME);
+	int64_t target = 0;
+	uint64_t end_ns = tgpio_now_ns();
+	uint64_t start_ns = end_ns - (uint64_t)dt_ms * NSEC_PER_USEC *
+			    USEC_PER_MSEC;
+	uint64_t rate, budget, used = 0;
+
+	if (!fan.stall && fan.duty >= FAN_MIN_DUTY) {
+		target = (int64_t)fan.duty * FAN_MAX_RPM * 1000 / 100;
+	}
+	fan.mrpm += (target - fan.mrpm) * dt_ms / (FAN_TAU_MS + dt_ms);
+	/* Stalled rotor stops at once */
+	if (fan.stall) {
+		fan.mrpm = 0;
+	}
+
+	rate = fan.mrpm * FAN_PULSES_PER_REV / 1000;
+	budget = rate * dt_ms;
+
+	k_sched_lock();
+	while (rate && fan.pulse_acc + budget >= FAN_PULSE_UNIT) {
+		uint64_t needed = FAN_PULSE_UNIT - fan.pulse_acc;
+		uint64_t edge_ns;
+
+		/* Edge lands part way through step */
+		used += needed;
+		budget -= needed;
+		fan.pulse_acc = 0;
+		edge_ns = start_ns + used * NSEC_PER_USEC * USEC_PER_MSEC /
+			  rate;
+		fan.edges++;
+
+		if (fan.ts_cb && ++fan.ts_edges >= fan.ceiling) {
+			fan.ts_edges = 0;
+			fan.ts_cb(dev, fan.pin, tgpio_time_of(edge_ns),
+				  fan.edges);
+		}
+	}
+	fan.pulse_acc += budget;
+
+	while (fan.count_cb && fan.next_count_ns <= end_ns) {
+		fan.count_cb(dev, fan.pin, tgpio_time_of(fan.next_count_ns),
+			     fan.edges);
+		fan.next_count_ns += fan.interval_ns;
+	}
+	k_sched_unlock();
+}
+
+int sim_fan_metric(const char *name, int32_t *value)
+{
+	if (!strcmp(name, "fan.rpm")) {
+		*value = fan.mrpm / 1000;
+	} else if (!strcmp(name, "fan.duty")) {
+		*value = fan.duty;
+	} else if (!strcmp(name, "fan.duty_step")) {
+		*value = fan.duty_step;
+	} else if (!strcmp(name, "fan.edges")) {
+		*value = fan.edges;
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_fan_reset(void)
+{
+	fan.duty_step = 0;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* GPIO port emulator. Device models drive input levels, edges and
+ * levels matching the configured interrupt run the registered callbacks
+ * with scheduler locked, as an ISR would.
+ */
+
+#include <device.h>
+#include <drivers/gpio.h>
+#include <sys/slist.h>
+#include "sim.h"
+
+struct sim_gpio_cfg {
+	/* gpio_driver_config needs to be first */
+	struct gpio_driver_config common;
+};
+
+struct sim_gpio_data {
+	/* gpio_driver_data needs to be first */
+	struct gpio_driver_data common;
+	sys_slist_t callbacks;
+	uint32_t in;
+	uint32_t out;
+	uint32_t dir_out;
+	uint32_t int_en;
+	uint32_t int_edge;
+	uint32_t int_low;
+	uint32_t int_high;
+};
+
+static void sim_gpio_fire(const struct device *port, uint32_t pins)
+{
+	struct sim_gpio_data *data = port->data;
+	struct gpio_callback *cb, *tmp;
+
+	k_sched_lock();
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&data->callbacks, cb, tmp, node) {
+		if (cb->pin_mask & pins) {
+			cb->handler(port, cb, cb->pin_mask & pins);
+		}
+	}
+	k_sched_unlock();
+}
+
+/* Pins of mask whose level matches their level interrupt. */
+static uint32_t sim_gpio_level_active(struct sim_gpio_data *data,
+				      uint32_t mask)
+{
+	uint32_t level = mask & data->int_en & ~data->int_edge;
+
+	return level & ((data->in & data->int_high) |
+			(~data->in & data->int_low));
+}
+
+static int sim_gpio_pin_configure(const struct device *port,
+				  gpio_pin_t pin, gpio_flags_t flags)
+{
+	struct sim_gpio_data *data = port->data;
+
+	if (flags & GPIO_OUTPUT) {
+		data->dir_out |= BIT(pin);
+		if (flags & GPIO_OUTPUT_INIT_HIGH) {
+			data->out |= BIT(pin);
+		} else if (flags & GPIO_OUTPUT_INIT_LOW) {
+			data->out &= ~BIT(pin);
+		}
+	} else {
+		data->dir_out &= ~BIT(pin);
+	}
+
+	return 0;
+}
+
+static int sim_gpio_port_get_raw(const struct device *port,
+				 gpio_port_value_t *value)
+{
+	struct sim_gpio_data *data = port->data;
+
+	*value = (data->out & data->dir_out) | (data->in & ~data->dir_out);
+
+	return 0;
+}
+
+static int sim_gpio_port_set_masked_raw(const struct device *port,
+					gpio_port_pins_t mask,
+					gpio_port_value_t value)
+{
+	struct sim_gpio_data *data = port->data;
+
+	data->out = (data->out & ~mask) | (value & mask);
+
+	return 0;
+}
+
+static int sim_gpio_port_set_bits_raw(const struct device *port,
+				      gpio_port_pins_t pins)
+{
+	struct sim_gpio_data *data = port->data;
+
+	data->out |= pins;
+
+	return 0;
+}
+
+static int sim_gpio_port_clear_bits_raw(const struct device *port,
+					gpio_port_pins_t pins)
+{
+	struct sim_gpio_data *data = port->data;
+
+	data->out &= ~pins;
+
+	return 0;
+}
+
+static int sim_gpio_port_toggle_bits(const struct device *port,
+				     gpio_port_pins_t pins)
+{
+	struct sim_gpio_data *data = port->data;
+
+	data->out ^= pins;
+
+	return 0;
+}
+
+static int sim_gpio_pin_interrupt_configure(const struct device *port,
+					    gpio_pin_t pin,
+					    enum gpio_int_mode mode,
+					    enum gpio_int_trig trig)
+{
+	struct sim_gpio_data *data = port->data;
+	uint32_t active;
+
+	data->int_en &= ~BIT(pin);
+	data->int_edge &= ~BIT(pin);
+	data->int_low &= ~BIT(pin);
+	data->int_high &= ~BIT(pin);
+
+	if (mode == GPIO_INT_MODE_DISABLED) {
+		return 0;
+	}
+
+	data->int_en |= BIT(pin);
+	if (mode == GPIO_INT_MODE_EDGE) {
+		data->int_edge |= BIT(pin);
+	}
+	if (trig & GPIO_INT_TRIG_LOW) {
+		data->int_low |= BIT(pin);
+	}
+	if (trig & GPIO_INT_TRIG_HIGH) {
+		data->int_high |= BIT(pin);
+	}
+
+	/* Level interrupt fires at once when level is already active */
+	active = sim_gpio_level_active(data, BIT(pin));
+	if (active) {
+		sim_gpio_fire(port, active);
+	}
+
+	return 0;
+}
+
+static int sim_gpio_manage_callback(const struct device *port,
+				    struct gpio_callback *callback, bool set)
+{
+	struct sim_gpio_data *data = port->data;
+
+	/* Registering again moves callback to head of list */
+	if (!sys_slist_find_and_remove(&data->callbacks, &callback->node) &&
+	    !set) {
+		return -EINVAL;
+	}
+
+	if (set) {
+		sys_slist_prepend(&data->callbacks, &callback->node);
+	}
+
+	return 0;
+}
+
+static uint32_t sim_gpio_get_pending_int(const struct device *port)
+{
+	ARG_UNUSED(port);
+
+	return 0;
+}
+
+void sim_gpio_drive(const char *name, uint32_t pin, int level)
+{
+	const struct device *port = device_get_binding(name);
+	struct sim_gpio_data *data;
+	uint32_t old, fire;
+
+	if (!port) {
+		return;
+	}
+
+	data = port->data;
+	old = data->in;
+	if (level) {
+		data->in |= BIT(pin);
+	} else {
+		data->in &= ~BIT(pin);
+	}
+
+	if (data->dir_out & BIT(pin)) {
+		return;
+	}
+
+	fire = sim_gpio_level_active(data, BIT(pin));
+	if ((data->int_en & data->int_edge & BIT(pin)) && old != data->in) {
+		if ((level && (data->int_high & BIT(pin))) ||
+		    (!level && (data->int_low & BIT(pin)))) {
+			fire |= BIT(pin);
+		}
+	}
+
+	if (fire) {
+		sim_gpio_fire(port, fire);
+	}
+}
+
+int sim_gpio_output(const char *name, uint32_t pin)
+{
+	const struct device *port = device_get_binding(name);
+	struct sim_gpio_data *data;
+
+	if (!port) {
+		return 0;
+	}
+
+	data = port->data;
+
+	return (data->dir_out & data->out & BIT(pin)) ? 1 : 0;
+}
+
+static int sim_gpio_init(const struct device *port)
+{
+	struct sim_gpio_data *data = port->data;
+
+	sys_slist_init(&data->callbacks);
+
+	return 0;
+}
+
+static const struct gpio_driver_api sim_gpio_api = {
+	.pin_configure = sim_gpio_pin_configure,
+	.port_get_raw = sim_gpio_port_get_raw,
+	.port_set_masked_raw = sim_gpio_port_set_masked_raw,
+	.port_set_bits_raw = sim_gpio_port_set_bits_raw,
+	.port_clear_bits_raw = sim_gpio_port_clear_bits_raw,
+	.port_toggle_bits = sim_gpio_port_toggle_bits,
+	.pin_interrupt_configure = sim_gpio_pin_interrupt_configure,
+	.manage_callback = sim_gpio_manage_callback,
+	.get_pending_int = sim_gpio_get_pending_int,
+};
+
+#define SIM_GPIO_PORT(n)						\
+	static const struct sim_gpio_cfg sim_gpio_cfg_##n = {		\
+		.common = {						\
+			.port_pin_mask = 0xFFFFFFFF,			\
+		},							\
+	};								\
+	static struct sim_gpio_data sim_gpio_data_##n;			\
+	DEVICE_AND_API_INIT(sim_gpio_##n, "GPIO_" #n, sim_gpio_init,	\
+			    &sim_gpio_data_##n, &sim_gpio_cfg_##n,	\
+			    POST_KERNEL,				\
+			    CONFIG_KERNEL_INIT_PRIORITY_DEVICE,		\
+			    &sim_gpio_api)
+
+SIM_GPIO_PORT(0);
+SIM_GPIO_PORT(1);
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* I2C bus emulator. Transfers are routed to attached slave models and
+ * charged in simulated time for the bits on the wire, so dispatcher
+ * latency includes bus time as on target.
+ */
+
+#include <device.h>
+#include <drivers/i2c.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+/* Start/address byte plus data bytes, 9 clocks each with ACK */
+#define I2C_BITS_PER_BYTE       9
+#define I2C_MAX_WRITE           40
+
+struct sim_i2c_bus {
+	uint32_t bitrate;
+};
+
+static struct sim_i2c_slave *slaves;
+static uint32_t bus_us;
+
+void sim_i2c_attach(struct sim_i2c_slave *slave)
+{
+	slave->next = slaves;
+	slaves = slave;
+}
+
+struct sim_i2c_slave *sim_i2c_find(uint16_t addr)
+{
+	for (struct sim_i2c_slave *s = slaves; s; s = s->next) {
+		if (s->addr == addr) {
+			return s;
+		}
+	}
+
+	return NULL;
+}
+
+int sim_i2c_nak_reg(struct sim_i2c_slave *slave, uint16_t reg, bool nak)
+{
+	for (int i = 0; i < slave->num_nak_regs; i++) {
+		if (slave->nak_regs[i] != reg) {
+			continue;
+		}
+		if (!nak) {
+			slave->nak_regs[i] =
+				slave->nak_regs[--slave->num_nak_regs];
+		}
+		return 0;
+	}
+
+	if (!nak) {
+		return 0;
+	}
+
+	if (slave->num_nak_regs == SIM_I2C_NAK_REGS) {
+		return -ENOMEM;
+	}
+
+	slave->nak_regs[slave->num_nak_regs++] = reg;
+
+	return 0;
+}
+
+/* Register address leading first write of a transfer, -1 if none. */
+static int32_t transfer_reg(struct sim_i2c_slave *slave,
+			    const struct i2c_msg *msg)
+{
+	if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ ||
+	    msg->len < (slave->reg16 ? 2 : 1)) {
+		return -1;
+	}
+
+	return slave->reg16 ? msg->buf[0] | (msg->buf[1] << 8) : msg->buf[0];
+}
+
+static bool slave_naks(struct sim_i2c_slave *slave, int32_t reg)
+{
+	for (int i = 0; reg >= 0 && i < slave->num_nak_regs; i++) {
+		if (slave->nak_regs[i] == reg) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static struct sim_i2c_slave *bus_slave(const struct device *dev,
+				       uint16_t addr)
+{
+	for (struct sim_i2c_slave *s = slaves; s; s = s->next) {
+		if (s->addr == addr && !strcmp(s->bus, dev->name)) {
+			return s;
+		}
+	}
+
+	return NULL;
+}
+
+static int sim_i2c_configure(const struct device *dev, uint32_t cfg)
+{
+	struct sim_i2c_bus *bus = dev->data;
+
+	bus->bitrate = I2C_SPEED_GET(cfg) == I2C_SPEED_STANDARD ?
+		       I2C_BITRATE_STANDARD : I2C_BITRATE_FAST;
+
+	return 0;
+}
+
+static int sim_i2c_transfer(const struct device *dev, struct i2c_msg *msgs,
+			    uint8_t num_msgs, uint16_t addr)
+{
+	struct sim_i2c_bus *bus = dev->data;
+	struct sim_i2c_slave *slave = bus_slave(dev, addr);
+	uint8_t wbuf[I2C_MAX_WRITE];
+	uint32_t wlen = 0, bytes = 0, us, reg_len;
+	int32_t reg;
+	bool read = false;
+	int ret = 0;
+
+	for (int i = 0; i < num_msgs; i++) {
+		/* Address byte on start and on every restart */
+		if (!i || (msgs[i].flags & I2C_MSG_RESTART)) {
+			bytes++;
+		}
+		bytes += msgs[i].len;
+	}
+
+	us = bytes * I2C_BITS_PER_BYTE * USEC_PER_SEC / bus->bitrate;
+	bus_us += us;
+	k_busy_wait(us);
+
+	if (!slave || slave->nak) {
+		return -EIO;
+	}
+
+	reg = num_msgs ? transfer_reg(slave, &msgs[0]) : -1;
+	if (slave_naks(slave, reg)) {
+		return -EIO;
+	}
+	reg_len = slave->reg16 ? 2 : 1;
+
+	slave->xfers++;
+
+	/* Leading writes carry register address and data, a read returns
+	 * contents of that register.
+	 */
+	for (int i = 0; i < num_msgs && !ret; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+			read = true;
+			ret = slave->read(slave, reg < 0 ? 0 : reg, msg->buf,
+					  msg->len);
+			continue;
+		}
+
+		if (wlen + msg->len > sizeof(wbuf)) {
+			return -EIO;
+		}
+		memcpy(wbuf + wlen, msg->buf, msg->len);
+		wlen += msg->len;
+	}
+
+	if (!read && wlen >= reg_len && !ret) {
+		ret = slave->write(slave, reg, wbuf + reg_len, wlen - reg_len);
+	}
+
+	return ret;
+}
+
+int sim_i2c_metric(const char *name, int32_t *value)
+{
+	struct sim_i2c_slave *slave;
+	char *end;
+	long addr;
+
+	/* slave.<addr>.xfers */
+	if (strncmp(name, "slave.", 6)) {
+		return -ENOENT;
+	}
+
+	addr = strtol(name + 6, &end, 0);
+	slave = sim_i2c_find(addr);
+	if (!slave || strcmp(end, ".xfers")) {
+		return -ENOENT;
+	}
+
+	*value = slave->xfers;
+	return 0;
+}
+
+void sim_i2c_reset(void)
+{
+	for (struct sim_i2c_slave *s = slaves; s; s = s->next) {
+		s->xfers = 0;
+	}
+}
+
+void sim_i2c_report(void)
+{
+	printk("i2c: bus time %u us, transfers since reset:\n", bus_us);
+	for (struct sim_i2c_slave *s = slaves; s; s = s->next) {
+		printk("  %s 0x%02x: %u xfers%s\n", s->bus, s->addr, s->xfers,
+		       s->nak ? " (nak)" : "");
+	}
+}
+
+static int sim_i2c_init(const struct device *dev)
+{
+	struct sim_i2c_bus *bus = dev->data;
+
+	bus->bitrate = I2C_BITRATE_STANDARD;
+
+	return 0;
+}
+
+static const struct i2c_driver_api sim_i2c_api = {
+	.configure = sim_i2c_configure,
+	.transfer = sim_i2c_transfer,
+};
+
+static struct sim_i2c_bus sim_i2c_bus_0;
+
+DEVICE_AND_API_INIT(sim_i2c_0, CONFIG_ECLITE_I2C_SLAVE_NAME, sim_i2c_init,
+		    &sim_i2c_bus_0, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_i2c_api);
+
+/* UCSI bus, carries PD controller model of emul_ccg.c */
+static struct sim_i2c_bus sim_i2c_bus_1;
+
+DEVICE_AND_API_INIT(sim_i2c_1, CONFIG_ECLITE_UCSI_I2C_SLAVE_NAME,
+		    sim_i2c_init, &sim_i2c_bus_1, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_i2c_api);
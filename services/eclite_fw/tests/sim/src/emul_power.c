@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* BQ40Z40 fuel gauge and BQ24610 charger model. Charge is integrated from
+ * battery current every step: charging with AC present and charge enable
+ * high, discharging at the scenario load without AC. BTP line rises when
+ * remaining capacity crosses a trip point in direction of current and
+ * drops when trip points are written.
+ */
+
+#include <init.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define BQ40Z40_ADDR            0x0B
+#define BQ40Z40_REGS            256
+
+#define SBS_MFG_ACCESS          0x00
+#define SBS_VOLTAGE             0x09
+#define SBS_CURRENT             0x0A
+#define SBS_RSOC                0x0D
+#define SBS_ASOC                0x0E
+#define SBS_REMAINING           0x0F
+#define SBS_FCC                 0x10
+#define SBS_CHARGE_VOLTAGE      0x14
+#define SBS_CHARGE_CURRENT      0x15
+#define SBS_STATUS              0x16
+#define SBS_CYCLE_COUNT         0x17
+#define SBS_DESIGN_CAPACITY     0x18
+#define SBS_DESIGN_VOLTAGE      0x19
+#define SBS_BTP_DISCHARGE       0x4A
+#define SBS_BTP_CHARGE          0x4B
+#define SBS_MFG_BLOCK           0x44
+
+#define MFG_IO_CONFIG           0x47CC
+#define MFG_HEADER_LEN          3
+
+#define STATUS_INIT             0x80
+#define STATUS_DSG              0x40
+#define STATUS_FC               0x20
+
+/* 2S pack */
+#define BAT_DESIGN_MAH          3000
+#define BAT_FCC_MAH             2800
+#define BAT_DESIGN_MV           7600
+#define BAT_EMPTY_MV            6600
+#define BAT_FULL_MV             8400
+#define BAT_CHARGE_MA           1500
+#define BAT_CYCLES              42
+#define BAT_INITIAL_PCT         60
+
+#define MA_MS_PER_MAH           3600000LL
+
+static struct {
+	struct sim_i2c_slave slave;
+	/* remaining charge in mA * ms */
+	int64_t charge;
+	int32_t load_ma;
+	uint16_t btp_discharge;
+	uint16_t btp_charge;
+	uint16_t mfg_cmd;
+	uint8_t io_config;
+	bool present;
+	bool ac;
+	bool btp;
+	uint32_t reads[BQ40Z40_REGS];
+} bat;
+
+static uint16_t bat_remaining(void)
+{
+	return bat.charge / MA_MS_PER_MAH;
+}
+
+static uint16_t bat_rsoc(void)
+{
+	return bat_remaining() * 100 / BAT_FCC_MAH;
+}
+
+static bool bat_charging(void)
+{
+	return bat.ac && bat_rsoc() < 100 &&
+	       sim_gpio_output(CONFIG_ECLITE_CHG_CTRL_GPIO_NAME,
+			       CONFIG_ECLITE_CHG_CTRL_GPIO_PIN);
+}
+
+static int32_t bat_current(void)
+{
+	if (!bat.present) {
+		return 0;
+	}
+
+	if (bat_charging()) {
+		return BAT_CHARGE_MA;
+	}
+
+	/* With AC present system runs from adapter */
+	return bat.ac ? 0 : -bat.load_ma;
+}
+
+static uint16_t bat_register(uint8_t reg)
+{
+	switch (reg) {
+	case SBS_VOLTAGE:
+		return BAT_EMPTY_MV +
+		       (BAT_FULL_MV - BAT_EMPTY_MV) * bat_rsoc() / 100;
+	case SBS_CURRENT:
+		return (uint16_t)(int16_t)bat_current();
+	case SBS_RSOC:
+		return bat_rsoc();
+	case SBS_ASOC:
+		return bat_remaining() * 100 / BAT_DESIGN_MAH;
+	case SBS_REMAINING:
+		return bat_remaining();
+	case SBS_FCC:
+		return BAT_FCC_MAH;
+	case SBS_CHARGE_VOLTAGE:
+		return BAT_FULL_MV;
+	case SBS_CHARGE_CURRENT:
+		return BAT_CHARGE_MA;
+	case SBS_STATUS:
+		return STATUS_INIT |
+		       (bat_current() < 0 ? STATUS_DSG : 0) |
+		       (bat_rsoc() >= 100 ? STATUS_FC : 0);
+	case SBS_CYCLE_COUNT:
+		return BAT_CYCLES;
+	case SBS_DESIGN_CAPACITY:
+		return BAT_DESIGN_MAH;
+	case SBS_DESIGN_VOLTAGE:
+		return BAT_DESIGN_MV;
+	case SBS_BTP_DISCHARGE:
+		return bat.btp_discharge;
+	case SBS_BTP_CHARGE:
+		return bat.btp_charge;
+	default:
+		return 0;
+	}
+}
+
+static void bat_btp_line(bool level)
+{
+	if (bat.btp == level) {
+		return;
+	}
+
+	bat.btp = level;
+	sim_gpio_drive(CONFIG_ECLITE_BATTERY_BTP_GPIO_NAME,
+		       CONFIG_ECLITE_BATTERY_BTP_GPIO_PIN, level);
+}
+
+static int bq40z40_read(struct sim_i2c_slave *slave, uint16_t reg,
+			uint8_t *buf, uint32_t len)
+{
+	ARG_UNUSED(slave);
+
+	bat.reads[reg]++;
+	memset(buf, 0, len);
+
+	if (reg == SBS_MFG_BLOCK) {
+		/* Length, command and data. Operation status reads 0,
+		 * security mode unsealed.
+		 */
+		if (len > 0) {
+			buf[0] = len - 1;
+		}
+		if (len > 2) {
+			buf[1] = bat.mfg_cmd & 0xFF;
+			buf[2] = bat.mfg_cmd >> 8;
+		}
+		if (len > MFG_HEADER_LEN && bat.mfg_cmd == MFG_IO_CONFIG) {
+			buf[MFG_HEADER_LEN] = bat.io_config;
+		}
+		return 0;
+	}
+
+	if (len >= 2) {
+		uint16_t value = bat_register(reg);
+
+		buf[0] = value & 0xFF;
+		buf[1] = value >> 8;
+	}
+
+	return 0;
+}
+
+static int bq40z40_write(struct sim_i2c_slave *slave, uint16_t reg,
+			 const uint8_t *buf, uint32_t len)
+{
+	ARG_UNUSED(slave);
+
+	if (reg == SBS_MFG_BLOCK) {
+		if (len < MFG_HEADER_LEN) {
+			return -EIO;
+		}
+		bat.mfg_cmd = buf[1] | (buf[2] << 8);
+		if (len > MFG_HEADER_LEN && bat.mfg_cmd == MFG_IO_CONFIG) {
+			bat.io_config = buf[MFG_HEADER_LEN];
+		}
+		return 0;
+	}
+
+	if (len < 2) {
+		return -EIO;
+	}
+
+	switch (reg) {
+	case SBS_MFG_ACCESS:
+		break;
+	case SBS_BTP_DISCHARGE:
+		bat.btp_discharge = buf[0] | (buf[1] << 8);
+		bat_btp_line(false);
+		break;
+	case SBS_BTP_CHARGE:
+		bat.btp_charge = buf[0] | (buf[1] << 8);
+		bat_btp_line(false);
+		break;
+	default:
+		return -EIO;
+	}
+
+	return 0;
+}
+
+void sim_power_ac(bool present)
+{
+	bat.ac = present;
+	sim_gpio_drive(CONFIG_ECLITE_CHG_GPIO_NAME, CONFIG_ECLITE_CHG_GPIO_PIN,
+		       present);
+}
+
+void sim_power_load(int32_t ma)
+{
+	bat.load_ma = ma;
+}
+
+void sim_power_capacity(uint32_t percent)
+{
+	bat.charge = MIN(percent, 100) * BAT_FCC_MAH * MA_MS_PER_MAH / 100;
+}
+
+void sim_power_battery(bool present)
+{
+	bat.present = present;
+	bat.slave.nak = !present;
+	if (!present) {
+		bat_btp_line(false);
+	}
+}
+
+void sim_power_step(uint32_t dt_ms)
+{
+	int32_t current = bat_current();
+	uint16_t remaining;
+
+	bat.charge += (int64_t)current * dt_ms;
+	bat.charge = MAX(bat.charge, 0);
+	bat.charge = MIN(bat.charge, BAT_FCC_MAH * MA_MS_PER_MAH);
+
+	if (!bat.present) {
+		return;
+	}
+
+	remaining = bat_remaining();
+	if ((current < 0 && remaining <= bat.btp_discharge) ||
+	    (current > 0 && remaining >= bat.btp_charge)) {
+		bat_btp_line(true);
+	}
+}
+
+int sim_power_metric(const char *name, int32_t *value)
+{
+	if (!strcmp(name, "battery.rsoc")) {
+		*value = bat_rsoc();
+	} else if (!strcmp(name, "battery.current")) {
+		*value = bat_current();
+	} else if (!strcmp(name, "battery.btp")) {
+		*value = bat.btp;
+	} else if (!strcmp(name, "chg.ce")) {
+		*value = sim_gpio_output(CONFIG_ECLITE_CHG_CTRL_GPIO_NAME,
+					 CONFIG_ECLITE_CHG_CTRL_GPIO_PIN);
+	} else if (!strncmp(name, "sbs.", 4)) {
+		/* sbs.<reg> reads of SBS register since reset */
+		*value = bat.reads[strtol(name + 4, NULL, 0) & 0xFF];
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_power_reset(void)
+{
+	memset(bat.reads, 0, sizeof(bat.reads));
+}
+
+static int sim_power_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	bat.slave.bus = CONFIG_ECLITE_I2C_SLAVE_NAME;
+	bat.slave.addr = BQ40Z40_ADDR;
+	bat.slave.read = bq40z40_read;
+	bat.slave.write = bq40z40_write;
+	bat.btp_charge = UINT16_MAX;
+	bat.io_config = 0x01;
+	sim_i2c_attach(&bat.slave);
+
+	sim_power_capacity(BAT_INITIAL_PCT);
+	sim_power_battery(true);
+	sim_power_ac(true);
+
+	return 0;
+}
+
+SYS_INIT(sim_power_init, POST_KERNEL, 60);
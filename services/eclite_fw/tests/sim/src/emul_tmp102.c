@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* TMP102 temperature sensor model in interrupt mode with active low
+ * ALERT. All sensors share one wired-OR alert line. An alert latches when
+ * temperature crosses T_HIGH or T_LOW and clears on any register read,
+ * a side re-arms once temperature is back inside the window.
+ */
+
+#include <init.h>
+#include <string.h>
+#include "sim.h"
+
+#define TMP102_NUM              4
+#define TMP102_REG_TEMP         0
+#define TMP102_REG_CONFIG       1
+#define TMP102_REG_T_LOW        2
+#define TMP102_REG_T_HIGH       3
+
+/* Power on defaults */
+#define TMP102_CONFIG_BYTE0     0x60
+#define TMP102_CONFIG_BYTE1     0xA0
+#define TMP102_T_LOW_DEFAULT    75
+#define TMP102_T_HIGH_DEFAULT   80
+#define TMP102_TEMP_DEFAULT     35
+
+struct sim_tmp102 {
+	struct sim_i2c_slave slave;
+	int8_t temp;
+	int8_t t_low;
+	int8_t t_high;
+	uint8_t config[2];
+	bool alert;
+	bool high_tripped;
+	bool low_tripped;
+};
+
+static struct sim_tmp102 sensors[TMP102_NUM];
+
+static void tmp102_update_line(void)
+{
+	bool asserted = false;
+
+	for (int i = 0; i < TMP102_NUM; i++) {
+		asserted |= sensors[i].alert;
+	}
+
+	sim_gpio_drive(CONFIG_ECLITE_THERMAL_SENSOR_GPIO_NAME,
+		       CONFIG_ECLITE_THERMAL_SENSOR_GPIO_PIN, !asserted);
+}
+
+static void tmp102_evaluate(struct sim_tmp102 *s)
+{
+	if (s->temp >= s->t_high) {
+		if (!s->high_tripped) {
+			s->high_tripped = true;
+			s->alert = true;
+		}
+	} else {
+		s->high_tripped = false;
+	}
+
+	if (s->temp <= s->t_low) {
+		if (!s->low_tripped) {
+			s->low_tripped = true;
+			s->alert = true;
+		}
+	} else {
+		s->low_tripped = false;
+	}
+
+	tmp102_update_line();
+}
+
+static int tmp102_read(struct sim_i2c_slave *slave, uint16_t reg,
+		       uint8_t *buf, uint32_t len)
+{
+	struct sim_tmp102 *s = CONTAINER_OF(slave, struct sim_tmp102, slave);
+	uint8_t regval[2] = { 0 };
+
+	switch (reg) {
+	case TMP102_REG_TEMP:
+		regval[0] = s->temp;
+		break;
+	case TMP102_REG_CONFIG:
+		regval[0] = s->config[0];
+		regval[1] = s->config[1];
+		break;
+	case TMP102_REG_T_LOW:
+		regval[0] = s->t_low;
+		break;
+	case TMP102_REG_T_HIGH:
+		regval[0] = s->t_high;
+		break;
+	default:
+		return -EIO;
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		buf[i] = i < sizeof(regval) ? regval[i] : 0;
+	}
+
+	/* Interrupt mode, reading any register clears alert */
+	if (s->alert) {
+		s->alert = false;
+		tmp102_update_line();
+	}
+
+	return 0;
+}
+
+static int tmp102_write(struct sim_i2c_slave *slave, uint16_t reg,
+			const uint8_t *buf, uint32_t len)
+{
+	struct sim_tmp102 *s = CONTAINER_OF(slave, struct sim_tmp102, slave);
+
+	if (len < 2) {
+		return -EIO;
+	}
+
+	switch (reg) {
+	case TMP102_REG_CONFIG:
+		s->config[0] = buf[0];
+		s->config[1] = buf[1];
+		break;
+	case TMP102_REG_T_LOW:
+		s->t_low = buf[0];
+		break;
+	case TMP102_REG_T_HIGH:
+		s->t_high = buf[0];
+		break;
+	default:
+		return -EIO;
+	}
+
+	tmp102_evaluate(s);
+
+	return 0;
+}
+
+void sim_tmp102_set(int sensor, int temp)
+{
+	if (sensor < 0 || sensor >= TMP102_NUM) {
+		return;
+	}
+
+	sensors[sensor].temp = temp;
+	tmp102_evaluate(&sensors[sensor]);
+}
+
+int sim_tmp102_get(int sensor)
+{
+	if (sensor < 0 || sensor >= TMP102_NUM) {
+		return 0;
+	}
+
+	return sensors[sensor].temp;
+}
+
+/* tmp<n>.t_high and tmp<n>.t_low read programmed alert limits */
+int sim_tmp102_metric(const char *name, int32_t *value)
+{
+	int sensor;
+
+	if (strncmp(name, "tmp", 3) || name[3] < '0' ||
+	    name[3] >= '0' + TMP102_NUM || name[4] != '.') {
+		return -ENOENT;
+	}
+
+	sensor = name[3] - '0';
+	if (!strcmp(name + 5, "t_high")) {
+		*value = sensors[sensor].t_high;
+	} else if (!strcmp(name + 5, "t_low")) {
+		*value = sensors[sensor].t_low;
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+static int sim_tmp102_init(const struct device *dev)
+{
+	static const uint16_t addr[TMP102_NUM] = {
+		CONFIG_THERM_SEN_0_I2C_SLAVE_ADDR,
+		CONFIG_THERM_SEN_1_I2C_SLAVE_ADDR,
+		CONFIG_THERM_SEN_2_I2C_SLAVE_ADDR,
+		CONFIG_THERM_SEN_3_I2C_SLAVE_ADDR,
+	};
+
+	ARG_UNUSED(dev);
+
+	for (int i = 0; i < TMP102_NUM; i++) {
+		struct sim_tmp102 *s = &sensors[i];
+
+		s->slave.bus = CONFIG_ECLITE_I2C_SLAVE_NAME;
+		s->slave.addr = addr[i];
+		s->slave.read = tmp102_read;
+		s->slave.write = tmp102_write;
+		s->temp = TMP102_TEMP_DEFAULT;
+		s->t_low = TMP102_T_LOW_DEFAULT;
+		s->t_high = TMP102_T_HIGH_DEFAULT;
+		s->config[0] = TMP102_CONFIG_BYTE0;
+		s->config[1] = TMP102_CONFIG_BYTE1;
+		sim_i2c_attach(&s->slave);
+	}
+
+	/* Alert line idles high */
+	tmp102_update_line();
+
+	return 0;
+}
+
+SYS_INIT(sim_tmp102_init, POST_KERNEL, 60);
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* HECI mock acting as the host driver. Requests are handed to the EClite
+ * client as the HECI driver would, host waits for flow control before
+ * next request. Replies update a host side copy of the opregion, events
+ * are counted and marked for ordering checks. On a UCSI event host takes
+ * CCI and MSG IN from the opregion right away, as OS UCSI driver would
+ * before sending anything else.
+ */
+
+#include <heci.h>
+#include <stdlib.h>
+#include <string.h>
+#include "eclite_hostcomm.h"
+#include "sim.h"
+
+#define HOST_CONN_ID            1
+#define HOST_EVENTS             256
+#define HOST_FC_TIMEOUT_MS      1000
+#define HOST_DELTA_SINCE_LEN    sizeof(uint32_t)
+
+static struct {
+	heci_client_t client;
+	bool registered;
+	bool connected;
+	bool disconnected;
+	uint32_t fc;
+	uint32_t replies;
+	uint32_t events[HOST_EVENTS];
+	uint32_t delta_gen;
+	uint32_t delta_chunks;
+	uint32_t delta_bytes;
+	uint32_t ucsi_cci;
+	uint32_t ucsi_complete;
+	uint32_t ucsi_error;
+	uint32_t ucsi_ack;
+	uint32_t ucsi_reset;
+	struct message_buffer req;
+	uint8_t opregion[MAX_OPR_LENGTH];
+} host;
+
+int heci_register(heci_client_t *client)
+{
+	/* Client description lives on caller stack */
+	host.client = *client;
+	host.registered = true;
+
+	return 0;
+}
+
+static void host_delta_reply(const struct eclite_delta_buffer *buf,
+			     uint32_t len)
+{
+	const struct message_header_type *hdr = &buf->message_header;
+	uint16_t end = hdr->offset + hdr->length;
+	uint32_t pos = 0;
+
+	host.delta_gen = buf->generation;
+	host.delta_chunks = 0;
+	host.delta_bytes = len - offsetof(struct eclite_delta_buffer, data);
+
+	for (int i = hdr->offset / ECLITE_OPR_GEN_CHUNK;
+	     i * ECLITE_OPR_GEN_CHUNK < end; i++) {
+		uint16_t from = MAX(i * ECLITE_OPR_GEN_CHUNK, hdr->offset);
+		uint16_t to = MIN((i + 1) * ECLITE_OPR_GEN_CHUNK, end);
+
+		if (!(buf->chunk_map & BIT(i))) {
+			continue;
+		}
+
+		host.delta_chunks++;
+		if (pos + (to - from) <= host.delta_bytes) {
+			memcpy(host.opregion + from, buf->data + pos,
+			       to - from);
+		}
+		pos += to - from;
+	}
+}
+
+static void host_ucsi_event(void)
+{
+	const struct ucsi_info_in *ucsi = &eclite_opregion.ucsi_in_data;
+
+	memcpy(&host.ucsi_cci, &ucsi->cci_info, sizeof(host.ucsi_cci));
+
+	if (ucsi->cci_info.error) {
+		host.ucsi_error++;
+		sim_mark("ucsi.error");
+	} else if (ucsi->cci_info.cmdcompleted) {
+		host.ucsi_complete++;
+		sim_mark("ucsi.done.%u", ucsi->msg_in_info.msg[0]);
+	}
+
+	if (ucsi->cci_info.ackcmdcomp) {
+		host.ucsi_ack++;
+		sim_mark("ucsi.ack");
+	}
+
+	if (ucsi->cci_info.resetcompleted) {
+		host.ucsi_reset++;
+	}
+}
+
+bool heci_send(uint32_t conn_id, mrd_t *msg)
+{
+	const struct message_header_type *hdr;
+
+	if (!host.connected || conn_id != HOST_CONN_ID ||
+	    msg->len < sizeof(*hdr)) {
+		return false;
+	}
+
+	hdr = msg->buf;
+	if (hdr->data_type == ECLITE_HEADER_TYPE_EVENT) {
+		host.events[hdr->event]++;
+		sim_mark("host.event.%u", hdr->event);
+		if (hdr->event == ECLITE_EVENT_UCSI_UPDATE) {
+			host_ucsi_event();
+		}
+		return true;
+	}
+
+	host.replies++;
+	if (hdr->read_write == ECLITE_HEADER_OPR_READ_DELTA) {
+		host_delta_reply(msg->buf, msg->len);
+	} else if (hdr->read_write == ECLITE_HEADER_OPR_READ) {
+		const struct message_buffer *buf = msg->buf;
+
+		memcpy(host.opregion + hdr->offset, buf->data,
+		       MIN(hdr->length, msg->len - sizeof(*hdr)));
+	}
+
+	return true;
+}
+
+bool heci_send_flow_control(uint32_t conn_id)
+{
+	if (conn_id != HOST_CONN_ID) {
+		return false;
+	}
+
+	host.fc++;
+
+	return true;
+}
+
+int heci_complete_disconnect(uint32_t conn_id)
+{
+	if (conn_id != HOST_CONN_ID) {
+		return -EINVAL;
+	}
+
+	host.connected = false;
+	host.disconnected = true;
+
+	return 0;
+}
+
+/* Hand request in host.req to client and wait until it is consumed. */
+static int host_request(uint8_t type, uint16_t len)
+{
+	heci_rx_msg_t *rx = host.client.rx_msg;
+	uint32_t fc = host.fc;
+
+	if (!host.registered) {
+		return -ENODEV;
+	}
+
+	memcpy(rx->buffer, &host.req, len);
+	rx->type = type;
+	rx->connection_id = HOST_CONN_ID;
+	rx->length = len;
+	rx->msg_lock = MSG_LOCKED;
+	host.client.event_cb(HECI_EVENT_NEW_MSG, host.client.param);
+
+	for (int ms = 0; host.fc == fc; ms++) {
+		if (ms >= HOST_FC_TIMEOUT_MS) {
+			return -ETIMEDOUT;
+		}
+		k_sleep(K_MSEC(1));
+	}
+
+	return 0;
+}
+
+static struct message_header_type *host_header(uint8_t data_type,
+					       uint8_t read_write,
+					       uint16_t offset,
+					       uint16_t length)
+{
+	struct message_header_type *hdr = &host.req.message_header;
+
+	memset(&host.req, 0, sizeof(host.req));
+	hdr->revision = ECLITE_OPR_REVISION;
+	hdr->data_type = data_type;
+	hdr->read_write = read_write;
+	hdr->offset = offset;
+	hdr->length = length;
+
+	return hdr;
+}
+
+int sim_host_connect(void)
+{
+	host.connected = true;
+	host.disconnected = false;
+	host_header(0, 0, 0, 0);
+
+	return host_request(HECI_CONNECT, sizeof(struct message_header_type));
+}
+
+int sim_host_disconnect(void)
+{
+	if (!host.registered) {
+		return -ENODEV;
+	}
+
+	host.client.event_cb(HECI_EVENT_DISCONN, host.client.param);
+	for (int ms = 0; !host.disconnected; ms++) {
+		if (ms >= HOST_FC_TIMEOUT_MS) {
+			return -ETIMEDOUT;
+		}
+		k_sleep(K_MSEC(1));
+	}
+
+	return 0;
+}
+
+int sim_host_read(uint16_t offset, uint16_t length)
+{
+	host_header(ECLITE_HEADER_TYPE_DATA, ECLITE_HEADER_OPR_READ, offset,
+		    length);
+
+	return host_request(HECI_REQUEST, sizeof(struct message_header_type));
+}
+
+int sim_host_write(uint16_t offset, uint16_t length, uint32_t value,
+		   uint8_t event)
+{
+	struct message_header_type *hdr;
+
+	hdr = host_header(ECLITE_HEADER_TYPE_DATA, ECLITE_HEADER_OPR_WRITE,
+			  offset, length);
+	hdr->event = event;
+	for (int i = 0; i < length && i < sizeof(value); i++) {
+		host.req.data[i] = value >> (8 * i);
+	}
+
+	return host_request(HECI_REQUEST,
+			    sizeof(struct message_header_type) + length);
+}
+
+int sim_host_event(uint8_t event)
+{
+	struct message_header_type *hdr;
+
+	hdr = host_header(ECLITE_HEADER_TYPE_EVENT, 0, 0, 0);
+	hdr->event = event;
+
+	return host_request(HECI_REQUEST, sizeof(struct message_header_type));
+}
+
+int sim_host_ucsi(uint8_t command, uint8_t param)
+{
+	struct message_header_type *hdr;
+	struct control_t control = {
+		.command = command,
+		.cmdspecific = { param },
+	};
+
+	hdr = host_header(ECLITE_HEADER_TYPE_DATA, ECLITE_HEADER_OPR_WRITE,
+			  offsetof(struct eclite_opregion_t,
+				   ucsi_in_data.control_info),
+			  sizeof(control));
+	hdr->event = ECLITE_OS_EVENT_UCSI_UPDATE;
+	memcpy(host.req.data, &control, sizeof(control));
+
+	return host_request(HECI_REQUEST,
+			    sizeof(struct message_header_type) +
+			    sizeof(control));
+}
+
+int sim_host_delta(bool since_prev, bool truncated)
+{
+	uint32_t since = since_prev ? host.delta_gen : 0;
+
+	host_header(ECLITE_HEADER_TYPE_DATA, ECLITE_HEADER_OPR_READ_DELTA, 0,
+		    MAX_OPR_LENGTH);
+	memcpy(host.req.data, &since, sizeof(since));
+
+	/* Truncated request leaves out half of generation */
+	return host_request(HECI_REQUEST,
+			    offsetof(struct message_buffer, data) +
+			    (truncated ? HOST_DELTA_SINCE_LEN / 2 :
+			     HOST_DELTA_SINCE_LEN));
+}
+
+int sim_host_opregion(uint16_t offset, uint16_t length, int32_t *value)
+{
+	uint32_t v = 0;
+
+	if (offset + length > MAX_OPR_LENGTH || length > sizeof(v)) {
+		return -EINVAL;
+	}
+
+	for (int i = length - 1; i >= 0; i--) {
+		v = (v << 8) | host.opregion[offset + i];
+	}
+	*value = v;
+
+	return 0;
+}
+
+int sim_host_metric(const char *name, int32_t *value)
+{
+	char *end;
+	long event;
+
+	if (!strcmp(name, "host.replies")) {
+		*value = host.replies;
+	} else if (!strcmp(name, "host.fc")) {
+		*value = host.fc;
+	} else if (!strcmp(name, "host.connected")) {
+		*value = host.connected;
+	} else if (!strcmp(name, "host.delta.chunks")) {
+		*value = host.delta_chunks;
+	} else if (!strcmp(name, "host.delta.bytes")) {
+		*value = host.delta_bytes;
+	} else if (!strcmp(name, "host.ucsi.cci")) {
+		*value = host.ucsi_cci;
+	} else if (!strcmp(name, "host.ucsi.complete")) {
+		*value = host.ucsi_complete;
+	} else if (!strcmp(name, "host.ucsi.error")) {
+		*value = host.ucsi_error;
+	} else if (!strcmp(name, "host.ucsi.ack")) {
+		*value = host.ucsi_ack;
+	} else if (!strcmp(name, "host.ucsi.reset")) {
+		*value = host.ucsi_reset;
+	} else if (!strncmp(name, "host.event.", 11)) {
+		event = strtol(name + 11, &end, 0);
+		if (*end || event < 0 || event >= HOST_EVENTS) {
+			return -ENOENT;
+		}
+		*value = host.events[event];
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_host_reset(void)
+{
+	host.fc = 0;
+	host.replies = 0;
+	host.ucsi_complete = 0;
+	host.ucsi_error = 0;
+	host.ucsi_ack = 0;
+	host.ucsi_reset = 0;
+	memset(host.events, 0, sizeof(host.events));
+}
+
+void sim_host_report(void)
+{
+	uint32_t sent = 0;
+
+	for (int i = 0; i < HOST_EVENTS; i++) {
+		sent += host.events[i];
+	}
+
+	printk("host since reset: replies %u flow control %u events %u\n",
+	       host.replies, host.fc, sent);
+}
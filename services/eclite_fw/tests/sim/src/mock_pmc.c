@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* PMC service mock. Answers PECI GetTemp and RdPkgConfig TjMax from the
+ * CPU model and records power state change requests. Each message takes
+ * the round trip time of the PMC IPC.
+ */
+
+#include <pmc_service.h>
+#include <string.h>
+#include "sim.h"
+
+#define PMC_PECI_GET_TEMP_CMD           0x12
+#define PMC_POWER_STATE_CHANGE_CMD      0x14
+#define PMC_PECI_RD_PKG_CMD             0x15
+
+#define PMC_SHUTDOWN                    BIT(4)
+#define PMC_WAKEUP                      BIT(5)
+
+/* Response byte offsets past cmd and reserved words */
+#define PECI_RES_STATUS                 4
+#define PECI_TEMP_LSB                   5
+#define PECI_TEMP_MSB                   6
+#define PECI_PKG_COMPLETION             5
+#define PECI_PKG_DATA                   6
+#define PECI_COMPLETION_OK              0x40
+#define PECI_RAW_TO_INT                 6
+
+#define PMC_GET_TEMP_US                 150
+#define PMC_RD_PKG_US                   300
+#define PMC_SHORT_MSG_US                50
+
+#define CPU_TEMP_DEFAULT                45
+#define CPU_TJMAX                       100
+
+static struct {
+	int temp;
+	uint32_t get_temp;
+	uint32_t tjmax;
+	uint32_t shutdown;
+	uint32_t wakeup;
+} pmc = {
+	.temp = CPU_TEMP_DEFAULT,
+};
+
+static int pmc_short_msg(struct pmc_msg_t *msg)
+{
+	k_busy_wait(PMC_SHORT_MSG_US);
+
+	if (msg->u.short_msg.cmd_id != PMC_POWER_STATE_CHANGE_CMD) {
+		return -EINVAL;
+	}
+
+	if (msg->u.short_msg.payload & PMC_SHUTDOWN) {
+		pmc.shutdown++;
+		sim_mark("pmc.shutdown");
+	}
+	if (msg->u.short_msg.payload & PMC_WAKEUP) {
+		pmc.wakeup++;
+		sim_mark("pmc.wakeup");
+	}
+
+	return 0;
+}
+
+int pmc_sync_send_msg(struct pmc_msg_t *usr_msg)
+{
+	uint8_t *buf = usr_msg->u.msg;
+	uint16_t cmd;
+	int16_t raw;
+
+	if (usr_msg->format == FORMAT_SHORT) {
+		return pmc_short_msg(usr_msg);
+	}
+
+	if (usr_msg->format != FORMAT_LONG) {
+		return -EINVAL;
+	}
+
+	cmd = buf[0] | (buf[1] << 8);
+	switch (cmd) {
+	case PMC_PECI_GET_TEMP_CMD:
+		k_busy_wait(PMC_GET_TEMP_US);
+		pmc.get_temp++;
+		/* Temperature below TjMax, integer part from bit 6 */
+		raw = (pmc.temp - CPU_TJMAX) * BIT(PECI_RAW_TO_INT);
+		buf[PECI_RES_STATUS] = 0;
+		buf[PECI_TEMP_LSB] = raw & 0xFF;
+		buf[PECI_TEMP_MSB] = (raw >> 8) & 0xFF;
+		return 0;
+	case PMC_PECI_RD_PKG_CMD:
+		k_busy_wait(PMC_RD_PKG_US);
+		pmc.tjmax++;
+		buf[PECI_RES_STATUS] = 0;
+		buf[PECI_PKG_COMPLETION] = PECI_COMPLETION_OK;
+		memset(&buf[PECI_PKG_DATA], 0, 4);
+		buf[PECI_PKG_DATA + 2] = CPU_TJMAX;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+void sim_cpu_set(int temp)
+{
+	pmc.temp = temp;
+}
+
+int sim_cpu_get(void)
+{
+	return pmc.temp;
+}
+
+int sim_pmc_metric(const char *name, int32_t *value)
+{
+	if (!strcmp(name, "pmc.get_temp")) {
+		*value = pmc.get_temp;
+	} else if (!strcmp(name, "pmc.tjmax")) {
+		*value = pmc.tjmax;
+	} else if (!strcmp(name, "pmc.shutdown")) {
+		*value = pmc.shutdown;
+	} else if (!strcmp(name, "pmc.wakeup")) {
+		*value = pmc.wakeup;
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_pmc_reset(void)
+{
+	pmc.get_temp = 0;
+	pmc.tjmax = 0;
+	pmc.shutdown = 0;
+	pmc.wakeup = 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* SEDI config and power management mock. EClite and DTS are enabled,
+ * host Sx and S0ix transitions are raised by the scenario in the order
+ * PSE power management notifies them.
+ */
+
+#include <sedi.h>
+#include "sim.h"
+
+static struct {
+	sedi_pm_sx_callback_t sx_cb;
+	void *sx_ctx;
+	sedi_pm_s0ix_callback_t s0ix_cb;
+	void *s0ix_ctx;
+	sedi_pm_callback_config_t rstprep;
+	bool rstprep_set;
+	uint32_t reset_type;
+} pm;
+
+int sedi_get_config(sedi_config_t id, void *data)
+{
+	ARG_UNUSED(id);
+	ARG_UNUSED(data);
+
+	return SEDI_CONFIG_SET;
+}
+
+int sedi_pm_configure_wake_source(sedi_pm_wake_event_t type,
+				  sedi_wake_event_instance_t instance,
+				  bool enable)
+{
+	ARG_UNUSED(type);
+	ARG_UNUSED(instance);
+	ARG_UNUSED(enable);
+
+	return SEDI_DRIVER_OK;
+}
+
+int sedi_pm_register_sx_notification(sedi_pm_sx_callback_t cb, void *ctx)
+{
+	pm.sx_cb = cb;
+	pm.sx_ctx = ctx;
+
+	return SEDI_DRIVER_OK;
+}
+
+int sedi_pm_register_s0ix_notification(sedi_pm_s0ix_callback_t cb,
+				       void *ctx)
+{
+	pm.s0ix_cb = cb;
+	pm.s0ix_ctx = ctx;
+
+	return SEDI_DRIVER_OK;
+}
+
+int sedi_pm_register_callback(sedi_pm_callback_config_t *config)
+{
+	if (config->type != CALLBACK_TYPE_RESET_PREP) {
+		return -EINVAL;
+	}
+
+	pm.rstprep = *config;
+	pm.rstprep_set = true;
+
+	return SEDI_DRIVER_OK;
+}
+
+int sedi_pm_get_reset_prep_info(sedi_pm_reset_prep_t *info)
+{
+	info->reset_type = pm.reset_type;
+
+	return SEDI_DRIVER_OK;
+}
+
+void sim_sedi_sx(uint32_t reset_type)
+{
+	pm.reset_type = reset_type;
+
+	if (reset_type == PM_RESET_TYPE_S0) {
+		if (pm.sx_cb) {
+			pm.sx_cb(PM_EVENT_HOST_SX_EXIT, pm.sx_ctx);
+		}
+		return;
+	}
+
+	/* Reset prep is notified ahead of Sx entry */
+	if (pm.rstprep_set) {
+		pm.rstprep.func.rstprep_cb(0, reset_type, pm.rstprep.ctx);
+	}
+	if (pm.sx_cb) {
+		pm.sx_cb(PM_EVENT_HOST_SX_ENTRY, pm.sx_ctx);
+	}
+}
+
+void sim_sedi_s0ix(bool enter)
+{
+	if (pm.s0ix_cb) {
+		pm.s0ix_cb(enter ? PM_EVENT_HOST_S0IX_ENTRY :
+			   PM_EVENT_HOST_S0IX_EXIT, pm.s0ix_ctx);
+	}
+}
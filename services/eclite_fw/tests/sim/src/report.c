@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* End of run report: dispatcher load and latency per event type, queue
+ * pressure, bus and PMC traffic and expectation results. Simulated time
+ * covers modelled bus and IPC time, host cycles cover EClite code.
+ */
+
+#include <zephyr.h>
+#include <init.h>
+#include "eclite_dispatcher.h"
+#include "eclite_hw_interface.h"
+#include "sim.h"
+#ifdef CONFIG_ARCH_POSIX
+#include <posix_board_if.h>
+#endif
+
+static const char * const event_names[NUM_OF_ECLITE_EVENTS] = {
+	"heci", "timer", "gpio", "chg", "fg", "thermal", "ucsi",
+};
+
+static const char * const prio_names[DISPATCHER_PRIO_MAX] = {
+	"critical", "host", "periodic",
+};
+
+static const char * const pmc_metrics[] = {
+	"pmc.get_temp", "pmc.tjmax", "pmc.shutdown", "pmc.wakeup",
+};
+
+static uint64_t start_cycles;
+
+static void report_dispatcher(void)
+{
+	struct dispatcher_stats stats;
+	uint32_t handled = 0;
+
+	eclite_get_dispatcher_stats(&stats);
+
+	printk("dispatcher since boot:\n");
+	printk("  event     handled    busy us   max us   avg us\n");
+	for (int i = 0; i < NUM_OF_ECLITE_EVENTS; i++) {
+		handled += stats.handled[i];
+		if (!stats.handled[i]) {
+			continue;
+		}
+		printk("  %-8s %8u %10u %8u %8u\n", event_names[i],
+		       stats.handled[i], stats.busy_us[i], stats.max_us[i],
+		       stats.busy_us[i] / stats.handled[i]);
+	}
+
+	for (int i = 0; i < DISPATCHER_PRIO_MAX; i++) {
+		printk("  queue %-8s high water %u dropped %u\n",
+		       prio_names[i], stats.high_water[i], stats.dropped[i]);
+	}
+	printk("  coalesced %u\n", stats.coalesced);
+
+	if (handled) {
+		uint32_t kcycles = (sim_host_cycles() - start_cycles) / 1000;
+
+		printk("  host kcycles %u, %u per event\n", kcycles,
+		       kcycles / handled);
+	}
+}
+
+static void report_i2c(void)
+{
+	struct eclite_i2c_stats stats;
+
+	eclite_i2c_get_stats(&stats);
+
+	printk("i2c since boot: xfers %u failures %u skipped %u\n",
+	       stats.xfers, stats.failures, stats.skipped);
+	sim_i2c_report();
+}
+
+static void report_pmc(void)
+{
+	int32_t value;
+
+	printk("pmc since reset:");
+	for (int i = 0; i < ARRAY_SIZE(pmc_metrics); i++) {
+		if (!sim_pmc_metric(pmc_metrics[i], &value)) {
+			printk(" %s %d", pmc_metrics[i] + 4, value);
+		}
+	}
+	printk("\n");
+}
+
+void sim_report(uint32_t passed, uint32_t failed)
+{
+	printk("\nsimulated time %u ms\n", k_uptime_get_32());
+	report_dispatcher();
+	report_i2c();
+	report_pmc();
+	sim_host_report();
+
+	printk("expectations: %u passed, %u failed\n", passed, failed);
+	printk("ECLITE SIM: %s\n", failed ? "FAIL" : "PASS");
+
+#ifdef CONFIG_ARCH_POSIX
+	posix_exit(failed ? 1 : 0);
+#endif
+}
+
+static int report_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	start_cycles = sim_host_cycles();
+
+	return 0;
+}
+
+SYS_INIT(report_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,725 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Scenario runner. Executes the scenario script built into the image one
+ * line at a time after EClite bring-up, advancing device models in
+ * SIM_TICK_MS steps while waiting, and checks expectations against
+ * model, host and EClite counters. See README.rst for the script format.
+ */
+
+#include <zephyr.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sedi.h>
+#include "eclite_dispatcher.h"
+#include "eclite_hostcomm.h"
+#include "eclite_hw_interface.h"
+#include "sim.h"
+
+#define SIM_LINE_LEN            128
+#define SIM_MAX_TOKENS          6
+#define SIM_MAX_MARKS           64
+#define SIM_MARK_LEN            24
+#define SIM_SYNC_TIMEOUT_MS     30000
+#define SIM_RUNNER_STACK        4096
+#define SIM_RUNNER_PRIO         K_PRIO_PREEMPT(5)
+#define SIM_CPU_SENSOR          -1
+
+static const char scenario[] = {
+#include "scenario.inc"
+	0x00
+};
+
+struct sim_field {
+	const char *name;
+	uint16_t offset;
+	uint16_t size;
+};
+
+#define OPR_FIELD(field_name, member)					\
+	{								\
+		.name = field_name,					\
+		.offset = offsetof(struct eclite_opregion_t, member),	\
+		.size = sizeof(((struct eclite_opregion_t *)0)->member),\
+	}
+
+static const struct sim_field fields[] = {
+	OPR_FIELD("battery_state", battery_info.state),
+	OPR_FIELD("remaining_capacity", battery_info.remaining_capacity),
+	OPR_FIELD("battery_voltage", battery_info.battery_voltage),
+	OPR_FIELD("design_capacity", battery_info.design_capacity),
+	OPR_FIELD("full_charge_capacity", battery_info.full_charge_capacity),
+	OPR_FIELD("cycle_count", battery_info.cycle_count),
+	OPR_FIELD("systherm0", systherm0_temp1),
+	OPR_FIELD("systherm1", systherm1_temp1),
+	OPR_FIELD("systherm2", systherm2_temp1),
+	OPR_FIELD("systherm3", systherm3_temp1),
+	OPR_FIELD("cpu_temperature", cpu_temperature),
+	OPR_FIELD("psrc", psrc),
+	OPR_FIELD("pwm_dutycyle", pwm_dutycyle),
+	OPR_FIELD("tacho_rpm", tacho_rpm),
+	OPR_FIELD("event_notify_config", event_notify_config),
+};
+
+static const char * const event_names[NUM_OF_ECLITE_EVENTS] = {
+	[HECI_EVENT] = "heci",
+	[TIMER_EVENT] = "timer",
+	[GPIO_EVENT] = "gpio",
+	[CHG_EVENT] = "chg",
+	[FG_EVENT] = "fg",
+	[THERMAL_EVENT] = "thermal",
+	[UCSI_EVENT] = "ucsi",
+};
+
+/* Named points in time, in order of occurrence since last reset */
+static char marks[SIM_MAX_MARKS][SIM_MARK_LEN];
+static uint32_t num_marks;
+
+static struct dispatcher_stats stats_base;
+static struct eclite_i2c_stats i2c_base;
+static uint32_t passed;
+static uint32_t failed;
+static int line_no;
+
+void sim_mark(const char *fmt, ...)
+{
+	va_list args;
+	unsigned int key = irq_lock();
+
+	if (num_marks < SIM_MAX_MARKS) {
+		va_start(args, fmt);
+		vsnprintf(marks[num_marks], SIM_MARK_LEN, fmt, args);
+		va_end(args);
+		num_marks++;
+	}
+
+	irq_unlock(key);
+}
+
+static int sim_mark_index(const char *name)
+{
+	for (int i = 0; i < num_marks; i++) {
+		if (!strcmp(marks[i], name)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void sim_fail(const char *fmt, ...)
+{
+	va_list args;
+
+	printk("line %d: FAIL ", line_no);
+	va_start(args, fmt);
+	vprintk(fmt, args);
+	va_end(args);
+	printk("\n");
+	failed++;
+}
+
+static bool sim_number(const char *tok, int32_t *value)
+{
+	char *end;
+
+	if (!tok || !*tok) {
+		return false;
+	}
+
+	*value = strtol(tok, &end, 0);
+
+	return *end == '\0';
+}
+
+static int sim_event_id(const char *name)
+{
+	for (int i = 0; i < NUM_OF_ECLITE_EVENTS; i++) {
+		if (!strcmp(event_names[i], name)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static const struct sim_field *sim_field(const char *name)
+{
+	for (int i = 0; i < ARRAY_SIZE(fields); i++) {
+		if (!strcmp(fields[i].name, name)) {
+			return &fields[i];
+		}
+	}
+
+	return NULL;
+}
+
+static uint32_t sim_handled(int event)
+{
+	struct dispatcher_stats stats;
+
+	eclite_get_dispatcher_stats(&stats);
+
+	return stats.handled[event] - stats_base.handled[event];
+}
+
+/* EClite counters since last reset */
+static int sim_eclite_metric(const char *name, int32_t *value)
+{
+	struct dispatcher_stats stats;
+	struct eclite_i2c_stats i2c;
+	const struct sim_field *field;
+	int event;
+
+	eclite_get_dispatcher_stats(&stats);
+	eclite_i2c_get_stats(&i2c);
+
+	if (!strncmp(name, "events.", 7)) {
+		event = sim_event_id(name + 7);
+		if (event < 0) {
+			return -ENOENT;
+		}
+		*value = stats.handled[event] - stats_base.handled[event];
+	} else if (!strcmp(name, "queue.coalesced")) {
+		*value = stats.coalesced - stats_base.coalesced;
+	} else if (!strcmp(name, "queue.dropped")) {
+		*value = 0;
+		for (int i = 0; i < DISPATCHER_PRIO_MAX; i++) {
+			*value += stats.dropped[i] - stats_base.dropped[i];
+		}
+	} else if (!strcmp(name, "i2c.xfers")) {
+		*value = i2c.xfers - i2c_base.xfers;
+	} else if (!strcmp(name, "i2c.failures")) {
+		*value = i2c.failures - i2c_base.failures;
+	} else if (!strcmp(name, "i2c.skipped")) {
+		*value = i2c.skipped - i2c_base.skipped;
+	} else if (!strncmp(name, "eclite.", 7)) {
+		/* EClite side of opregion */
+		field = sim_field(name + 7);
+		if (!field) {
+			return -ENOENT;
+		}
+		*value = 0;
+		memcpy(value, (uint8_t *)&eclite_opregion + field->offset,
+		       field->size);
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+static int sim_metric(const char *name, int32_t *value)
+{
+	const struct sim_field *field;
+
+	if (sim_number(name, value)) {
+		return 0;
+	}
+
+	if (!strncmp(name, "host.", 5)) {
+		/* Host copy of opregion as of last read */
+		field = sim_field(name + 5);
+		if (field) {
+			return sim_host_opregion(field->offset, field->size,
+						 value);
+		}
+		return sim_host_metric(name, value);
+	}
+
+	if (!sim_eclite_metric(name, value) ||
+	    !sim_power_metric(name, value) ||
+	    !sim_fan_metric(name, value) ||
+	    !sim_tmp102_metric(name, value) ||
+	    !sim_ccg_metric(name, value) ||
+	    !sim_pmc_metric(name, value) ||
+	    !sim_i2c_metric(name, value)) {
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+static void sim_step(uint32_t ms)
+{
+	for (uint32_t t = 0; t < ms; t += SIM_TICK_MS) {
+		k_sleep(K_MSEC(SIM_TICK_MS));
+		sim_power_step(SIM_TICK_MS);
+		sim_fan_step(SIM_TICK_MS);
+		sim_ccg_step(SIM_TICK_MS);
+	}
+}
+
+static void sim_reset(void)
+{
+	eclite_get_dispatcher_stats(&stats_base);
+	eclite_i2c_get_stats(&i2c_base);
+	num_marks = 0;
+	sim_i2c_reset();
+	sim_power_reset();
+	sim_fan_reset();
+	sim_ccg_reset();
+	sim_pmc_reset();
+	sim_host_reset();
+}
+
+static void sim_set_temp(int sensor, int temp)
+{
+	if (sensor == SIM_CPU_SENSOR) {
+		sim_cpu_set(temp);
+	} else {
+		sim_tmp102_set(sensor, temp);
+	}
+}
+
+static int sim_get_temp(int sensor)
+{
+	return sensor == SIM_CPU_SENSOR ? sim_cpu_get() :
+	       sim_tmp102_get(sensor);
+}
+
+static bool sim_sensor(const char *tok, int *sensor)
+{
+	int32_t n;
+
+	if (tok && !strcmp(tok, "cpu")) {
+		*sensor = SIM_CPU_SENSOR;
+		return true;
+	}
+
+	if (sim_number(tok, &n) && n >= 0 && n <= 3) {
+		*sensor = n;
+		return true;
+	}
+
+	return false;
+}
+
+static int sim_cmd_wait(char **tok, int n)
+{
+	int32_t ms;
+
+	if (n != 2 || !sim_number(tok[1], &ms) || ms < 0) {
+		return -EINVAL;
+	}
+
+	sim_step(ms);
+
+	return 0;
+}
+
+/* sync <event> [timeout]: wait for next handled event of a type */
+static int sim_cmd_sync(char **tok, int n)
+{
+	int32_t timeout = SIM_SYNC_TIMEOUT_MS;
+	int event = n > 1 ? sim_event_id(tok[1]) : -1;
+	uint32_t base;
+
+	if (event < 0 || n > 3 || (n == 3 && !sim_number(tok[2], &timeout))) {
+		return -EINVAL;
+	}
+
+	base = sim_handled(event);
+	for (int32_t t = 0; sim_handled(event) == base; t += SIM_TICK_MS) {
+		if (t >= timeout) {
+			sim_fail("no %s event within %d ms", tok[1], timeout);
+			return 0;
+		}
+		sim_step(SIM_TICK_MS);
+	}
+
+	return 0;
+}
+
+static int sim_cmd_temp(char **tok, int n)
+{
+	int32_t temp;
+	int sensor;
+
+	if (n != 3 || !sim_sensor(tok[1], &sensor) ||
+	    !sim_number(tok[2], &temp)) {
+		return -EINVAL;
+	}
+
+	sim_set_temp(sensor, temp);
+
+	return 0;
+}
+
+/* ramp <sensor> <to> <ms>: linear change, one step per tick */
+static int sim_cmd_ramp(char **tok, int n)
+{
+	int32_t to, ms, from;
+	int sensor;
+
+	if (n != 4 || !sim_sensor(tok[1], &sensor) ||
+	    !sim_number(tok[2], &to) || !sim_number(tok[3], &ms) ||
+	    ms < SIM_TICK_MS) {
+		return -EINVAL;
+	}
+
+	from = sim_get_temp(sensor);
+	for (int32_t t = SIM_TICK_MS; t <= ms; t += SIM_TICK_MS) {
+		sim_set_temp(sensor, from + (to - from) * t / ms);
+		sim_step(SIM_TICK_MS);
+	}
+
+	return 0;
+}
+
+static int sim_cmd_ac(char **tok, int n)
+{
+	int32_t present;
+
+	if (n != 2 || !sim_number(tok[1], &present)) {
+		return -EINVAL;
+	}
+
+	sim_power_ac(present);
+
+	return 0;
+}
+
+static int sim_cmd_battery(char **tok, int n)
+{
+	int32_t value;
+
+	if (n == 2 && !strcmp(tok[1], "remove")) {
+		sim_power_battery(false);
+	} else if (n == 2 && !strcmp(tok[1], "insert")) {
+		sim_power_battery(true);
+	} else if (n == 3 && !strcmp(tok[1], "discharge") &&
+		   sim_number(tok[2], &value)) {
+		sim_power_load(value);
+	} else if (n == 3 && !strcmp(tok[1], "capacity") &&
+		   sim_number(tok[2], &value)) {
+		sim_power_capacity(value);
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int sim_cmd_fan(char **tok, int n)
+{
+	int32_t stall;
+
+	if (n != 3 || strcmp(tok[1], "stall") || !sim_number(tok[2], &stall)) {
+		return -EINVAL;
+	}
+
+	sim_fan_stall(stall);
+
+	return 0;
+}
+
+static int sim_cmd_i2c(char **tok, int n)
+{
+	struct sim_i2c_slave *slave;
+	int32_t addr, nak, reg = 0;
+
+	if ((n != 4 && n != 5) || strcmp(tok[1], "nak") ||
+	    !sim_number(tok[2], &addr) || !sim_number(tok[3], &nak) ||
+	    (n == 5 && (!sim_number(tok[4], &reg) || reg < 0 ||
+			reg > UINT16_MAX))) {
+		return -EINVAL;
+	}
+
+	slave = sim_i2c_find(addr);
+	if (!slave) {
+		return -ENODEV;
+	}
+
+	/* With register given only that register is refused */
+	if (n == 5) {
+		return sim_i2c_nak_reg(slave, reg, nak);
+	}
+
+	slave->nak = nak;
+
+	return 0;
+}
+
+static int sim_cmd_ccg(char **tok, int n)
+{
+	int32_t count;
+
+	if (n != 3 || strcmp(tok[1], "drop") || !sim_number(tok[2], &count) ||
+	    count < 0) {
+		return -EINVAL;
+	}
+
+	sim_ccg_drop(count);
+
+	return 0;
+}
+
+static int sim_cmd_sx(char **tok, int n)
+{
+	static const struct {
+		const char *name;
+		uint32_t type;
+	} states[] = {
+		{ "s0", PM_RESET_TYPE_S0 },
+		{ "s3", PM_RESET_TYPE_S3 },
+		{ "s4", PM_RESET_TYPE_S4 },
+		{ "s5", PM_RESET_TYPE_S5 },
+	};
+
+	for (int i = 0; n == 2 && i < ARRAY_SIZE(states); i++) {
+		if (!strcmp(tok[1], states[i].name)) {
+			sim_sedi_sx(states[i].type);
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int sim_cmd_s0ix(char **tok, int n)
+{
+	if (n == 2 && !strcmp(tok[1], "enter")) {
+		sim_sedi_s0ix(true);
+	} else if (n == 2 && !strcmp(tok[1], "exit")) {
+		sim_sedi_s0ix(false);
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int sim_cmd_host(char **tok, int n)
+{
+	const struct sim_field *field = n > 2 ? sim_field(tok[2]) : NULL;
+	int32_t value, event = 0, param = 0;
+
+	if (n < 2) {
+		return -EINVAL;
+	}
+
+	if (n == 2 && !strcmp(tok[1], "connect")) {
+		return sim_host_connect();
+	} else if (n == 2 && !strcmp(tok[1], "disconnect")) {
+		return sim_host_disconnect();
+	} else if (n == 3 && !strcmp(tok[1], "read") && field) {
+		return sim_host_read(field->offset, field->size);
+	} else if ((n == 4 || n == 5) && !strcmp(tok[1], "write") && field &&
+		   sim_number(tok[3], &value) &&
+		   (n == 4 || sim_number(tok[4], &event))) {
+		return sim_host_write(field->offset, field->size, value,
+				      event);
+	} else if (n == 3 && !strcmp(tok[1], "event") &&
+		   sim_number(tok[2], &event)) {
+		return sim_host_event(event);
+	} else if ((n == 3 || n == 4) && !strcmp(tok[1], "ucsi") &&
+		   sim_number(tok[2], &value) &&
+		   (n == 3 || sim_number(tok[3], &param))) {
+		return sim_host_ucsi(value, param);
+	} else if (n <= 3 && !strcmp(tok[1], "delta")) {
+		return sim_host_delta(n == 3 && !strcmp(tok[2], "prev"),
+				      false);
+	} else if (n == 2 && !strcmp(tok[1], "delta_short")) {
+		return sim_host_delta(false, true);
+	}
+
+	return -EINVAL;
+}
+
+static int sim_cmd_reset(char **tok, int n)
+{
+	ARG_UNUSED(tok);
+
+	if (n != 1) {
+		return -EINVAL;
+	}
+
+	sim_reset();
+
+	return 0;
+}
+
+static bool sim_compare(int32_t a, const char *op, int32_t b, bool *result)
+{
+	if (!strcmp(op, "==")) {
+		*result = a == b;
+	} else if (!strcmp(op, "!=")) {
+		*result = a != b;
+	} else if (!strcmp(op, "<")) {
+		*result = a < b;
+	} else if (!strcmp(op, "<=")) {
+		*result = a <= b;
+	} else if (!strcmp(op, ">")) {
+		*result = a > b;
+	} else if (!strcmp(op, ">=")) {
+		*result = a >= b;
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+/* expect <metric> <op> <metric|number> or expect order <mark> <mark> */
+static int sim_cmd_expect(char **tok, int n)
+{
+	int32_t a, b;
+	bool ok;
+
+	if (n == 4 && !strcmp(tok[1], "order")) {
+		int first = sim_mark_index(tok[2]);
+		int second = sim_mark_index(tok[3]);
+
+		if (first < 0 || second < 0 || first > second) {
+			sim_fail("expected %s (#%d) before %s (#%d)", tok[2],
+				 first, tok[3], second);
+		} else {
+			passed++;
+		}
+		return 0;
+	}
+
+	if (n != 4) {
+		return -EINVAL;
+	}
+
+	if (sim_metric(tok[1], &a) || sim_metric(tok[3], &b)) {
+		return -ENOENT;
+	}
+
+	if (!sim_compare(a, tok[2], b, &ok)) {
+		return -EINVAL;
+	}
+
+	if (ok) {
+		passed++;
+	} else {
+		sim_fail("%s %s %s: %d vs %d", tok[1], tok[2], tok[3], a, b);
+	}
+
+	return 0;
+}
+
+static int sim_cmd_print(char **tok, int n)
+{
+	int32_t value;
+
+	for (int i = 1; i < n; i++) {
+		if (sim_metric(tok[i], &value)) {
+			return -ENOENT;
+		}
+		printk("line %d: %s = %d\n", line_no, tok[i], value);
+	}
+
+	return 0;
+}
+
+static const struct {
+	const char *name;
+	int (*run)(char **tok, int n);
+} commands[] = {
+	{ "wait", sim_cmd_wait },
+	{ "sync", sim_cmd_sync },
+	{ "temp", sim_cmd_temp },
+	{ "ramp", sim_cmd_ramp },
+	{ "ac", sim_cmd_ac },
+	{ "battery", sim_cmd_battery },
+	{ "fan", sim_cmd_fan },
+	{ "i2c", sim_cmd_i2c },
+	{ "ccg", sim_cmd_ccg },
+	{ "sx", sim_cmd_sx },
+	{ "s0ix", sim_cmd_s0ix },
+	{ "host", sim_cmd_host },
+	{ "reset", sim_cmd_reset },
+	{ "expect", sim_cmd_expect },
+	{ "print", sim_cmd_print },
+};
+
+/* Split line in place on blanks, drop comment. */
+static int sim_tokenize(char *line, char **tok)
+{
+	int n = 0;
+
+	for (char *p = line; *p && *p != '#';) {
+		if (*p == ' ' || *p == '\t' || *p == '\r') {
+			*p++ = '\0';
+			continue;
+		}
+
+		if (n == SIM_MAX_TOKENS) {
+			return -E2BIG;
+		}
+		tok[n++] = p;
+		while (*p && *p != ' ' && *p != '\t' && *p != '\r' &&
+		       *p != '#') {
+			p++;
+		}
+		if (*p == '#') {
+			*p = '\0';
+		}
+	}
+
+	return n;
+}
+
+static void sim_execute(char *line)
+{
+	char *tok[SIM_MAX_TOKENS];
+	int n = sim_tokenize(line, tok);
+	int ret = -EINVAL;
+
+	if (n == 0) {
+		return;
+	}
+
+	for (int i = 0; n > 0 && i < ARRAY_SIZE(commands); i++) {
+		if (!strcmp(tok[0], commands[i].name)) {
+			ret = commands[i].run(tok, n);
+			break;
+		}
+	}
+
+	if (ret) {
+		sim_fail("%s: error %d", tok[0], ret);
+	}
+}
+
+static void sim_runner(void *p1, void *p2, void *p3)
+{
+	char line[SIM_LINE_LEN];
+	const char *p = scenario;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	/* Let EClite finish bring-up and cold plug handling */
+	sim_step(SIM_BOOT_MS);
+	sim_reset();
+
+	while (*p) {
+		const char *eol = strchr(p, '\n');
+		size_t len = eol ? eol - p : strlen(p);
+
+		line_no++;
+		if (len >= sizeof(line)) {
+			sim_fail("line too long");
+		} else {
+			memcpy(line, p, len);
+			line[len] = '\0';
+			sim_execute(line);
+		}
+		p += eol ? len + 1 : len;
+	}
+
+	sim_report(passed, failed);
+}
+
+K_THREAD_DEFINE(sim_runner_tid, SIM_RUNNER_STACK, sim_runner, NULL, NULL,
+		NULL, SIM_RUNNER_PRIO, 0, 0);
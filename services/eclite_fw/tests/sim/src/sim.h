@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Interfaces between the scenario runner and the device models,
+ * bus emulators and service mocks of the EClite simulation.
+ */
+
+#ifndef _ECLITE_SIM_H_
+#define _ECLITE_SIM_H_
+
+#include <zephyr.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Scenario time 0 starts after EClite bring-up finished. */
+#define SIM_BOOT_MS             1000
+/** Device models advance in steps of this length. */
+#define SIM_TICK_MS             10
+
+/** Registers an emulated I2C slave refuses at most. */
+#define SIM_I2C_NAK_REGS        4
+
+/** Emulated I2C slave. */
+struct sim_i2c_slave {
+	/** bus device name slave is attached to */
+	const char *bus;
+	/** 7 bit slave address */
+	uint16_t addr;
+	/** register address is two bytes, little endian */
+	bool reg16;
+	/** read len bytes from register reg */
+	int (*read)(struct sim_i2c_slave *slave, uint16_t reg, uint8_t *buf,
+		    uint32_t len);
+	/** write len bytes to register reg */
+	int (*write)(struct sim_i2c_slave *slave, uint16_t reg,
+		     const uint8_t *buf, uint32_t len);
+	/** slave does not acknowledge its address */
+	bool nak;
+	/** register addresses slave does not acknowledge */
+	uint16_t nak_regs[SIM_I2C_NAK_REGS];
+	uint8_t num_nak_regs;
+	/** transfers addressed to slave */
+	uint32_t xfers;
+	struct sim_i2c_slave *next;
+};
+
+/* I2C bus emulator */
+void sim_i2c_attach(struct sim_i2c_slave *slave);
+struct sim_i2c_slave *sim_i2c_find(uint16_t addr);
+int sim_i2c_nak_reg(struct sim_i2c_slave *slave, uint16_t reg, bool nak);
+int sim_i2c_metric(const char *name, int32_t *value);
+void sim_i2c_reset(void);
+void sim_i2c_report(void);
+
+/* GPIO emulator */
+void sim_gpio_drive(const char *port, uint32_t pin, int level);
+int sim_gpio_output(const char *port, uint32_t pin);
+
+/* TMP102 sensors */
+void sim_tmp102_set(int sensor, int temp);
+int sim_tmp102_get(int sensor);
+int sim_tmp102_metric(const char *name, int32_t *value);
+
+/* Battery and charger */
+void sim_power_ac(bool present);
+void sim_power_load(int32_t ma);
+void sim_power_capacity(uint32_t percent);
+void sim_power_battery(bool present);
+void sim_power_step(uint32_t dt_ms);
+int sim_power_metric(const char *name, int32_t *value);
+void sim_power_reset(void);
+
+/* Fan, PWM and tachometer */
+void sim_fan_stall(bool stall);
+void sim_fan_step(uint32_t dt_ms);
+int sim_fan_metric(const char *name, int32_t *value);
+void sim_fan_reset(void);
+
+/* CCG PD controller */
+void sim_ccg_drop(uint32_t count);
+void sim_ccg_step(uint32_t dt_ms);
+int sim_ccg_metric(const char *name, int32_t *value);
+void sim_ccg_reset(void);
+
+/* PMC: PECI and power state messages */
+void sim_cpu_set(int temp);
+int sim_cpu_get(void);
+int sim_pmc_metric(const char *name, int32_t *value);
+void sim_pmc_reset(void);
+
+/* SEDI power management */
+void sim_sedi_sx(uint32_t reset_type);
+void sim_sedi_s0ix(bool enter);
+
+/* Host side of HECI */
+int sim_host_connect(void);
+int sim_host_disconnect(void);
+int sim_host_read(uint16_t offset, uint16_t length);
+int sim_host_write(uint16_t offset, uint16_t length, uint32_t value,
+		   uint8_t event);
+int sim_host_event(uint8_t event);
+int sim_host_ucsi(uint8_t command, uint8_t param);
+int sim_host_delta(bool since_prev, bool truncated);
+int sim_host_opregion(uint16_t offset, uint16_t length, int32_t *value);
+int sim_host_metric(const char *name, int32_t *value);
+void sim_host_reset(void);
+void sim_host_report(void);
+
+/* Scenario runner */
+void sim_mark(const char *fmt, ...);
+void sim_report(uint32_t passed, uint32_t failed);
+
+/** Host time stamp counter, simulated time does not advance while EClite
+ * code runs, so host CPU cost is taken from it.
+ */
+static inline uint64_t sim_host_cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	uint32_t lo, hi;
+
+	__asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t)hi << 32) | lo;
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+#endif /* _ECLITE_SIM_H_ */
@@ -63,6 +63,9 @@ void initialize_cloud_adapter(void)
 
 		cloud_adapter.process_message =
 			telit_process_message;
+
+		cloud_adapter.cmd_table =
+			&telit_cmd_table;
 #endif
 	} else if (creds->cloud_adapter == THINGSBOARD) {
 #if defined(CONFIG_MQTT_LIB_TLS) || defined(CONFIG_MQTT_LIB)
@@ -83,6 +86,9 @@ void initialize_cloud_adapter(void)
 
 		cloud_adapter.process_message =
 			thingsboard_process_message;
+
+		cloud_adapter.cmd_table =
+			&thingsboard_cmd_table;
 #endif
 	} else if (creds->cloud_adapter == AZURE) {
 #if defined(CONFIG_MQTT_LIB_TLS) || defined(CONFIG_MQTT_LIB)
@@ -103,6 +109,9 @@ void initialize_cloud_adapter(void)
 
 		cloud_adapter.process_message =
 			azure_iot_process_message;
+
+		cloud_adapter.cmd_table =
+			&azure_iot_cmd_table;
 #endif
 	}
 }
@@ -25,6 +25,7 @@
 
 #if defined(CONFIG_MQTT_LIB_TLS) || defined(CONFIG_MQTT_LIB)
 #include <mqtt_client/mqtt_client.h>
+#include "adapter_parser.h"
 
 /**
  * Function pointer type to call mqtt publish topic
@@ -121,6 +122,7 @@ struct cloud_adapter_client {
 	mqtt_static_attrib_pub_msg prep_static_attrib_pub_msg;
 	mqtt_event_pub_msg prep_event_pub_msg;
 	mqtt_process_incoming_message process_message;
+	const struct adapter_cmd_table *cmd_table;
 };
 
 #endif /* defined CONFIG_MQTT_LIB_TLS OR CONFIG_MQTT_LIB */
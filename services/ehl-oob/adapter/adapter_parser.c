@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file adapter_parser.c
+ *
+ * \brief This file contains the single-pass tokenizer shared by all
+ * cloud adapters. It replaces the per-command strstr scans: a message
+ * is walked once and every token is checked against the adapter's
+ * command table, which is rejected on length before any compare.
+ *
+ * \see adapter_parser.h
+ *
+ */
+
+#include <string.h>
+#include "adapter_parser.h"
+
+/**
+ * Internal function to check a token against a list of known tokens
+ *
+ * @param [in] list const struct adapter_token *
+ * @param [in] count uint8_t
+ * @param [in] tok const uint8_t *
+ * @param [in] tok_len uint32_t
+ * @retval index of the matching token, -1 if none
+ **/
+static int adapter_token_lookup(const struct adapter_token *list,
+				uint8_t count,
+				const uint8_t *tok,
+				uint32_t tok_len)
+{
+	for (int i = 0; i < count; i++) {
+		if (list[i].len == tok_len &&
+		    list[i].str[0] == tok[0] &&
+		    !memcmp(list[i].str, tok, tok_len)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Internal function to classify one token of a message and fold it
+ * into the parse result.
+ *
+ * @param [in]      table const struct adapter_cmd_table *
+ * @param [in]      tok const uint8_t *
+ * @param [in]      tok_len uint32_t
+ * @param [in][out] res struct adapter_parse_result *
+ * @retval true if the token is the request id key
+ **/
+static bool adapter_token_process(const struct adapter_cmd_table *table,
+				  const uint8_t *tok,
+				  uint32_t tok_len,
+				  struct adapter_parse_result *res)
+{
+	int idx;
+
+	if (tok_len == 0) {
+		return false;
+	}
+
+	if (res->cmd == IGNORE) {
+		idx = adapter_token_lookup(table->cmds, table->cmd_count,
+					   tok, tok_len);
+		if (idx >= 0) {
+			res->cmd = table->cmds[idx].msg;
+			return false;
+		}
+	}
+
+	idx = adapter_token_lookup(table->markers, table->marker_count,
+				   tok, tok_len);
+	if (idx >= 0) {
+		res->found |= BIT(idx);
+		return false;
+	}
+
+	if (res->expect != NULL && res->expect_len == tok_len &&
+	    !memcmp(res->expect, tok, tok_len)) {
+		res->found |= ADAPTER_PARSE_EXPECT_FOUND;
+		return false;
+	}
+
+	return (res->req_id == NULL &&
+		table->req_id_key != NULL &&
+		table->req_id_key_len == tok_len &&
+		!memcmp(table->req_id_key, tok, tok_len));
+}
+
+static void adapter_parse_reset(struct adapter_parse_result *res)
+{
+	res->cmd = IGNORE;
+	res->found = 0;
+	res->req_id = NULL;
+	res->req_id_len = 0;
+}
+
+enum oob_messages adapter_parse_json(const struct adapter_cmd_table *table,
+				     const uint8_t *buf,
+				     uint32_t len,
+				     struct adapter_parse_result *res)
+{
+	const uint8_t *tok = NULL;
+	bool in_string = false;
+	bool want_id = false;
+
+	adapter_parse_reset(res);
+
+	for (uint32_t i = 0; i < len && buf[i] != '\0'; i++) {
+		if (!in_string) {
+			if (buf[i] == '\"') {
+				in_string = true;
+				tok = &buf[i + 1];
+			} else if (want_id && buf[i] != ':' && buf[i] != ' ') {
+				/* Request id value is not a string */
+				want_id = false;
+			}
+			continue;
+		}
+
+		if (buf[i] == '\\') {
+			/* Skip escaped character */
+			i++;
+			continue;
+		}
+
+		if (buf[i] != '\"') {
+			continue;
+		}
+
+		in_string = false;
+		if (want_id) {
+			res->req_id = tok;
+			res->req_id_len = &buf[i] - tok;
+			want_id = false;
+			continue;
+		}
+		want_id = adapter_token_process(table, tok, &buf[i] - tok, res);
+	}
+
+	return res->cmd;
+}
+
+enum oob_messages adapter_parse_topic(const struct adapter_cmd_table *table,
+				      const uint8_t *buf,
+				      uint32_t len,
+				      struct adapter_parse_result *res)
+{
+	const uint8_t *tok = buf;
+	uint32_t i;
+
+	adapter_parse_reset(res);
+
+	for (i = 0; i < len && buf[i] != '\0'; i++) {
+		if (buf[i] == '/') {
+			adapter_token_process(table, tok, &buf[i] - tok, res);
+			tok = &buf[i + 1];
+		}
+	}
+	adapter_token_process(table, tok, &buf[i] - tok, res);
+
+	return res->cmd;
+}
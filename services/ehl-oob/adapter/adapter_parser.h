@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file adapter_parser.h
+ *
+ * \brief This file contains the shared single-pass tokenizer used by
+ * the cloud adapters to identify commands in incoming messages.
+ *
+ * Every adapter registers a struct adapter_cmd_table in its
+ * cloud_adapter_client. The payload (JSON) or topic ('/' separated)
+ * is scanned exactly once; each token is looked up in the table and
+ * the request id, if any, is captured on the way.
+ *
+ */
+
+#ifndef _ADAPTER_PARSER_H_
+#define _ADAPTER_PARSER_H_
+
+#include <zephyr.h>
+#include <common/utils.h>
+
+/** Max no of marker tokens an adapter can register */
+#define ADAPTER_MAX_MARKERS 7
+
+/** Bit set in adapter_parse_result.found when the expected token is seen */
+#define ADAPTER_PARSE_EXPECT_FOUND BIT(ADAPTER_MAX_MARKERS)
+
+/** Helper to declare a token from a string literal */
+#define ADAPTER_TOKEN(s, m) { (s), sizeof(s) - 1, (m) }
+
+/**
+ * A known token. For command tokens msg is the oob message returned
+ * when the token is seen, for marker tokens it is unused.
+ */
+struct adapter_token {
+	const char *str;
+	uint8_t len;
+	enum oob_messages msg;
+};
+
+/**
+ * Command table registered by each cloud adapter
+ *
+ * cmds:        command names mapped to enum oob_messages
+ * markers:     tokens whose presence is only recorded (eg. method.exec)
+ * req_id_key:  key whose value is captured as request id (JSON only)
+ */
+struct adapter_cmd_table {
+	const struct adapter_token *cmds;
+	uint8_t cmd_count;
+	const struct adapter_token *markers;
+	uint8_t marker_count;
+	const char *req_id_key;
+	uint8_t req_id_key_len;
+};
+
+/**
+ * Result of a single pass over a message
+ *
+ * expect and expect_len are inputs, set by the caller to a runtime
+ * token (eg. the device thing key) that must be present. All other
+ * fields are outputs.
+ */
+struct adapter_parse_result {
+	const char *expect;
+	uint32_t expect_len;
+	enum oob_messages cmd;
+	uint32_t found;
+	const uint8_t *req_id;
+	uint32_t req_id_len;
+};
+
+/**
+ * Scan a JSON payload once and look up every string token in table.
+ * The first command token wins. Escaped characters inside strings are
+ * skipped, the payload does not need to be NUL terminated.
+ *
+ * @param [in]      table const struct adapter_cmd_table *
+ * @param [in]      buf const uint8_t *
+ * @param [in]      len uint32_t
+ * @param [in][out] res struct adapter_parse_result *
+ * @retval enum oob_messages command found, IGNORE otherwise
+ **/
+enum oob_messages adapter_parse_json(const struct adapter_cmd_table *table,
+				     const uint8_t *buf,
+				     uint32_t len,
+				     struct adapter_parse_result *res);
+
+/**
+ * Scan an MQTT topic once, treating each '/' separated level as a
+ * token, and look up every level in table.
+ *
+ * @param [in]      table const struct adapter_cmd_table *
+ * @param [in]      buf const uint8_t *
+ * @param [in]      len uint32_t
+ * @param [in][out] res struct adapter_parse_result *
+ * @retval enum oob_messages command found, IGNORE otherwise
+ **/
+enum oob_messages adapter_parse_topic(const struct adapter_cmd_table *table,
+				      const uint8_t *buf,
+				      uint32_t len,
+				      struct adapter_parse_result *res);
+
+#endif
@@ -24,6 +24,18 @@ LOG_MODULE_REGISTER(OOB_AZURE_IOT, CONFIG_OOB_LOGGING);
 VAR_DEFINER_BSS char msg_buffer[MAX_MSG_BUF_LEN];
 VAR_DEFINER_BSS char az_payload[MAX_MSG_BUF_LEN];
 
+static const struct adapter_token azure_iot_cmds[] = {
+	ADAPTER_TOKEN(AZURE_IOT_REBOOT_PARAMS_METHOD, REBOOT),
+	ADAPTER_TOKEN(AZURE_IOT_POWERUP_PARAMS_METHOD, POWERON),
+	ADAPTER_TOKEN(AZURE_IOT_POWERDOWN_PARAMS_METHOD, POWEROFF),
+	ADAPTER_TOKEN(AZURE_IOT_DECOMMISSION_PARAMS_METHOD, DECOMMISSION)
+};
+
+const struct adapter_cmd_table azure_iot_cmd_table = {
+	.cmds = azure_iot_cmds,
+	.cmd_count = ARRAY_SIZE(azure_iot_cmds)
+};
+
 VAR_DEFINER char *azure_iot_mqtt_subs_topics[NUM_AZURE_IOT_SUB_TOPICS] = {
 	AZURE_IOT_RPC_SUB_TOPIC
 };
@@ -114,7 +126,7 @@ enum oob_messages azure_iot_process_message(uint8_t *payload,
 					    char *next_msg,
 					    size_t next_msg_size)
 {
-	char *oob_cmd = NULL;
+	struct adapter_parse_result res = { 0 };
 	enum oob_messages oob_cmd_msg = IGNORE;
 
 	if (topic_length > MAX_MSG_BUF_LEN) {
@@ -129,34 +141,12 @@ enum oob_messages azure_iot_process_message(uint8_t *payload,
 
 	if (!strstr(topic, AZURE_IOT_RPC_REPLY_TOPIC)) {
 		LOG_INF("Processing message azure_iot");
-		oob_cmd = strstr(topic, AZURE_IOT_REBOOT_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = REBOOT;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(topic, AZURE_IOT_POWERUP_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = POWERON;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(topic, AZURE_IOT_POWERDOWN_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = POWEROFF;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(topic, AZURE_IOT_DECOMMISSION_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = DECOMMISSION;
-			goto oob_cmd_exit;
-		}
+		oob_cmd_msg = adapter_parse_topic(&azure_iot_cmd_table,
+						  topic, topic_length,
+						  &res);
 	}
 
-oob_cmd_exit:
-
-	if (oob_cmd != NULL) {
+	if (oob_cmd_msg != IGNORE) {
 		snprintf(next_msg, next_msg_size,
 			 AZURE_IOT_ATTRIBUTE_MESSAGE_TEMPLATE,
 			 "status", "200");
@@ -18,6 +18,7 @@
 #include <common/pse_app_framework.h>
 #include <common/utils.h>
 #include <mqtt_client/mqtt_client.h>
+#include "adapter_parser.h"
 
 /** Used during verification of commn_name from the certificates
  * during SSL handshake
@@ -62,6 +63,9 @@
 /** AZURE_IOT topic on which server posts messages for every trigger */
 #define AZURE_IOT_RPC_SUB_TOPIC "$iothub/methods/POST/#"
 
+/** AZURE_IOT command table used by the shared single-pass parser */
+extern const struct adapter_cmd_table azure_iot_cmd_table;
+
 /**
  * AZURE_IOT specific method to get mqtt subscription topics count
  *
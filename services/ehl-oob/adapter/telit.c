@@ -27,6 +27,29 @@ VAR_DEFINER char telit_ignore_list[TELIT_NUM_IGNORE_MESSAGES]
 	TELIT_CMD_REPLY_MESSAGE
 };
 
+static const struct adapter_token telit_cmds[] = {
+	ADAPTER_TOKEN(TELIT_REBOOT_PARAMS_METHOD, REBOOT),
+	ADAPTER_TOKEN(TELIT_POWERUP_PARAMS_METHOD, POWERON),
+	ADAPTER_TOKEN(TELIT_POWERDOWN_PARAMS_METHOD, POWEROFF),
+	ADAPTER_TOKEN(TELIT_DECOMMISSION_PARAMS_METHOD, DECOMMISSION)
+};
+
+/** Marker index 0, see TELIT_MARKER_METHOD_EXEC */
+static const struct adapter_token telit_markers[] = {
+	ADAPTER_TOKEN(TELIT_METHOD_EXEC, IGNORE)
+};
+
+#define TELIT_MARKER_METHOD_EXEC BIT(0)
+
+const struct adapter_cmd_table telit_cmd_table = {
+	.cmds = telit_cmds,
+	.cmd_count = ARRAY_SIZE(telit_cmds),
+	.markers = telit_markers,
+	.marker_count = ARRAY_SIZE(telit_markers),
+	.req_id_key = TELIT_REQUEST_ID,
+	.req_id_key_len = sizeof(TELIT_REQUEST_ID) - 1
+};
+
 VAR_DEFINER char *telit_mqtt_subs_topics[NUM_TELIT_SUB_TOPICS] = {
 	TELIT_REPLY_SUB_TOPIC,
 	TELIT_REPLYZ_SUB_TOPIC,
@@ -117,6 +140,34 @@ void telit_prepare_mailbox_check(char *msg_buf, size_t msg_buf_size)
 		 1);
 }
 
+/**
+ * Internal TELIT specific function to format a mailbox.ack message
+ * for an already extracted request id.
+ *
+ * @param [in]      id const uint8_t *
+ * @param [in]      id_len uint32_t
+ * @param [in][out] msg_buf char *
+ * @param [in]      msg_buf_size size_t
+ * @retval void
+ **/
+static void telit_format_mailbox_ack(const uint8_t *id, uint32_t id_len,
+				     char *msg_buf, size_t msg_buf_size)
+{
+	memset(msg_buf, '\0', msg_buf_size);
+
+	if (id == NULL) {
+		return;
+	}
+
+	if (id_len > TELIT_ID_LEN) {
+		id_len = TELIT_ID_LEN;
+	}
+
+	snprintf(msg_buf, msg_buf_size,
+		 TELIT_MAILBOX_ACK_MESSAGE_TEMPLATE,
+		 (int)id_len, (const char *)id, TELIT_MAILBOX_ACK_RESPONSE);
+}
+
 enum oob_messages telit_process_message(uint8_t *payload,
 					uint32_t payload_length,
 					uint8_t *topic,
@@ -124,9 +175,7 @@ enum oob_messages telit_process_message(uint8_t *payload,
 					char *next_msg,
 					size_t next_msg_size)
 {
-	char *method_exec = NULL;
-	char *oob_cmd = NULL;
-	char *thing_verify = NULL;
+	struct adapter_parse_result res;
 
 	if (!strncmp(topic,
 		     TELIT_REPLY_TOPIC,
@@ -148,42 +197,19 @@ enum oob_messages telit_process_message(uint8_t *payload,
 	if (!strncmp(topic,
 		     TELIT_REPLY_TOPIC,
 		     strlen(TELIT_REPLY_TOPIC))) {
-		method_exec = strstr(payload, TELIT_METHOD_EXEC);
-		thing_verify = strstr(payload, creds->username);
-
-		oob_cmd = strstr(payload, TELIT_REBOOT_PARAMS_METHOD);
-		if (method_exec != NULL &&
-		    oob_cmd != NULL &&
-		    thing_verify != NULL) {
-			telit_prepare_mailbox_ack(payload, next_msg, next_msg_size);
-			return REBOOT;
-		}
-
-		oob_cmd = strstr(payload,
-				 TELIT_POWERUP_PARAMS_METHOD);
-		if (method_exec != NULL &&
-		    oob_cmd != NULL &&
-		    thing_verify != NULL) {
-			telit_prepare_mailbox_ack(payload, next_msg, next_msg_size);
-			return POWERON;
-		}
+		res.expect = creds->username;
+		res.expect_len = strlen(creds->username);
 
-		oob_cmd = strstr(payload,
-				 TELIT_POWERDOWN_PARAMS_METHOD);
-		if (method_exec != NULL &&
-		    oob_cmd != NULL &&
-		    thing_verify != NULL) {
-			telit_prepare_mailbox_ack(payload, next_msg, next_msg_size);
-			return POWEROFF;
+		if (adapter_parse_json(&telit_cmd_table, payload,
+				       payload_length, &res) == IGNORE) {
+			return IGNORE;
 		}
 
-		oob_cmd = strstr(payload,
-				 TELIT_DECOMMISSION_PARAMS_METHOD);
-		if (method_exec != NULL &&
-		    oob_cmd != NULL &&
-		    thing_verify != NULL) {
-			telit_prepare_mailbox_ack(payload, next_msg, next_msg_size);
-			return DECOMMISSION;
+		if ((res.found & TELIT_MARKER_METHOD_EXEC) &&
+		    (res.found & ADAPTER_PARSE_EXPECT_FOUND)) {
+			telit_format_mailbox_ack(res.req_id, res.req_id_len,
+						 next_msg, next_msg_size);
+			return res.cmd;
 		}
 	}
 	return IGNORE;
@@ -202,26 +228,11 @@ void telit_prepare_log_message(char *msg_buf, size_t msg_buf_size,
 void telit_prepare_mailbox_ack(char *payload, char *msg_buf,
 			       size_t msg_buf_size)
 {
-	char *temp_buf, bufout[TELIT_ID_LEN];
-	int i = 2;
-
-	memset(msg_buf, '\0', msg_buf_size);
+	struct adapter_parse_result res = { 0 };
 
 	/* Extract the ID from payload */
-	temp_buf = strstr(payload, TELIT_REQUEST_ID);
-	if (temp_buf == NULL) {
-		return;
-	}
-
-	while (i--) {
-		temp_buf = strchr(temp_buf, '\"');
-		temp_buf++;
-	}
-
-	memcpy(bufout, temp_buf, TELIT_ID_LEN);
-
-	snprintf(msg_buf, msg_buf_size,
-		 TELIT_MAILBOX_ACK_MESSAGE_TEMPLATE,
-		 bufout, TELIT_MAILBOX_ACK_RESPONSE);
+	adapter_parse_json(&telit_cmd_table, (uint8_t *)payload,
+			   strlen(payload), &res);
+	telit_format_mailbox_ack(res.req_id, res.req_id_len,
+				 msg_buf, msg_buf_size);
 }
-
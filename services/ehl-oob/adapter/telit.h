@@ -18,6 +18,7 @@
 #include <common/pse_app_framework.h>
 #include <common/utils.h>
 #include <mqtt_client/mqtt_client.h>
+#include "adapter_parser.h"
 
 /** Used during verification of commn_name from the certificates
  * during SSL handshake
@@ -43,9 +44,9 @@
 #define TELIT_ID_LEN 24
 #define TELIT_MAILBOX_ACK_RESPONSE "Command Received"
 
-#define TELIT_MAILBOX_ACK_MESSAGE_TEMPLATE	     \
-	"{\"cmd\":{\"command\":\"mailbox.ack\","     \
-	"\"params\":{\"id\":\"%s\",\"errorCode\":0," \
+#define TELIT_MAILBOX_ACK_MESSAGE_TEMPLATE	       \
+	"{\"cmd\":{\"command\":\"mailbox.ack\","       \
+	"\"params\":{\"id\":\"%.*s\",\"errorCode\":0," \
 	"\"params\":{\"Response\":\"%s\"}}}}"
 
 #define TELIT_LOG_MESSAGE_TEMPLATE		 \
@@ -90,6 +91,9 @@
 extern VAR_DEFINER char ignore_list[TELIT_NUM_IGNORE_MESSAGES]
 [TELIT_MAX_IGNORE_MESSAGE_LENGTH];
 
+/** TELIT command table used by the shared single-pass parser */
+extern const struct adapter_cmd_table telit_cmd_table;
+
 /**
  * TELIT specific method to get mqtt subscription topics count
  *
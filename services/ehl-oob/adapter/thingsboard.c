@@ -26,6 +26,18 @@ VAR_DEFINER_BSS char tb_payload[MAX_MSG_BUF_LEN];
 
 extern VAR_DEFINER struct cloud_credentials *creds;
 
+static const struct adapter_token thingsboard_cmds[] = {
+	ADAPTER_TOKEN(THINGSBOARD_REBOOT_PARAMS_METHOD, REBOOT),
+	ADAPTER_TOKEN(THINGSBOARD_POWERUP_PARAMS_METHOD, POWERON),
+	ADAPTER_TOKEN(THINGSBOARD_POWERDOWN_PARAMS_METHOD, POWEROFF),
+	ADAPTER_TOKEN(THINGSBOARD_DECOMMISSION_PARAMS_METHOD, DECOMMISSION)
+};
+
+const struct adapter_cmd_table thingsboard_cmd_table = {
+	.cmds = thingsboard_cmds,
+	.cmd_count = ARRAY_SIZE(thingsboard_cmds)
+};
+
 VAR_DEFINER char *thingsboard_mqtt_subs_topics[NUM_THINGSBOARD_SUB_TOPICS] = {
 	THINGSBOARD_RPC_SUB_TOPIC
 };
@@ -105,7 +117,7 @@ enum oob_messages thingsboard_process_message(uint8_t *payload,
 					      char *next_msg,
 					      size_t next_msg_size)
 {
-	char *oob_cmd = NULL;
+	struct adapter_parse_result res = { 0 };
 	enum oob_messages oob_cmd_msg = IGNORE;
 
 	if (topic_length > MAX_MSG_BUF_LEN) {
@@ -119,34 +131,12 @@ enum oob_messages thingsboard_process_message(uint8_t *payload,
 	memset(next_msg, 0x00, next_msg_size);
 
 	if (!strstr(topic, THINGSBOARD_RPC_REPLY_TOPIC)) {
-		oob_cmd = strstr(payload, THINGSBOARD_REBOOT_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = REBOOT;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(payload, THINGSBOARD_POWERUP_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = POWERON;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(payload, THINGSBOARD_POWERDOWN_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = POWEROFF;
-			goto oob_cmd_exit;
-		}
-
-		oob_cmd = strstr(payload, THINGSBOARD_DECOMMISSION_PARAMS_METHOD);
-		if (oob_cmd != NULL) {
-			oob_cmd_msg = DECOMMISSION;
-			goto oob_cmd_exit;
-		}
+		oob_cmd_msg = adapter_parse_json(&thingsboard_cmd_table,
+						 payload, payload_length,
+						 &res);
 	}
 
-oob_cmd_exit:
-
-	if (oob_cmd != NULL) {
+	if (oob_cmd_msg != IGNORE) {
 		snprintf(next_msg, next_msg_size,
 			 THINGSBOARD_ATTRIBUTE_MESSAGE_TEMPLATE,
 			 "status", "200");
@@ -18,6 +18,7 @@
 #include <common/pse_app_framework.h>
 #include <common/utils.h>
 #include <mqtt_client/mqtt_client.h>
+#include "adapter_parser.h"
 
 /** Used during verification of commn_name from the certificates
  * during SSL handshake
@@ -63,6 +64,9 @@
 /** THINGSBOARD topic on which server posts messages for every trigger */
 #define THINGSBOARD_RPC_SUB_TOPIC "v1/devices/me/rpc/request/+"
 
+/** THINGSBOARD command table used by the shared single-pass parser */
+extern const struct adapter_cmd_table thingsboard_cmd_table;
+
 /**
  * THINGSBOARD specific method to get mqtt subscription topics count
  *
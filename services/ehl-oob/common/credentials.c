@@ -277,10 +277,27 @@ void oob_release_credentials(void)
 #endif
 }
 
+#if defined(CONFIG_OOB_BIOS_IPC)
+/* Fetched length of credential type, 0 if it was not requested */
+static unsigned int cred_item_len(const struct sec_cred_item *items,
+				  int count, enum sec_cred_type type)
+{
+	for (int i = 0; i < count; i++) {
+		if (items[i].type == type) {
+			return items[i].len;
+		}
+	}
+
+	return 0;
+}
+
+#define CRED_LEN(type)  cred_item_len(items, ARRAY_SIZE(items), type)
+#endif
+
 /**
  * Function used to populate the credentials sent from ehl_oob
- * It allocates buffers for each piece of information on the heap and expects
- * pse_oob_sec_<field_specific> to populate it.
+ * All fields are fetched from sec_bios_ipc in one sec_get_credentials()
+ * call which fills creds in place.
  *
  * \note Since th HECI and bios modules are not in place, we need to currently
  * stub it out
@@ -297,127 +314,85 @@ int populate_credentials(void)
 
 	stubbed_credentials(cloud_type);
 #else
-	char buffer[SEC_URL_LEN * 2];
-	int size;
-	int port;
+	unsigned int cld_port = 0;
+	unsigned int pxy_port = 0;
 	int fetch_result = OOB_ERR_FETCH_ERROR;
+	/* Every field is copied by sec_bios_ipc straight into creds */
+	struct sec_cred_item items[] = {
+		{ SEC_CRED_CLD_ADAPTER, (char *)creds->cloud_type,
+		  MAX_ARR_LEN },
+		{ SEC_CRED_TOK_ID, (char *)creds->token, MAX_ID_LEN },
+		{ SEC_CRED_DEV_ID, (char *)creds->username, MAX_ID_LEN },
+		{ SEC_CRED_MQTT_CLIENT_ID, (char *)creds->mqtt_client_id,
+		  MAX_ID_LEN },
+		{ SEC_CRED_CLD_HOST_URL, (char *)creds->cloud_host,
+		  MAX_ARR_LEN },
+		{ SEC_CRED_CLD_HOST_PORT, &cld_port, sizeof(cld_port) },
+		{ SEC_CRED_PXY_HOST_URL, (char *)creds->proxy_url,
+		  MAX_ARR_LEN },
+		{ SEC_CRED_PXY_HOST_PORT, &pxy_port, sizeof(pxy_port) },
+#if defined(CONFIG_MQTT_LIB_TLS)
+		{ SEC_CRED_ROOT_CA, creds->trusted_ca, MAX_CERT_LEN },
+#endif
+	};
+	static const int fetch_err[SEC_CRED_MAX] = {
+		[SEC_CRED_CLD_ADAPTER] = OOB_ERR_FETCH_CLOUD_ADAPTER,
+		[SEC_CRED_TOK_ID] = OOB_ERR_FETCH_CLOUD_PASSWORD,
+		[SEC_CRED_DEV_ID] = OOB_ERR_FETCH_CLOUD_USERNAME,
+		[SEC_CRED_MQTT_CLIENT_ID] = OOB_ERR_FETCH_CLOUD_MQTT_CLIENT_ID,
+		[SEC_CRED_CLD_HOST_URL] = OOB_ERR_FETCH_CLOUD_HOST_URL,
+		[SEC_CRED_CLD_HOST_PORT] = OOB_ERR_FETCH_CLOUD_HOST_PORT,
+		[SEC_CRED_PXY_HOST_URL] = OOB_ERR_FETCH_PROXY_HOST_URL,
+		[SEC_CRED_PXY_HOST_PORT] = OOB_ERR_FETCH_PROXY_HOST_PORT,
+		[SEC_CRED_ROOT_CA] = OOB_ERR_FETCH_ROOT_CA,
+	};
 
 	LOG_DBG("Fetching credentials through BIOS IPC");
 
-	/* Cloud Adapter Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_cld_adapter(buffer, &size);
+	fetch_result = sec_get_credentials(items, ARRAY_SIZE(items));
 	if (fetch_result) {
-		LOG_ERR("Failed to fetch cloud_adapter");
-		return OOB_ERR_FETCH_CLOUD_ADAPTER;
+		/* Report the first missing field, as fetched in order */
+		for (int i = 0; i < ARRAY_SIZE(items); i++) {
+			if (items[i].result) {
+				LOG_ERR("Failed to fetch credential %d",
+					items[i].type);
+				return fetch_err[items[i].type];
+			}
+		}
+		return OOB_ERR_FETCH_ERROR;
 	}
-	memset((char *)creds->cloud_type, '\0', size + 1);
-	memcpy((char *)creds->cloud_type, buffer, size);
+
 	LOG_DBG("Cloud type from BIOS: %s", creds->cloud_type);
 	creds->cloud_adapter = extract_adapter((char *)creds->cloud_type);
 	LOG_DBG("cloud_adapter: %d size: %d", creds->cloud_adapter,
-		strlen(creds->cloud_type));
+		CRED_LEN(SEC_CRED_CLD_ADAPTER));
 
-	/* Token-id/Password Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_tok_id(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch token_id");
-		return OOB_ERR_FETCH_CLOUD_PASSWORD;
-	}
-	memset((char *)creds->token, '\0', size + 1);
-	memcpy((char *)creds->token, buffer, size);
-	creds->token_size = size;
+	creds->token_size = CRED_LEN(SEC_CRED_TOK_ID);
 	LOG_DBG("token: %s size: %d", creds->token, creds->token_size);
 
-	/* Device-id/Username Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_dev_id(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch device_id");
-		return OOB_ERR_FETCH_CLOUD_USERNAME;
-	}
-	memset((char *)creds->username, '\0', size + 1);
-	memcpy((char *)creds->username, buffer, size);
-	creds->username_size = size;
+	creds->username_size = CRED_LEN(SEC_CRED_DEV_ID);
 	LOG_DBG("username: %s size: %d", creds->username,
 		creds->username_size);
 
-	/* MQTT Client-id Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_mqtt_client_id(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch mqtt client id");
-		return OOB_ERR_FETCH_CLOUD_MQTT_CLIENT_ID;
-	}
-	memset((char *)creds->mqtt_client_id, '\0', size + 1);
-	memcpy((char *)creds->mqtt_client_id, buffer, size);
-	creds->mqtt_client_id_size = size;
+	creds->mqtt_client_id_size = CRED_LEN(SEC_CRED_MQTT_CLIENT_ID);
 	LOG_DBG("mqtt client id : %s size: %d", creds->mqtt_client_id,
 		creds->mqtt_client_id_size);
 
-	/* Cloud host Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_cld_host_url(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch cld_host_url");
-		return OOB_ERR_FETCH_CLOUD_HOST_URL;
-	}
-	memset((char *)creds->cloud_host, '\0', size + 1);
-	memcpy((char *)creds->cloud_host, buffer, size);
 	LOG_DBG("cloud host url: %s size: %d", creds->cloud_host,
-		strlen(creds->cloud_host));
+		CRED_LEN(SEC_CRED_CLD_HOST_URL));
 
-	/* Cloud host port Fetching */
-	port = 0;
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_cld_host_port(&port);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch cld_host_port");
-		return OOB_ERR_FETCH_CLOUD_HOST_PORT;
-	}
-	sprintf(buffer, "%d", port);
-	size = strlen(buffer);
-	memset((char *)creds->cloud_port, '\0', size + 1);
-	memcpy((char *)creds->cloud_port, buffer, size);
+	snprintf((char *)creds->cloud_port, MAX_ARR_LEN, "%d", cld_port);
 	LOG_DBG("cloud port :%s size: %d", creds->cloud_port,
 		strlen(creds->cloud_port));
 
-	/* Proxy host URL Fetching */
-	memset(buffer, '\0', SEC_URL_LEN);
-	fetch_result = sec_get_pxy_host_url(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch pxy_host_url");
-		return OOB_ERR_FETCH_PROXY_HOST_URL;
-	}
-	memset((char *)creds->proxy_url, '\0', size + 1);
-	memcpy((char *)creds->proxy_url, buffer, size);
 	LOG_DBG("proxy url :%s size: %d", creds->proxy_url,
-		strlen(creds->proxy_url));
+		CRED_LEN(SEC_CRED_PXY_HOST_URL));
 
-	/* Proxy host port Fetching */
-	port = 0;
-	memset(buffer, '\0', SEC_URL_LEN);
-	sec_get_pxy_host_port(&port);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch pxy_host_port");
-		return OOB_ERR_FETCH_PROXY_HOST_PORT;
-	}
-	sprintf(buffer, "%d", port);
-	size = strlen(buffer);
-	memset((char *)creds->proxy_port, '\0', size + 1);
-	memcpy((char *)creds->proxy_port, buffer, size);
+	snprintf((char *)creds->proxy_port, MAX_ARR_LEN, "%d", pxy_port);
 	LOG_DBG("proxy port :%s size: %d", creds->proxy_port,
 		strlen(creds->proxy_port));
 
 #if defined CONFIG_MQTT_LIB_TLS
-	memset(buffer, '\0', SEC_URL_LEN * 2);
-	fetch_result = sec_get_root_ca(buffer, &size);
-	if (fetch_result) {
-		LOG_ERR("Failed to fetch root_ca");
-		return OOB_ERR_FETCH_ROOT_CA;
-	}
-
 	/* SNI as per cloud type, for now it's TELIT */
 	if (creds->cloud_adapter == TELIT) {
 		strncpy((char *)creds->cloud_tls_sni,
@@ -430,9 +405,8 @@ int populate_credentials(void)
 			AZURE_IOT_TLS_SNI_HOSTNAME, MAX_ARR_LEN);
 	}
 
-	creds->trusted_ca_size = size + 1;
-	memset((char *)creds->trusted_ca, '\0', creds->trusted_ca_size);
-	memcpy(creds->trusted_ca, buffer, creds->trusted_ca_size);
+	/* Size includes the terminating NUL */
+	creds->trusted_ca_size = CRED_LEN(SEC_CRED_ROOT_CA) + 1;
 	LOG_DBG("creds->trusted_ca: %s size: %d", creds->trusted_ca,
 		creds->trusted_ca_size);
 #endif  /* CONFIG_MQTT_LIB_TLS */
@@ -20,6 +20,7 @@
 #include <common/utils.h>
 #include <sec_bios_ipc/pse_oob_sec.h>
 #include <logging/log.h>
+#include <stdio.h>
 
 #include <driver/sedi_driver_pm.h>
 #include <driver/sedi_driver_common.h>
@@ -161,6 +162,29 @@ void send_platform_info(void)
 	post_message("Static Telemetry published...", EVENT);
 }
 
+#if (CONFIG_OOB_TELEMETRY_LOAD_KEYS > 0)
+/**
+ * \brief Test only function which sends synthetic dynamic telemetry
+ * on every mqtt live tick. Every key gets a new value each time, so
+ * what reaches the broker is down to the DYNAMIC publish policy.
+ *
+ * @returnval void
+ **/
+static void send_telemetry_load(void)
+{
+	static uint32_t seq;
+	char key[MAX_TELEMETRY_KEY_LEN];
+	char value[MAX_TELEMETRY_VALUE_LEN];
+
+	seq++;
+	for (int i = 0; i < CONFIG_OOB_TELEMETRY_LOAD_KEYS; i++) {
+		snprintf(key, sizeof(key), "LOAD_%d", i);
+		snprintf(value, sizeof(value), "%u", seq);
+		send_telemetry(key, value, DYNAMIC);
+	}
+}
+#endif
+
 /**
  * brief Function:
  * cloud connection recovery/re-stablishing
@@ -305,7 +329,6 @@ void wait_for_events(void)
 			rc = post_message(data_item->next_msg, API);
 			if (rc != OOB_SUCCESS) {
 				LOG_ERR(OOB_API_MSG_ERR "error: (%d)\n", rc);
-				continue;
 			}
 			break;
 
@@ -421,6 +444,7 @@ void wait_for_events(void)
 						post_message(
 							OOB_DECOMMISSION_SUCCESS,
 							EVENT);
+						release_message(data_item);
 						goto exit;
 					} else {
 						LOG_INF(OOB_DECOMMISSION_FAILED);
@@ -473,6 +497,10 @@ void wait_for_events(void)
 			if (connected) {
 				LOG_INF("Connected to cloud...\n");
 				LOG_INF("Listening to commands from cloud...\n");
+#if (CONFIG_OOB_TELEMETRY_LOAD_KEYS > 0)
+				send_telemetry_load();
+#endif
+				flush_telemetry();
 			} else {
 				LOG_INF("Lost Connection to cloud\n");
 				LOG_INF("Retrying connection...\n");
@@ -493,6 +521,9 @@ void wait_for_events(void)
 			 */
 			break;
 		}
+
+		/* Return the message buffer to the mqtt client pool */
+		release_message(data_item);
 	}
 exit:
 	LOG_INF("Exit: %s\n", __func__);
@@ -62,6 +62,7 @@
 int ehl_oob_bootstrap(void);
 int post_message(char *payload, enum app_message_type type);
 int send_telemetry(char *key, char *value, enum app_message_type type);
+void release_message(struct fifo_message *msg);
 void oob_set_pm_control(bool set_oob);
 void oob_tls_session_expiry(struct k_timer *timer);
 void oob_sx_trans_expiry(struct k_timer *timer);
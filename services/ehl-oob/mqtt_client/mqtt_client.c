@@ -11,11 +11,13 @@
  *
  */
 
+#include <stdlib.h>
 #include <random/rand32.h>
 #include <adapter/adapter.h>
 #include "common/credentials.h"
 #include <common/pse_app_framework.h>
 #include "mqtt_client.h"
+#include "mqtt_pub_tmpl.h"
 #include "common/utils.h"
 #include <logging/log.h>
 
@@ -29,7 +31,7 @@ K_TIMER_DEFINE(ping_req_timer, timer_expiry_pingreq, NULL);
 
 /** Global to keep TLS session & mqtt states */
 VAR_DEFINER_BSS enum oob_conn_state oob_conn_st;
-static VAR_DEFINER_BSS struct fifo_message mqtt_state_q, fmessage;
+static VAR_DEFINER_BSS struct fifo_message mqtt_state_q;
 
 /** FIFO queue to share messages between protocol and ehl-oob main */
 K_FIFO_DEFINE(managability_fifo);
@@ -68,10 +70,86 @@ VAR_DEFINER_BSS struct mqtt_subscription_list sub_list;
 VAR_DEFINER_BSS struct mqtt_topic topic_list[MAX_SUBLIST_COUNT];
 VAR_DEFINER_BSS struct mqtt_subscription_list *sub_list_p;
 
-VAR_DEFINER_BSS char msg_buf[BIG_GENERAL_BUF_SIZE];
 VAR_DEFINER_BSS char sub_topics[MAX_SUBLIST_COUNT][MAX_MQTT_SUBS_TOPIC_LEN];
 
-VAR_DEFINER_BSS char next_msg[BIG_GENERAL_BUF_SIZE];
+/** Reference counted message buffer. Received payloads, the replies the
+ * adapter formats for them and outgoing publishes all live in one of
+ * these, and are handed to mqtt_publish without another copy. A reply
+ * queued on managability_fifo owns its buffer until release_message.
+ *
+ * The pool is only used from the OOB service thread: mqtt_evt_handler
+ * runs from mqtt_input, so no locking is needed.
+ */
+struct pub_buf {
+	struct fifo_message fmsg;
+	uint16_t len;
+	uint8_t ref;
+	char data[MQTT_PUB_BUF_SIZE];
+};
+
+VAR_DEFINER_BSS struct pub_buf pub_buf_pool[MQTT_PUB_BUF_COUNT];
+
+/** Precompiled publish topic, built once per connection */
+struct pub_topic_desc {
+	char topic[MAX_MQTT_PUB_TOPIC_LEN];
+	uint32_t len;
+};
+
+/** Coalescing modes for a publish class */
+enum pub_coalesce {
+	/* Publish every message */
+	PUB_COALESCE_NONE,
+	/* Publish only if the value moved by more than delta */
+	PUB_COALESCE_DELTA,
+	/* Publish only the latest value per min_interval_ms */
+	PUB_COALESCE_LATEST
+};
+
+/** Publish policy of a message class */
+struct pub_policy {
+	enum mqtt_qos qos;
+	uint8_t retain;
+	uint32_t min_interval_ms;
+	enum pub_coalesce coalesce;
+	int32_t delta;
+};
+
+/** Policy table indexed by enum app_message_type. Commands, responses
+ * and events are one-shot and keep QoS1. Dynamic telemetry is latest
+ * value wins and is rate limited so it can not flood the broker.
+ */
+static const struct pub_policy pub_policies[API + 1] = {
+	[STATIC] = { MQTT_QOS_1_AT_LEAST_ONCE, 0, 0, PUB_COALESCE_NONE, 0 },
+	[DYNAMIC] = { MQTT_QOS_0_AT_MOST_ONCE, 0,
+		      CONFIG_OOB_TELEMETRY_MIN_INTERVAL,
+#if (CONFIG_OOB_TELEMETRY_DELTA > 0)
+		      PUB_COALESCE_DELTA,
+#else
+		      PUB_COALESCE_LATEST,
+#endif
+		      CONFIG_OOB_TELEMETRY_DELTA },
+	[EVENT] = { MQTT_QOS_1_AT_LEAST_ONCE, 0, 0, PUB_COALESCE_NONE, 0 },
+	[API] = { MQTT_QOS_1_AT_LEAST_ONCE, 0, 0, PUB_COALESCE_NONE, 0 }
+};
+
+/** Last published and pending value of a dynamic telemetry key */
+struct telemetry_state {
+	char key[MAX_TELEMETRY_KEY_LEN];
+	char value[MAX_TELEMETRY_VALUE_LEN];
+	char pending[MAX_TELEMETRY_VALUE_LEN];
+	int64_t last_ms;
+	bool has_pending;
+};
+
+/** Keys beyond MAX_TELEMETRY_KEYS share the last entry, so they are
+ * rate limited together instead of not at all.
+ */
+VAR_DEFINER_BSS struct telemetry_state telemetry[MAX_TELEMETRY_KEYS + 1];
+#define TELEMETRY_OVERFLOW (&telemetry[MAX_TELEMETRY_KEYS])
+
+/** Topic and payload caches indexed by enum app_message_type */
+VAR_DEFINER_BSS struct pub_topic_desc pub_topics[API + 1];
+VAR_DEFINER_BSS struct pub_payload_tmpl pub_tmpls[EVENT + 1];
 
 #if defined(CONFIG_NET_IPV6)
 VAR_DEFINER_BSS struct sockaddr_in6 *broker6;
@@ -141,6 +219,63 @@ static int tls_init(void)
 }
 #endif /* CONFIG_MQTT_LIB_TLS */
 
+/** Takes a free buffer from the pool
+ *
+ * @retval pointer to struct pub_buf with one reference, NULL if none
+ */
+static struct pub_buf *pub_buf_alloc(void)
+{
+	for (int i = 0; i < MQTT_PUB_BUF_COUNT; i++) {
+		if (pub_buf_pool[i].ref == 0) {
+			pub_buf_pool[i].ref = 1;
+			pub_buf_pool[i].len = 0;
+			pub_buf_pool[i].data[0] = '\0';
+			return &pub_buf_pool[i];
+		}
+	}
+
+	LOG_WRN("MQTT buffer pool exhausted");
+	return NULL;
+}
+
+/** Finds the pool buffer holding data, if any
+ *
+ * @param [in] data pointer to the start of a message
+ * @retval pointer to struct pub_buf, NULL if data is not pooled
+ */
+static struct pub_buf *pub_buf_from_data(const void *data)
+{
+	for (int i = 0; i < MQTT_PUB_BUF_COUNT; i++) {
+		if (data == (const void *)pub_buf_pool[i].data) {
+			return &pub_buf_pool[i];
+		}
+	}
+	return NULL;
+}
+
+static struct pub_buf *pub_buf_ref(struct pub_buf *buf)
+{
+	buf->ref++;
+	return buf;
+}
+
+static void pub_buf_unref(struct pub_buf *buf)
+{
+	if (buf != NULL && buf->ref > 0) {
+		buf->ref--;
+	}
+}
+
+void release_message(struct fifo_message *msg)
+{
+	for (int i = 0; i < MQTT_PUB_BUF_COUNT; i++) {
+		if (msg == &pub_buf_pool[i].fmsg) {
+			pub_buf_unref(&pub_buf_pool[i]);
+			return;
+		}
+	}
+}
+
 /** Sets the file descriptor used by mqtt socket connection
  * depending the transport chosen
  *
@@ -224,24 +359,57 @@ static void mqtt_process_receive(uint8_t *payload,
 				 uint32_t topic_len)
 {
 	enum oob_messages ret = IGNORE;
+	struct pub_buf *reply;
 	int res;
 
-	next_msg[BIG_GENERAL_BUF_SIZE - 1] = '\0';
-	size_t next_msg_size = sizeof(next_msg);
+	reply = pub_buf_alloc();
+	if (reply == NULL) {
+		LOG_ERR("No buffer to queue cloud message");
+		return;
+	}
 
 	ret = cloud_adapter.process_message(payload,
 					    payload_size,
 					    topic,
 					    topic_len,
-					    next_msg,
-					    next_msg_size);
+					    reply->data,
+					    sizeof(reply->data));
 	if (ret != IGNORE) {
-		fmessage.next_msg = next_msg;
-		fmessage.current_msg_type = ret;
-		res = k_fifo_alloc_put(&managability_fifo, &fmessage);
-		if (res != 0) {
-			LOG_ERR("k_fifo_alloc_put failed, ret = %d\n", res);
+		reply->data[sizeof(reply->data) - 1] = '\0';
+		reply->len = strlen(reply->data);
+		reply->fmsg.next_msg = (uint8_t *)reply->data;
+		reply->fmsg.current_msg_type = ret;
+
+		/* On success the fifo entry owns the buffer */
+		res = k_fifo_alloc_put(&managability_fifo, &reply->fmsg);
+		if (res == 0) {
+			return;
 		}
+		LOG_ERR("k_fifo_alloc_put failed, ret = %d\n", res);
+	}
+
+	pub_buf_unref(reply);
+}
+
+/** Drops a received payload that does not fit into a pool buffer,
+ * so that the MQTT stream stays in sync.
+ *
+ * @param [in] client pointer to struct mqtt_client
+ * @param [in] len payload length
+ */
+static void mqtt_discard_payload(struct mqtt_client *const client,
+				 uint32_t len)
+{
+	uint8_t discard[SMALL_BUFFER];
+	int rc;
+
+	while (len > 0) {
+		rc = mqtt_read_publish_payload_blocking(
+			client, discard, MIN(len, sizeof(discard)));
+		if (rc <= 0) {
+			break;
+		}
+		len -= rc;
 	}
 }
 
@@ -335,35 +503,42 @@ void mqtt_evt_handler(struct mqtt_client *const client,
 			break;
 		}
 
-		uint8_t buf[XL_LARGE_BUFFER];
-		int rc_mqtt_read = -1;
-
-		memset(buf, 0x00, XL_LARGE_BUFFER);
+		uint32_t len = evt->param.publish.message.payload.len;
+		struct pub_buf *rx = pub_buf_alloc();
 
 		LOG_DBG("[%s:%d] EVT_PUBLISH packet id: %u\n",
 			__func__, __LINE__,
 			evt->param.pubcomp.message_id);
 
-		do {
-			rc_mqtt_read = mqtt_read_publish_payload(
-				client,
-				buf,
-				evt->param.publish.message.payload.len);
-		} while (rc_mqtt_read > 0);
+		if (rx == NULL || len >= sizeof(rx->data)) {
+			LOG_ERR("Dropping %u byte payload", len);
+			mqtt_discard_payload(client, len);
+			pub_buf_unref(rx);
+			break;
+		}
 
-		buf[evt->param.publish.message.payload.len] = '\0';
+		if (mqtt_readall_publish_payload(client,
+						 (uint8_t *)rx->data,
+						 len) != 0) {
+			LOG_ERR("Failed to read %u byte payload", len);
+			pub_buf_unref(rx);
+			break;
+		}
+		rx->data[len] = '\0';
+		rx->len = len;
 
 		LOG_INF(
 			"MQTT callback received message: %s on topic: %s",
-			log_strdup(buf),
+			log_strdup(rx->data),
 			log_strdup(evt->param.publish.message.topic.topic.utf8));
 
 		mqtt_process_receive(
-			buf,
-			(uint32_t)evt->param.publish.message.payload.len,
+			(uint8_t *)rx->data,
+			len,
 			(uint8_t *)evt->param.publish.message.topic.topic.utf8,
 			(uint32_t)evt->param.publish.message.topic.topic.size
 			);
+		pub_buf_unref(rx);
 
 		memset((uint8_t *)evt->param.publish.message.topic.topic.utf8,
 		       0x00,
@@ -376,11 +551,64 @@ void mqtt_evt_handler(struct mqtt_client *const client,
 	}
 }
 
+/** Inner function to build publish topics and payload templates once
+ * per connection. Anything the adapter can not express as a fixed
+ * topic or template is left invalid and formatted on every publish.
+ */
+static void pub_cache_init(void)
+{
+	const char *topic;
+	size_t len;
+	int rc;
+
+	memset(pub_topics, 0x00, sizeof(pub_topics));
+	memset(pub_tmpls, 0x00, sizeof(pub_tmpls));
+
+	/* API topics carry the request id and are built per request */
+	for (int type = STATIC; type < API; type++) {
+		topic = cloud_adapter.get_mqtt_pub_topic(type);
+		if (topic == NULL) {
+			continue;
+		}
+
+		len = strlen(topic);
+		if (len >= MAX_MQTT_PUB_TOPIC_LEN) {
+			LOG_ERR("Publish topic %d too long: %u", type,
+				(uint32_t)len);
+			continue;
+		}
+		memcpy(pub_topics[type].topic, topic, len);
+		pub_topics[type].len = (uint32_t)len;
+	}
+
+	cloud_adapter.prep_static_attrib_pub_msg(pub_tmpls[STATIC].skel,
+						 sizeof(pub_tmpls[STATIC].skel),
+						 PUB_TMPL_SLOT_0,
+						 PUB_TMPL_SLOT_1);
+	rc = pub_tmpl_compile(&pub_tmpls[STATIC], 2);
+	if (rc) {
+		LOG_ERR("Attribute payload template rejected: %d", rc);
+	}
+
+	cloud_adapter.prep_event_pub_msg(pub_tmpls[EVENT].skel,
+					 sizeof(pub_tmpls[EVENT].skel),
+					 PUB_TMPL_SLOT_0);
+	rc = pub_tmpl_compile(&pub_tmpls[EVENT], 1);
+	if (rc) {
+		LOG_ERR("Event payload template rejected: %d", rc);
+	}
+}
+
 /** Inner function to prepare messages that the application publishes
- * The application passed a pre-allocated buffer to cloud adapter
- * and packages it in mqtt struct mqtt_publish_msg
+ * The payload is formatted straight into a pool buffer and packaged
+ * in mqtt struct mqtt_publish_msg. An API message which already sits
+ * in a pool buffer is published in place. Topics and payload skeletons
+ * cached at connect are used when available.
+ *
+ * The caller has to pub_buf_unref *buf once mqtt_publish returned.
  *
  * @param [in] pointer to struct mqtt_publish_param
+ * @param [out] buf pointer to the struct pub_buf holding the payload
  * @param [in] key char pointer
  * @param [in] value char pointer
  * @param [in] eventmsg char pointer
@@ -389,6 +617,7 @@ void mqtt_evt_handler(struct mqtt_client *const client,
  * @retval non-zero on errro
  */
 static int prepare_mqtt_pub_msg(struct mqtt_publish_param *param,
+				struct pub_buf **buf,
 				const char *key,
 				const char *value,
 				const char *eventmsg,
@@ -396,9 +625,50 @@ static int prepare_mqtt_pub_msg(struct mqtt_publish_param *param,
 				enum app_message_type type)
 {
 
-	size_t msg_buf_size = sizeof(char) * BIG_GENERAL_BUF_SIZE;
+	const char *values[MAX_MQTT_PUB_TMPL_SLOTS] = { key, value };
+	enum app_message_type tmpl_type = type;
+	struct pub_buf *pbuf;
+	uint32_t msg_len = 0;
+	size_t msg_buf_size;
+	char *msg_buf;
+	char *topic;
+
+	*buf = NULL;
+
+	if (type == API) {
+		pbuf = pub_buf_from_data(api_msg);
+		if (pbuf != NULL) {
+			*buf = pub_buf_ref(pbuf);
+			msg_len = pbuf->len;
+		}
+	}
 
-	if (type == STATIC) {
+	if (*buf == NULL) {
+		*buf = pub_buf_alloc();
+		if (*buf == NULL) {
+			return -ENOMEM;
+		}
+	}
+
+	msg_buf = (*buf)->data;
+	msg_buf_size = sizeof((*buf)->data);
+
+	if (type == EVENT) {
+		values[0] = eventmsg;
+	} else if (type == DYNAMIC) {
+		/* Dynamic telemetry shares the key/value payload format */
+		tmpl_type = STATIC;
+	}
+
+	if (tmpl_type != API && pub_tmpls[tmpl_type].valid) {
+		msg_len = pub_tmpl_fill(&pub_tmpls[tmpl_type], values,
+					msg_buf, msg_buf_size);
+		if (msg_len == 0) {
+			LOG_ERR("Publish payload bigger than target size:%d",
+				msg_buf_size);
+			goto err;
+		}
+	} else if (tmpl_type == STATIC) {
 		cloud_adapter.prep_static_attrib_pub_msg(msg_buf,
 							 msg_buf_size,
 							 key, value);
@@ -406,7 +676,7 @@ static int prepare_mqtt_pub_msg(struct mqtt_publish_param *param,
 		cloud_adapter.prep_event_pub_msg(msg_buf,
 						 msg_buf_size,
 						 eventmsg);
-	} else if (type == API) {
+	} else if (type == API && api_msg != msg_buf) {
 
 		/* Overflow check-prevention*/
 		size_t api_msg_size = strlen(api_msg) + 1;
@@ -416,26 +686,61 @@ static int prepare_mqtt_pub_msg(struct mqtt_publish_param *param,
 				"Src buffer api_msg size:%d bigger than target size:%d",
 				api_msg_size,
 				msg_buf_size);
-			return OOB_ERR_BUFFER_OVERFLOW;
+			goto err;
 		}
 		memcpy(msg_buf, api_msg, api_msg_size);
 		msg_buf[msg_buf_size - 1] = '\0';
+		msg_len = (uint32_t)(api_msg_size - 1);
+	}
+
+	if (msg_len == 0) {
+		msg_len = (uint32_t)strlen(msg_buf);
 	}
 
-	(param->message).topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
-	(param->message).topic.topic.utf8 =
-		(uint8_t *)cloud_adapter.get_mqtt_pub_topic(type);
-	(param->message).topic.topic.size =
-		(uint32_t)strlen(
-			(uint8_t *)cloud_adapter.get_mqtt_pub_topic(type));
+	(param->message).topic.qos = pub_policies[type].qos;
+	if (pub_topics[type].len != 0) {
+		(param->message).topic.topic.utf8 =
+			(uint8_t *)pub_topics[type].topic;
+		(param->message).topic.topic.size = pub_topics[type].len;
+	} else {
+		topic = cloud_adapter.get_mqtt_pub_topic(type);
+		if (topic == NULL) {
+			pub_buf_unref(*buf);
+			*buf = NULL;
+			return -EINVAL;
+		}
+		(param->message).topic.topic.utf8 = (uint8_t *)topic;
+		(param->message).topic.topic.size = (uint32_t)strlen(topic);
+	}
 	(param->message).payload.data = (uint8_t *)(msg_buf);
-	(param->message).payload.len =
-		(uint32_t)strlen((param->message).payload.data);
+	(param->message).payload.len = msg_len;
 	param->message_id = sys_rand32_get();
 	param->dup_flag = 0;
-	param->retain_flag = 0;
+	param->retain_flag = pub_policies[type].retain;
 
 	return OOB_SUCCESS;
+
+err:
+	pub_buf_unref(*buf);
+	*buf = NULL;
+	return OOB_ERR_BUFFER_OVERFLOW;
+}
+
+/** Inner helper function called after mqtt_publish. QoS0 messages
+ * expect no acknowledgment, so the poll for the broker response is
+ * skipped for them.
+ *
+ * @retval 0 on success
+ * @retval -EIO
+ */
+static int publish_wait_ack(void)
+{
+	if (param.message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		return OOB_SUCCESS;
+	}
+
+	wait(APP_SLEEP_MSECS);
+	return mqtt_input(&client);
 }
 
 /** Inner helper function thats gets called by send
@@ -452,11 +757,13 @@ static int prepare_mqtt_pub_msg(struct mqtt_publish_param *param,
  */
 int publish_event(char *msg)
 {
+	struct pub_buf *buf;
 	int rc;
 
 	memset(&param, 0x00, sizeof(struct mqtt_publish_param));
 
 	rc = prepare_mqtt_pub_msg(&param,
+				  &buf,
 				  NULL,
 				  NULL,
 				  msg,
@@ -473,15 +780,14 @@ int publish_event(char *msg)
 
 	rc = mqtt_publish(&client, &param);
 	PRINT_RESULT("mqtt_publish", rc);
+	pub_buf_unref(buf);
 
 	if (rc != OOB_SUCCESS) {
 		LOG_ERR("mqtt_publish error: %d", rc);
 		return rc;
 	}
 
-	wait(APP_SLEEP_MSECS);
-	rc = mqtt_input(&client);
-	return rc;
+	return publish_wait_ack();
 }
 
 /** Inner helper function thats gets called by send
@@ -498,11 +804,13 @@ int publish_event(char *msg)
  */
 int publish_api(char *msg)
 {
+	struct pub_buf *buf;
 	int rc;
 
 	memset(&param, 0x00, sizeof(struct mqtt_publish_param));
 
 	rc = prepare_mqtt_pub_msg(&param,
+				  &buf,
 				  NULL,
 				  NULL,
 				  NULL,
@@ -519,15 +827,14 @@ int publish_api(char *msg)
 
 	rc = mqtt_publish(&client, &param);
 	PRINT_RESULT("mqtt_publish", rc);
+	pub_buf_unref(buf);
 
 	if (rc != OOB_SUCCESS) {
 		LOG_ERR("mqtt_publish error: %d", rc);
 		return rc;
 	}
 
-	wait(APP_SLEEP_MSECS);
-	rc = mqtt_input(&client);
-	return rc;
+	return publish_wait_ack();
 }
 
 /** Inner helper function thats gets called by send_telemetry
@@ -545,11 +852,13 @@ int publish_api(char *msg)
 int publish_static(char *key,
 		   char *value)
 {
+	struct pub_buf *buf;
 	int rc;
 
 	memset(&param, 0x00, sizeof(struct mqtt_publish_param));
 
 	rc = prepare_mqtt_pub_msg(&param,
+				  &buf,
 				  key,
 				  value,
 				  NULL,
@@ -567,15 +876,166 @@ int publish_static(char *key,
 
 	rc = mqtt_publish(&client, &param);
 	PRINT_RESULT("mqtt_publish", rc);
+	pub_buf_unref(buf);
 
 	if (rc != OOB_SUCCESS) {
 		LOG_ERR("mqtt_publish error: %d", rc);
 		return rc;
 	}
 
-	wait(APP_SLEEP_MSECS);
-	rc = mqtt_input(&client);
-	return rc;
+	return publish_wait_ack();
+}
+
+/** Inner function to find the coalescing state of a telemetry key,
+ * allocating a free entry on first use.
+ *
+ * @param [in] key char pointer
+ * @retval pointer to struct telemetry_state, the shared overflow entry
+ * if the table is full or the key too long
+ */
+static struct telemetry_state *telemetry_state_get(const char *key)
+{
+	struct telemetry_state *free_st = NULL;
+
+	for (int i = 0; i < MAX_TELEMETRY_KEYS; i++) {
+		if (telemetry[i].key[0] == '\0') {
+			if (free_st == NULL) {
+				free_st = &telemetry[i];
+			}
+			continue;
+		}
+		if (!strncmp(telemetry[i].key, key, MAX_TELEMETRY_KEY_LEN)) {
+			return &telemetry[i];
+		}
+	}
+
+	if (free_st == NULL || strlen(key) >= MAX_TELEMETRY_KEY_LEN) {
+		return TELEMETRY_OVERFLOW;
+	}
+
+	strcpy(free_st->key, key);
+	return free_st;
+}
+
+/** Inner function to apply the publish policy to a telemetry value
+ *
+ * @param [in] policy pointer to struct pub_policy
+ * @param [in] st pointer to struct telemetry_state
+ * @param [in] value char pointer
+ * @param [in] now uptime in millisecs
+ * @retval true if the value has to be published now
+ */
+static bool telemetry_publish_due(const struct pub_policy *policy,
+				  const struct telemetry_state *st,
+				  const char *value,
+				  int64_t now)
+{
+	char *end_new, *end_old;
+	long new_val, old_val;
+
+	if (st->value[0] == '\0') {
+		return true;
+	}
+
+	if (now - st->last_ms < policy->min_interval_ms) {
+		return false;
+	}
+
+	/* Overflow entry keeps no last value per key to compare with */
+	if (policy->coalesce != PUB_COALESCE_DELTA ||
+	    st == TELEMETRY_OVERFLOW) {
+		return true;
+	}
+
+	new_val = strtol(value, &end_new, 10);
+	old_val = strtol(st->value, &end_old, 10);
+	if (end_new == value || end_old == st->value) {
+		/* Non numeric values only go out on change */
+		return strncmp(st->value, value, MAX_TELEMETRY_VALUE_LEN) != 0;
+	}
+
+	return labs(new_val - old_val) > policy->delta;
+}
+
+/** Inner helper function thats gets called by send_telemetry
+ * if app_message_type is DYNAMIC. The value is rate limited and
+ * coalesced as per pub_policies before it is published.
+ *
+ * @param [in] key char pointer
+ * @param [in] value char pointer
+ *
+ * @retval 0 on success or when the value got coalesced
+ * @retval -EINVAL
+ * @retval -ENOMEM
+ * @retval -EIO
+ */
+int publish_dynamic(char *key,
+		    char *value)
+{
+	const struct pub_policy *policy = &pub_policies[DYNAMIC];
+	struct telemetry_state *st;
+	int64_t now = k_uptime_get();
+	struct pub_buf *buf;
+	int rc;
+
+	st = telemetry_state_get(key);
+
+	/* Overflow keys take turns, while one is held back the others
+	 * are dropped.
+	 */
+	if (st == TELEMETRY_OVERFLOW && st->has_pending &&
+	    strncmp(st->key, key, MAX_TELEMETRY_KEY_LEN) != 0) {
+		return OOB_SUCCESS;
+	}
+
+	if (!telemetry_publish_due(policy, st, value, now)) {
+		if ((policy->coalesce == PUB_COALESCE_LATEST ||
+		     st == TELEMETRY_OVERFLOW) &&
+		    strlen(key) < MAX_TELEMETRY_KEY_LEN &&
+		    strlen(value) < MAX_TELEMETRY_VALUE_LEN) {
+			/* key is st->key itself when flushed */
+			if (st->key != key) {
+				strcpy(st->key, key);
+			}
+			strcpy(st->pending, value);
+			st->has_pending = true;
+		}
+		return OOB_SUCCESS;
+	}
+
+	memset(&param, 0x00, sizeof(struct mqtt_publish_param));
+
+	rc = prepare_mqtt_pub_msg(&param,
+				  &buf,
+				  key,
+				  value,
+				  NULL,
+				  NULL,
+				  DYNAMIC);
+
+	if (rc != OOB_SUCCESS) {
+		return rc;
+	}
+
+	LOG_DBG("Publishing dynamic telmetry: key:<%s, %s> with packet_id: %u",
+		key,
+		value,
+		param.message_id);
+
+	rc = mqtt_publish(&client, &param);
+	PRINT_RESULT("mqtt_publish", rc);
+	pub_buf_unref(buf);
+
+	if (rc != OOB_SUCCESS) {
+		LOG_ERR("mqtt_publish error: %d", rc);
+		return rc;
+	}
+
+	strncpy(st->value, value, MAX_TELEMETRY_VALUE_LEN - 1);
+	st->last_ms = now;
+	st->has_pending = false;
+
+	return publish_wait_ack();
 }
 
 /** Function thats gets called from ehl_oob_main to send messages of type
@@ -602,7 +1062,6 @@ int post_message(char *payload, enum app_message_type type)
 /** Function thats gets called from ehl_oob_main to send messages of
  * app_message_type: STATIC, DYNAMIC.
  * Calls lower level functions publish_static and publish_dynamic
- * in future
  *
  * @param [in] key char pointer
  * @param [in] value char pointer
@@ -617,10 +1076,42 @@ int send_telemetry(char *key, char *value, enum app_message_type type)
 {
 	if (type == STATIC) {
 		return publish_static(key, value);
+	} else if (type == DYNAMIC) {
+		return publish_dynamic(key, value);
 	}
 	return -EINVAL;
 }
 
+/** Function thats gets called from ehl_oob_main on every mqtt live
+ * tick to publish dynamic telemetry values held back by coalescing
+ * once their interval has elapsed.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL
+ * @retval -ENOMEM
+ * @retval -EIO
+ */
+int flush_telemetry(void)
+{
+	int64_t now = k_uptime_get();
+	int rc = OOB_SUCCESS;
+
+	for (int i = 0; i < ARRAY_SIZE(telemetry); i++) {
+		if (!telemetry[i].has_pending ||
+		    now - telemetry[i].last_ms <
+		    pub_policies[DYNAMIC].min_interval_ms) {
+			continue;
+		}
+
+		rc = publish_dynamic(telemetry[i].key, telemetry[i].pending);
+		if (rc != OOB_SUCCESS) {
+			break;
+		}
+	}
+
+	return rc;
+}
+
 /** Function thats gets called from client_init
  * to set the broker context
  */
@@ -856,6 +1347,8 @@ int device_cloud_connect(void)
 
 	try_to_connect();
 
+	pub_cache_init();
+
 	sub_list_p = set_subscription_topics();
 
 	for (int i = 0; i < sub_list_p->list_count; i++) {
@@ -70,6 +70,22 @@ extern VAR_DEFINER_BSS struct mqtt_client client;
 /** Max length for MQTT_SUB_TOPIC */
 #define MAX_MQTT_SUBS_TOPIC_LEN         200
 
+/** Max length for a cached MQTT publish topic */
+#define MAX_MQTT_PUB_TOPIC_LEN          SMALL_BUFFER
+
+/** Message buffer pool: every command pending in ehl-oob main holds
+ * its queued reply. One more buffer takes the payload being received,
+ * it is released as soon as the adapter has built the reply, and one
+ * the publish in flight from ehl-oob main (telemetry, event or reply).
+ */
+#define MQTT_PUB_BUF_SIZE               BIG_GENERAL_BUF_SIZE
+#define MQTT_PUB_BUF_COUNT              (CONFIG_OOB_MQTT_PENDING_CMDS + 2)
+
+/** Dynamic telemetry keys tracked for coalescing */
+#define MAX_TELEMETRY_KEYS              8
+#define MAX_TELEMETRY_KEY_LEN           32
+#define MAX_TELEMETRY_VALUE_LEN         32
+
 /** Function thats gets called from ehl_oob_main to send messages of type
  * EVENT, API. Calls lower level functions publish_event, publish_api
  *
@@ -85,7 +101,8 @@ int post_message(char *payload, enum app_message_type type);
 
 /** Function thats gets called from ehl_oob_main to send messages of
  * app_message_type: STATIC, DYNAMIC. Calls lower level functions
- * publish_static and publish_dynamic in future
+ * publish_static and publish_dynamic. DYNAMIC telemetry is rate limited
+ * and coalesced, see CONFIG_OOB_TELEMETRY_MIN_INTERVAL.
  *
  * @param [in] key char pointer
  * @param [in] value char pointer
@@ -98,6 +115,24 @@ int post_message(char *payload, enum app_message_type type);
  */
 int send_telemetry(char *key, char *value, enum app_message_type type);
 
+/** Function thats gets called from ehl_oob_main on every mqtt live
+ * tick to publish coalesced DYNAMIC telemetry that is due
+ *
+ * @retval 0 on success
+ * @retval -EINVAL
+ * @retval -ENOMEM
+ * @retval -EIO
+ */
+int flush_telemetry(void);
+
+/** Function thats gets called from ehl_oob_main once it is done with
+ * a message taken from managability_fifo. It returns the message
+ * buffer to the pool, messages not owned by the pool are ignored.
+ *
+ * @param [in] msg pointer to struct fifo_message
+ */
+void release_message(struct fifo_message *msg);
+
 /** Function device cloud init request
  *
  * @param[in] void
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file mqtt_pub_tmpl.c
+ *
+ * \brief This file contains the compile and fill steps of the mqtt
+ * client publish payload templates.
+ *
+ * \see mqtt_pub_tmpl.h
+ *
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "mqtt_pub_tmpl.h"
+
+int pub_tmpl_compile(struct pub_payload_tmpl *tmpl, uint8_t slot_count)
+{
+	uint16_t start = 0;
+	uint8_t slot = 0;
+	uint16_t len;
+	uint16_t i;
+	char c;
+
+	tmpl->valid = false;
+	tmpl->slot_count = slot_count;
+
+	/* snprintf truncation leaves the buffer full and terminated */
+	len = strnlen(tmpl->skel, sizeof(tmpl->skel));
+	if (len >= sizeof(tmpl->skel) - 1) {
+		return -E2BIG;
+	}
+
+	for (i = 0; i < len; i++) {
+		c = tmpl->skel[i];
+		if (c < PUB_TMPL_SLOT_0[0] || c > PUB_TMPL_SLOT_1[0]) {
+			continue;
+		}
+		/* Slots must appear once each, in order */
+		if (slot == slot_count || c != PUB_TMPL_SLOT_0[0] + slot) {
+			return -EINVAL;
+		}
+		tmpl->seg_off[slot] = start;
+		tmpl->seg_len[slot] = i - start;
+		start = i + 1;
+		slot++;
+	}
+
+	if (slot != slot_count) {
+		return -EINVAL;
+	}
+
+	tmpl->seg_off[slot] = start;
+	tmpl->seg_len[slot] = len - start;
+	tmpl->valid = true;
+
+	return 0;
+}
+
+uint32_t pub_tmpl_fill(const struct pub_payload_tmpl *tmpl,
+		       const char *const values[],
+		       char *buf,
+		       size_t buf_size)
+{
+	uint32_t pos = 0;
+	size_t len;
+
+	for (uint8_t i = 0; i <= tmpl->slot_count; i++) {
+		len = tmpl->seg_len[i];
+		if (pos + len >= buf_size) {
+			return 0;
+		}
+		memcpy(&buf[pos], &tmpl->skel[tmpl->seg_off[i]], len);
+		pos += len;
+
+		if (i == tmpl->slot_count) {
+			break;
+		}
+
+		len = strlen(values[i]);
+		if (pos + len >= buf_size) {
+			return 0;
+		}
+		memcpy(&buf[pos], values[i], len);
+		pos += len;
+	}
+	buf[pos] = '\0';
+
+	return pos;
+}
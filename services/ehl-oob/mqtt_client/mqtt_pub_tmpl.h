@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file mqtt_pub_tmpl.h
+ *
+ * \brief This file contains the publish payload templates used by the
+ * mqtt client. The cloud adapter formats a payload once at connect
+ * with slot markers in place of the values; the skeleton is split into
+ * fixed segments so steady-state publishes only copy segments and
+ * values, without any format string parsing.
+ *
+ */
+
+#ifndef _MQTT_PUB_TMPL_H_
+#define _MQTT_PUB_TMPL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+/** Max no of variable slots in a cached publish payload template */
+#define MAX_MQTT_PUB_TMPL_SLOTS         2
+
+/** Max length of a payload skeleton */
+#define MAX_MQTT_PUB_TMPL_LEN           256
+
+/** Markers passed to the adapter in place of the values when the
+ * payload templates are compiled. They are split out again to find
+ * the fixed segments around each slot.
+ */
+#define PUB_TMPL_SLOT_0 "\x01"
+#define PUB_TMPL_SLOT_1 "\x02"
+
+/** Precompiled payload skeleton, split in fixed segments around slots */
+struct pub_payload_tmpl {
+	char skel[MAX_MQTT_PUB_TMPL_LEN];
+	uint16_t seg_off[MAX_MQTT_PUB_TMPL_SLOTS + 1];
+	uint16_t seg_len[MAX_MQTT_PUB_TMPL_SLOTS + 1];
+	uint8_t slot_count;
+	bool valid;
+};
+
+/**
+ * Split the skeleton in tmpl->skel into fixed segments around its slot
+ * markers. tmpl->valid is only set if every slot appears once, in
+ * order. A skeleton filling the whole buffer can not be told apart
+ * from one the adapter truncated and is rejected.
+ *
+ * @param [in][out] tmpl pointer to struct pub_payload_tmpl
+ * @param [in] slot_count number of slots expected in the skeleton
+ * @retval 0 on success, -E2BIG if the skeleton does not fit,
+ *         -EINVAL if the slots do not match
+ **/
+int pub_tmpl_compile(struct pub_payload_tmpl *tmpl, uint8_t slot_count);
+
+/**
+ * Patch values into a compiled payload template
+ *
+ * @param [in] tmpl pointer to struct pub_payload_tmpl
+ * @param [in] values one string per slot
+ * @param [in][out] buf output buffer
+ * @param [in] buf_size size of output buffer
+ * @retval length of the payload, 0 on overflow
+ **/
+uint32_t pub_tmpl_fill(const struct pub_payload_tmpl *tmpl,
+		       const char *const values[],
+		       char *buf,
+		       size_t buf_size);
+
+#endif
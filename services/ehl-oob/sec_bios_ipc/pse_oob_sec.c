@@ -97,6 +97,15 @@ SEC_RTN unsigned int sec_get_pxy_host_port(
 	return sec_int_get_pxy_host_port(p_sec_data);
 };
 
+SEC_RTN unsigned int sec_get_credentials(
+	SEC_INOUT struct sec_cred_item *p_items,
+	SEC_IN unsigned int count
+	)
+{
+
+	return sec_int_get_credentials(p_items, count);
+};
+
 SEC_RTN unsigned int sec_set_reprovision(
 	SEC_IN void *p_sec_data,
 	SEC_IN unsigned int sec_len,
@@ -315,6 +315,30 @@ SEC_RTN unsigned int sec_get_pxy_host_port(
 	 */
 	);
 
+/*
+ * Get a snapshot of the cloud login credentials in one call.
+ * The context is locked once and every segment it touches is
+ * verified once, each field is copied straight into the buffer
+ * of its item.
+ *
+ * return:
+ * SEC_FAILED_INVALID_PARAM_LEN - A field is larger than the
+ * buffer of its item
+ * SEC_FAILED_OOB_HASH_MISMATCH - Context integrity check failed
+ * SEC_SUCCESS - All items are returned successfully
+ * SEC_FAILED - An item is failed to return, see its result
+ */
+SEC_RTN unsigned int sec_get_credentials(
+	SEC_INOUT struct sec_cred_item *p_items,
+	/* Items to fetch. For each item the calling function sets
+	 * type, p_data and the size of p_data in len. The field
+	 * length and status are updated in len and result.
+	 */
+	SEC_IN unsigned int count
+	/* Number of items.
+	 */
+	);
+
 /*
  *   Update DEVICE_ID, TOKEN_ID, CLD_HOST_URL, CLD_HOST_PORT,
  *   PXY_HOST_URL, or PXY_HOST_PORT. More than one call to this
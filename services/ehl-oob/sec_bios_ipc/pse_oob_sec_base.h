@@ -32,6 +32,16 @@
 
 #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
 extern void *unit_test_param[SEC_UNIT_TEST_PARAM_SIZE];
+/* Mock sideband DRNG, the fixed test pattern is returned when NULL */
+extern unsigned int (*unit_test_drng_read)(void);
+/* Work counters, tests assert on these rather than on elapsed time */
+extern unsigned int unit_test_key_setups;
+extern unsigned int unit_test_hash_bytes;
+extern unsigned int unit_test_seg_hashes;
+unsigned int unit_test_drng_healthy(void);
+int test_sideband_drng_pool(void);
+int test_sec_hc_replay(void);
+int test_sec_hc_crypto_soak(void);
 #if (defined(_WIN32) && _WIN32)
 #define SEC_ASSERT(condition) do {			  \
 		if (!(condition)) {			  \
@@ -50,9 +60,7 @@ extern void *unit_test_param[SEC_UNIT_TEST_PARAM_SIZE];
 			result = SEC_FAILED;		  \
 		} } while (0)
 #endif  /* #if (defined(_WIN32) && _WIN32) */
-#endif  /* SEC_UNIT_TEST */
-
-#if defined SEC_DEBUG
+#elif defined SEC_DEBUG
 #define SEC_ASSERT(condition) do {				  \
 		if (!condition)					  \
 			break;					  \
@@ -66,7 +74,7 @@ extern void *unit_test_param[SEC_UNIT_TEST_PARAM_SIZE];
 	printk("SEC Assertion: "		     \
 	       "Failed at %s: line %d, Param: %d\n", \
 	       __func__, __LINE__, condition);
-#endif /* SEC_DEBUG */
+#endif /* SEC_UNIT_TEST */
 
 /**
  * Multi-threads or Tasks Support
@@ -99,6 +107,7 @@ extern void *unit_test_param[SEC_UNIT_TEST_PARAM_SIZE];
 #define SEC_FAILED_INVALID_PARAM 2
 #define SEC_FAILED_INVALID_PARAM_LEN 3
 #define SEC_FAILED_INVALID_PARAM_VAL 4
+#define SEC_FAILED_BUSY 5
 
 /**
  * Alias for specific error code
@@ -47,6 +47,24 @@ enum sec_info_type {
 	SEC_PROV_STATE
 };
 
+/*
+ * This defines the credentials returned
+ * by a bulk credential fetch, see
+ * sec_get_credentials().
+ */
+enum sec_cred_type {
+	SEC_CRED_CLD_ADAPTER,
+	SEC_CRED_TOK_ID,
+	SEC_CRED_DEV_ID,
+	SEC_CRED_MQTT_CLIENT_ID,
+	SEC_CRED_CLD_HOST_URL,
+	SEC_CRED_CLD_HOST_PORT,
+	SEC_CRED_PXY_HOST_URL,
+	SEC_CRED_PXY_HOST_PORT,
+	SEC_CRED_ROOT_CA,
+	SEC_CRED_MAX
+};
+
 /*
  * This is a flag indicating
  * a decommissioned/reprovisioned
@@ -7,13 +7,12 @@
 #include "mbedtls/sha256.h"     /* SHA-256 only */
 #include "mbedtls/md.h"         /* generic interface */
 #include "mbedtls/gcm.h"        /* mbedtls_gcm_context */
-#include "mbedtls/entropy.h"
-#include "mbedtls/ctr_drbg.h"
 #include "mbedtls/hkdf.h"
 
 #include <device.h>
 #include <init.h>
 #include <string.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <sys/printk.h>
 #include <logging/log.h>
@@ -28,7 +27,9 @@
 
 LOG_MODULE_REGISTER(OOB_SEC_HC, CONFIG_OOB_LOGGING);
 
-K_HEAP_DEFINE(oob_sec_hc_heap, SEC_HC_HEAP_SIZE);
+/* Fixed work buffers for encrypt/decrypt, no heap on the crypto path */
+K_MEM_SLAB_DEFINE(sec_hc_crypto_slab, SEC_HC_CRYPTO_BUF_SIZE,
+		  SEC_HC_CRYPTO_BUF_NUM, 4);
 
 /* sec heci thread id */
 k_tid_t sec_hc_thread_id;
@@ -74,10 +75,13 @@ static uint32_t sec_hc_conn_id;
 static uint32_t sec_hc_prev_command_id;
 static bool sec_hc_abort_set;
 
-typedef struct {
-	mbedtls_gcm_context gcm;
-} SEC_HC_CIPHER_T;
-SEC_HC_CIPHER_T sec_hc_cipher_t;
+/* HKDF info label of each cached key purpose */
+static const char *const sec_hc_key_label[SEC_KEY_PURPOSE_MAX] = {
+	[SEC_KEY_TOK_ID] = "TOK_ENC_KEY",
+	[SEC_KEY_DEV_ID] = "DEV_ENC_KEY",
+	[SEC_KEY_MQTT_CLIENT_ID] = "MQTT_ID_ENC_KEY",
+	[SEC_KEY_CLOUD_HASH] = "CLD_HASH_ENC_KEY",
+};
 
 typedef struct {
 	/* Packet variable*/
@@ -104,6 +108,7 @@ typedef struct {
 	unsigned int a_cse_seed_no;
 } SEC_HC_CSE_SEED;
 SEC_HC_CSE_SEED sec_hc_cse_seed;
+static unsigned char sec_hc_cse_seed_buf[MAX_CSE_SEED_NO][SEC_CSE_SEED_LEN];
 
 static bool sec_hc_seed_updated;
 /* ================================================================= */
@@ -148,7 +153,7 @@ static void sec_hc_rel_cse_seed(void)
 		sec_hc_cse_seed.a_cse_seed_no);
 	for (int seed_idx = 0; seed_idx < sec_hc_cse_seed.a_cse_seed_no;
 	     seed_idx++) {
-		k_heap_free(&oob_sec_hc_heap, sec_hc_cse_seed.a_cse_seed[seed_idx]);
+		memset(sec_hc_cse_seed_buf[seed_idx], 0, SEC_CSE_SEED_LEN);
 		sec_hc_cse_seed.a_cse_seed[seed_idx] = NULL;
 		LOG_INF("Free seed index: %d\n", seed_idx);
 	}
@@ -168,15 +173,7 @@ int sec_hc_process_cse_seed(void *p_sec_data, int idx, int data_len)
 			__func__, __LINE__, idx);
 		return SEC_FAILED;
 	}
-	sec_hc_cse_seed.a_cse_seed[idx] = (unsigned char *)k_heap_alloc(&oob_sec_hc_heap,
-							SEC_CSE_SEED_LEN * sizeof(char),
-							K_NO_WAIT);
-
-	if (sec_hc_cse_seed.a_cse_seed[idx] == NULL) {
-		LOG_DBG("[%s:%d] Memory Allocation Failed!\n",
-			__func__, __LINE__);
-		return SEC_FAILED;
-	}
+	sec_hc_cse_seed.a_cse_seed[idx] = sec_hc_cse_seed_buf[idx];
 	memcpy(sec_hc_cse_seed.a_cse_seed[idx], p_sec_data, SEC_CSE_SEED_LEN);
 	sec_hc_cse_seed.a_cse_seed_no = sec_hc_cse_seed.a_cse_seed_no + 1;
 	sec_hc_print_context_param("sec_hc_cse_seed.a_cse_seed[idx]",
@@ -186,6 +183,87 @@ int sec_hc_process_cse_seed(void *p_sec_data, int idx, int data_len)
 	return SEC_SUCCESS;
 }
 
+/* How a credential data item is stored in the sec context */
+enum sec_hc_data_kind {
+	/* sec_int_set_* setter with length */
+	SEC_HC_DATA_SET,
+	/* sec_int_set_* setter of a single value */
+	SEC_HC_DATA_VAL,
+	/* raw copy into the wrapper, eg. encrypted blobs */
+	SEC_HC_DATA_COPY,
+	/* CSE seed, kept until the init flow completes */
+	SEC_HC_DATA_SEED
+};
+
+struct sec_hc_data_handler {
+	const char *label;
+	enum sec_hc_data_kind kind;
+	unsigned int (*set)(void *p_sec_data, unsigned int *p_sec_len);
+	unsigned int (*set_val)(unsigned int *p_sec_data);
+	/* SEC_HC_DATA_COPY destination in sec_ctx, 0 max_len: unchecked */
+	unsigned int offset;
+	unsigned int max_len;
+};
+
+#define SEC_HC_DATA_SETTER(t, fn) \
+	[t] = { #t, SEC_HC_DATA_SET, fn, NULL, 0, 0 }
+#define SEC_HC_DATA_VALUE(t, fn) \
+	[t] = { #t, SEC_HC_DATA_VAL, NULL, fn, 0, 0 }
+#define SEC_HC_DATA_RAW(t, field, max) \
+	[t] = { #t, SEC_HC_DATA_COPY, NULL, NULL, \
+		offsetof(struct sec_context_wrapper, field), max }
+#define SEC_HC_DATA_CSE_SEED(t) \
+	[t] = { #t, SEC_HC_DATA_SEED, NULL, NULL, 0, SEC_CSE_SEED_LEN }
+
+/* Credential data items BIOS may send, indexed by sec_hc_cmd_data_type */
+static const struct sec_hc_data_handler sec_hc_data_tbl[] = {
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_ROOTCA, sec_int_set_root_ca),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_256_OWN_PUB_KEY,
+			   sec_int_set_own_pub_key),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_HKDF_32B_PSE_SALT,
+			   sec_int_set_hkdf_32b_pse_salt),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_DENC_TOK_ID, sec_int_set_tok_id),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_DENC_DEV_ID, sec_int_set_dev_id),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_TOK_ID, a_enc_tok_id,
+			SEC_TOK_ID_LEN),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_TOK_ID_TAG, a_enc_tok_id_tag,
+			SEC_ENC_TAG_SIZE),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_TOK_ID_IV, a_enc_tok_id_iv,
+			SEC_ENC_IV_SIZE),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_DEV_ID, a_enc_dev_id,
+			SEC_DEV_ID_LEN),
+	/* Need Fix from BIOS: bound to SEC_ENC_TAG_SIZE after BIOS changes */
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_DEV_ID_TAG, a_enc_dev_id_tag, 0),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_DEV_ID_IV, a_enc_dev_id_iv,
+			SEC_ENC_IV_SIZE),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_CLD_URL, sec_int_set_cld_host_url),
+	SEC_HC_DATA_VALUE(SEC_HC_TYPE_CLD_PORT, sec_int_set_cld_host_port),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_PXY_URL, sec_int_set_pxy_host_url),
+	SEC_HC_DATA_VALUE(SEC_HC_TYPE_PXY_PORT, sec_int_set_pxy_host_port),
+	SEC_HC_DATA_VALUE(SEC_HC_TYPE_PROV_STATE, sec_int_set_prov_state),
+	SEC_HC_DATA_CSE_SEED(SEC_HC_TYPE_PSE_SEED_1),
+	SEC_HC_DATA_CSE_SEED(SEC_HC_TYPE_PSE_SEED_2),
+	SEC_HC_DATA_CSE_SEED(SEC_HC_TYPE_PSE_SEED_3),
+	SEC_HC_DATA_CSE_SEED(SEC_HC_TYPE_PSE_SEED_4),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_CLD_ADAPTER, sec_int_set_cld_adapter),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_DENC_MQTT_CLIENT_ID,
+			   sec_int_set_mqtt_client_id),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_MQTT_CLIENT_ID, a_enc_mqtt_client_id,
+			SEC_MQTT_CLIENT_ID_LEN),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_TAG,
+			a_enc_mqtt_client_id_tag, SEC_ENC_TAG_SIZE),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_IV,
+			a_enc_mqtt_client_id_iv, SEC_ENC_IV_SIZE),
+	SEC_HC_DATA_SETTER(SEC_HC_TYPE_DENC_CLOUD_HASH_ID,
+			   sec_int_set_cloud_hash),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_CLOUD_HASH_ID, a_enc_cloud_hash_id,
+			SEC_CLOUD_HASH_LEN),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_CLOUD_HASH_ID_TAG,
+			a_enc_cloud_hash_id_tag, SEC_ENC_TAG_SIZE),
+	SEC_HC_DATA_RAW(SEC_HC_TYPE_ENC_CLOUD_HASH_ID_IV,
+			a_enc_cloud_hash_id_iv, SEC_ENC_IV_SIZE),
+};
+
 int sec_hc_process_cmd_data_once(union sec_hc_cmd_data_hdr_u *cmd_hdr_data,
 	struct sec_context *ctx,
 	uint32_t conti
@@ -195,7 +273,7 @@ int sec_hc_process_cmd_data_once(union sec_hc_cmd_data_hdr_u *cmd_hdr_data,
 	union sec_hc_cmd_data_hdr_u *hdr = cmd_hdr_data;
 	sec_hc_cmd_data_t *data =
 		(sec_hc_cmd_data_t *)(cmd_hdr_data + 1);
-
+	const struct sec_hc_data_handler *ent = NULL;
 	int data_len = 0;
 
 	data_len = (hdr->bitfields.length)
@@ -218,346 +296,49 @@ int sec_hc_process_cmd_data_once(union sec_hc_cmd_data_hdr_u *cmd_hdr_data,
 	sec_hc_print_context_param("get data",
 				   (uint8_t *)(cmd_hdr_data), data_len);
 
-	switch ((hdr->bitfields.type)) {
-
-	case SEC_HC_TYPE_DENC_MQTT_CLIENT_ID:
-		LOG_INF("get SEC_HC_TYPE_MQTT_CLIENT_ID data\n");
-		sec_int_set_mqtt_client_id((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_MQTT_CLIENT_ID data",
-			(ctx->a_mqtt_client_id), (ctx->a_mqtt_client_id_len));
-		break;
-
-	case SEC_HC_TYPE_ENC_MQTT_CLIENT_ID:
-		LOG_INF("get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID data\n");
-		if (data_len > SEC_MQTT_CLIENT_ID_LEN) {
-			LOG_DBG("[%s:%d] Invalid ENC MQTT Client ID Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_mqtt_client_id, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_TAG:
-		LOG_INF("get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_TAG data\n");
-		if (data_len > SEC_ENC_TAG_SIZE) {
-			LOG_DBG("[%s:%d]Invalid ENC MQTT Client TAG Len!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_mqtt_client_id_tag, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_TAG data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_IV:
-		LOG_INF("get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_IV data\n");
-		if (data_len > SEC_ENC_IV_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC MQTT Client IV Len!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_mqtt_client_id_iv, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_IV data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ROOTCA:
-		LOG_INF("get SEC_HC_TYPE_ROOTCA data\n");
-		sec_int_set_root_ca((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ROOTCA data",
-			(ctx->a_root_ca), (ctx->root_ca_len));
-		break;
-
-	case SEC_HC_TYPE_256_OWN_PUB_KEY:
-		LOG_INF("get SEC_HC_TYPE_256_OWN_PUB_KEY data\n");
-		sec_int_set_own_pub_key((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_256_OWN_PUB_KEY data",
-			(ctx->a_own_pub_key),
-			(ctx->own_pub_key_len));
-
-		break;
-
-	case SEC_HC_TYPE_HKDF_32B_PSE_SALT:
-		LOG_INF("get SEC_HC_TYPE_HKDF_32B_PSE_SALT data\n");
-		sec_int_set_hkdf_32b_pse_salt((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_HKDF_32B_PSE_SALT data",
-			(ctx->a_hkdf_32b_pse_salt),
-			(ctx->hkdf_32b_pse_salt_len));
-		break;
-
-	case SEC_HC_TYPE_DENC_TOK_ID:
-		LOG_INF("get SEC_HC_TYPE_DENC_TKN_ID data\n");
-		sec_int_set_tok_id((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_DENC_TOK_ID data",
-			(ctx->a_tok_id), (ctx->tok_id_len));
-		break;
-
-	case SEC_HC_TYPE_DENC_DEV_ID:
-		LOG_INF("get SEC_HC_TYPE_DENC_DEV_ID data\n");
-		sec_int_set_dev_id((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_DENC_DEV_ID data",
-			(ctx->a_dev_id), (ctx->dev_id_len));
-		break;
-
-	case SEC_HC_TYPE_ENC_TOK_ID:
-		LOG_INF("get SEC_HC_TYPE_ENC_TKN_ID data\n");
-		if (data_len > SEC_TOK_ID_LEN) {
-			LOG_DBG("[%s:%d] Invalid ENC Token ID Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_tok_id, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_TOK_ID data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_TOK_ID_TAG:
-		LOG_INF("get SEC_HC_TYPE_ENC_TOK_ID_TAG data\n");
-		if (data_len > SEC_ENC_TAG_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC Token TAG Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_tok_id_tag, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_TOK_ID_TAG data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_TOK_ID_IV:
-		LOG_INF("get SEC_HC_TYPE_ENC_TOK_ID_IV data\n");
-		if (data_len > SEC_ENC_IV_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC Token IV Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_tok_id_iv, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_TOK_ID_IV data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_DEV_ID:
-		LOG_INF("get SEC_HC_TYPE_ENC_DVCE_ID data\n");
-		if (data_len > SEC_DEV_ID_LEN) {
-			LOG_DBG("[%s:%d] Invalid ENC Device ID Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_dev_id, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_DEV_ID data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_DEV_ID_TAG:
-		LOG_INF("get TYPE_ENC_DEV_ID_TAG data\n");
-		/* Need Fix from BIOS: Uncomment after BIOS changes.
-		 * if (data_len > SEC_ENC_TAG_SIZE) {
-		 *	LOG_DBG("[%s:%d] Invalid ENC Device TAG Len! :%d\n",
-		 *		__func__, __LINE__, data_len);
-		 *	result = SEC_FAILED;
-		 *	break;
-		 * }
-		 */
-		memmove(sec_ctx.a_enc_dev_id_tag, data, data_len);
-		sec_hc_print_context_param(
-			"get TYPE_ENC_DEV_ID_TAG data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_DEV_ID_IV:
-		LOG_INF("get TYPE_ENC_DEV_ID_IV data\n");
-		if (data_len > SEC_ENC_IV_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC Device IV Len! :%d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_dev_id_iv, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_DEV_ID_IV data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_CLD_URL:
-		LOG_INF("get SEC_HC_TYPE_CLD_URL data\n");
-		sec_int_set_cld_host_url((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_CLD_URL data",
-			(uint8_t *)(ctx->a_cld_host_url),
-			ctx->cld_host_url_len);
-		break;
-
-	case SEC_HC_TYPE_CLD_PORT:
-		LOG_INF("get SEC_HC_TYPE_CLD_PORT data\n");
-		sec_int_set_cld_host_port((void *)(data));
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_CLD_PORT data",
-			(uint8_t *)&(ctx->cld_host_port), 4);
-		break;
-
-	case SEC_HC_TYPE_PXY_URL:
-		LOG_INF("get SEC_HC_TYPE_PXY_URL data\n");
-		sec_int_set_pxy_host_url((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PXY_URL data",
-			(uint8_t *)(ctx->a_pxy_host_url),
-			ctx->pxy_host_url_len);
-		break;
-
-	case SEC_HC_TYPE_PXY_PORT:
-		LOG_INF("get SEC_HC_TYPE_PXY_PORT data\n");
-		sec_int_set_pxy_host_port((void *)(data));
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PXY_PORT data",
-			(uint8_t *)&(ctx->pxy_host_port), 4);
-		break;
-
-	case SEC_HC_TYPE_CLD_ADAPTER:
-		LOG_INF("get SEC_HC_TYPE_CLD_ADAPTER data\n");
-		sec_int_set_cld_adapter((void *)(data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_CLD_ADAPTER data",
-			(uint8_t *)(ctx->a_cld_adapter),
-			ctx->cld_adapter_len);
-		break;
-
-	case SEC_HC_TYPE_PROV_STATE:
-		LOG_INF("get SEC_HC_TYPE_PROV_STATE data\n");
-		sec_int_set_prov_state((void *)(data));
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PROV_STATE data",
-			(uint8_t *)&(ctx->prov_state), 4);
-		break;
-
-	case SEC_HC_TYPE_DENC_CLOUD_HASH_ID:
-		LOG_INF("get SEC_HC_TYPE_DENC_CLOUD_HASH_ID data\n");
-		sec_int_set_cloud_hash((void *) (data), &data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_CLD_ADAPTER data",
-			(uint8_t *)(ctx->a_cloud_hash),
-			ctx->a_cloud_hash_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_CLOUD_HASH_ID:
-		LOG_INF("get SEC_HC_TYPE_ENC_CLOUD_HASH_ID data\n");
-		if (data_len > SEC_CLOUD_HASH_LEN) {
-			LOG_DBG("[%s:%d] Invalid ENC Cloud hash ID Len!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_cloud_hash_id, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_ENC_CLOUD_HASH_ID data",
-			((uint8_t  *)data), data_len);
-		break;
-
-	case SEC_HC_TYPE_ENC_CLOUD_HASH_ID_TAG:
-		LOG_INF("get SEC_HC_TYPE_ENC_CLOUD_HASH_ID_TAG data\n");
-		if (data_len > SEC_ENC_TAG_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC Cloud hash TAG Len!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_cloud_hash_id_tag, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_END_CLOUD_HASH_ID_TAG data",
-			((uint8_t  *)data), data_len);
-		break;
+	if (hdr->bitfields.type < ARRAY_SIZE(sec_hc_data_tbl)) {
+		ent = &sec_hc_data_tbl[hdr->bitfields.type];
+	}
+	if (ent == NULL || ent->label == NULL) {
+		LOG_INF("get UNSUPPORTED data\n");
+		LOG_INF("]]\n");
+		return SEC_FAILED;
+	}
 
-	case SEC_HC_TYPE_ENC_CLOUD_HASH_ID_IV:
-		LOG_INF("get SEC_HC_TYPE_ENC_CLOUD_HASH_ID_IV data\n");
-		if (data_len > SEC_ENC_IV_SIZE) {
-			LOG_DBG("[%s:%d] Invalid ENC Cloud hash IV Len!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		memmove(sec_ctx.a_enc_cloud_hash_id_iv, data, data_len);
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_END_CLOUD_HASH_ID_IV data",
-			((uint8_t  *)data), data_len);
-		break;
+	LOG_INF("get %s data\n", ent->label);
+	if (ent->max_len != 0 && data_len > ent->max_len) {
+		LOG_DBG("[%s:%d] Invalid %s Len! :%d\n",
+			__func__, __LINE__, ent->label, data_len);
+		LOG_INF("]]\n");
+		return SEC_FAILED;
+	}
 
-	case SEC_HC_TYPE_PSE_SEED_1:
-		if (SEC_SUCCESS !=
-		    sec_hc_process_cse_seed(data, CSE_SEED1, data_len)) {
-			LOG_DBG("[%s:%d] CSE Seed1 process Failed!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PSE_SEED_1 data",
-			((uint8_t  *)data), data_len);
+	switch (ent->kind) {
+	case SEC_HC_DATA_SET:
+		result = ent->set((void *)(data), (unsigned int *)&data_len);
 		break;
 
-	case SEC_HC_TYPE_PSE_SEED_2:
-		if (SEC_SUCCESS !=
-		    sec_hc_process_cse_seed(data, CSE_SEED2, data_len)) {
-			LOG_DBG("[%s:%d] CSE Seed2 process Failed!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PSE_SEED_2 data",
-			((uint8_t  *)data), data_len);
+	case SEC_HC_DATA_VAL:
+		result = ent->set_val((unsigned int *)(data));
 		break;
 
-	case SEC_HC_TYPE_PSE_SEED_3:
-		if (SEC_SUCCESS !=
-		    sec_hc_process_cse_seed(data, CSE_SEED3, data_len)) {
-			LOG_DBG("[%s:%d] CSE Seed3 process Failed!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-
-		}
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PSE_SEED_3 data",
-			((uint8_t  *)data), data_len);
+	case SEC_HC_DATA_COPY:
+		memmove((uint8_t *)&sec_ctx + ent->offset, data, data_len);
 		break;
 
-	case SEC_HC_TYPE_PSE_SEED_4:
-		if (SEC_SUCCESS !=
-		    sec_hc_process_cse_seed(data, CSE_SEED4, data_len)) {
-			LOG_DBG("[%s:%d] CSE Seed3 process Failed!: %d\n",
-				__func__, __LINE__, data_len);
-			result = SEC_FAILED;
-			break;
-		}
-		sec_hc_print_context_param(
-			"get SEC_HC_TYPE_PSE_SEED_4 data",
-			((uint8_t  *)data), data_len);
+	case SEC_HC_DATA_SEED:
+		result = sec_hc_process_cse_seed(data,
+			hdr->bitfields.type - SEC_HC_TYPE_PSE_SEED_1,
+			data_len);
 		break;
+	}
 
-	default:
-		LOG_INF("get UNSUPPORTED data\n");
-		result = SEC_FAILED;
-		break;
+	if (result != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] %s process Failed!: %d\n",
+			__func__, __LINE__, ent->label, data_len);
+	} else {
+		sec_hc_print_context_param((uint8_t *)ent->label,
+					   (uint8_t *)data, data_len);
 	}
 
 	LOG_INF("]]\n");
@@ -583,6 +364,14 @@ int sec_hc_process_cmd_data(union sec_hc_cmd_data_hdr_u *req_data,
 	}
 
 	while (len > 0) {
+		/* A zero length item would never advance */
+		if (hdr->bitfields.length <
+		    sizeof(union sec_hc_cmd_data_hdr_u)) {
+			LOG_DBG("[%s:%d] Invalid data item length!\n",
+				__func__, __LINE__);
+			return SEC_FAILED;
+		}
+
 		LOG_INF("[\n\n");
 		result = sec_hc_process_cmd_data_once(
 			hdr, ctx, conti);
@@ -654,33 +443,15 @@ int sec_hc_create_cmd_data(
 static int  sec_hc_gen_random_num(unsigned char *buf, int len)
 {
 	int ret;
-	char *personalization = "SEC_INTERNAL";
-	mbedtls_ctr_drbg_context ctr_drbg;
-	mbedtls_entropy_context entropy;
-
-	mbedtls_ctr_drbg_init(&ctr_drbg);
-	mbedtls_entropy_init(&entropy);
-
-	ret = mbedtls_ctr_drbg_seed(&ctr_drbg,
-				    mbedtls_entropy_func,
-				    &entropy,
-				    (const unsigned char *)personalization,
-				    strlen(personalization));
-	if (ret != 0) {
-		LOG_INF("mbedtls dnrg seed failed: %d\n", ret);
-		SEC_ASSERT(ret);
-	}
 
-	ret = mbedtls_ctr_drbg_random(&ctr_drbg, buf, len);
-	if (ret != 0) {
+	/* Shared CTR_DRBG, seeded from the health tested DRNG pool */
+	ret = sec_int_drbg_random(buf, len);
+	if (ret != SEC_SUCCESS) {
 		LOG_INF("mbedtls drng random gen failed!\n");
-		SEC_ASSERT(ret);
+		return ret;
 	}
-	LOG_INF("\n");
 	sec_hc_print_context_param("Random Num output: ",
 				   (uint8_t *)buf, len);
-	mbedtls_ctr_drbg_free(&ctr_drbg);
-	mbedtls_entropy_free(&entropy);
 	return ret;
 }
 
@@ -694,19 +465,9 @@ static unsigned int sec_hc_resp_data_int(SEC_HC_PACKET_DATA_T *sec_hc_pkt)
 	return SEC_SUCCESS;
 }
 
-static SEC_HC_PACKET_DATA_T *sec_hc_setup_rxhdr(uint8_t *buf)
+static void sec_hc_setup_rxhdr(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+			       uint8_t *buf)
 {
-	SEC_HC_PACKET_DATA_T *sec_hc_pkt;
-
-	sec_hc_pkt = (SEC_HC_PACKET_DATA_T *)k_malloc(
-		sizeof(SEC_HC_PACKET_DATA_T));
-
-	if (sec_hc_pkt == NULL) {
-		LOG_DBG("[%s:%d] Memory Allocation Fail! len = %u\n",
-			__func__, __LINE__, sizeof(SEC_HC_PACKET_DATA_T));
-		return NULL;
-	}
-
 	sec_hc_pkt->rxhdr = (struct sec_hc_cmd_hdr_t *)buf;
 	sec_hc_pkt->req_data =
 		(union sec_hc_cmd_data_hdr_u *)(sec_hc_pkt->rxhdr + 1);
@@ -717,7 +478,6 @@ static SEC_HC_PACKET_DATA_T *sec_hc_setup_rxhdr(uint8_t *buf)
 	LOG_INF("(rxhdr->command) :0x%08x\n", (sec_hc_pkt->rxhdr->command));
 	sec_hc_print_context_param("[get ipc buf data]", (uint8_t *)(buf),
 				   (sec_hc_pkt->rxhdr->length));
-	return sec_hc_pkt;
 }
 
 static void sec_hc_txhdr_config(SEC_HC_PACKET_DATA_T *sec_hc_pkt)
@@ -803,7 +563,36 @@ int sec_hc_hkdf_key_gen(unsigned char *type,
 	return ret;
 }
 
+/*
+ * Get the GCM context for a key purpose. HKDF and the AES key schedule
+ * only run on a cache miss, after a rekey or decommission. The derived
+ * key is also kept in its sec_ctx slot as before.
+ * Caller must hold the ctx mutex while the context is in use.
+ */
+static mbedtls_gcm_context *sec_hc_get_cipher(
+	enum sec_key_purpose purpose,
+	unsigned char *key
+	)
+{
+	mbedtls_gcm_context *gcm;
+	const char *label = sec_hc_key_label[purpose];
+
+	gcm = sec_int_key_cache_lookup(purpose);
+	if (gcm != NULL) {
+		return gcm;
+	}
+
+	LOG_INF("Create %s\n", label);
+	if (sec_hc_hkdf_key_gen((unsigned char *)label, strlen(label),
+				key) != SEC_SUCCESS) {
+		return NULL;
+	}
+
+	return sec_int_key_cache_set(purpose, key, SEC_FUSE_LEN);
+}
+
 int sec_hc_encrypt_data_once(
+	enum sec_key_purpose purpose,
 	unsigned char *key,
 	unsigned char *clear_text,
 	unsigned int clear_text_len,
@@ -814,7 +603,7 @@ int sec_hc_encrypt_data_once(
 {
 
 	int ret = SEC_SUCCESS;
-	unsigned int key_len = SEC_FUSE_LEN;
+	mbedtls_gcm_context *gcm;
 
 	/* TRNG hardware generated seed in MBEDTLS */
 	if (sec_hc_get_entropy_state()) {
@@ -831,16 +620,12 @@ int sec_hc_encrypt_data_once(
 		memset(a_encrypted_iv, 0x00, SEC_ENC_IV_SIZE);
 	}
 
-	ret = mbedtls_gcm_setkey(
-		&sec_hc_cipher_t.gcm,
-		MBEDTLS_CIPHER_ID_AES,
-		key,
-		key_len * 8
-		);
-
-	if (ret != 0) {
-		LOG_INF("mbedtls_gcm_setkey() failed for: %s, ret: %d\n",
-			clear_text, ret);
+	sec_int_lock_ctx_mutex();
+	gcm = sec_hc_get_cipher(purpose, key);
+	if (gcm == NULL) {
+		sec_int_unlock_ctx_mutex();
+		LOG_INF("Cipher setup failed for: %s\n",
+			sec_hc_key_label[purpose]);
 		return SEC_FAILED;
 	}
 
@@ -848,7 +633,7 @@ int sec_hc_encrypt_data_once(
 	memset((void *)a_encrypted_tag, 0, SEC_ENC_TAG_SIZE);
 
 	ret = mbedtls_gcm_crypt_and_tag(
-		&sec_hc_cipher_t.gcm,
+		gcm,
 		MBEDTLS_GCM_ENCRYPT,
 		clear_text_len,
 		a_encrypted_iv,
@@ -859,10 +644,11 @@ int sec_hc_encrypt_data_once(
 		encrypted,
 		SEC_ENC_TAG_SIZE,
 		a_encrypted_tag);
+	sec_int_unlock_ctx_mutex();
 
 	if (ret != 0) {
 		LOG_INF("mbedtls_gcm_crypt_and_tag() failed for: %s, ret: %d\n",
-			clear_text, ret);
+			sec_hc_key_label[purpose], ret);
 		return SEC_FAILED;
 	}
 	sec_hc_print_context_param(
@@ -873,6 +659,7 @@ int sec_hc_encrypt_data_once(
 }
 
 int sec_hc_decrypt_data_once(
+	enum sec_key_purpose purpose,
 	unsigned char *key,
 	unsigned char *clear_text,
 	unsigned int clear_text_len,
@@ -882,27 +669,20 @@ int sec_hc_decrypt_data_once(
 	)
 {
 	int ret = SEC_SUCCESS;
-	unsigned int key_len = SEC_FUSE_LEN;
-
-	LOG_INF(" 5 key_len: %d\n", key_len);
-	LOG_INF("key_len * 8 : %d\n", key_len * 8);
+	mbedtls_gcm_context *gcm;
 
-	ret = mbedtls_gcm_setkey(
-		&sec_hc_cipher_t.gcm,
-		MBEDTLS_CIPHER_ID_AES,
-		key,
-		key_len * 8
-		);
-
-	if (ret != 0) {
-		LOG_INF("mbedtls_gcm_setkey() failed for: %s, ret: %d\n",
-			clear_text, ret);
+	sec_int_lock_ctx_mutex();
+	gcm = sec_hc_get_cipher(purpose, key);
+	if (gcm == NULL) {
+		sec_int_unlock_ctx_mutex();
+		LOG_INF("Cipher setup failed for: %s\n",
+			sec_hc_key_label[purpose]);
 		return SEC_FAILED;
 	}
 
 	memset((void *)clear_text, 0, clear_text_len);
 	ret = mbedtls_gcm_auth_decrypt(
-		&sec_hc_cipher_t.gcm,
+		gcm,
 		clear_text_len,
 		a_encrypted_iv,
 		SEC_ENC_IV_SIZE,
@@ -912,10 +692,11 @@ int sec_hc_decrypt_data_once(
 		SEC_ENC_TAG_SIZE,
 		encrypted,
 		clear_text);
+	sec_int_unlock_ctx_mutex();
 
 	if (ret != 0) {
 		LOG_INF("mbedtls_gcm_auth_decrypt() failed for: %s, ret: %d\n",
-			clear_text, ret);
+			sec_hc_key_label[purpose], ret);
 		return SEC_FAILED;
 	}
 	sec_hc_print_context_param("Decrypted Data: ",
@@ -923,36 +704,49 @@ int sec_hc_decrypt_data_once(
 	return ret;
 }
 
-static int sec_hc_encrypt_data(
+/* Take a crypto work buffer, busy rather than wait if none is free */
+static int sec_hc_crypto_buf_get(unsigned char **buffer, unsigned int buf_len)
+{
+	if (buf_len > SEC_HC_CRYPTO_BUF_SIZE) {
+		LOG_DBG("[%s:%d] Invalid buf_len = %d !\n",
+			__func__, __LINE__, buf_len);
+		return SEC_FAILED_INVALID_PARAM_LEN;
+	}
+
+	if (k_mem_slab_alloc(&sec_hc_crypto_slab, (void **)buffer,
+			     K_NO_WAIT) != 0) {
+		LOG_DBG("[%s:%d] Crypto buffers busy!\n",
+			__func__, __LINE__);
+		return SEC_FAILED_BUSY;
+	}
+
+	memset(*buffer, '\0', buf_len);
+	return SEC_SUCCESS;
+}
+
+static void sec_hc_crypto_buf_put(unsigned char *buffer)
+{
+	/* Clear text credentials must not outlive the operation */
+	memset(buffer, '\0', SEC_HC_CRYPTO_BUF_SIZE);
+	k_mem_slab_free(&sec_hc_crypto_slab, (void **)&buffer);
+}
+
+static int sec_hc_encrypt_data_buf(
 	sec_hc_type_enc_a data_type,
-	unsigned int buf_len)
+	unsigned int buf_len,
+	unsigned char *buffer)
 {
 	int size;
 	int ret = SEC_SUCCESS;
-	unsigned char *buffer = (unsigned char *)k_heap_alloc(&oob_sec_hc_heap, buf_len, K_NO_WAIT);
-
-	if (buffer == NULL) {
-		LOG_DBG("[%s:%d] Memory Allocation Fail, buf_len = %d !\n",
-			__func__, __LINE__, buf_len);
-		return SEC_FAILED;
-	}
 
 	memset(buffer, '\0', buf_len);
 	switch (data_type) {
 	case SEC_HC_TYPE_ENC_TOK:
 		/* MBED encryption: token id start */
-		LOG_INF("Create token id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"TOK_ENC_KEY",
-			strlen("TOK_ENC_KEY"),
-			sec_ctx.a_tok_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
 		LOG_INF("encryption: token id generation\n");
 		sec_int_get_tok_id(buffer, &size);
 		ret = sec_hc_encrypt_data_once(
+			SEC_KEY_TOK_ID,
 			sec_ctx.a_tok_id_enc_key,
 			buffer,
 			buf_len,
@@ -971,18 +765,10 @@ static int sec_hc_encrypt_data(
 
 	case SEC_HC_TYPE_ENC_DEV:
 		/* MBED encryption: Device id start */
-		LOG_INF("Create device id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"DEV_ENC_KEY",
-			strlen("DEV_ENC_KEY"),
-			sec_ctx.a_dev_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
 		LOG_INF("encryption: device id generation\n");
 		sec_int_get_dev_id(buffer, &size);
 		ret = sec_hc_encrypt_data_once(
+			SEC_KEY_DEV_ID,
 			sec_ctx.a_dev_id_enc_key,
 			buffer,
 			buf_len,
@@ -1001,18 +787,10 @@ static int sec_hc_encrypt_data(
 
 	case SEC_HC_TYPE_ENC_MQTT_ID:
 		/* MBED encryption: MQTT id start */
-		LOG_INF("Create mqtt client id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"MQTT_ID_ENC_KEY",
-			strlen("MQTT_ID_ENC_KEY"),
-			sec_ctx.a_mqtt_client_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
 		LOG_INF("encryption: mqtt client id\n");
 		sec_int_get_mqtt_client_id(buffer, &size);
 		ret = sec_hc_encrypt_data_once(
+			SEC_KEY_MQTT_CLIENT_ID,
 			sec_ctx.a_mqtt_client_id_enc_key,
 			buffer,
 			buf_len,
@@ -1032,18 +810,10 @@ static int sec_hc_encrypt_data(
 
 	case SEC_HC_TYPE_ENC_CLD_HASH:
 		/* MBED encryption: Cloud hash id start */
-		LOG_INF("Create cld hash id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"CLD_HASH_ENC_KEY",
-			strlen("CLD_HASH_ENC_KEY"),
-			sec_ctx.a_cloud_hash_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
 		LOG_INF("encryption: cld hash id generation\n");
 		sec_int_get_cloud_hash(buffer, &size);
 		ret = sec_hc_encrypt_data_once(
+			SEC_KEY_CLOUD_HASH,
 			sec_ctx.a_cloud_hash_enc_key,
 			buffer,
 			buf_len,
@@ -1066,41 +836,23 @@ static int sec_hc_encrypt_data(
 		break;
 	}
 
-	k_heap_free(&oob_sec_hc_heap, buffer);
 	return ret;
 }
 
-int sec_hc_decrypt_data(sec_hc_type_dec_a data_type, unsigned int buf_len)
+static int sec_hc_decrypt_data_buf(
+	sec_hc_type_dec_a data_type,
+	unsigned int buf_len,
+	unsigned char *buffer)
 {
 	int ret = SEC_SUCCESS;
-	unsigned char *buffer = (unsigned char *)k_heap_alloc(&oob_sec_hc_heap, buf_len, K_NO_WAIT);
-
-	if (buffer == NULL) {
-		LOG_DBG("[%s:%d] Memory Allocation Fail!\n",
-			__func__, __LINE__);
-		return SEC_FAILED;
-	}
 
 	memset(buffer, '\0', buf_len);
 	switch (data_type) {
 	case SEC_HC_TYPE_DEC_TOK:
 		/* MBED decryption: token id start */
-		LOG_INF("Decryption: Create token id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"TOK_ENC_KEY",
-			strlen("TOK_ENC_KEY"),
-			sec_ctx.a_tok_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
-		sec_hc_print_context_param(
-			"sec_ctx.a_tok_id_enc_key: ",
-			(uint8_t *)sec_ctx.a_tok_id_enc_key,
-			SEC_FUSE_LEN);
-
 		LOG_INF("Decryption: token id\n");
 		ret = sec_hc_decrypt_data_once(
+			SEC_KEY_TOK_ID,
 			sec_ctx.a_tok_id_enc_key,
 			buffer,
 			buf_len,
@@ -1123,22 +875,9 @@ int sec_hc_decrypt_data(sec_hc_type_dec_a data_type, unsigned int buf_len)
 
 	case SEC_HC_TYPE_DEC_DEV:
 		/* MBED decryption: Device id start */
-		LOG_INF("Decryption: Create device id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"DEV_ENC_KEY",
-			strlen("DEV_ENC_KEY"),
-			sec_ctx.a_dev_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
-		sec_hc_print_context_param(
-			"sec_ctx.a_dev_id_enc_key: ",
-			(uint8_t *)sec_ctx.a_dev_id_enc_key,
-			SEC_FUSE_LEN);
-
 		LOG_INF("Decryption: Device id\n");
 		ret = sec_hc_decrypt_data_once(
+			SEC_KEY_DEV_ID,
 			sec_ctx.a_dev_id_enc_key,
 			buffer,
 			buf_len,
@@ -1161,23 +900,10 @@ int sec_hc_decrypt_data(sec_hc_type_dec_a data_type, unsigned int buf_len)
 
 	case SEC_HC_TYPE_DEC_MQTT_ID:
 		/* MBED decryption: MQTT id start */
-		LOG_INF("Decryption: Create MQTT Client id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"MQTT_ID_ENC_KEY",
-			strlen("MQTT_ID_ENC_KEY"),
-			sec_ctx.a_mqtt_client_id_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
-		sec_hc_print_context_param(
-			"sec_ctx.a_mqtt_client_id_enc_key: ",
-			(uint8_t *)sec_ctx.a_mqtt_client_id_enc_key,
-			SEC_FUSE_LEN);
-
 		/* MBED decryption: token id start */
 		LOG_INF("Decryption: mqtt client id\n");
 		ret = sec_hc_decrypt_data_once(
+			SEC_KEY_MQTT_CLIENT_ID,
 			sec_ctx.a_mqtt_client_id_enc_key,
 			buffer,
 			buf_len,
@@ -1200,22 +926,9 @@ int sec_hc_decrypt_data(sec_hc_type_dec_a data_type, unsigned int buf_len)
 
 	case SEC_HC_TYPE_DEC_CLD_HASH:
 		/* MBED decryption: cloud hash id start */
-		LOG_INF("Decryption: Create cld hash id key\n");
-		ret = sec_hc_hkdf_key_gen(
-			"CLD_HASH_ENC_KEY",
-			strlen("CLD_HASH_ENC_KEY"),
-			sec_ctx.a_cloud_hash_enc_key
-			);
-		if (ret != SEC_SUCCESS) {
-			break;
-		}
-		sec_hc_print_context_param(
-			"sec_ctx.a_cloud_hash_enc_key: ",
-			(uint8_t *)sec_ctx.a_cloud_hash_enc_key,
-			SEC_FUSE_LEN);
-
 		LOG_INF("Decryption: cld hash id\n");
 		ret = sec_hc_decrypt_data_once(
+			SEC_KEY_CLOUD_HASH,
 			sec_ctx.a_cloud_hash_enc_key,
 			buffer,
 			buf_len,
@@ -1241,7 +954,6 @@ int sec_hc_decrypt_data(sec_hc_type_dec_a data_type, unsigned int buf_len)
 		break;
 	}
 
-	k_heap_free(&oob_sec_hc_heap, buffer);
 	return ret;
 }
 
@@ -1508,7 +1220,7 @@ static int sec_hc_set_pref_cse_seed(a_cse_seed_type seed)
  * to get right cse seed to decrypt received encrypted
  * data
  */
-static unsigned int sec_hc_find_cse_seed(void)
+static unsigned int sec_hc_find_cse_seed(unsigned char *scratch)
 {
 	LOG_INF("%s: Totoal Seeds Available: %d\n",
 		__func__, sec_hc_cse_seed.a_cse_seed_no);
@@ -1523,8 +1235,8 @@ static unsigned int sec_hc_find_cse_seed(void)
 
 		LOG_INF("Cloud hash decrypt using preferred seed idx: %d\n",
 			idx);
-		if (sec_hc_decrypt_data(SEC_HC_TYPE_DEC_CLD_HASH,
-					SEC_CLOUD_HASH_LEN) !=
+		if (sec_hc_decrypt_data_buf(SEC_HC_TYPE_DEC_CLD_HASH,
+					    SEC_CLOUD_HASH_LEN, scratch) !=
 				SEC_SUCCESS) {
 			LOG_DBG("Retry with Previous seed value\n");
 			continue;
@@ -1571,591 +1283,435 @@ void sec_hc_pse_set_salt(void)
 	sec_int_set_hkdf_32b_pse_salt((void *)(buffer_pse_salt), &size);
 }
 
-static void sec_hc_process_cmd(
-	uint8_t *buf
-	)
+/* Encrypt all credentials with CSE seed 1 and compose the response */
+static int sec_hc_prov_encrypt_resp(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				    unsigned char *scratch)
 {
-	LOG_INF("Enter: %s\n", __func__);
-	SEC_HC_PACKET_DATA_T *sec_hc_pkt;
-
-	/* setup rxhdr*/
-	sec_hc_pkt = sec_hc_setup_rxhdr(buf);
-	if (sec_hc_pkt == NULL) {
-		LOG_INF("Setup for rx header Buffer initialization Fail!\n");
-		goto err;
+	/* Generate PSE Salt */
+	sec_hc_pse_set_salt();
+	LOG_INF("Set pref cse seed as seed\n");
+	if (sec_hc_set_pref_cse_seed(CSE_SEED1) != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Preferred CSE Seed Set Failed!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
 	}
 
-	/* setup txhdr */
-	sec_hc_txhdr_config(sec_hc_pkt);
+	/* Data type is token */
+	LOG_INF("Start: Encrypt Token id\n");
+	if (sec_hc_encrypt_data_buf(SEC_HC_TYPE_ENC_TOK,
+				    SEC_TOK_ID_LEN, scratch) !=
+			SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Enc Tok id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-	/* initialize response packate */
-	if (sec_hc_resp_data_int(sec_hc_pkt) != SEC_SUCCESS) {
-		LOG_INF("Response Buffer initialization Fail!\n");
-		k_free(sec_hc_pkt);
-		goto err;
+	/* Data type is device */
+	LOG_INF("Start: Encrypt Device id\n");
+	if (sec_hc_encrypt_data_buf(SEC_HC_TYPE_ENC_DEV,
+				    SEC_DEV_ID_LEN, scratch) !=
+			SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Enc Dev id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
 	}
 
-	mbedtls_gcm_init(&sec_hc_cipher_t.gcm);
+	/* Data type mqtt ID */
+	LOG_INF("Start: Encrypt MQTT Client id\n");
+	if (sec_hc_encrypt_data_buf(SEC_HC_TYPE_ENC_MQTT_ID,
+				    SEC_MQTT_CLIENT_ID_LEN, scratch) !=
+			SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Enc MQTT Client id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-	mrd_t sec_hc_msg = { 0 };
+	/* Data type cld hash ID */
+	LOG_INF("Start: Encrypt CLD HASH id\n");
+	if (sec_hc_encrypt_data_buf(SEC_HC_TYPE_ENC_CLD_HASH,
+				    SEC_CLOUD_HASH_LEN, scratch) !=
+			SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Encrypt CLD HASH id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-	sec_hc_msg.buf = sec_hc_tx_buffer;
-
-	LOG_INF("[sec_heci] %s\n", __func__);
-
-	switch (sec_hc_pkt->rxhdr->command) {
-	case SEC_HC_PROV_INIT_OOB:
-		LOG_INF(">> [SEC_HC_PROV_INIT_OOB]\n");
-
-		sec_hc_process_cmd_data(
-			sec_hc_pkt->req_data,
-			((sec_hc_pkt->rxhdr->length)
-			 - sizeof(struct sec_hc_cmd_hdr_t)),
-			&(sec_ctx.sec_ctx), !(sec_hc_pkt->rxhdr->msg_comp));
-
-		sec_hc_pkt->txhdr->command = SEC_HC_PROV_INIT_OK;
-		if ((sec_hc_pkt->rxhdr->msg_comp) != SEC_HC_LAST_MSG_YES) {
-			LOG_INF("Multiple IPC packet >>\n");
-			sec_hc_prev_command_id = SEC_HC_PROV_INIT_OOB;
-			break;
-		}
-
-		/* Generate PSE Salt */
-		sec_hc_pse_set_salt();
-		LOG_INF("SEC_HC_PROV_INIT_OOB, Set pref cse seed as seed\n");
-		if (sec_hc_set_pref_cse_seed(CSE_SEED1) != SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Preferred CSE Seed Set Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
-
-		/* Data type is token */
-		LOG_INF("Start: Encrypt Token id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_TOK,
-					SEC_TOK_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Enc Tok id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
-
-		/* Data type is device */
-		LOG_INF("Star: Encrypt Device id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_DEV,
-					SEC_DEV_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Enc Dev id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
-
-		/* Data type mqtt ID */
-		LOG_INF("Start: Encrypt MQTT Client id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_MQTT_ID,
-					SEC_MQTT_CLIENT_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Enc MQTT Client id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
-
-		/* Data type cld hash ID */
-		LOG_INF("Start: Encrypt CLD HASH id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_CLD_HASH,
-					SEC_CLOUD_HASH_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt CLD HASH id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
-
-		/* Create response packet */
-		sec_hc_resp_pkt.buf_compose =
-			(uint32_t  *)(sec_hc_pkt->txhdr + 1);
-
-		sec_hc_resp_pkt.buf_compose_next =
-			(uint32_t  *)(sec_hc_pkt->txhdr + 1);
-
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_PSE_SALT) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for PSE SALT Fail!\n");
-			break;
-		}
-
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_TOK) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for Token ID Fail!\n");
-			break;
-		}
-
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_DEV) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for Device ID!\n");
-			break;
-		}
-
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_MQTT_ID) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for MQTT ID!\n");
-			break;
-		}
-
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_CLD_HASH) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for CLD hash Fail!\n");
-			break;
-		}
-
-		sec_hc_pkt->txhdr->length
-			= sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
-
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_PROV_INIT_OOB\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
-
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_PROV_INIT_OK] >>\n");
-
-		sec_hc_prev_command_id = SEC_HC_PROV_INIT_OOB;
-		break;
+	/* Create response packet */
+	sec_hc_resp_pkt.buf_compose =
+		(uint32_t  *)(sec_hc_pkt->txhdr + 1);
+	sec_hc_resp_pkt.buf_compose_next =
+		(uint32_t  *)(sec_hc_pkt->txhdr + 1);
 
-	case SEC_HC_PROV_INIT_ACK:
-		LOG_INF(">> [SEC_HC_PROV_INIT_ACK]\n");
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_PSE_SALT) !=
+			SEC_SUCCESS) {
+		LOG_DBG("Create Resp for PSE SALT Fail!\n");
+		return SEC_FAILED;
+	}
 
-		sec_hc_process_cmd_data(
-			sec_hc_pkt->req_data,
-			((sec_hc_pkt->rxhdr->length)
-			 - sizeof(struct sec_hc_cmd_hdr_t)),
-			&(sec_ctx.sec_ctx),
-			!(sec_hc_pkt->rxhdr->msg_comp));
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_TOK) !=
+			SEC_SUCCESS) {
+		LOG_DBG("Create Resp for Token ID Fail!\n");
+		return SEC_FAILED;
+	}
 
-		sec_hc_pkt->txhdr->command = SEC_HC_PROV_INIT_ACK2;
-		if ((sec_hc_pkt->rxhdr->msg_comp) != SEC_HC_LAST_MSG_YES) {
-			LOG_INF("Multiple IPC packet >>\n");
-			sec_hc_prev_command_id = SEC_HC_PROV_INIT_ACK;
-			break;
-		}
-		sec_hc_pkt->txhdr->length
-			= sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_DEV) !=
+			SEC_SUCCESS) {
+		LOG_DBG("Create Resp for Device ID!\n");
+		return SEC_FAILED;
+	}
 
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_PROV_INIT_ACK\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_MQTT_ID) !=
+			SEC_SUCCESS) {
+		LOG_DBG("Create Resp for MQTT ID!\n");
+		return SEC_FAILED;
+	}
 
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_CLD_HASH) !=
+			SEC_SUCCESS) {
+		LOG_DBG("Create Resp for CLD hash Fail!\n");
+		return SEC_FAILED;
+	}
 
-		sec_hc_prev_command_id = SEC_HC_PROV_INIT_ACK;
-		LOG_INF("[SEC_HC_PROV_INIT_ACK2] >>\n");
-		break;
+	return SEC_SUCCESS;
+}
 
-	case SEC_HC_STATUS_OOB:
-		LOG_INF(">> [SEC_HC_STATUS_OOB]\n");
+static int sec_hc_cmd_prov_init(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				unsigned char *scratch)
+{
+	return sec_hc_prov_encrypt_resp(sec_hc_pkt, scratch);
+}
 
-		sec_hc_pkt->txhdr->command = SEC_HC_STATUS_OOB_RES;
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_OOB_ST) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp OOB Status Fail!\n");
-			break;
-		}
-		sec_hc_pkt->txhdr->length =
-			sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(
-			struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
+static int sec_hc_cmd_rprov_req(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				unsigned char *scratch)
+{
+	sec_hc_seed_updated = false;
+	LOG_INF("Create pse seed salt using pse hw random gen\n");
+	return sec_hc_prov_encrypt_resp(sec_hc_pkt, scratch);
+}
 
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_STATUS_OOB\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
+static int sec_hc_cmd_status(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+			     unsigned char *scratch)
+{
+	ARG_UNUSED(sec_hc_pkt);
+	ARG_UNUSED(scratch);
 
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
+	if (sec_hc_response_data(SEC_HC_TYPE_RESP_OOB_ST) != SEC_SUCCESS) {
+		LOG_DBG("Create Resp OOB Status Fail!\n");
+		return SEC_FAILED;
+	}
+	return SEC_SUCCESS;
+}
 
-		sec_hc_prev_command_id = SEC_HC_STATUS_OOB;
-		LOG_INF("[SEC_HC_STATUS_OOB_RES] >>\n");
-		break;
+static int sec_hc_cmd_init_oob2(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				unsigned char *scratch)
+{
+	ARG_UNUSED(sec_hc_pkt);
 
-	case SEC_HC_INIT_OOB:
-		LOG_INF(">> [SEC_HC_INIT_OOB]\n");
-
-		sec_hc_process_cmd_data(
-			sec_hc_pkt->req_data,
-			((sec_hc_pkt->rxhdr->length) -
-			 sizeof(struct sec_hc_cmd_hdr_t)),
-			&(sec_ctx.sec_ctx),
-			!(sec_hc_pkt->rxhdr->msg_comp));
-
-		sec_hc_pkt->txhdr->command = SEC_HC_INIT_OOB_OK;
-		if ((sec_hc_pkt->rxhdr->msg_comp) !=
-		    SEC_HC_LAST_MSG_YES) {
-			LOG_INF("Multiple IPC packet >>\n");
-			sec_hc_prev_command_id = SEC_HC_INIT_OOB;
-			break;
+	/* First decrypt hash value and
+	 * check decrypted value with received
+	 * hash value from BIOS
+	 * [normal flow bios will send
+	 * enc hash data and hash value ]
+	 */
+	LOG_INF("call -> sec_hc_find_cse_seed\n");
+	if (sec_hc_find_cse_seed(scratch) != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Failed to Find Right Seed Val!\n",
+			__func__, __LINE__);
+		if (sec_hc_response_msg_type(
+			    SEC_HC_TYPE_NORMAL_FLW_DATA_ERR) != SEC_SUCCESS) {
+			LOG_DBG("Create Resp for data err Failed!\n");
+			return SEC_FAILED;
 		}
+		return SEC_SUCCESS;
+	}
 
-		sec_hc_pkt->txhdr->length =
-			sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t) +
-				 sec_hc_resp_pkt.accum_compose_len;
-
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_INIT_OOB\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
-
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_INIT_OOB_OK] >>\n");
-
-		sec_hc_prev_command_id = SEC_HC_INIT_OOB;
-		break;
-
-	case SEC_HC_INIT_OOB2:
-		LOG_INF(" >> [SEC_HC_INIT_OOB2]\n");
-		sec_hc_process_cmd_data(
-			sec_hc_pkt->req_data,
-			((sec_hc_pkt->rxhdr->length)
-			 - sizeof(struct sec_hc_cmd_hdr_t)),
-			&(sec_ctx.sec_ctx),
-			!(sec_hc_pkt->rxhdr->msg_comp));
-
-		sec_hc_pkt->txhdr->command = SEC_HC_INIT_ACK;
-		if ((sec_hc_pkt->rxhdr->msg_comp) != SEC_HC_LAST_MSG_YES) {
-			LOG_INF("Multiple IPC packet >>\n");
-			sec_hc_prev_command_id = SEC_HC_INIT_OOB2;
-			break;
+	/* Compare Two HASH Val Dec val with Received value */
+	if (sec_hc_int_hash_check() != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] CLD Hash check Failed !\n",
+			__func__, __LINE__);
+		if (sec_hc_response_msg_type(
+			    SEC_HC_TYPE_NORMAL_FLW_HASH_ERR) != SEC_SUCCESS) {
+			LOG_DBG("Create Resp for Hash Err Failed!\n");
+			return SEC_FAILED;
 		}
+		return SEC_SUCCESS;
+	}
 
-		/* First decrypt hash value and
-		 * check decrypted value with received
-		 * hash value from BIOS
-		 * [normal flow bios will send
-		 * enc hash data and hash value ]
-		 */
-
-		LOG_INF("call -> sec_hc_find_cse_seed\n");
-		if (sec_hc_find_cse_seed() != SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Failed to Find Right Seed Val!\n",
-				__func__, __LINE__);
-			if (sec_hc_response_msg_type(
-				    SEC_HC_TYPE_NORMAL_FLW_DATA_ERR) !=
-					SEC_SUCCESS) {
-				LOG_DBG("Create Resp for data err Failed!\n");
-				break;
-			}
-			goto resp;
-		}
+	if (sec_hc_seed_updated == true) {
+		LOG_INF("Reprovision set in sec ctx\n");
+		unsigned int reprov_state = (unsigned int)SEC_RPROV;
 
-		/* Compare Two HASH Val Dec val with Received value */
-		if (sec_hc_int_hash_check() != SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] CLD Hash check Failed !\n",
-				__func__, __LINE__);
-			if (sec_hc_response_msg_type(
-				    SEC_HC_TYPE_NORMAL_FLW_HASH_ERR)
-					!= SEC_SUCCESS) {
-				LOG_DBG(
-					"Create Resp for Hash Err Failed!\n");
-				break;
-			}
-			goto resp;
+		sec_int_set_prov_state((unsigned int *)&reprov_state);
+		if (sec_hc_response_msg_type(
+			    SEC_HC_TYPE_NORMAL_FLW_REPROV_REQ) != SEC_SUCCESS) {
+			LOG_DBG("Create Resp for Reprov Failed!\n");
+			return SEC_FAILED;
 		}
+	} else if (sec_hc_response_msg_type(
+			   SEC_HC_TYPE_NORMAL_FLW_SUCCESS) != SEC_SUCCESS) {
+		LOG_DBG("Create Resp for Normal Flow Failed!\n");
+		return SEC_FAILED;
+	}
 
-		if (sec_hc_seed_updated == true) {
-			LOG_INF("Reprovision set in sec ctx\n");
-			unsigned int reprov_state =
-				(unsigned int)SEC_RPROV;
-			sec_int_set_prov_state(
-				(unsigned int *)&reprov_state);
-			if (sec_hc_response_msg_type(
-					SEC_HC_TYPE_NORMAL_FLW_REPROV_REQ)
-					!= SEC_SUCCESS) {
-				LOG_DBG("Create Resp for Reprov Failed!\n");
-				break;
-			}
-			goto decry;
-		}
-		if (sec_hc_response_msg_type(SEC_HC_TYPE_NORMAL_FLW_SUCCESS) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for Normal Flow Failed!\n");
-			break;
-		}
+	/* Decrypt token ID */
+	LOG_INF("Start: Decrypt Token ID\n");
+	if (sec_hc_decrypt_data_buf(SEC_HC_TYPE_DEC_TOK,
+				    SEC_TOK_ID_LEN, scratch) != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Decrypt Token id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-decry:
-		/* Decrypt token ID */
-		LOG_INF("Start: Decrypt Token ID\n");
-		if (sec_hc_decrypt_data(SEC_HC_TYPE_DEC_TOK,
-					SEC_TOK_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Decrypt Token id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
+	/* Decrypt Device ID */
+	LOG_INF("Start: Decrypt Device ID\n");
+	if (sec_hc_decrypt_data_buf(SEC_HC_TYPE_DEC_DEV,
+				    SEC_DEV_ID_LEN, scratch) != SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Decrypt Device id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-		/* Decrypt Device ID */
-		LOG_INF("Start: Decrypt Device ID\n");
-		if (sec_hc_decrypt_data(SEC_HC_TYPE_DEC_DEV,
-					SEC_DEV_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Decrypt Device id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
+	/* Decrypt mqtt ID */
+	LOG_INF("Start: Decrypt MQTT Client ID\n");
+	if (sec_hc_decrypt_data_buf(SEC_HC_TYPE_DEC_MQTT_ID,
+				    SEC_MQTT_CLIENT_ID_LEN, scratch) !=
+			SEC_SUCCESS) {
+		LOG_DBG("[%s:%d] Start: Decrypt MQTT id Fail!\n",
+			__func__, __LINE__);
+		return SEC_FAILED;
+	}
 
-		/* Decrypt mqtt ID */
-		LOG_INF("Start: Decrypt MQTT Client ID\n");
-		if (sec_hc_decrypt_data(SEC_HC_TYPE_DEC_MQTT_ID,
-					SEC_MQTT_CLIENT_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt MQTT id Fail!\n",
-				__func__, __LINE__);
-			break;
-		}
+	return SEC_SUCCESS;
+}
 
-		/*
-		 * Create response packet
-		 */
-resp:
-		sec_hc_pkt->txhdr->length =
-			sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
+static int sec_hc_cmd_rprov_ack(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				unsigned char *scratch)
+{
+	ARG_UNUSED(sec_hc_pkt);
+	ARG_UNUSED(scratch);
 
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_INIT_OOB2\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
+	unsigned int prov_state = (unsigned int)SEC_PROV;
 
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data] ",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_INIT_ACK] >>\n");
+	sec_int_set_prov_state((unsigned int *)&prov_state);
+	return SEC_SUCCESS;
+}
 
-		sec_hc_prev_command_id = SEC_HC_INIT_OOB2;
-		break;
+/* Init flow completed, CSE seeds are no longer needed */
+static void sec_hc_post_init_done(void)
+{
+	sec_hc_rel_cse_seed();
 
-	case SEC_HC_INIT_ACK2:
-		LOG_INF(" >> [SEC_HC_INIT_ACK2]\n");
+	/* Flag that the init flow completed */
+	sec_int_lock_ctx_mutex();
+	sec_int_start_init_flag = 1;
+	sec_int_unlock_ctx_mutex();
+}
 
-		sec_hc_process_cmd_data(
-			sec_hc_pkt->req_data,
-			((sec_hc_pkt->rxhdr->length)
-			 - sizeof(struct sec_hc_cmd_hdr_t)),
-			&(sec_ctx.sec_ctx),
-			!(sec_hc_pkt->rxhdr->msg_comp));
+static void sec_hc_post_decomm(void)
+{
+	/* Notify OOB service to continue user side decommissioning */
+	sec_hc_final_decommission();
+}
 
-		sec_hc_prev_command_id = SEC_HC_INIT_ACK2;
-		sec_hc_rel_cse_seed();
+/* Command carries credential data items */
+#define SEC_HC_CMD_DATA         BIT(0)
+/* Command may span several IPC packets, run once the last one is in */
+#define SEC_HC_CMD_MULTI        BIT(1)
+/* Command runs AES-GCM, gets a crypto work buffer for the whole message */
+#define SEC_HC_CMD_CRYPTO       BIT(2)
+/* Command is answered with resp_cmd */
+#define SEC_HC_CMD_RESP         BIT(3)
+
+struct sec_hc_cmd_handler {
+	const char *label;
+	uint8_t flags;
+	uint8_t resp_cmd;
+	/* Accepted payload length, header excluded */
+	uint16_t min_len;
+	uint16_t max_len;
+	int (*handler)(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+		       unsigned char *scratch);
+	/* Runs after the response is sent */
+	void (*post)(void);
+};
 
-		/* Flag that the init flow completed */
-		sec_int_lock_ctx_mutex();
-		sec_int_start_init_flag = 1;
-		sec_int_unlock_ctx_mutex();
-		break;
+#define SEC_HC_MAX_PAYLOAD \
+	(SEC_HC_MAX_RX_SIZE - sizeof(struct sec_hc_cmd_hdr_t))
+
+/* Smallest payload that carries a credential item */
+#define SEC_HC_MIN_DATA_PAYLOAD sizeof(union sec_hc_cmd_data_hdr_u)
+
+#define SEC_HC_CMD(c, f, r, min, max, h, p) \
+	[c] = { #c, f, r, min, max, h, p }
+
+/* BIOS commands, indexed by sec_hc_command_id */
+static const struct sec_hc_cmd_handler sec_hc_cmd_tbl[] = {
+	SEC_HC_CMD(SEC_HC_PROV_INIT_OOB,
+		   SEC_HC_CMD_DATA | SEC_HC_CMD_MULTI | SEC_HC_CMD_CRYPTO |
+		   SEC_HC_CMD_RESP,
+		   SEC_HC_PROV_INIT_OK,
+		   SEC_HC_MIN_DATA_PAYLOAD, SEC_HC_MAX_PAYLOAD,
+		   sec_hc_cmd_prov_init, NULL),
+	SEC_HC_CMD(SEC_HC_PROV_INIT_ACK,
+		   SEC_HC_CMD_DATA | SEC_HC_CMD_MULTI | SEC_HC_CMD_RESP,
+		   SEC_HC_PROV_INIT_ACK2,
+		   0, SEC_HC_MAX_PAYLOAD,
+		   NULL, NULL),
+	SEC_HC_CMD(SEC_HC_INIT_OOB,
+		   SEC_HC_CMD_DATA | SEC_HC_CMD_MULTI | SEC_HC_CMD_RESP,
+		   SEC_HC_INIT_OOB_OK,
+		   SEC_HC_MIN_DATA_PAYLOAD, SEC_HC_MAX_PAYLOAD,
+		   NULL, NULL),
+	SEC_HC_CMD(SEC_HC_INIT_OOB2,
+		   SEC_HC_CMD_DATA | SEC_HC_CMD_MULTI | SEC_HC_CMD_CRYPTO |
+		   SEC_HC_CMD_RESP,
+		   SEC_HC_INIT_ACK,
+		   SEC_HC_MIN_DATA_PAYLOAD, SEC_HC_MAX_PAYLOAD,
+		   sec_hc_cmd_init_oob2, NULL),
+	SEC_HC_CMD(SEC_HC_INIT_ACK2,
+		   SEC_HC_CMD_DATA,
+		   0,
+		   0, SEC_HC_MAX_PAYLOAD,
+		   NULL, sec_hc_post_init_done),
+	SEC_HC_CMD(SEC_HC_RPROV_REQ,
+		   SEC_HC_CMD_CRYPTO | SEC_HC_CMD_RESP,
+		   SEC_HC_RPROV_RES,
+		   0, 0,
+		   sec_hc_cmd_rprov_req, NULL),
+	SEC_HC_CMD(SEC_HC_RPROV_ACK,
+		   SEC_HC_CMD_RESP,
+		   SEC_HC_RPROV_ACK2,
+		   0, 0,
+		   sec_hc_cmd_rprov_ack, sec_hc_post_init_done),
+	SEC_HC_CMD(SEC_HC_STATUS_OOB,
+		   SEC_HC_CMD_RESP,
+		   SEC_HC_STATUS_OOB_RES,
+		   0, 0,
+		   sec_hc_cmd_status, NULL),
+	SEC_HC_CMD(SEC_HC_DECOMM_ACK,
+		   SEC_HC_CMD_RESP,
+		   SEC_HC_DECOMM_ACK2,
+		   0, 0,
+		   NULL, sec_hc_post_decomm),
+};
 
-	case SEC_HC_RPROV_REQ:
-		LOG_INF(" >> [SEC_HC_RPROV_REQ]\n");
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+/* Last response, captured instead of sent */
+unsigned int unit_test_hc_tx_len;
+uint8_t *unit_test_hc_tx = sec_hc_tx_buffer;
+#endif
 
-		sec_hc_seed_updated = false;
-		sec_hc_pkt->txhdr->command = SEC_HC_RPROV_RES;
+static void sec_hc_send_response(SEC_HC_PACKET_DATA_T *sec_hc_pkt,
+				 const char *label)
+{
+	mrd_t sec_hc_msg = { 0 };
 
-		LOG_INF("Create pse seed salt using pse hw random gen\n");
-		sec_hc_pse_set_salt();
+	sec_hc_msg.buf = sec_hc_tx_buffer;
+	sec_hc_pkt->txhdr->length = sec_hc_resp_pkt.accum_compose_len;
+	sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
+			 + sec_hc_resp_pkt.accum_compose_len;
+
+	/* RESPONSE */
+	LOG_INF("Send Response for: %s\n", label);
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+	unit_test_hc_tx_len = sec_hc_msg.len;
+#else
+	heci_send(sec_hc_conn_id, &sec_hc_msg);
+#endif
 
-		if (sec_hc_set_pref_cse_seed(CSE_SEED1) != SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Preferred CSE Seed Set Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
+	LOG_INF("[%s][[\n", __func__);
+	sec_hc_print_context_param(
+		"[get tx data]",
+		(uint8_t *)(sec_hc_tx_buffer),
+		(sec_hc_resp_pkt.accum_compose_len));
+	LOG_INF("]]\n");
+}
 
-		/* Data type is token */
-		LOG_INF("Start: Encrypt Token id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_TOK,
-					SEC_TOK_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt Token id Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
+void sec_hc_process_cmd(
+	uint8_t *buf
+	)
+{
+	LOG_INF("Enter: %s\n", __func__);
+	SEC_HC_PACKET_DATA_T sec_hc_pkt;
+	const struct sec_hc_cmd_handler *ent = NULL;
+	unsigned char *scratch = NULL;
+	uint32_t command;
+	int payload_len;
+	int ret = SEC_SUCCESS;
 
-		/* Data type is device */
-		LOG_INF("Start: Encrypt Device id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_DEV,
-					SEC_DEV_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt Device id Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
+	/* setup rxhdr*/
+	sec_hc_setup_rxhdr(&sec_hc_pkt, buf);
 
-		/* encrypt mqtt ID */
-		LOG_INF("Start: Encrypt MQTT Client id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_MQTT_ID,
-					SEC_MQTT_CLIENT_ID_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt MQTT id Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
+	/* setup txhdr */
+	sec_hc_txhdr_config(&sec_hc_pkt);
 
-		/* Data type cld hash ID */
-		LOG_INF("Start: Encrypt CLD HASH id\n");
-		if (sec_hc_encrypt_data(SEC_HC_TYPE_ENC_CLD_HASH,
-					SEC_CLOUD_HASH_LEN) !=
-				SEC_SUCCESS) {
-			LOG_DBG("[%s:%d] Start: Encrypt CLD HASH id Failed!\n",
-				__func__, __LINE__);
-			break;
-		}
+	/* initialize response packate */
+	sec_hc_resp_data_int(&sec_hc_pkt);
 
-		sec_hc_resp_pkt.buf_compose =
-			(uint32_t  *)(sec_hc_pkt->txhdr + 1);
-		sec_hc_resp_pkt.buf_compose_next =
-			(uint32_t  *)(sec_hc_pkt->txhdr + 1);
+	command = sec_hc_pkt.rxhdr->command;
+	if (command < ARRAY_SIZE(sec_hc_cmd_tbl)) {
+		ent = &sec_hc_cmd_tbl[command];
+	}
+	if (ent == NULL || ent->label == NULL) {
+		LOG_INF("get SEC_HC ANY command: 0x%02x\n", command);
+		goto err;
+	}
 
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_PSE_SALT) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for PSE SALT Failed!\n");
-			break;
-		}
+	LOG_INF(">> [%s]\n", ent->label);
+	payload_len = (int)sec_hc_pkt.rxhdr->length
+		      - (int)sizeof(struct sec_hc_cmd_hdr_t);
+	if (payload_len < ent->min_len || payload_len > ent->max_len) {
+		LOG_DBG("[%s:%d] Invalid payload len: %d\n",
+			__func__, __LINE__, payload_len);
+		goto err;
+	}
 
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_TOK) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for Token ID Failed!\n");
-			break;
-		}
+	sec_hc_pkt.txhdr->command = ent->resp_cmd;
 
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_DEV) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for Device ID!\n");
-			break;
-		}
+	if (ent->flags & SEC_HC_CMD_DATA) {
+		sec_hc_process_cmd_data(sec_hc_pkt.req_data, payload_len,
+					&(sec_ctx.sec_ctx),
+					!(sec_hc_pkt.rxhdr->msg_comp));
+	}
 
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_MQTT_ID) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for MQTT ID!\n");
-			break;
-		}
+	if ((ent->flags & SEC_HC_CMD_MULTI) &&
+	    (sec_hc_pkt.rxhdr->msg_comp) != SEC_HC_LAST_MSG_YES) {
+		LOG_INF("Multiple IPC packet >>\n");
+		sec_hc_prev_command_id = command;
+		goto err;
+	}
 
-		if (sec_hc_response_data(SEC_HC_TYPE_RESP_CLD_HASH) !=
-				SEC_SUCCESS) {
-			LOG_DBG("Create Resp for CLD hash Failed!\n");
-			break;
+	/* One work buffer serves every encrypt/decrypt of this message */
+	if (ent->flags & SEC_HC_CMD_CRYPTO) {
+		ret = sec_hc_crypto_buf_get(&scratch,
+					    SEC_HC_CRYPTO_BUF_SIZE);
+		if (ret != SEC_SUCCESS) {
+			goto err;
 		}
+	}
 
-		sec_hc_pkt->txhdr->length =
-			sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
-
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_RPROV_REQ\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
-
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data] ",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_RPROV_RES] >>\n ");
-
-		sec_hc_prev_command_id = SEC_HC_RPROV_REQ;
-		break;
-
-	case SEC_HC_RPROV_ACK:
-		LOG_INF(" >> [SEC_HC_RPROV_ACK]\n");
-
-		unsigned int prov_state =
-			(unsigned int)SEC_PROV;
-		sec_int_set_prov_state(
-			(unsigned int *)&prov_state);
-		sec_hc_pkt->txhdr->command = SEC_HC_RPROV_ACK2;
-		sec_hc_pkt->txhdr->length =
-			sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
-
-		LOG_INF("Send Response for: SEC_HC_RPROV_ACK\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
-
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_RPROV_ACK] >>\n");
-
-		sec_hc_prev_command_id = SEC_HC_RPROV_ACK;
-		sec_hc_rel_cse_seed();
-
-		/* Flag that the init flow completed */
-		sec_int_lock_ctx_mutex();
-		sec_int_start_init_flag = 1;
-		sec_int_unlock_ctx_mutex();
-		break;
-
-	case SEC_HC_DECOMM_ACK:
-		LOG_INF(">> [SEC_HC_DECOMM_ACK]\n");
+	if (ent->handler != NULL) {
+		ret = ent->handler(&sec_hc_pkt, scratch);
+	}
 
-		/*
-		 * BIOS Sent ACK as to perform remaining Decommission from
-		 * PSE OOB side
-		 */
-		sec_hc_pkt->txhdr->command = SEC_HC_DECOMM_ACK2;
-		sec_hc_pkt->txhdr->length
-			= sec_hc_resp_pkt.accum_compose_len;
-		sec_hc_msg.len = sizeof(struct sec_hc_cmd_hdr_t)
-				 + sec_hc_resp_pkt.accum_compose_len;
+	if (scratch != NULL) {
+		sec_hc_crypto_buf_put(scratch);
+	}
 
-		/* RESPONSE */
-		LOG_INF("Send Response for: SEC_HC_DECOMM_ACK\n");
-		heci_send(sec_hc_conn_id, &sec_hc_msg);
+	if (ret != SEC_SUCCESS) {
+		goto err;
+	}
 
-		LOG_INF("[%s][[\n", __func__);
-		sec_hc_print_context_param(
-			"[get tx data]",
-			(uint8_t *)(sec_hc_tx_buffer),
-			(sec_hc_resp_pkt.accum_compose_len));
-		LOG_INF("]]\n");
-		LOG_INF("[SEC_HC_DECOMM_ACK] >>\n");
+	if (ent->flags & SEC_HC_CMD_RESP) {
+		sec_hc_send_response(&sec_hc_pkt, ent->label);
+	}
 
-		sec_hc_prev_command_id = SEC_HC_DECOMM_ACK;
-		/* Notify OOB service to continue user side decommissioning */
-		sec_hc_final_decommission();
-		break;
+	sec_hc_prev_command_id = command;
 
-	default:
-		LOG_INF("get SEC_HC ANY command\n");
-		LOG_INF("heci_send for ANY\n");
-		break;
+	if (ent->post != NULL) {
+		ent->post();
 	}
 
-	k_free(sec_hc_pkt);
-	mbedtls_gcm_free(&sec_hc_cipher_t.gcm);
-
 err:
 	LOG_INF("Exiting %s\n", __func__);
 }
@@ -2208,6 +1764,9 @@ static void sec_hc_task(
 			 */
 			/* RESPONSE */
 			heci_send_flow_control(sec_hc_conn_id);
+
+			/* Top up the DRNG pool while the host is idle */
+			sec_int_entropy_pool_prefetch();
 			break;
 
 		case HECI_EVENT_DISCONN:
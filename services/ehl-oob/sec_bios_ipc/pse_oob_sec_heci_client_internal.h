@@ -25,7 +25,10 @@ extern "C" {
 
 #define SEC_HC_MAX_RX_SIZE        4096
 #define SEC_HC_STACK_SIZE         4096*2
-#define SEC_HC_HEAP_SIZE          4096
+
+/* Crypto work buffers, sized for the largest credential (token id) */
+#define SEC_HC_CRYPTO_BUF_SIZE    SEC_TOK_ID_LEN
+#define SEC_HC_CRYPTO_BUF_NUM     2
 
 #define SEC_HC_MAJOR_MINOR_VERSION 0x2
 /* 1.00 = 0x0
@@ -33,6 +36,22 @@ extern "C" {
  * 1.02 = 0x2
  */
 
+void sec_hc_process_cmd(uint8_t *buf);
+int sec_hc_encrypt_data_once(enum sec_key_purpose purpose,
+			     unsigned char *key,
+			     unsigned char *clear_text,
+			     unsigned int clear_text_len,
+			     unsigned char *encrypted,
+			     unsigned char *a_encrypted_iv,
+			     unsigned char *a_encrypted_tag);
+
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+extern struct k_mem_slab sec_hc_crypto_slab;
+/* Response of the last sec_hc_process_cmd, heci_send is bypassed */
+extern uint8_t *unit_test_hc_tx;
+extern unsigned int unit_test_hc_tx_len;
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,58 +41,148 @@ APP_GLOBAL_VAR(2) struct sec_context_wrapper
 struct sec_context_wrapper sec_ctx;
 #endif
 
-#define RETRY 2
-#define COMPARE_DRNG_SEED(prev, cur) (prev ^ cur)
+/* Entropy pool and DRBG are used from both the OOB and sec heci thread */
+#if defined(CONFIG_SOC_INTEL_PSE)
+APP_GLOBAL_VAR_BSS(2) static struct sec_entropy_pool sec_pool;
+APP_GLOBAL_VAR_BSS(2) static mbedtls_ctr_drbg_context sec_drbg;
+APP_GLOBAL_VAR_BSS(2) static bool sec_drbg_seeded;
+APP_GLOBAL_VAR_BSS(2) static bool sec_entropy_state;
+#else
+static struct sec_entropy_pool sec_pool;
+static mbedtls_ctr_drbg_context sec_drbg;
+static bool sec_drbg_seeded;
+static bool sec_entropy_state;
+#endif
 
-typedef struct {
-	unsigned int drng_prev;
-	bool is_1st_drng_rd;
-	bool is_not_1st_hw_poll;
-	bool entropy_state;
-} SEC_INT_ENTROPY_T;
-static SEC_INT_ENTROPY_T sec_entropy_t;
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+unsigned int unit_test_key_setups;
+unsigned int unit_test_hash_bytes;
+unsigned int unit_test_seg_hashes;
+#endif
 
-/** PRIVATE Function */
-SEC_RTN int sec_int_verify_context_hash(void)
-{
-	unsigned int i;
-	unsigned int input_text_size;
-	unsigned char calculated_hash[SEC_HASH_LEN];
+/* Segment boundaries in struct sec_context, see enum sec_ctx_segment */
+static const unsigned int sec_seg_offset[SEC_SEG_MAX + 1] = {
+	[SEC_SEG_ROOT_CA] = offsetof(struct sec_context, a_root_ca),
+	[SEC_SEG_KEYS] = offsetof(struct sec_context, a_own_pub_key),
+	[SEC_SEG_IDS] = offsetof(struct sec_context, a_dev_id),
+	[SEC_SEG_HOSTS] = offsetof(struct sec_context, a_cld_adapter),
+	[SEC_SEG_CLIENT] = offsetof(struct sec_context, a_mqtt_client_id),
+	[SEC_SEG_STATE] = offsetof(struct sec_context, pxy_host_port),
+	[SEC_SEG_MAX] = sizeof(struct sec_context),
+};
 
+static void sec_int_hash_segment(enum sec_ctx_segment seg,
+				 unsigned char *hash)
+{
 #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
-	input_text_size = *((unsigned int *)unit_test_param[0]);
-#else
-	input_text_size = sizeof(sec_ctx.sec_ctx);
+	unit_test_seg_hashes++;
+	unit_test_hash_bytes += sec_seg_offset[seg + 1] - sec_seg_offset[seg];
 #endif
+	mbedtls_sha512((unsigned char *)&(sec_ctx.sec_ctx) +
+		       sec_seg_offset[seg],
+		       sec_seg_offset[seg + 1] - sec_seg_offset[seg],
+		       hash,
+		       IS384);
+}
 
-	mbedtls_sha512((unsigned char *)&(sec_ctx.sec_ctx),
-		       input_text_size,
-		       calculated_hash,
+static void sec_int_hash_root(unsigned char *hash)
+{
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+	unit_test_hash_bytes += sizeof(sec_ctx.a_seg_hash);
+#endif
+	mbedtls_sha512((unsigned char *)sec_ctx.a_seg_hash,
+		       sizeof(sec_ctx.a_seg_hash),
+		       hash,
 		       IS384);
+}
 
-	for (i = 0; i < SEC_HASH_LEN; i++) {
-		if (calculated_hash[i] != sec_ctx.a_hash[i]) {
-			return SEC_FAILED_OOB_HASH_MISMATCH;
-		}
+/* Compare without early exit, timing does not leak the mismatch index */
+static bool sec_int_hash_equal(const unsigned char *a,
+			       const unsigned char *b)
+{
+	unsigned char diff = 0;
+
+	for (int i = 0; i < SEC_HASH_LEN; i++) {
+		diff |= a[i] ^ b[i];
+	}
+
+	return diff == 0;
+}
+
+/** PRIVATE Function */
+SEC_RTN int sec_int_verify_segment_hash(
+	SEC_IN enum sec_ctx_segment seg
+	)
+{
+	unsigned char calculated_hash[SEC_HASH_LEN];
+
+	if (seg >= SEC_SEG_MAX) {
+		return SEC_FAILED_INVALID_PARAM;
+	}
+
+	/* Segment digests are only trusted while the root matches */
+	sec_int_hash_root(calculated_hash);
+	if (!sec_int_hash_equal(calculated_hash, sec_ctx.a_hash)) {
+		goto mismatch;
+	}
+
+	sec_int_hash_segment(seg, calculated_hash);
+	if (!sec_int_hash_equal(calculated_hash, sec_ctx.a_seg_hash[seg])) {
+		goto mismatch;
 	}
 
 	return SEC_SUCCESS;
+
+mismatch:
+	/* Do not trust keys derived from a tampered context */
+	sec_int_key_cache_invalidate();
+	return SEC_FAILED_OOB_HASH_MISMATCH;
 };
 
-SEC_RTN int sec_int_update_context_hash(void)
+SEC_RTN int sec_int_update_segment_hash(
+	SEC_IN enum sec_ctx_segment seg
+	)
 {
-	unsigned int input_text_size;
+	if (seg >= SEC_SEG_MAX) {
+		return SEC_FAILED_INVALID_PARAM;
+	}
 
-#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
-	input_text_size = *((unsigned int *)unit_test_param[0]);
-#else
-	input_text_size = sizeof(sec_ctx.sec_ctx);
-#endif
+	sec_int_hash_segment(seg, sec_ctx.a_seg_hash[seg]);
+	sec_int_hash_root(sec_ctx.a_hash);
 
-	mbedtls_sha512((unsigned char *)&(sec_ctx.sec_ctx),
-		       input_text_size,
-		       sec_ctx.a_hash,
-		       IS384);
+	return SEC_SUCCESS;
+};
+
+SEC_RTN int sec_int_verify_context_hash(void)
+{
+	unsigned char calculated_hash[SEC_HASH_LEN];
+
+	sec_int_hash_root(calculated_hash);
+	if (!sec_int_hash_equal(calculated_hash, sec_ctx.a_hash)) {
+		goto mismatch;
+	}
+
+	for (int seg = 0; seg < SEC_SEG_MAX; seg++) {
+		sec_int_hash_segment(seg, calculated_hash);
+		if (!sec_int_hash_equal(calculated_hash,
+					sec_ctx.a_seg_hash[seg])) {
+			goto mismatch;
+		}
+	}
+
+	return SEC_SUCCESS;
+
+mismatch:
+	sec_int_key_cache_invalidate();
+	return SEC_FAILED_OOB_HASH_MISMATCH;
+};
+
+SEC_RTN int sec_int_update_context_hash(void)
+{
+	for (int seg = 0; seg < SEC_SEG_MAX; seg++) {
+		sec_int_hash_segment(seg, sec_ctx.a_seg_hash[seg]);
+	}
+	sec_int_hash_root(sec_ctx.a_hash);
 
 	return SEC_SUCCESS;
 };
@@ -117,6 +207,8 @@ SEC_RTN int sec_int_init_context(void)
 		SEC_REPROV_NONE;
 #endif
 
+	sec_int_key_cache_invalidate();
+
 	/** Initialize Hash() */
 	result = sec_int_update_context_hash();
 
@@ -131,6 +223,7 @@ SEC_RTN int sec_int_init_context(void)
 SEC_RTN void sec_int_sec_decommission(void)
 {
 	oob_set_pm_control(false);
+	sec_int_key_cache_invalidate();
 	memset((void *)&sec_ctx, 0, sizeof(sec_ctx));
 };
 
@@ -220,7 +313,7 @@ SEC_RTN unsigned int sec_int_get_root_ca(
 		return SEC_FAILED_INVALID_PARAM;
 	}
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_ROOT_CA);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -247,7 +340,7 @@ SEC_RTN unsigned int sec_int_set_mqtt_client_id(
 	unsigned int result = SEC_SUCCESS;
 
 	sec_int_lock_ctx_mutex();
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -262,7 +355,7 @@ SEC_RTN unsigned int sec_int_set_mqtt_client_id(
 		&sec_ctx.sec_ctx.a_mqtt_client_id_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_CLIENT);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -277,7 +370,7 @@ SEC_RTN unsigned int sec_int_get_mqtt_client_id(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -311,7 +404,7 @@ SEC_RTN unsigned int sec_int_set_root_ca(
 		return SEC_FAILED_INVALID_PARAM;
 	}
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_ROOT_CA);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -326,7 +419,7 @@ SEC_RTN unsigned int sec_int_set_root_ca(
 		&sec_ctx.sec_ctx.root_ca_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_ROOT_CA);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -341,7 +434,7 @@ SEC_RTN unsigned int sec_int_get_own_pub_key(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_KEYS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -370,7 +463,7 @@ SEC_RTN unsigned int sec_int_set_own_pub_key(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_KEYS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -385,7 +478,8 @@ SEC_RTN unsigned int sec_int_set_own_pub_key(
 		&sec_ctx.sec_ctx.own_pub_key_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_key_cache_invalidate();
+	sec_int_update_segment_hash(SEC_SEG_KEYS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -410,6 +504,7 @@ SEC_RTN unsigned int sec_int_set_pse_32b_fuse(
 		&sec_ctx.a_pse_32b_fuse_len
 		);
 
+	sec_int_key_cache_invalidate();
 	sec_int_unlock_ctx_mutex();
 	return result;
 }
@@ -451,7 +546,7 @@ SEC_RTN unsigned int sec_int_get_hkdf_32b_pse_salt(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_KEYS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -480,7 +575,7 @@ SEC_RTN unsigned int sec_int_set_hkdf_32b_pse_salt(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_KEYS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -495,7 +590,8 @@ SEC_RTN unsigned int sec_int_set_hkdf_32b_pse_salt(
 		&sec_ctx.sec_ctx.hkdf_32b_pse_salt_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_key_cache_invalidate();
+	sec_int_update_segment_hash(SEC_SEG_KEYS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -510,7 +606,7 @@ SEC_RTN unsigned int sec_int_get_dev_id(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_IDS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -538,7 +634,7 @@ SEC_RTN unsigned int sec_int_set_dev_id(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_IDS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -553,7 +649,7 @@ SEC_RTN unsigned int sec_int_set_dev_id(
 		&sec_ctx.sec_ctx.dev_id_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_IDS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -568,7 +664,7 @@ SEC_RTN unsigned int sec_int_get_tok_id(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_IDS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -595,7 +691,7 @@ SEC_RTN unsigned int sec_int_set_tok_id(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_IDS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -610,7 +706,7 @@ SEC_RTN unsigned int sec_int_set_tok_id(
 		&sec_ctx.sec_ctx.tok_id_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_IDS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -626,7 +722,7 @@ SEC_RTN unsigned int sec_int_get_cld_adapter(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -654,7 +750,7 @@ SEC_RTN unsigned int sec_int_set_cld_adapter(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -669,7 +765,7 @@ SEC_RTN unsigned int sec_int_set_cld_adapter(
 		&sec_ctx.sec_ctx.cld_adapter_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_HOSTS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -684,7 +780,7 @@ SEC_RTN unsigned int sec_int_get_cld_host_url(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -713,7 +809,7 @@ SEC_RTN unsigned int sec_int_set_cld_host_url(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -728,7 +824,7 @@ SEC_RTN unsigned int sec_int_set_cld_host_url(
 		&sec_ctx.sec_ctx.cld_host_url_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_HOSTS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -742,7 +838,7 @@ SEC_RTN unsigned int sec_int_get_cld_host_port(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -768,7 +864,7 @@ SEC_RTN unsigned int sec_int_set_cld_host_port(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -782,7 +878,7 @@ SEC_RTN unsigned int sec_int_set_cld_host_port(
 		.cld_host_port
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_HOSTS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -797,7 +893,7 @@ SEC_RTN unsigned int sec_int_get_pxy_host_url(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -826,7 +922,7 @@ SEC_RTN unsigned int sec_int_set_pxy_host_url(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_HOSTS);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -841,7 +937,7 @@ SEC_RTN unsigned int sec_int_set_pxy_host_url(
 		&sec_ctx.sec_ctx.pxy_host_url_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_HOSTS);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -855,7 +951,7 @@ SEC_RTN unsigned int sec_int_get_pxy_host_port(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -881,7 +977,7 @@ SEC_RTN unsigned int sec_int_set_pxy_host_port(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -894,7 +990,143 @@ SEC_RTN unsigned int sec_int_set_pxy_host_port(
 		(unsigned int *)&sec_ctx.sec_ctx
 		.pxy_host_port);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_STATE);
+	sec_int_unlock_ctx_mutex();
+
+	return result;
+};
+
+enum sec_cred_kind {
+	/* NUL terminated string in sec_ctx */
+	SEC_CRED_STR,
+	/* buffer with a separate length field in sec_ctx */
+	SEC_CRED_BUF,
+	/* single unsigned int value */
+	SEC_CRED_VAL
+};
+
+struct sec_cred_field {
+	enum sec_cred_kind kind;
+	enum sec_ctx_segment seg;
+	unsigned int offset;
+	unsigned int len_offset;
+	unsigned int max_len;
+};
+
+#define SEC_CRED_FIELD_STR(t, seg, field, max) \
+	[t] = { SEC_CRED_STR, seg, offsetof(struct sec_context, field), \
+		0, max }
+#define SEC_CRED_FIELD_BUF(t, seg, field, len, max) \
+	[t] = { SEC_CRED_BUF, seg, offsetof(struct sec_context, field), \
+		offsetof(struct sec_context, len), max }
+#define SEC_CRED_FIELD_VAL(t, seg, field) \
+	[t] = { SEC_CRED_VAL, seg, offsetof(struct sec_context, field), 0, \
+		sizeof(unsigned int) }
+
+/* Location of each credential in sec_ctx, indexed by sec_cred_type */
+static const struct sec_cred_field sec_cred_tbl[SEC_CRED_MAX] = {
+	SEC_CRED_FIELD_STR(SEC_CRED_CLD_ADAPTER, SEC_SEG_HOSTS,
+			   a_cld_adapter, SEC_CLD_LEN),
+	SEC_CRED_FIELD_STR(SEC_CRED_TOK_ID, SEC_SEG_IDS,
+			   a_tok_id, SEC_TOK_ID_LEN),
+	SEC_CRED_FIELD_STR(SEC_CRED_DEV_ID, SEC_SEG_IDS,
+			   a_dev_id, SEC_DEV_ID_LEN),
+	SEC_CRED_FIELD_STR(SEC_CRED_MQTT_CLIENT_ID, SEC_SEG_CLIENT,
+			   a_mqtt_client_id, SEC_MQTT_CLIENT_ID_LEN),
+	SEC_CRED_FIELD_BUF(SEC_CRED_CLD_HOST_URL, SEC_SEG_HOSTS,
+			   a_cld_host_url, cld_host_url_len, SEC_URL_LEN),
+	SEC_CRED_FIELD_VAL(SEC_CRED_CLD_HOST_PORT, SEC_SEG_HOSTS,
+			   cld_host_port),
+	SEC_CRED_FIELD_BUF(SEC_CRED_PXY_HOST_URL, SEC_SEG_HOSTS,
+			   a_pxy_host_url, pxy_host_url_len, SEC_URL_LEN),
+	SEC_CRED_FIELD_VAL(SEC_CRED_PXY_HOST_PORT, SEC_SEG_STATE,
+			   pxy_host_port),
+	SEC_CRED_FIELD_STR(SEC_CRED_ROOT_CA, SEC_SEG_ROOT_CA,
+			   a_root_ca, SEC_ROOT_CA_LEN),
+};
+
+static unsigned int sec_int_copy_cred(
+	SEC_IN const struct sec_cred_field *fld,
+	SEC_INOUT struct sec_cred_item *item
+	)
+{
+	unsigned char *p_field = (unsigned char *)&sec_ctx.sec_ctx +
+				 fld->offset;
+	unsigned int len;
+
+	switch (fld->kind) {
+	case SEC_CRED_VAL:
+		if (item->len < sizeof(unsigned int)) {
+			return SEC_FAILED_INVALID_PARAM_LEN;
+		}
+		*(unsigned int *)item->p_data = *(unsigned int *)p_field;
+		item->len = sizeof(unsigned int);
+		return SEC_SUCCESS;
+	case SEC_CRED_BUF:
+		len = *(unsigned int *)((unsigned char *)&sec_ctx.sec_ctx +
+					fld->len_offset);
+		if (len > fld->max_len) {
+			return SEC_FAILED_INVALID_PARAM;
+		}
+		break;
+	default:
+		len = strnlen((char *)p_field, fld->max_len);
+		break;
+	}
+
+	/* Room for the terminating NUL */
+	if (len >= item->len) {
+		return SEC_FAILED_INVALID_PARAM_LEN;
+	}
+	memcpy(item->p_data, p_field, len);
+	((unsigned char *)item->p_data)[len] = '\0';
+	item->len = len;
+
+	return SEC_SUCCESS;
+}
+
+SEC_RTN unsigned int sec_int_get_credentials(
+	SEC_INOUT struct sec_cred_item *p_items,
+	SEC_IN unsigned int count
+	)
+{
+	unsigned int result = SEC_SUCCESS;
+	unsigned int seg_result[SEC_SEG_MAX];
+	unsigned int verified = 0;
+	const struct sec_cred_field *fld;
+	struct sec_cred_item *item;
+
+	if (p_items == NULL) {
+		return SEC_FAILED_INVALID_PARAM;
+	}
+
+	sec_int_lock_ctx_mutex();
+
+	for (item = p_items; item < p_items + count; item++) {
+		if (item->type >= SEC_CRED_MAX || item->p_data == NULL) {
+			item->result = SEC_FAILED_INVALID_PARAM;
+			goto next;
+		}
+		fld = &sec_cred_tbl[item->type];
+
+		/* Each segment is verified once for the whole snapshot */
+		if (!(verified & BIT(fld->seg))) {
+			seg_result[fld->seg] =
+				sec_int_verify_segment_hash(fld->seg);
+			verified |= BIT(fld->seg);
+		}
+
+		item->result = seg_result[fld->seg];
+		if (item->result == SEC_SUCCESS) {
+			item->result = sec_int_copy_cred(fld, item);
+		}
+next:
+		if (item->result != SEC_SUCCESS && result == SEC_SUCCESS) {
+			LOG_INF("%s type %d failed!", __func__, item->type);
+			result = item->result;
+		}
+	}
+
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -912,7 +1144,7 @@ SEC_RTN unsigned int sec_int_get_cloud_hash(
 	}
 
 	sec_int_lock_ctx_mutex();
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -944,7 +1176,7 @@ SEC_RTN unsigned int sec_int_set_cloud_hash(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -959,7 +1191,7 @@ SEC_RTN unsigned int sec_int_set_cloud_hash(
 		&sec_ctx.sec_ctx.a_cloud_hash_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_CLIENT);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -978,7 +1210,7 @@ SEC_RTN unsigned int sec_int_set_cloud_hash_dec(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -993,7 +1225,7 @@ SEC_RTN unsigned int sec_int_set_cloud_hash_dec(
 		&sec_ctx.sec_ctx.a_cloud_hash_len
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_CLIENT);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -1005,7 +1237,7 @@ SEC_RTN unsigned int sec_hc_int_hash_check(void)
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_CLIENT);
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
 		LOG_INF("%s hash failed!", __func__);
@@ -1042,7 +1274,7 @@ SEC_RTN unsigned int sec_int_get_prov_state(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -1069,7 +1301,7 @@ SEC_RTN unsigned int sec_int_set_prov_state(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -1083,7 +1315,7 @@ SEC_RTN unsigned int sec_int_set_prov_state(
 		.prov_state
 		);
 
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_STATE);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -1097,7 +1329,7 @@ SEC_RTN unsigned int sec_int_get_reprov_pend(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -1124,7 +1356,7 @@ SEC_RTN unsigned int sec_int_set_reprov_pend(
 
 	sec_int_lock_ctx_mutex();
 
-	result = sec_int_verify_context_hash();
+	result = sec_int_verify_segment_hash(SEC_SEG_STATE);
 
 	if (result != SEC_SUCCESS) {
 		sec_int_unlock_ctx_mutex();
@@ -1137,7 +1369,7 @@ SEC_RTN unsigned int sec_int_set_reprov_pend(
 		(unsigned int *)&sec_ctx.sec_ctx
 		.reprov_pend
 		);
-	sec_int_update_context_hash();
+	sec_int_update_segment_hash(SEC_SEG_STATE);
 	sec_int_unlock_ctx_mutex();
 
 	return result;
@@ -1208,7 +1440,9 @@ SEC_RTN unsigned int sec_int_read_iosf_sb(
 	case SB_DRNG:
 
 #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
-		*((unsigned int *)p_sec_data) = 0x01234567;
+		*((unsigned int *)p_sec_data) = unit_test_drng_read ?
+						unit_test_drng_read() :
+						0x01234567;
 #else
 
 		ret = sedi_sideband_send(0, port, SEDI_SIDEBAND_ACTION_READ,
@@ -1322,10 +1556,7 @@ SEC_RTN unsigned int sec_int_set_reprovision(
  */
 static void sec_hc_reset_drng_state(void)
 {
-	sec_entropy_t.is_1st_drng_rd = false;
-	sec_entropy_t.is_not_1st_hw_poll = false;
-	sec_entropy_t.entropy_state = false;
-	sec_entropy_t.drng_prev &= 0x0000;
+	sec_int_entropy_pool_reset();
 };
 
 unsigned int sec_int_start_init_flag;
@@ -1435,6 +1666,220 @@ SEC_RTN unsigned int sec_int_get_rand_num(
 	return result;
 };
 
+/** ========================= Entropy Pool =============================== */
+
+/* SP 800-90B 4.4 health tests on one sample, true if the source is OK */
+static bool sec_int_entropy_health_test(unsigned char sample)
+{
+	bool healthy = true;
+
+	/* Repetition count test */
+	if (sec_pool.rct_count && sample == sec_pool.rct_last) {
+		if (++sec_pool.rct_count >= SEC_ENTROPY_RCT_CUTOFF) {
+			sec_pool.rct_failures++;
+			healthy = false;
+		}
+	} else {
+		sec_pool.rct_last = sample;
+		sec_pool.rct_count = 1;
+	}
+
+	/* Adaptive proportion test */
+	if (sec_pool.apt_seen == 0) {
+		sec_pool.apt_base = sample;
+		sec_pool.apt_count = 1;
+	} else if (sample == sec_pool.apt_base) {
+		if (++sec_pool.apt_count >= SEC_ENTROPY_APT_CUTOFF) {
+			sec_pool.apt_failures++;
+			healthy = false;
+		}
+	}
+	if (++sec_pool.apt_seen == SEC_ENTROPY_APT_WINDOW) {
+		sec_pool.apt_seen = 0;
+	}
+
+	if (!healthy) {
+		sec_pool.rct_count = 0;
+		sec_pool.apt_seen = 0;
+		sec_pool.health_failures++;
+	}
+
+	return healthy;
+}
+
+/* Fill the pool up. DRNG reads go to a local buffer without the ctx
+ * mutex, which is taken only to health test and commit the samples.
+ */
+static unsigned int sec_int_entropy_pool_fill(void)
+{
+	unsigned char a_fresh[SEC_ENTROPY_POOL_SIZE +
+			      SEC_DRNG_EGETDATA24_SIZE_BITS / 8];
+	unsigned int result = SEC_SUCCESS;
+	unsigned int drng_val;
+	unsigned int need;
+	unsigned int got = 0;
+	unsigned int reads = 0;
+
+	sec_int_lock_ctx_mutex();
+	need = SEC_ENTROPY_POOL_SIZE - sec_pool.count;
+	sec_int_unlock_ctx_mutex();
+
+	while (got < need) {
+		if (sec_int_get_rand_num(&drng_val,
+					 SEC_DRNG_EGETDATA24_SIZE_BITS) !=
+		    SEC_SUCCESS) {
+			result = SEC_FAILED;
+			break;
+		}
+		reads++;
+
+		/* 24 valid bits per DRNG read */
+		for (int i = 0; i < SEC_DRNG_EGETDATA24_SIZE_BITS / 8; i++) {
+			a_fresh[got++] = (unsigned char)(drng_val >> (i * 8));
+		}
+	}
+
+	sec_int_lock_ctx_mutex();
+	sec_pool.drng_reads += reads;
+	for (unsigned int i = 0; i < got; i++) {
+		if (!sec_int_entropy_health_test(a_fresh[i])) {
+			LOG_INF("%s: DRNG health test failed\n", __func__);
+			/* Drop everything gathered with the failure */
+			memset(sec_pool.a_pool, 0, sizeof(sec_pool.a_pool));
+			sec_pool.count = 0;
+			sec_entropy_state = false;
+			result = SEC_FAILED;
+			break;
+		}
+		/* Another fill may have topped the pool up meanwhile */
+		if (sec_pool.count < SEC_ENTROPY_POOL_SIZE) {
+			sec_pool.a_pool[sec_pool.count++] = a_fresh[i];
+		}
+	}
+	if (result == SEC_SUCCESS) {
+		sec_entropy_state = true;
+	}
+	sec_int_unlock_ctx_mutex();
+
+	memset(a_fresh, 0, sizeof(a_fresh));
+
+	return result;
+}
+
+/* Take up to len bytes from the pool, caller holds the ctx mutex */
+static unsigned int sec_int_entropy_pool_take(unsigned char *p_data,
+					      unsigned int len)
+{
+	unsigned int chunk = MIN(len, sec_pool.count);
+
+	sec_pool.count -= chunk;
+	memcpy(p_data, &sec_pool.a_pool[sec_pool.count], chunk);
+	/* Entropy is handed out once only */
+	memset(&sec_pool.a_pool[sec_pool.count], 0, chunk);
+
+	return chunk;
+}
+
+SEC_RTN unsigned int sec_int_entropy_pool_prefetch(void)
+{
+	return sec_int_entropy_pool_fill();
+};
+
+SEC_RTN unsigned int sec_int_entropy_pool_read(
+	SEC_OUT unsigned char *p_data,
+	SEC_IN unsigned int len
+	)
+{
+	unsigned int chunk;
+
+	while (len) {
+		sec_int_lock_ctx_mutex();
+		chunk = sec_int_entropy_pool_take(p_data, len);
+		sec_int_unlock_ctx_mutex();
+
+		p_data += chunk;
+		len -= chunk;
+		if (len && sec_int_entropy_pool_fill() != SEC_SUCCESS) {
+			return SEC_FAILED;
+		}
+	}
+
+	return SEC_SUCCESS;
+};
+
+SEC_RTN void sec_int_entropy_pool_reset(void)
+{
+	sec_int_lock_ctx_mutex();
+	memset(&sec_pool, 0, sizeof(sec_pool));
+	if (sec_drbg_seeded) {
+		mbedtls_ctr_drbg_free(&sec_drbg);
+		sec_drbg_seeded = false;
+	}
+	sec_entropy_state = false;
+	sec_int_unlock_ctx_mutex();
+};
+
+SEC_RTN const struct sec_entropy_pool *sec_int_entropy_pool_stats(void)
+{
+	return &sec_pool;
+};
+
+/* DRBG entropy callback, runs under the ctx mutex so it only takes what
+ * sec_int_drbg_random() prefetched and never reads the DRNG itself.
+ */
+static int sec_int_drbg_entropy(void *data, unsigned char *output,
+				size_t len)
+{
+	ARG_UNUSED(data);
+
+	return sec_int_entropy_pool_take(output, len) == len ?
+	       0 : MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+}
+
+/* CTR_DRBG seeded and reseeded from the pool, for bulk consumers */
+SEC_RTN unsigned int sec_int_drbg_random(
+	SEC_OUT unsigned char *p_data,
+	SEC_IN unsigned int len
+	)
+{
+	const char *personalization = "SEC_INTERNAL";
+	int ret;
+
+	/* Top the pool up before locking so a seed or reseed finds it full.
+	 * A failure here surfaces as a seed failure below.
+	 */
+	if (sec_pool.count < SEC_ENTROPY_POOL_SIZE) {
+		sec_int_entropy_pool_fill();
+	}
+
+	sec_int_lock_ctx_mutex();
+	if (!sec_drbg_seeded) {
+		mbedtls_ctr_drbg_init(&sec_drbg);
+		ret = mbedtls_ctr_drbg_seed(&sec_drbg,
+					    sec_int_drbg_entropy,
+					    NULL,
+					    (const unsigned char *)personalization,
+					    strlen(personalization));
+		if (ret != 0) {
+			mbedtls_ctr_drbg_free(&sec_drbg);
+			sec_int_unlock_ctx_mutex();
+			LOG_INF("%s mbedtls_ctr_drbg_seed failed!", __func__);
+			return SEC_FAILED;
+		}
+		sec_drbg_seeded = true;
+	}
+
+	ret = mbedtls_ctr_drbg_random(&sec_drbg, p_data, len);
+	sec_int_unlock_ctx_mutex();
+
+	if (ret != 0) {
+		LOG_INF("%s mbedtls_ctr_drbg_random() failed!", __func__);
+		return SEC_FAILED;
+	}
+
+	return SEC_SUCCESS;
+};
+
 #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
 
 /** Internal testing only to ensure that whenever MBEDTLS
@@ -1481,6 +1926,85 @@ SEC_RTN unsigned int sec_int_get_rand_num_by_mbed(
 
 #endif
 
+/** ========================= Key Cache ================================== */
+
+/* Caller must hold the ctx mutex while the returned context is in use,
+ * an invalidation from another thread frees it.
+ */
+SEC_RTN mbedtls_gcm_context *sec_int_key_cache_lookup(
+	SEC_IN enum sec_key_purpose purpose
+	)
+{
+	struct sec_key_cache_entry *entry;
+
+	if (purpose >= SEC_KEY_PURPOSE_MAX) {
+		return NULL;
+	}
+
+	entry = &sec_ctx.a_key_cache[purpose];
+	if (!entry->valid || entry->version != sec_ctx.key_version) {
+		return NULL;
+	}
+
+	return &entry->gcm;
+};
+
+SEC_RTN mbedtls_gcm_context *sec_int_key_cache_set(
+	SEC_IN enum sec_key_purpose purpose,
+	SEC_IN unsigned char *p_key,
+	SEC_IN unsigned int key_len
+	)
+{
+	struct sec_key_cache_entry *entry;
+	int ret;
+
+	if (purpose >= SEC_KEY_PURPOSE_MAX) {
+		return NULL;
+	}
+
+	entry = &sec_ctx.a_key_cache[purpose];
+	if (!entry->valid) {
+		mbedtls_gcm_init(&entry->gcm);
+	}
+
+	/* AES key schedule is expanded once here */
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+	unit_test_key_setups++;
+#endif
+	ret = mbedtls_gcm_setkey(&entry->gcm,
+				 MBEDTLS_CIPHER_ID_AES,
+				 p_key,
+				 key_len * 8
+				 );
+	if (ret != 0) {
+		LOG_INF("%s mbedtls_gcm_setkey() failed!", __func__);
+		mbedtls_gcm_free(&entry->gcm);
+		entry->valid = false;
+		return NULL;
+	}
+
+	entry->version = sec_ctx.key_version;
+	entry->valid = true;
+
+	return &entry->gcm;
+};
+
+SEC_RTN void sec_int_key_cache_invalidate(void)
+{
+	sec_int_lock_ctx_mutex();
+
+	for (int i = 0; i < SEC_KEY_PURPOSE_MAX; i++) {
+		if (sec_ctx.a_key_cache[i].valid) {
+			/* mbedtls_gcm_free() zeroizes the key schedule */
+			mbedtls_gcm_free(&sec_ctx.a_key_cache[i].gcm);
+			sec_ctx.a_key_cache[i].valid = false;
+		}
+	}
+	sec_ctx.key_version++;
+
+	sec_int_unlock_ctx_mutex();
+};
+
 /** ========================= NONCE Challenge ============================= */
 
 SEC_RTN unsigned int sec_int_get_nonce(
@@ -1530,7 +2054,7 @@ SEC_RTN unsigned int sec_int_check_nonce(
 
 	/* mbed */
 	int ret;
-	mbedtls_gcm_context gcm;
+	mbedtls_gcm_context *gcm;
 	unsigned char decrypted[SEC_NONCE_DENC_BUFFER_SIZE];
 
 	sec_int_lock_ctx_mutex();
@@ -1539,31 +2063,29 @@ SEC_RTN unsigned int sec_int_check_nonce(
 		LOG_INF("%s hash failed!", __func__);
 		return SEC_FAILED_INVALID_PARAM;
 	}
-	sec_int_unlock_ctx_mutex();
 
-	key_len = SEC_OWN_PUB_KEY_LEN;
-	result = sec_int_get_own_pub_key(key, &key_len);
+	gcm = sec_int_key_cache_lookup(SEC_KEY_OWN_PUB);
+	if (gcm == NULL) {
+		key_len = SEC_OWN_PUB_KEY_LEN;
+		result = sec_int_get_own_pub_key(key, &key_len);
 
-	if (result != SEC_SUCCESS) {
-		LOG_INF("%s sec_int_get_own_pub_key() failed!", __func__);
-		return result;
-	}
-
-	mbedtls_gcm_init(&gcm);
-
-	ret = mbedtls_gcm_setkey(&gcm,
-				 MBEDTLS_CIPHER_ID_AES,
-				 key,
-				 key_len * 8
-				 );
+		if (result != SEC_SUCCESS) {
+			sec_int_unlock_ctx_mutex();
+			LOG_INF("%s sec_int_get_own_pub_key() failed!",
+				__func__);
+			return result;
+		}
 
-	if (ret != 0) {
-		LOG_INF("%s mbedtls_gcm_setkey() failed!", __func__);
-		return SEC_FAILED;
+		gcm = sec_int_key_cache_set(SEC_KEY_OWN_PUB, key, key_len);
+		memset(key, 0, sizeof(key));
+		if (gcm == NULL) {
+			sec_int_unlock_ctx_mutex();
+			return SEC_FAILED;
+		}
 	}
 
 	ret = mbedtls_gcm_auth_decrypt(
-		&gcm,
+		gcm,
 		encrypted_nonce_data_len,
 		p_encrypted_nonce_iv,
 		encrypted_nonce_iv_len,
@@ -1575,11 +2097,11 @@ SEC_RTN unsigned int sec_int_check_nonce(
 		decrypted);
 
 	if (ret != 0) {
-		LOG_INF("%s sec_int_get_own_pub_key() failed!", __func__);
+		sec_int_unlock_ctx_mutex();
+		LOG_INF("%s mbedtls_gcm_auth_decrypt() failed!", __func__);
 		return SEC_FAILED;
 	}
 
-	sec_int_lock_ctx_mutex();
 	if (sec_ctx.nonce != *((unsigned int *)decrypted)) {
 		sec_int_unlock_ctx_mutex();
 		LOG_INF("%s(nonce !=*((unsigned int *)decrypted)) failed!",
@@ -1678,7 +2200,7 @@ SEC_RTN unsigned int sec_int_get_time(
 
 bool sec_hc_get_entropy_state(void)
 {
-	return sec_entropy_t.entropy_state;
+	return sec_entropy_state;
 };
 
 /*
@@ -1697,171 +2219,24 @@ int mbedtls_hardware_poll(
 	size_t *olen
 	)
 {
-	LOG_INF("\nEnter: %s\n", __func__);
-
-	unsigned int output_byte_cnt;
-	int attempt = RETRY;
-	unsigned int hw_entropy_buf = 0;
-	unsigned int hw_entropy_byte_pos = 0;
+	ARG_UNUSED(data);
 
   #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
 	*((unsigned int *)unit_test_param[0]) = 1;
   #endif
 
 	/*
-	 * Sample random number generation steps with security check with
-	 *
-	 * Caller request random number of 2 bytes 1st time after boot:
-	 * A > B > D > F
-	 *
-	 * Caller request random number of 6 bytes 1st time after boot:
-	 * A > B > D > E > F
-	 *
-	 * Caller request random number of another 6 bytes not first
-	 * time after boot:
-	 * A > B > C > D > E > F
-	 *
-	 * Caller request random number of another 3 bytes not first
-	 * time after boot:
-	 * A > B > C > D > F
-	 *
+	 * Served from the health tested DRNG pool, the pool is refilled
+	 * in bulk here when empty and topped up by the sec heci thread
+	 * between requests.
 	 */
-
-	do {
-		LOG_INF("Entropy: Default Attempts is : %d\n",
-			attempt);
-
-		hw_entropy_buf = 0;
-		hw_entropy_byte_pos = SEC_BYTE3;
-
-		/*
-		 * Step A: Byte reqest loop for given length
-		 * new drng read will fill 3bytes out of
-		 * requested length
-		 */
-		for (
-			output_byte_cnt = 0;
-			output_byte_cnt < len;
-			output_byte_cnt++
-			) {
-			if (hw_entropy_byte_pos > SEC_BYTE2) {
-				hw_entropy_byte_pos = 0;
-				/*
-				 * Step B: Generates drng random number
-				 */
-				if (sec_int_get_rand_num(
-					    &hw_entropy_buf,
-					    SEC_DRNG_EGETDATA24_SIZE_BITS) ==
-				    SEC_FAILED) {
-					LOG_INF("%s failed\n", __func__);
-					return SEC_FAILED;
-				}
-				hw_entropy_buf = hw_entropy_buf &
-						 SEC_BYTE012_SET_MSK;
-				/*
-				 * Step C: 2nd request from caller to generate first
-				 * Random after first hardware poll completed
-				 * after boot
-				 */
-				if ((sec_entropy_t.is_1st_drng_rd == false) &&
-				    (sec_entropy_t.is_not_1st_hw_poll ==
-				     true)) {
-					if (!COMPARE_DRNG_SEED(
-						    sec_entropy_t.drng_prev,
-						    hw_entropy_buf)) {
-						/*
-						 * HW Poll default attempt is set to 2,
-						 * reaching here means first attempt is over,
-						 * updating remaining last retry drng read
-						 * request
-						 */
-						attempt = attempt - 1;
-						sec_entropy_t.is_1st_drng_rd = false;
-						if (attempt <= 0) {
-							sec_entropy_t.entropy_state = false;
-							LOG_DBG("Failed seeding, init status:%d\n"
-								,
-								sec_entropy_t.entropy_state);
-							return SEC_FAILED;
-						}
-						goto retry;
-					}
-				}
-				/*
-				 * Step D: store the first hardware drng read from
-				 * current call by caller for next compare with next
-				 * hw drng read
-				 */
-				if (sec_entropy_t.is_1st_drng_rd == false) {
-					sec_entropy_t.drng_prev =
-						hw_entropy_buf;
-				}
-				/*
-				 * Step E: Compare 2nd hw drng Read with 1st hw drng
-				 * read store if prev and cur drng random num are
-				 * different
-				 */
-				if (sec_entropy_t.is_1st_drng_rd == true) {
-					if (COMPARE_DRNG_SEED(
-						    sec_entropy_t.drng_prev,
-						    hw_entropy_buf)) {
-						sec_entropy_t.drng_prev =
-							hw_entropy_buf;
-					} else {
-						/*
-						 * HW Poll default attempt is set to 2,
-						 * reaching here means first attempt is
-						 * over , updating remaining last retry
-						 * drng read request
-						 */
-						attempt = attempt - 1;
-						sec_entropy_t.is_1st_drng_rd = false;
-						if (attempt <= 0) {
-							sec_entropy_t.entropy_state = false;
-							LOG_DBG("Failed seeding, status: %d\n"
-								,
-								sec_entropy_t.entropy_state);
-							return SEC_FAILED;
-						}
-						goto retry;
-					}
-				}
-				/* set to true, once first
-				 * drng read completed
-				 */
-				sec_entropy_t.is_1st_drng_rd = true;
-			}
-
-			/*
-			 * Step: F output buf is copied with 24-bits/3bytes
-			 * New Random num request is called after output is
-			 * copied with 24bits/3bytes
-			 */
-			output[output_byte_cnt] =
-				(unsigned char)(hw_entropy_buf);
-			hw_entropy_buf = (hw_entropy_buf >> 8);
-			hw_entropy_byte_pos++;
-		} /* for loop */
-
-retry:
-		if (attempt == 2) {
-			/*
-			 * bypass pass case
-			 */
-			attempt = 0;
-		}
-	} while (attempt > 0); /* retry loop */
+	if (sec_int_entropy_pool_read(output, len) != SEC_SUCCESS) {
+		LOG_DBG("Failed seeding, init status:%d\n",
+			sec_entropy_state);
+		*olen = 0;
+		return SEC_FAILED;
+	}
 
 	*olen = len;
-
-	/*
-	 * Set entropy state is success, make 1st drng
-	 * read as default, as first hw poll is successful
-	 * set its as true
-	 */
-	sec_entropy_t.entropy_state = true;
-	sec_entropy_t.is_1st_drng_rd = false;
-	sec_entropy_t.is_not_1st_hw_poll = true;
-	LOG_INF("Entropy: Succeeded: %d\n", sec_entropy_t.entropy_state);
 	return SEC_SUCCESS;
 };
@@ -18,6 +18,8 @@
 
 #include <common/pse_app_framework.h>
 
+#include "mbedtls/gcm.h"        /** mbedtls_gcm_context */
+
 
 typedef void (*EXPIRY_FUNC)(struct k_timer *a);
 
@@ -52,6 +54,16 @@ typedef void (*EXPIRY_FUNC)(struct k_timer *a);
 #define SEC_DRNG_EGETDATA24_TIMEOUT_CYCLES 65536
 #define SEC_DRNG_EGETDATA24_SIZE_BITS 24
 
+/*
+ * DRNG entropy pool, refilled in bulk from the sideband DRNG. Every
+ * byte goes through the SP 800-90B repetition count and adaptive
+ * proportion tests, cutoffs for H = 4 bits/byte and alpha = 2^-20.
+ */
+#define SEC_ENTROPY_POOL_SIZE 96
+#define SEC_ENTROPY_RCT_CUTOFF 6
+#define SEC_ENTROPY_APT_WINDOW 512
+#define SEC_ENTROPY_APT_CUTOFF 62
+
 #define SEC_ENC_IV_SIZE 12
 #define SEC_ENC_TAG_SIZE 16
 
@@ -61,6 +73,59 @@ typedef void (*EXPIRY_FUNC)(struct k_timer *a);
 #define SEC_NONCE_DENC_TAG_SIZE 16
 #define SEC_NONCE_DENC_TIMEOUT_IN_S 30
 
+/*
+ * Key cache: derived keys are expanded into a GCM context once and
+ * reused until the key version changes (rekey, decommission or
+ * context hash mismatch).
+ */
+enum sec_key_purpose {
+	SEC_KEY_TOK_ID = 0,
+	SEC_KEY_DEV_ID,
+	SEC_KEY_MQTT_CLIENT_ID,
+	SEC_KEY_CLOUD_HASH,
+	SEC_KEY_OWN_PUB,
+	SEC_KEY_PURPOSE_MAX
+};
+
+struct sec_entropy_pool {
+	unsigned char a_pool[SEC_ENTROPY_POOL_SIZE];
+	unsigned int count;
+	/* repetition count test */
+	unsigned char rct_last;
+	unsigned int rct_count;
+	/* adaptive proportion test */
+	unsigned char apt_base;
+	unsigned int apt_count;
+	unsigned int apt_seen;
+	/* statistics */
+	unsigned int health_failures;
+	unsigned int rct_failures;
+	unsigned int apt_failures;
+	unsigned int drng_reads;
+};
+
+/*
+ * Context integrity: struct sec_context is split into segments of
+ * consecutive fields, each with its own digest. The top level a_hash is
+ * the digest of all segment digests, so a field update only rehashes
+ * its segment and the root, and a read only verifies its segment.
+ */
+enum sec_ctx_segment {
+	SEC_SEG_ROOT_CA = 0,    /* root CA, large and rarely read */
+	SEC_SEG_KEYS,           /* owner key, PSE salt */
+	SEC_SEG_IDS,            /* device and token id */
+	SEC_SEG_HOSTS,          /* cloud adapter, cloud host, proxy url */
+	SEC_SEG_CLIENT,         /* MQTT client id, cloud hash */
+	SEC_SEG_STATE,          /* proxy port, provisioning flags */
+	SEC_SEG_MAX
+};
+
+struct sec_key_cache_entry {
+	unsigned int version;
+	bool valid;
+	mbedtls_gcm_context gcm;
+};
+
 struct sec_context {
 	unsigned char a_root_ca[SEC_ROOT_CA_LEN];
 	unsigned int root_ca_len;
@@ -90,10 +155,23 @@ struct sec_context {
 	unsigned int reprov_pend;
 };
 
+/*
+ * One field of a bulk credential fetch. len is the capacity of p_data
+ * on input and the field length on output, string fields are always
+ * NUL terminated. result is the per-field status.
+ */
+struct sec_cred_item {
+	enum sec_cred_type type;
+	void *p_data;
+	unsigned int len;
+	unsigned int result;
+};
+
 struct sec_context_wrapper {
 	struct sec_context sec_ctx;
-	/* integrity check */
+	/* integrity check, root over a_seg_hash */
 	unsigned char a_hash[SEC_HASH_LEN];
+	unsigned char a_seg_hash[SEC_SEG_MAX][SEC_HASH_LEN];
 	unsigned int tran_id;
 	unsigned int nonce;
 	unsigned long nonce_time_s;
@@ -124,6 +202,10 @@ struct sec_context_wrapper {
 	/* fuse data*/
 	unsigned char a_pse_32b_fuse[SEC_FUSE_LEN];
 	unsigned int a_pse_32b_fuse_len;
+
+	/* key cache */
+	unsigned int key_version;
+	struct sec_key_cache_entry a_key_cache[SEC_KEY_PURPOSE_MAX];
 };
 
 typedef enum {
@@ -145,6 +227,14 @@ SEC_RTN int sec_int_verify_context_hash(void);
 
 SEC_RTN int sec_int_update_context_hash(void);
 
+SEC_RTN int sec_int_verify_segment_hash(
+	SEC_IN enum sec_ctx_segment seg
+	);
+
+SEC_RTN int sec_int_update_segment_hash(
+	SEC_IN enum sec_ctx_segment seg
+	);
+
 SEC_RTN int sec_int_init_context(void);
 
 /* ================================================================= */
@@ -323,6 +413,13 @@ SEC_RTN unsigned int sec_int_set_pxy_host_port(
 
 /* ================================================================= */
 
+SEC_RTN unsigned int sec_int_get_credentials(
+	SEC_INOUT struct sec_cred_item *p_items,
+	SEC_IN unsigned int count
+	);
+
+/* ================================================================= */
+
 SEC_RTN unsigned int sec_int_get_reprov_pend(
 	SEC_OUT unsigned int *p_sec_data
 	);
@@ -416,6 +513,20 @@ SEC_RTN unsigned int sec_int_check_nonce(
 	SEC_IN unsigned int tran_id
 	);
 
+/* ========================= Key Cache ================================== */
+
+SEC_RTN mbedtls_gcm_context *sec_int_key_cache_lookup(
+	SEC_IN enum sec_key_purpose purpose
+	);
+
+SEC_RTN mbedtls_gcm_context *sec_int_key_cache_set(
+	SEC_IN enum sec_key_purpose purpose,
+	SEC_IN unsigned char     *p_key,
+	SEC_IN unsigned int key_len
+	);
+
+SEC_RTN void sec_int_key_cache_invalidate(void);
+
 /* ========================= Handshake with BIOS =========================== */
 
 SEC_RTN unsigned int sec_int_start(
@@ -428,6 +539,22 @@ SEC_RTN unsigned int sec_int_get_rand_num(
 	SEC_IN unsigned int size_in_bit
 	);
 
+SEC_RTN unsigned int sec_int_entropy_pool_prefetch(void);
+
+SEC_RTN unsigned int sec_int_entropy_pool_read(
+	SEC_OUT unsigned char     *p_data,
+	SEC_IN unsigned int len
+	);
+
+SEC_RTN void sec_int_entropy_pool_reset(void);
+
+SEC_RTN const struct sec_entropy_pool *sec_int_entropy_pool_stats(void);
+
+SEC_RTN unsigned int sec_int_drbg_random(
+	SEC_OUT unsigned char     *p_data,
+	SEC_IN unsigned int len
+	);
+
 SEC_RTN unsigned int sec_int_get_rand_num_by_mbed(
 	SEC_INOUT unsigned int     *p_rand_num_data,
 	SEC_IN unsigned int size_in_bit
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Replay of a BIOS provisioning and init flow through the HECI client.
+ * Expected responses are the ones of the switch based handler the
+ * command table replaced.
+ */
+#include <zephyr.h>
+#include <string.h>
+#include <logging/log.h>
+
+#include "pse_oob_sec_base.h"
+#include "pse_oob_sec_internal.h"
+#include "pse_oob_sec_enum.h"
+#include "pse_oob_sec_heci_client.h"
+#include "pse_oob_sec_heci_client_internal.h"
+
+LOG_MODULE_REGISTER(OOB_SEC_HC_UNITTEST, CONFIG_OOB_LOGGING);
+
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+
+#define HC_HDR_LEN sizeof(struct sec_hc_cmd_hdr_t)
+#define HC_ITEM_LEN(len) (sizeof(union sec_hc_cmd_data_hdr_u) + (len))
+/* Encrypted credential with its IV and tag */
+#define HC_ENC_LEN(len) (HC_ITEM_LEN(len) + \
+			 HC_ITEM_LEN(SEC_ENC_IV_SIZE) + \
+			 HC_ITEM_LEN(SEC_ENC_TAG_SIZE))
+
+#define HC_REPLAY_STATUS_LOOP 1000
+
+static uint8_t hc_rx[SEC_HC_MAX_RX_SIZE];
+static uint8_t hc_prov_resp[SEC_HC_MAX_RX_SIZE];
+static unsigned int hc_prov_resp_len;
+
+static const unsigned char hc_tok_id[] = "replay-token-id";
+static const unsigned char hc_dev_id[] = "replay-device-id";
+static const unsigned char hc_mqtt_id[] = "replay-mqtt-client";
+static const unsigned char hc_cld_url[] = "mqtt.example.com";
+static const unsigned int hc_cld_port = 8883;
+static unsigned char hc_cld_hash[SEC_CLOUD_HASH_LEN];
+static unsigned char hc_seed[SEC_CSE_SEED_LEN];
+
+static unsigned int hc_put(unsigned int off, unsigned int type,
+			   const void *data, unsigned int len)
+{
+	union sec_hc_cmd_data_hdr_u hdr = { 0 };
+
+	hdr.bitfields.type = type;
+	hdr.bitfields.length = HC_ITEM_LEN(len);
+	memcpy(&hc_rx[off], &hdr, sizeof(hdr));
+	memcpy(&hc_rx[off + sizeof(hdr)], data, len);
+
+	return off + HC_ITEM_LEN(len);
+}
+
+/* Copy one item of a previous response into the message */
+static unsigned int hc_put_from(unsigned int off, const uint8_t *resp,
+				unsigned int resp_len, unsigned int type)
+{
+	union sec_hc_cmd_data_hdr_u hdr;
+	unsigned int pos = HC_HDR_LEN;
+
+	while (pos < resp_len) {
+		memcpy(&hdr, &resp[pos], sizeof(hdr));
+		if (hdr.bitfields.type == type) {
+			memcpy(&hc_rx[off], &resp[pos], hdr.bitfields.length);
+			return off + hdr.bitfields.length;
+		}
+		pos += hdr.bitfields.length;
+	}
+
+	return off;
+}
+
+/* Encrypted items of the PROV_INIT_OOB response, in order */
+static const unsigned int hc_prov_types[] = {
+	SEC_HC_TYPE_HKDF_32B_PSE_SALT,
+	SEC_HC_TYPE_ENC_TOK_ID,
+	SEC_HC_TYPE_ENC_TOK_ID_IV,
+	SEC_HC_TYPE_ENC_TOK_ID_TAG,
+	SEC_HC_TYPE_ENC_DEV_ID,
+	SEC_HC_TYPE_ENC_DEV_ID_IV,
+	SEC_HC_TYPE_ENC_DEV_ID_TAG,
+	SEC_HC_TYPE_ENC_MQTT_CLIENT_ID,
+	SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_IV,
+	SEC_HC_TYPE_ENC_MQTT_CLIENT_ID_TAG,
+	SEC_HC_TYPE_ENC_CLOUD_HASH_ID,
+	SEC_HC_TYPE_ENC_CLOUD_HASH_ID_IV,
+	SEC_HC_TYPE_ENC_CLOUD_HASH_ID_TAG,
+};
+
+/* Clear credentials as BIOS sends them at provisioning */
+static unsigned int hc_prov_init_msg(void)
+{
+	unsigned int off = HC_HDR_LEN;
+
+	off = hc_put(off, SEC_HC_TYPE_DENC_TOK_ID, hc_tok_id,
+		     sizeof(hc_tok_id));
+	off = hc_put(off, SEC_HC_TYPE_DENC_DEV_ID, hc_dev_id,
+		     sizeof(hc_dev_id));
+	off = hc_put(off, SEC_HC_TYPE_DENC_MQTT_CLIENT_ID, hc_mqtt_id,
+		     sizeof(hc_mqtt_id));
+	off = hc_put(off, SEC_HC_TYPE_DENC_CLOUD_HASH_ID, hc_cld_hash,
+		     sizeof(hc_cld_hash));
+	off = hc_put(off, SEC_HC_TYPE_CLD_URL, hc_cld_url,
+		     sizeof(hc_cld_url));
+	off = hc_put(off, SEC_HC_TYPE_CLD_PORT, &hc_cld_port,
+		     sizeof(hc_cld_port));
+	return hc_put(off, SEC_HC_TYPE_PSE_SEED_1, hc_seed, sizeof(hc_seed));
+}
+
+/* Stored PROV_INIT_OOB response sent back at boot */
+static unsigned int hc_init_oob2_msg(void)
+{
+	unsigned int off = HC_HDR_LEN;
+
+	for (int i = 0; i < ARRAY_SIZE(hc_prov_types); i++) {
+		off = hc_put_from(off, hc_prov_resp, hc_prov_resp_len,
+				  hc_prov_types[i]);
+	}
+	off = hc_put(off, SEC_HC_TYPE_DENC_CLOUD_HASH_ID, hc_cld_hash,
+		     sizeof(hc_cld_hash));
+	return hc_put(off, SEC_HC_TYPE_PSE_SEED_1, hc_seed, sizeof(hc_seed));
+}
+
+static uint32_t hc_send(unsigned int command, unsigned int len)
+{
+	struct sec_hc_cmd_hdr_t *hdr = (struct sec_hc_cmd_hdr_t *)hc_rx;
+	uint32_t start;
+
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->msg_comp = SEC_HC_LAST_MSG_YES;
+	hdr->protocol_ver = SEC_HC_MAJOR_MINOR_VERSION;
+	hdr->source = SEC_HC_SOURCE_BIOS;
+	hdr->length = len;
+	hdr->command = command;
+
+	unit_test_hc_tx_len = 0;
+	start = k_cycle_get_32();
+	sec_hc_process_cmd(hc_rx);
+
+	return k_cyc_to_us_floor32(k_cycle_get_32() - start);
+}
+
+static const struct sec_hc_cmd_hdr_t *hc_tx_hdr(void)
+{
+	return (const struct sec_hc_cmd_hdr_t *)unit_test_hc_tx;
+}
+
+/* Header length field counts the header, it is sent once more in front */
+static unsigned int hc_tx_len(void)
+{
+	return hc_tx_hdr()->length + HC_HDR_LEN;
+}
+
+static unsigned int hc_tx_item_type(unsigned int idx)
+{
+	union sec_hc_cmd_data_hdr_u hdr;
+	unsigned int pos = HC_HDR_LEN;
+
+	for (;;) {
+		memcpy(&hdr, &unit_test_hc_tx[pos], sizeof(hdr));
+		if (idx-- == 0) {
+			return hdr.bitfields.type;
+		}
+		pos += hdr.bitfields.length;
+	}
+}
+
+int test_sec_hc_replay(void)
+{
+	int result = SEC_SUCCESS;
+	unsigned char buf[SEC_TOK_ID_LEN];
+	unsigned int len, off, us, total_us;
+	unsigned int prov_state;
+
+	LOG_INF("Begin to replay BIOS HECI messages\n");
+	LOG_INF("==================================\n");
+
+	memset(hc_cld_hash, 0xC5, sizeof(hc_cld_hash));
+	memset(hc_seed, 0x3A, sizeof(hc_seed));
+
+	/* STATUS_OOB: OOB status item only */
+	us = hc_send(SEC_HC_STATUS_OOB, HC_HDR_LEN);
+	sec_int_get_prov_state(&prov_state);
+	SEC_ASSERT(hc_tx_hdr()->length == HC_HDR_LEN + HC_ITEM_LEN(4));
+	SEC_ASSERT(unit_test_hc_tx_len == hc_tx_len());
+	SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_STATUS_OOB_RES);
+	SEC_ASSERT(hc_tx_item_type(0) == SEC_HC_TYPE_OOB_STATUS);
+	SEC_ASSERT(!memcmp(&unit_test_hc_tx[HC_HDR_LEN + HC_ITEM_LEN(0)],
+			   &prov_state, sizeof(prov_state)));
+	LOG_INF("STATUS_OOB: %u us\n", us);
+
+	/* PROV_INIT_OOB: clear credentials in, encrypted ones out */
+	us = hc_send(SEC_HC_PROV_INIT_OOB, hc_prov_init_msg());
+
+	len = HC_HDR_LEN + HC_ITEM_LEN(SEC_PSE_SALT_LEN) +
+	      HC_ENC_LEN(SEC_TOK_ID_LEN) + HC_ENC_LEN(SEC_DEV_ID_LEN) +
+	      HC_ENC_LEN(SEC_MQTT_CLIENT_ID_LEN) +
+	      HC_ENC_LEN(SEC_CLOUD_HASH_LEN);
+	SEC_ASSERT(hc_tx_hdr()->length == len);
+	SEC_ASSERT(unit_test_hc_tx_len == hc_tx_len());
+	SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_PROV_INIT_OK);
+	for (int i = 0; i < ARRAY_SIZE(hc_prov_types); i++) {
+		SEC_ASSERT(hc_tx_item_type(i) == hc_prov_types[i]);
+	}
+	SEC_ASSERT(!memcmp(&unit_test_hc_tx[HC_HDR_LEN +
+					    HC_ITEM_LEN(SEC_PSE_SALT_LEN) +
+					    HC_ITEM_LEN(0)],
+			   sec_ctx.a_enc_tok_id, SEC_TOK_ID_LEN));
+	LOG_INF("PROV_INIT_OOB: %u us\n", us);
+
+	/* BIOS stores the encrypted response */
+	hc_prov_resp_len = unit_test_hc_tx_len;
+	memcpy(hc_prov_resp, unit_test_hc_tx, hc_prov_resp_len);
+
+	/* PROV_INIT_ACK: empty acknowledge */
+	us = hc_send(SEC_HC_PROV_INIT_ACK, HC_HDR_LEN);
+	SEC_ASSERT(hc_tx_hdr()->length == HC_HDR_LEN);
+	SEC_ASSERT(unit_test_hc_tx_len == hc_tx_len());
+	SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_PROV_INIT_ACK2);
+	LOG_INF("PROV_INIT_ACK: %u us\n", us);
+
+	/* Next boot: context lost, BIOS sends the stored blobs back */
+	len = sizeof("lost");
+	sec_int_set_tok_id((void *)"lost", &len);
+
+	us = hc_send(SEC_HC_INIT_OOB2, hc_init_oob2_msg());
+
+	SEC_ASSERT(hc_tx_hdr()->length == HC_HDR_LEN + HC_ITEM_LEN(4));
+	SEC_ASSERT(unit_test_hc_tx_len == hc_tx_len());
+	SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_INIT_ACK);
+	SEC_ASSERT(hc_tx_item_type(0) == SEC_HC_TYPE_NORMAL_FLW_SUCCESS);
+	memset(buf, 0, sizeof(buf));
+	sec_int_get_tok_id(buf, &len);
+	SEC_ASSERT(!memcmp(buf, hc_tok_id, sizeof(hc_tok_id)));
+	LOG_INF("INIT_OOB2: %u us\n", us);
+
+	/* INIT_ACK2: no response, init flow done */
+	us = hc_send(SEC_HC_INIT_ACK2, HC_HDR_LEN);
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+	SEC_ASSERT(sec_int_start_init_flag == 1);
+	LOG_INF("INIT_ACK2: %u us\n", us);
+
+	/* Unknown command is dropped */
+	hc_send(SEC_HC_TESTING, HC_HDR_LEN);
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+
+	/* Zero length data item must not hang the parser */
+	off = hc_put(HC_HDR_LEN, SEC_HC_TYPE_CLD_URL, "", 0);
+	((union sec_hc_cmd_data_hdr_u *)&hc_rx[HC_HDR_LEN])->bitfields.length
+		= 0;
+	hc_send(SEC_HC_INIT_OOB, off);
+	SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_INIT_OOB_OK);
+
+	/* Payload out of the command range is dropped before its handler */
+	hc_send(SEC_HC_STATUS_OOB, HC_HDR_LEN + HC_ITEM_LEN(0));
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+	hc_send(SEC_HC_INIT_OOB, HC_HDR_LEN);
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+	prov_state = SEC_RPROV;
+	sec_int_set_prov_state(&prov_state);
+	hc_send(SEC_HC_RPROV_ACK, HC_HDR_LEN + HC_ITEM_LEN(0));
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+	sec_int_get_prov_state(&prov_state);
+	SEC_ASSERT(prov_state == SEC_RPROV);
+
+	/* Dispatch cost of the cheapest command */
+	total_us = 0;
+	for (int i = 0; i < HC_REPLAY_STATUS_LOOP; i++) {
+		total_us += hc_send(SEC_HC_STATUS_OOB, HC_HDR_LEN);
+	}
+	LOG_INF("STATUS_OOB avg: %u us\n", total_us / HC_REPLAY_STATUS_LOOP);
+
+	return result;
+}
+
+#define HC_SOAK_LOOP 1000
+#define HC_SOAK_BUCKETS 6
+
+/* Long running provisioning and boot flow through the dispatcher:
+ * latency distribution of the encrypt and decrypt commands and no
+ * growth of the crypto work buffers.
+ */
+int test_sec_hc_crypto_soak(void)
+{
+	int result = SEC_SUCCESS;
+	unsigned char buf[SEC_TOK_ID_LEN];
+	unsigned int len, us, max_us = 0;
+	unsigned int free_before;
+	void *p_blocks[SEC_HC_CRYPTO_BUF_NUM];
+	const unsigned int bucket_us[HC_SOAK_BUCKETS] = {
+		500, 1000, 2000, 5000, 10000, UINT32_MAX
+	};
+	unsigned int hist[HC_SOAK_BUCKETS] = { 0 };
+	int b;
+
+	memset(hc_cld_hash, 0xC5, sizeof(hc_cld_hash));
+	memset(hc_seed, 0x3A, sizeof(hc_seed));
+
+	free_before = k_mem_slab_num_free_get(&sec_hc_crypto_slab);
+	SEC_ASSERT(free_before == SEC_HC_CRYPTO_BUF_NUM);
+
+	for (int i = 0; i < HC_SOAK_LOOP; i++) {
+		us = hc_send(SEC_HC_PROV_INIT_OOB, hc_prov_init_msg());
+		SEC_ASSERT(hc_tx_hdr()->command == SEC_HC_PROV_INIT_OK);
+		hc_prov_resp_len = unit_test_hc_tx_len;
+		memcpy(hc_prov_resp, unit_test_hc_tx, hc_prov_resp_len);
+
+		len = sizeof("lost");
+		sec_int_set_tok_id((void *)"lost", &len);
+		us += hc_send(SEC_HC_INIT_OOB2, hc_init_oob2_msg());
+		SEC_ASSERT(hc_tx_item_type(0) ==
+			   SEC_HC_TYPE_NORMAL_FLW_SUCCESS);
+
+		for (b = 0; us >= bucket_us[b]; b++) {
+		}
+		hist[b]++;
+		max_us = MAX(max_us, us);
+
+		SEC_ASSERT(k_mem_slab_num_free_get(&sec_hc_crypto_slab) ==
+			   free_before);
+		if (result != SEC_SUCCESS) {
+			break;
+		}
+	}
+
+	LOG_INF("PROV_INIT_OOB + INIT_OOB2 x %d, max %u us\n",
+		HC_SOAK_LOOP, max_us);
+	for (b = 0; b < HC_SOAK_BUCKETS; b++) {
+		LOG_INF("  < %u us: %u\n", bucket_us[b], hist[b]);
+	}
+
+	/* Decrypted token id must round trip */
+	memset(buf, 0, sizeof(buf));
+	sec_int_get_tok_id(buf, &len);
+	SEC_ASSERT(!memcmp(buf, hc_tok_id, sizeof(hc_tok_id)));
+
+	/* All buffers taken: command fails busy, never waits or allocates */
+	for (b = 0; b < SEC_HC_CRYPTO_BUF_NUM; b++) {
+		SEC_ASSERT(k_mem_slab_alloc(&sec_hc_crypto_slab,
+					    &p_blocks[b], K_NO_WAIT) == 0);
+	}
+	hc_send(SEC_HC_PROV_INIT_OOB, hc_prov_init_msg());
+	SEC_ASSERT(unit_test_hc_tx_len == 0);
+	for (b = 0; b < SEC_HC_CRYPTO_BUF_NUM; b++) {
+		k_mem_slab_free(&sec_hc_crypto_slab, &p_blocks[b]);
+	}
+	SEC_ASSERT(k_mem_slab_num_free_get(&sec_hc_crypto_slab) ==
+		   free_before);
+
+	return result;
+}
+
+#endif /* SEC_UNIT_TEST */
@@ -14,9 +14,13 @@
  */
 #include "pse_oob_sec_base.h"
 #include "pse_oob_sec_internal.h"
+#include "pse_oob_sec_heci_client.h"
+#include "pse_oob_sec_heci_client_internal.h"
+#include "pse_oob_sec_status_code.h"
 
 #include <string.h>
 #include <stdio.h>
+#include <stddef.h>
 
 #include <logging/log.h>
 LOG_MODULE_REGISTER(OOB_SEC_UNITTEST, CONFIG_OOB_LOGGING);
@@ -27,8 +31,10 @@ LOG_MODULE_REGISTER(OOB_SEC_UNITTEST, CONFIG_OOB_LOGGING);
  */
 
 #include "mbedtls/sha256.h"     /* SHA-256 only */
+#include "mbedtls/sha512.h"     /* SHA-384/512 */
 #include "mbedtls/md.h"         /* generic interface */
 #include "mbedtls/gcm.h"        /* mbedtls_gcm_context */
+#include "mbedtls/hkdf.h"
 
 
 #if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
@@ -43,98 +49,187 @@ unsigned int clear_text_size_for_hash;
 unsigned int default_ctx_init_value_in_byte;
 unsigned int mbedtls_hardware_poll_flag;
 
-/* See https://github.com/wolfeidau/mbedtls/tree/master/test/example-hashing
- *  for test pattern.
- */
-SEC_RTN int unit_test_sec_int_verify_context_hash(void)
+/* Reference digests computed straight from the segment layout */
+static void unit_test_hash_segments(
+	unsigned char seg_hash[SEC_SEG_MAX][SEC_HASH_LEN],
+	unsigned char *root_hash)
 {
-	int result;
-	unsigned char *clear_text;
+	unsigned int offset[SEC_SEG_MAX + 1] = {
+		offsetof(struct sec_context, a_root_ca),
+		offsetof(struct sec_context, a_own_pub_key),
+		offsetof(struct sec_context, a_dev_id),
+		offsetof(struct sec_context, a_cld_adapter),
+		offsetof(struct sec_context, a_mqtt_client_id),
+		offsetof(struct sec_context, pxy_host_port),
+		sizeof(struct sec_context)
+	};
 
+	for (int i = 0; i < SEC_SEG_MAX; i++) {
+		mbedtls_sha512((unsigned char *)&(sec_ctx.sec_ctx) + offset[i],
+			       offset[i + 1] - offset[i], seg_hash[i], 1);
+	}
+	mbedtls_sha512((unsigned char *)seg_hash,
+		       SEC_SEG_MAX * SEC_HASH_LEN, root_hash, 1);
+}
 
-	unsigned char expected_hash[] = {
-		0x31, 0x5f, 0x5b, 0xdb, 0x76, 0xd0, 0x78, 0xc4, 0x3b, 0x8a,
-		0xc0, 0x06, 0x4e, 0x4a, 0x01, 0x64, 0x61, 0x2b, 0x1f, 0xce,
-		0x77, 0xc8, 0x69, 0x34, 0x5b, 0xfc, 0x94, 0xc7, 0x58, 0x94,
-		0xed, 0xd3
-	};
+SEC_RTN int unit_test_sec_int_verify_context_hash(void)
+{
+	int result;
 
 	result = SEC_SUCCESS;
 
-	/* Initialize clear text value */
-	clear_text = (unsigned char *)&(sec_ctx.sec_ctx);
-	clear_text_size_for_hash = 13;
-
-	clear_text[0] = 'H';
-	clear_text[1] = 'e';
-	clear_text[2] = 'l';
-	clear_text[3] = 'l';
-	clear_text[4] = 'o';
-	clear_text[5] = ',';
-	clear_text[6] = ' ';
-	clear_text[7] = 'w';
-	clear_text[8] = 'o';
-	clear_text[9] = 'r';
-	clear_text[10] = 'l';
-	clear_text[11] = 'd';
-	clear_text[12] = '!';
+	memset((void *)&(sec_ctx.sec_ctx), 0, sizeof(sec_ctx.sec_ctx));
+	memcpy(sec_ctx.sec_ctx.a_root_ca, "Hello, world!", 13);
 
-	unit_test_param[0] = (void *)&clear_text_size_for_hash;
-
-	/* Initialize hash value */
-	for (int i = 0; i < SEC_HASH_LEN; i++) {
-		sec_ctx.a_hash[i] = expected_hash[i];
-	}
+	unit_test_hash_segments(sec_ctx.a_seg_hash, sec_ctx.a_hash);
 
 	SEC_ASSERT(((sec_int_verify_context_hash()) == SEC_SUCCESS));
+	for (int seg = 0; seg < SEC_SEG_MAX; seg++) {
+		SEC_ASSERT((sec_int_verify_segment_hash(seg) == SEC_SUCCESS));
+	}
 
 	return result;
 }
 
-/* See https://github.com/wolfeidau/mbedtls/tree/master/test/example-hashing
- *  for test pattern.
- */
 SEC_RTN int unit_test_sec_int_update_context_hash(void)
 {
 	int result;
-	unsigned char *clear_text;
-	unsigned int clear_text_size_for_hash;
+	unsigned char expected_seg_hash[SEC_SEG_MAX][SEC_HASH_LEN];
+	unsigned char expected_hash[SEC_HASH_LEN];
+
+	result = SEC_SUCCESS;
 
-	unsigned char expected_hash[] = {
-		0x31, 0x5f, 0x5b, 0xdb, 0x76, 0xd0, 0x78, 0xc4, 0x3b, 0x8a,
-		0xc0, 0x06, 0x4e, 0x4a, 0x01, 0x64, 0x61, 0x2b, 0x1f, 0xce,
-		0x77, 0xc8, 0x69, 0x34, 0x5b, 0xfc, 0x94, 0xc7, 0x58, 0x94,
-		0xed, 0xd3
+	memset((void *)&(sec_ctx.sec_ctx), 0, sizeof(sec_ctx.sec_ctx));
+	memcpy(sec_ctx.sec_ctx.a_root_ca, "Hello, world!", 13);
+
+	unit_test_hash_segments(expected_seg_hash, expected_hash);
+
+	SEC_ASSERT((sec_int_update_context_hash() == SEC_SUCCESS));
+
+	SEC_ASSERT((memcmp(expected_hash, sec_ctx.a_hash,
+			   SEC_HASH_LEN) == 0));
+	SEC_ASSERT((memcmp(expected_seg_hash, sec_ctx.a_seg_hash,
+			   sizeof(expected_seg_hash)) == 0));
+
+	/* Single segment update must land on the same digests */
+	sec_ctx.sec_ctx.prov_state = 1;
+	unit_test_hash_segments(expected_seg_hash, expected_hash);
+	SEC_ASSERT((sec_int_update_segment_hash(SEC_SEG_STATE) ==
+		    SEC_SUCCESS));
+	SEC_ASSERT((memcmp(expected_hash, sec_ctx.a_hash,
+			   SEC_HASH_LEN) == 0));
+	sec_ctx.sec_ctx.prov_state = 0;
+	sec_int_update_context_hash();
+
+	return result;
+}
+
+SEC_RTN int unit_test_sec_int_segment_hash_tamper(void)
+{
+	int result;
+	unsigned int offset[SEC_SEG_MAX] = {
+		offsetof(struct sec_context, a_root_ca),
+		offsetof(struct sec_context, a_own_pub_key),
+		offsetof(struct sec_context, a_dev_id),
+		offsetof(struct sec_context, a_cld_adapter),
+		offsetof(struct sec_context, a_mqtt_client_id),
+		offsetof(struct sec_context, pxy_host_port)
 	};
+	unsigned char *ctx = (unsigned char *)&(sec_ctx.sec_ctx);
+	unsigned char keys_hash[SEC_HASH_LEN];
+	char root_ca[] = "Tamper test root CA";
+	unsigned int root_ca_len = sizeof(root_ca);
 
 	result = SEC_SUCCESS;
 
-	/* Initialize clear text value */
-	clear_text = (unsigned char *)&(sec_ctx.sec_ctx);
-	clear_text_size_for_hash = 13;
-
-	clear_text[0] = 'H';
-	clear_text[1] = 'e';
-	clear_text[2] = 'l';
-	clear_text[3] = 'l';
-	clear_text[4] = 'o';
-	clear_text[5] = ',';
-	clear_text[6] = ' ';
-	clear_text[7] = 'w';
-	clear_text[8] = 'o';
-	clear_text[9] = 'r';
-	clear_text[10] = 'l';
-	clear_text[11] = 'd';
-	clear_text[12] = '!';
+	sec_int_update_context_hash();
+
+	/* Tampered data is caught by its own segment and the full check */
+	for (int seg = 0; seg < SEC_SEG_MAX; seg++) {
+		ctx[offset[seg]] ^= 0xFF;
+		SEC_ASSERT((sec_int_verify_segment_hash(seg) ==
+			    SEC_FAILED_OOB_HASH_MISMATCH));
+		SEC_ASSERT((sec_int_verify_context_hash() ==
+			    SEC_FAILED_OOB_HASH_MISMATCH));
+		ctx[offset[seg]] ^= 0xFF;
+		SEC_ASSERT((sec_int_verify_segment_hash(seg) == SEC_SUCCESS));
+	}
 
-	unit_test_param[0] = (void *)&clear_text_size_for_hash;
+	/* Tampered segment digest breaks the root for every segment */
+	sec_ctx.a_seg_hash[SEC_SEG_IDS][0] ^= 0xFF;
+	for (int seg = 0; seg < SEC_SEG_MAX; seg++) {
+		SEC_ASSERT((sec_int_verify_segment_hash(seg) ==
+			    SEC_FAILED_OOB_HASH_MISMATCH));
+	}
+	sec_ctx.a_seg_hash[SEC_SEG_IDS][0] ^= 0xFF;
 
-	SEC_ASSERT((sec_int_update_context_hash() == SEC_SUCCESS));
+	/* Tampered root */
+	sec_ctx.a_hash[SEC_HASH_LEN - 1] ^= 0xFF;
+	SEC_ASSERT((sec_int_verify_segment_hash(SEC_SEG_KEYS) ==
+		    SEC_FAILED_OOB_HASH_MISMATCH));
+	sec_ctx.a_hash[SEC_HASH_LEN - 1] ^= 0xFF;
 
-	for (int i = 0; i < SEC_HASH_LEN; i++) {
+	SEC_ASSERT((sec_int_verify_context_hash() == SEC_SUCCESS));
+	SEC_ASSERT((sec_int_verify_segment_hash(SEC_SEG_MAX) ==
+		    SEC_FAILED_INVALID_PARAM));
+
+	/* Root CA update leaves the owner key and salt digest alone */
+	memcpy(keys_hash, sec_ctx.a_seg_hash[SEC_SEG_KEYS], SEC_HASH_LEN);
+	SEC_ASSERT((sec_int_set_root_ca(root_ca, &root_ca_len) ==
+		    SEC_SUCCESS));
+	SEC_ASSERT((memcmp(keys_hash, sec_ctx.a_seg_hash[SEC_SEG_KEYS],
+			   SEC_HASH_LEN) == 0));
+	SEC_ASSERT((sec_int_verify_context_hash() == SEC_SUCCESS));
+
+	return result;
+}
+
+#define SEC_UNIT_TEST_HASH_LOOP 200
 
-		SEC_ASSERT((expected_hash[i] == sec_ctx.a_hash[i]));
+/* Cost of one counter update, full context rehash against segment.
+ * Timings are only reported, the check is on the bytes hashed.
+ */
+SEC_RTN int unit_test_sec_int_segment_hash_perf(void)
+{
+	int result;
+	unsigned long start, full_ms, seg_ms;
+	unsigned int full_bytes, seg_bytes;
+	const unsigned int root_bytes = sizeof(sec_ctx.a_seg_hash);
+	const unsigned int state_bytes = sizeof(struct sec_context) -
+		offsetof(struct sec_context, pxy_host_port);
+
+	result = SEC_SUCCESS;
+
+	unit_test_hash_bytes = 0;
+	sec_int_get_time(&start);
+	for (int i = 0; i < SEC_UNIT_TEST_HASH_LOOP; i++) {
+		sec_ctx.sec_ctx.reprov_pend = i;
+		sec_int_update_context_hash();
+	}
+	sec_int_get_time(&full_ms);
+	full_ms -= start;
+	full_bytes = unit_test_hash_bytes;
+
+	unit_test_hash_bytes = 0;
+	sec_int_get_time(&start);
+	for (int i = 0; i < SEC_UNIT_TEST_HASH_LOOP; i++) {
+		sec_ctx.sec_ctx.reprov_pend = i;
+		sec_int_update_segment_hash(SEC_SEG_STATE);
 	}
+	sec_int_get_time(&seg_ms);
+	seg_ms -= start;
+	seg_bytes = unit_test_hash_bytes;
+
+	LOG_INF("%d updates: full context %lu ms %u bytes, "
+		"segment %lu ms %u bytes\n", SEC_UNIT_TEST_HASH_LOOP,
+		full_ms, full_bytes, seg_ms, seg_bytes);
+	SEC_ASSERT(full_bytes == SEC_UNIT_TEST_HASH_LOOP *
+		   (sizeof(struct sec_context) + root_bytes));
+	SEC_ASSERT(seg_bytes == SEC_UNIT_TEST_HASH_LOOP *
+		   (state_bytes + root_bytes));
+
+	sec_ctx.sec_ctx.reprov_pend = 0;
+	sec_int_update_context_hash();
 
 	return result;
 }
@@ -1305,10 +1400,16 @@ SEC_RTN int unit_test_sec_int_get_rand_num_by_mbed(void)
 
 	unit_test_param[0] = (void *)&clear_text_size_for_hash;
 
+	/* The fixed test pattern fails the DRNG health tests */
+	unit_test_drng_read = unit_test_drng_healthy;
+	sec_int_entropy_pool_reset();
+
 	SEC_ASSERT((sec_int_get_rand_num_by_mbed(
 			    &rand_num_data, SEC_DRNG_EGETDATA24_SIZE_BITS) == SEC_SUCCESS));
-	SEC_ASSERT(rand_num_data == 0x00f354ad);
 	SEC_ASSERT(mbedtls_hardware_poll_flag = 1);
+	SEC_ASSERT(sec_int_entropy_pool_stats()->health_failures == 0);
+
+	unit_test_drng_read = NULL;
 
 	return result;
 }
@@ -1411,6 +1512,304 @@ SEC_RTN int unit_test_sec_int_check_nonce(void)
 	return result;
 }
 
+SEC_RTN int unit_test_sec_int_key_cache(void)
+{
+	int result;
+
+	unsigned char key[SEC_FUSE_LEN + 1] =
+		"KE123456789012345678901234567890";
+	unsigned char salt[SEC_PSE_SALT_LEN + 1] =
+		"SA123456789012345678901234567890";
+	unsigned int salt_len = SEC_PSE_SALT_LEN;
+	unsigned char iv[SEC_ENC_IV_SIZE + 1] = "IV1234567890";
+	unsigned char clear_text[SEC_MQTT_CLIENT_ID_LEN] = "a secret message!";
+	unsigned char enc_cached[SEC_MQTT_CLIENT_ID_LEN];
+	unsigned char enc_fresh[SEC_MQTT_CLIENT_ID_LEN];
+	unsigned char tag_cached[SEC_ENC_TAG_SIZE];
+	unsigned char tag_fresh[SEC_ENC_TAG_SIZE];
+	unsigned int version;
+	mbedtls_gcm_context *cached;
+	mbedtls_gcm_context gcm;
+
+	result = SEC_SUCCESS;
+
+	clear_text_size_for_hash = sizeof(sec_ctx.sec_ctx);
+	unit_test_param[0] = (void *)&clear_text_size_for_hash;
+	sec_int_update_context_hash();
+
+	sec_int_key_cache_invalidate();
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_TOK_ID) == NULL);
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_PURPOSE_MAX) == NULL);
+
+	cached = sec_int_key_cache_set(SEC_KEY_TOK_ID, key, SEC_FUSE_LEN);
+	SEC_ASSERT(cached != NULL);
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_TOK_ID) == cached);
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_DEV_ID) == NULL);
+
+	/* Cached context must produce the same output as a fresh one,
+	 * also when used a second time
+	 */
+	mbedtls_gcm_init(&gcm);
+	SEC_ASSERT(mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES,
+				      key, SEC_FUSE_LEN * 8) == 0);
+	SEC_ASSERT(mbedtls_gcm_crypt_and_tag(
+			   &gcm, MBEDTLS_GCM_ENCRYPT, sizeof(clear_text),
+			   iv, SEC_ENC_IV_SIZE, (unsigned char *)"", 0,
+			   clear_text, enc_fresh,
+			   SEC_ENC_TAG_SIZE, tag_fresh) == 0);
+	mbedtls_gcm_free(&gcm);
+
+	for (int i = 0; i < 2; i++) {
+		SEC_ASSERT(mbedtls_gcm_crypt_and_tag(
+				   cached, MBEDTLS_GCM_ENCRYPT,
+				   sizeof(clear_text),
+				   iv, SEC_ENC_IV_SIZE, (unsigned char *)"", 0,
+				   clear_text, enc_cached,
+				   SEC_ENC_TAG_SIZE, tag_cached) == 0);
+		SEC_ASSERT(memcmp(enc_cached, enc_fresh,
+				  sizeof(enc_fresh)) == 0);
+		SEC_ASSERT(memcmp(tag_cached, tag_fresh,
+				  sizeof(tag_fresh)) == 0);
+	}
+
+	/* Rekey drops every cached key */
+	version = sec_ctx.key_version;
+	SEC_ASSERT(sec_int_set_hkdf_32b_pse_salt(salt, &salt_len) ==
+		   SEC_SUCCESS);
+	SEC_ASSERT(sec_ctx.key_version != version);
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_TOK_ID) == NULL);
+
+	/* So does a context hash mismatch */
+	SEC_ASSERT(sec_int_key_cache_set(SEC_KEY_TOK_ID, key,
+					 SEC_FUSE_LEN) != NULL);
+	sec_ctx.a_hash[0] ^= 0xFF;
+	SEC_ASSERT(sec_int_verify_context_hash() != SEC_SUCCESS);
+	SEC_ASSERT(sec_int_key_cache_lookup(SEC_KEY_TOK_ID) == NULL);
+	sec_int_update_context_hash();
+
+	sec_int_key_cache_invalidate();
+
+	return result;
+}
+
+#define SEC_UNIT_TEST_ENC_LOOP 1000
+
+/* Encrypt ops per second, key derivation and AES key schedule on every
+ * call (previous flow) against the cached GCM context. Timings are only
+ * reported, the check is that the cached path schedules the key once.
+ */
+SEC_RTN int unit_test_sec_int_key_cache_perf(void)
+{
+	int result;
+
+	unsigned char fuse[SEC_FUSE_LEN + 1] =
+		"FU123456789012345678901234567890";
+	unsigned char salt[SEC_PSE_SALT_LEN + 1] =
+		"SA123456789012345678901234567890";
+	unsigned char iv[SEC_ENC_IV_SIZE + 1] = "IV1234567890";
+	unsigned char clear_text[SEC_MQTT_CLIENT_ID_LEN] = "a secret message!";
+	unsigned char encrypted[SEC_MQTT_CLIENT_ID_LEN];
+	unsigned char tag[SEC_ENC_TAG_SIZE];
+	unsigned char key[SEC_FUSE_LEN];
+	unsigned long start, uncached_ms, cached_ms;
+	unsigned int setups, len;
+	const mbedtls_md_info_t *p_md_info =
+		mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+	mbedtls_gcm_context gcm;
+
+	result = SEC_SUCCESS;
+
+	sec_int_get_time(&start);
+	for (int i = 0; i < SEC_UNIT_TEST_ENC_LOOP; i++) {
+		mbedtls_hkdf(p_md_info, salt, SEC_PSE_SALT_LEN,
+			     fuse, SEC_FUSE_LEN,
+			     (unsigned char *)"MQTT_ID_ENC_KEY",
+			     strlen("MQTT_ID_ENC_KEY"), key, SEC_FUSE_LEN);
+		mbedtls_gcm_init(&gcm);
+		mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES,
+				   key, SEC_FUSE_LEN * 8);
+		mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT,
+					  sizeof(clear_text), iv,
+					  SEC_ENC_IV_SIZE,
+					  (unsigned char *)"", 0, clear_text,
+					  encrypted, SEC_ENC_TAG_SIZE, tag);
+		mbedtls_gcm_free(&gcm);
+	}
+	sec_int_get_time(&uncached_ms);
+	uncached_ms -= start;
+
+	/* Production encrypt path, key derived and scheduled once. Fuse
+	 * and salt updates drop any cached key.
+	 */
+	len = SEC_FUSE_LEN;
+	SEC_ASSERT(sec_int_set_pse_32b_fuse(fuse, &len) == SEC_SUCCESS);
+	len = SEC_PSE_SALT_LEN;
+	SEC_ASSERT(sec_int_set_hkdf_32b_pse_salt(salt, &len) == SEC_SUCCESS);
+	setups = unit_test_key_setups;
+
+	sec_int_get_time(&start);
+	for (int i = 0; i < SEC_UNIT_TEST_ENC_LOOP; i++) {
+		SEC_ASSERT(sec_hc_encrypt_data_once(SEC_KEY_MQTT_CLIENT_ID,
+						    key, clear_text,
+						    sizeof(clear_text),
+						    encrypted, iv, tag) ==
+			   SEC_SUCCESS);
+	}
+	sec_int_get_time(&cached_ms);
+	cached_ms -= start;
+
+	LOG_INF("Encrypt %d x %d bytes: uncached %lu ms, cached %lu ms\n",
+		SEC_UNIT_TEST_ENC_LOOP, (int)sizeof(clear_text),
+		uncached_ms, cached_ms);
+	if (uncached_ms && cached_ms) {
+		LOG_INF("Encrypt ops/s: uncached %lu, cached %lu\n",
+			SEC_UNIT_TEST_ENC_LOOP * 1000UL / uncached_ms,
+			SEC_UNIT_TEST_ENC_LOOP * 1000UL / cached_ms);
+	}
+	SEC_ASSERT(unit_test_key_setups - setups == 1);
+
+	/* Rekey costs exactly one more key schedule */
+	sec_int_key_cache_invalidate();
+	for (int i = 0; i < 2; i++) {
+		SEC_ASSERT(sec_hc_encrypt_data_once(SEC_KEY_MQTT_CLIENT_ID,
+						    key, clear_text,
+						    sizeof(clear_text),
+						    encrypted, iv, tag) ==
+			   SEC_SUCCESS);
+	}
+	SEC_ASSERT(unit_test_key_setups - setups == 2);
+
+	sec_int_key_cache_invalidate();
+
+	return result;
+}
+
+#define SEC_UNIT_TEST_CRED_LOOP 100
+
+/* Credential load at OOB boot, one sec_int_get_* call per field
+ * (previous flow) against a single bulk snapshot. Timings are only
+ * reported, the check is on the segments hashed.
+ */
+SEC_RTN int unit_test_sec_int_get_credentials(void)
+{
+	int result;
+
+	unsigned int clear_text_size_for_hash;
+	static unsigned char buffer[SEC_URL_LEN * 2];
+	static unsigned char root_ca[SEC_ROOT_CA_LEN];
+	unsigned char host[SEC_URL_LEN];
+	unsigned char tok_id[SEC_TOK_ID_LEN];
+	unsigned char adapter[SEC_CLD_LEN];
+	unsigned int cld_port, pxy_port, size;
+	uint32_t start, per_field_us, bulk_us;
+	unsigned int per_field_hashes, bulk_hashes;
+	struct sec_cred_item items[] = {
+		{ SEC_CRED_CLD_ADAPTER, adapter },
+		{ SEC_CRED_TOK_ID, tok_id },
+		{ SEC_CRED_DEV_ID, buffer },
+		{ SEC_CRED_MQTT_CLIENT_ID, buffer },
+		{ SEC_CRED_CLD_HOST_URL, host },
+		{ SEC_CRED_CLD_HOST_PORT, &cld_port },
+		{ SEC_CRED_PXY_HOST_URL, buffer },
+		{ SEC_CRED_PXY_HOST_PORT, &pxy_port },
+		{ SEC_CRED_ROOT_CA, root_ca },
+	};
+	const unsigned int cap[ARRAY_SIZE(items)] = {
+		sizeof(adapter), sizeof(tok_id), SEC_DEV_ID_LEN,
+		SEC_MQTT_CLIENT_ID_LEN, sizeof(host), sizeof(cld_port),
+		SEC_URL_LEN, sizeof(pxy_port), sizeof(root_ca)
+	};
+
+	result = SEC_SUCCESS;
+
+	clear_text_size_for_hash = sizeof(sec_ctx.sec_ctx);
+	unit_test_param[0] = (void *)&clear_text_size_for_hash;
+
+	SEC_ASSERT((sec_int_init_context() == SEC_SUCCESS));
+
+	strcpy((char *)sec_ctx.sec_ctx.a_cld_adapter, "Telit");
+	strcpy((char *)sec_ctx.sec_ctx.a_tok_id, "TOKEN_ID");
+	strcpy((char *)sec_ctx.sec_ctx.a_dev_id, "DEVICE_ID");
+	strcpy((char *)sec_ctx.sec_ctx.a_mqtt_client_id, "CLIENT_ID");
+	memcpy(sec_ctx.sec_ctx.a_cld_host_url, "api.example.com", 15);
+	sec_ctx.sec_ctx.cld_host_url_len = 15;
+	sec_ctx.sec_ctx.cld_host_port = 8883;
+	sec_ctx.sec_ctx.pxy_host_url_len = 0;
+	sec_ctx.sec_ctx.pxy_host_port = 911;
+	memset(sec_ctx.sec_ctx.a_root_ca, 'C', SEC_ROOT_CA_LEN - 1);
+	sec_ctx.sec_ctx.a_root_ca[SEC_ROOT_CA_LEN - 1] = '\0';
+	sec_ctx.sec_ctx.root_ca_len = SEC_ROOT_CA_LEN - 1;
+
+	SEC_ASSERT((sec_int_update_context_hash() == SEC_SUCCESS));
+
+	unit_test_seg_hashes = 0;
+	start = k_cycle_get_32();
+	for (int i = 0; i < SEC_UNIT_TEST_CRED_LOOP; i++) {
+		sec_int_get_cld_adapter(buffer, &size);
+		sec_int_get_tok_id(buffer, &size);
+		sec_int_get_dev_id(buffer, &size);
+		sec_int_get_mqtt_client_id(buffer, &size);
+		sec_int_get_cld_host_url(buffer, &size);
+		sec_int_get_cld_host_port(&cld_port);
+		sec_int_get_pxy_host_url(buffer, &size);
+		sec_int_get_pxy_host_port(&pxy_port);
+		sec_int_get_root_ca(buffer, &size);
+	}
+	per_field_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	per_field_hashes = unit_test_seg_hashes;
+
+	unit_test_seg_hashes = 0;
+	start = k_cycle_get_32();
+	for (int i = 0; i < SEC_UNIT_TEST_CRED_LOOP; i++) {
+		for (int j = 0; j < ARRAY_SIZE(items); j++) {
+			items[j].len = cap[j];
+		}
+		SEC_ASSERT(sec_int_get_credentials(items, ARRAY_SIZE(items)) ==
+			   SEC_SUCCESS);
+	}
+	bulk_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	bulk_hashes = unit_test_seg_hashes;
+
+	LOG_INF("Credential load: per field %u us, bulk %u us\n",
+		per_field_us / SEC_UNIT_TEST_CRED_LOOP,
+		bulk_us / SEC_UNIT_TEST_CRED_LOOP);
+	/* Per field verifies a segment per getter, bulk each of the root
+	 * CA, ids, hosts, client and state segments once.
+	 */
+	SEC_ASSERT(per_field_hashes ==
+		   SEC_UNIT_TEST_CRED_LOOP * ARRAY_SIZE(items));
+	SEC_ASSERT(bulk_hashes == SEC_UNIT_TEST_CRED_LOOP * 5);
+
+	SEC_ASSERT(strcmp((char *)adapter, "Telit") == 0);
+	SEC_ASSERT(items[SEC_CRED_CLD_ADAPTER].len == 5);
+	SEC_ASSERT(strcmp((char *)tok_id, "TOKEN_ID") == 0);
+	SEC_ASSERT(strcmp((char *)host, "api.example.com") == 0);
+	SEC_ASSERT(items[SEC_CRED_CLD_HOST_URL].len == 15);
+	SEC_ASSERT(cld_port == 8883 && pxy_port == 911);
+	SEC_ASSERT(items[SEC_CRED_PXY_HOST_URL].len == 0);
+	SEC_ASSERT(items[SEC_CRED_ROOT_CA].len == SEC_ROOT_CA_LEN - 1);
+
+	/* No room for the terminating NUL */
+	items[SEC_CRED_CLD_ADAPTER].len = 5;
+	SEC_ASSERT(sec_int_get_credentials(items, 1) ==
+		   SEC_FAILED_INVALID_PARAM_LEN);
+	SEC_ASSERT(items[SEC_CRED_CLD_ADAPTER].result ==
+		   SEC_FAILED_INVALID_PARAM_LEN);
+
+	/* Tampered segment fails only the fields it holds */
+	items[SEC_CRED_CLD_ADAPTER].len = sizeof(adapter);
+	items[SEC_CRED_TOK_ID].len = sizeof(tok_id);
+	sec_ctx.sec_ctx.a_tok_id[0] ^= 0x01;
+	SEC_ASSERT(sec_int_get_credentials(items, 2) ==
+		   SEC_FAILED_OOB_HASH_MISMATCH);
+	SEC_ASSERT(items[SEC_CRED_CLD_ADAPTER].result == SEC_SUCCESS);
+	SEC_ASSERT(items[SEC_CRED_TOK_ID].result ==
+		   SEC_FAILED_OOB_HASH_MISMATCH);
+	sec_ctx.sec_ctx.a_tok_id[0] ^= 0x01;
+
+	return result;
+}
+
 SEC_RTN int main(void)
 {
 	int result;
@@ -1429,6 +1828,21 @@ SEC_RTN int main(void)
 
 	LOG_INF("unit_test_sec_int_update_context_hash()!\n");
 
+	result = unit_test_sec_int_segment_hash_tamper();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("unit_test_sec_int_segment_hash_tamper()!\n");
+
+	result = unit_test_sec_int_segment_hash_perf();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("unit_test_sec_int_segment_hash_perf()!\n");
+
+	result = test_sideband_drng_pool();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("test_sideband_drng_pool()!\n");
+
 	result = unit_test_sec_int_get_context_param();
 	SEC_ASSERT(result == SEC_SUCCESS);
 
@@ -1616,6 +2030,31 @@ SEC_RTN int main(void)
 
 	LOG_INF("unit_test_sec_int_check_nonce!\n");
 
+	result = unit_test_sec_int_key_cache();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("unit_test_sec_int_key_cache!\n");
+
+	result = unit_test_sec_int_key_cache_perf();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("unit_test_sec_int_key_cache_perf!\n");
+
+	result = unit_test_sec_int_get_credentials();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("unit_test_sec_int_get_credentials!\n");
+
+	result = test_sec_hc_replay();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("test_sec_hc_replay!\n");
+
+	result = test_sec_hc_crypto_soak();
+	SEC_ASSERT(result == SEC_SUCCESS);
+
+	LOG_INF("test_sec_hc_crypto_soak!\n");
+
 exit:
 
 #if (defined(_WIN32) && _WIN32)
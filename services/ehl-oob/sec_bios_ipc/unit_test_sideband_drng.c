@@ -4,8 +4,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "driver/sedi_driver_sideband.h"
 #include <logging/log.h>
+#include "pse_oob_sec_base.h"
+#include "pse_oob_sec_internal.h"
 
 LOG_MODULE_REGISTER(OOB_SEC_UNITTEST, CONFIG_OOB_LOGGING);
 
@@ -68,3 +71,134 @@ void test_sideband_drng(void)
 	test_sideband_drng_reg(EGETDATA24, "EGETDATA24 x2");
 
 }
+
+#if (defined(SEC_UNIT_TEST) && SEC_UNIT_TEST)
+
+#define DRNG_POOL_TEST_BYTES 4096
+#define DRNG_POOL_TEST_CHUNK 32
+#define DRNG_DRBG_TEST_BYTES (64 * 1024)
+
+unsigned int (*unit_test_drng_read)(void);
+
+static unsigned int mock_drng_state = 0x2545F491;
+
+/* xorshift32, stands in for a healthy DRNG */
+unsigned int unit_test_drng_healthy(void)
+{
+	mock_drng_state ^= mock_drng_state << 13;
+	mock_drng_state ^= mock_drng_state >> 17;
+	mock_drng_state ^= mock_drng_state << 5;
+
+	return mock_drng_state;
+}
+
+/* Stuck-at fault, every 24 bit sample byte reads 0xA5 */
+static unsigned int mock_drng_stuck(void)
+{
+	return 0x00A5A5A5;
+}
+
+/* Every byte is 0x3C with probability 1/4 */
+static unsigned int mock_drng_biased(void)
+{
+	unsigned int val = unit_test_drng_healthy();
+	unsigned int sel = unit_test_drng_healthy();
+
+	for (int i = 0; i < 3; i++) {
+		if (((sel >> (i * 2)) & 0x3) == 0) {
+			val = (val & ~(0xFFu << (i * 8))) | (0x3Cu << (i * 8));
+		}
+	}
+
+	return val;
+}
+
+static unsigned int test_drng_pool_drain(unsigned int bytes)
+{
+	unsigned char buf[DRNG_POOL_TEST_CHUNK];
+	unsigned int done;
+
+	for (done = 0; done < bytes; done += sizeof(buf)) {
+		if (sec_int_entropy_pool_read(buf, sizeof(buf)) !=
+		    SEC_SUCCESS) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+int test_sideband_drng_pool(void)
+{
+	int result = SEC_SUCCESS;
+	unsigned char buf[DRNG_POOL_TEST_CHUNK];
+	const struct sec_entropy_pool *stats = sec_int_entropy_pool_stats();
+	int64_t start, elapsed;
+	unsigned int done;
+
+	LOG_INF("Begin to test DRNG entropy pool\n");
+	LOG_INF("===============================\n");
+
+	/* Healthy source: throughput and DRNG reads per byte */
+	unit_test_drng_read = unit_test_drng_healthy;
+	sec_int_entropy_pool_reset();
+
+	start = k_uptime_get();
+	done = test_drng_pool_drain(DRNG_POOL_TEST_BYTES);
+	elapsed = k_uptime_get() - start;
+
+	SEC_ASSERT(done == DRNG_POOL_TEST_BYTES);
+	SEC_ASSERT(stats->health_failures == 0);
+	SEC_ASSERT(sec_hc_get_entropy_state());
+	LOG_INF("Pool: %u bytes in %d ms, %u DRNG reads\n",
+		done, (int)elapsed, stats->drng_reads);
+	if (elapsed > 0) {
+		LOG_INF("Pool: %u bytes/s\n",
+			(unsigned int)(done * 1000LL / elapsed));
+	}
+
+	start = k_uptime_get();
+	for (done = 0; done < DRNG_DRBG_TEST_BYTES; done += sizeof(buf)) {
+		if (sec_int_drbg_random(buf, sizeof(buf)) != SEC_SUCCESS) {
+			break;
+		}
+	}
+	elapsed = k_uptime_get() - start;
+
+	SEC_ASSERT(done == DRNG_DRBG_TEST_BYTES);
+	if (elapsed > 0) {
+		LOG_INF("DRBG: %u bytes/s\n",
+			(unsigned int)(done * 1000LL / elapsed));
+	}
+
+	/* Stuck source: repetition count test trips on the sixth 0xA5,
+	 * long before the adaptive proportion test could.
+	 */
+	unit_test_drng_read = mock_drng_stuck;
+	sec_int_entropy_pool_reset();
+
+	SEC_ASSERT(sec_int_entropy_pool_read(buf, sizeof(buf)) ==
+		   SEC_FAILED);
+	SEC_ASSERT(stats->rct_failures == 1);
+	SEC_ASSERT(stats->apt_failures == 0);
+	SEC_ASSERT(stats->count == 0);
+	SEC_ASSERT(!sec_hc_get_entropy_state());
+	SEC_ASSERT(sec_int_drbg_random(buf, sizeof(buf)) == SEC_FAILED);
+	LOG_INF("Stuck DRNG: rejected after %u reads\n", stats->drng_reads);
+
+	/* Biased source: caught within a few APT windows */
+	unit_test_drng_read = mock_drng_biased;
+	sec_int_entropy_pool_reset();
+
+	done = test_drng_pool_drain(DRNG_POOL_TEST_BYTES * 4);
+	SEC_ASSERT(done < DRNG_POOL_TEST_BYTES * 4);
+	SEC_ASSERT(stats->apt_failures > 0);
+	LOG_INF("Biased DRNG: rejected after %u bytes\n", done);
+
+	unit_test_drng_read = NULL;
+	sec_int_entropy_pool_reset();
+
+	return result;
+}
+
+#endif /* SEC_UNIT_TEST */
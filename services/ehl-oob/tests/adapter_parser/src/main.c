@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file main.c
+ *
+ * \brief Unit tests for the cloud adapter single-pass parser. Recorded
+ * payloads of each adapter are parsed whole, truncated at every length,
+ * malformed, oversized and fuzzed; every result must stay inside the
+ * bytes handed to the parser.
+ *
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <adapter/adapter_parser.h>
+#include <bench_cycles.h>
+
+/** Recorded payloads, one per adapter */
+#define TELIT_PAYLOAD							\
+	"{\"thingKey\":\"pse-ehl-0001\",\"cmd\":{\"command\":"		\
+	"\"method.exec\",\"params\":{\"method\":\"reboot_device\"}},"	\
+	"\"id\":\"5f3c9a1e2b7d4c00a1b2c3d4\"}"
+#define THINGSBOARD_PAYLOAD						\
+	"{\"method\":\"powerdown_device\",\"params\":{},"		\
+	"\"requestID\":\"42\"}"
+#define AZURE_IOT_TOPIC							\
+	"$iothub/methods/POST/powerup_device/?$rid=1"
+
+#define TEST_THING_KEY  "pse-ehl-0001"
+#define TEST_REQ_ID     "5f3c9a1e2b7d4c00a1b2c3d4"
+
+#define OVERSIZED_LEN   4096
+#define FUZZ_ROUNDS     2000
+#define FUZZ_MAX_LEN    96
+#define BENCH_ROUNDS    1000
+
+static const struct adapter_token test_cmds[] = {
+	ADAPTER_TOKEN("reboot_device", REBOOT),
+	ADAPTER_TOKEN("powerup_device", POWERON),
+	ADAPTER_TOKEN("powerdown_device", POWEROFF),
+	ADAPTER_TOKEN("decommision_device", DECOMMISSION)
+};
+
+static const struct adapter_token test_markers[] = {
+	ADAPTER_TOKEN("method.exec", IGNORE)
+};
+
+static const struct adapter_cmd_table telit_table = {
+	.cmds = test_cmds,
+	.cmd_count = ARRAY_SIZE(test_cmds),
+	.markers = test_markers,
+	.marker_count = ARRAY_SIZE(test_markers),
+	.req_id_key = "id",
+	.req_id_key_len = sizeof("id") - 1
+};
+
+static const struct adapter_cmd_table thingsboard_table = {
+	.cmds = test_cmds,
+	.cmd_count = ARRAY_SIZE(test_cmds),
+	.req_id_key = "requestID",
+	.req_id_key_len = sizeof("requestID") - 1
+};
+
+static const struct adapter_cmd_table azure_iot_table = {
+	.cmds = test_cmds,
+	.cmd_count = ARRAY_SIZE(test_cmds),
+	.markers = test_markers,
+	.marker_count = ARRAY_SIZE(test_markers)
+};
+
+static uint8_t big_buf[OVERSIZED_LEN];
+
+/** Check that a parse result only points into buf[0, len) */
+static void check_bounds(const struct adapter_parse_result *res,
+			 const uint8_t *buf, uint32_t len)
+{
+	zassert_true(res->cmd <= IGNORE, "invalid command %d", res->cmd);
+
+	if (res->req_id == NULL) {
+		zassert_equal(res->req_id_len, 0, "length without id");
+		return;
+	}
+
+	zassert_true(res->req_id >= buf && res->req_id <= buf + len,
+		     "request id outside payload");
+	zassert_true(res->req_id_len <= (uint32_t)(buf + len - res->req_id),
+		     "request id runs past payload");
+}
+
+static void test_json_recorded(void)
+{
+	const uint8_t *buf = (const uint8_t *)TELIT_PAYLOAD;
+	struct adapter_parse_result res = { 0 };
+
+	res.expect = TEST_THING_KEY;
+	res.expect_len = sizeof(TEST_THING_KEY) - 1;
+
+	zassert_equal(adapter_parse_json(&telit_table, buf,
+					 sizeof(TELIT_PAYLOAD) - 1, &res),
+		      REBOOT, "telit command not found");
+	zassert_equal(res.found, BIT(0) | ADAPTER_PARSE_EXPECT_FOUND,
+		      "telit markers: %x", res.found);
+	zassert_equal(res.req_id_len, sizeof(TEST_REQ_ID) - 1,
+		      "telit request id length");
+	zassert_mem_equal(res.req_id, TEST_REQ_ID, res.req_id_len,
+			  "telit request id");
+
+	memset(&res, 0, sizeof(res));
+	buf = (const uint8_t *)THINGSBOARD_PAYLOAD;
+	zassert_equal(adapter_parse_json(&thingsboard_table, buf,
+					 sizeof(THINGSBOARD_PAYLOAD) - 1,
+					 &res),
+		      POWEROFF, "thingsboard command not found");
+	zassert_equal(res.req_id_len, 2, "thingsboard request id length");
+	zassert_mem_equal(res.req_id, "42", 2, "thingsboard request id");
+}
+
+static void test_topic_recorded(void)
+{
+	const uint8_t *buf = (const uint8_t *)AZURE_IOT_TOPIC;
+	struct adapter_parse_result res = { 0 };
+
+	zassert_equal(adapter_parse_topic(&azure_iot_table, buf,
+					  sizeof(AZURE_IOT_TOPIC) - 1, &res),
+		      POWERON, "azure command not found");
+	zassert_is_null(res.req_id, "topic has no request id");
+}
+
+static void test_json_malformed(void)
+{
+	static const char * const payloads[] = {
+		"",
+		"{",
+		"\"",
+		"\\",
+		"\"\\",
+		"{\"method\":\"reboot_device",
+		"{\"method\":reboot_device}",
+		"{\"method\":\"reboot_device\\\"}",
+		"{\"id\":42,\"method\":\"x\"}",
+		"{\"id\":\"",
+		"{\"id\"",
+		"\"\"\"\"\"\"",
+		"}}}:::,,,\"",
+	};
+	struct adapter_parse_result res = { 0 };
+
+	for (int i = 0; i < ARRAY_SIZE(payloads); i++) {
+		const uint8_t *buf = (const uint8_t *)payloads[i];
+		uint32_t len = strlen(payloads[i]);
+
+		zassert_equal(adapter_parse_json(&telit_table, buf, len, &res),
+			      IGNORE, "payload %d gave a command", i);
+		check_bounds(&res, buf, len);
+	}
+
+	/* Non string id value must not be taken as request id */
+	adapter_parse_json(&telit_table, (const uint8_t *)
+			   "{\"id\":42,\"x\":\"y\"}", 17, &res);
+	zassert_is_null(res.req_id, "numeric request id captured");
+}
+
+static void test_json_truncated(void)
+{
+	const char *payload = TELIT_PAYLOAD;
+	const char *cmd_end = strstr(payload, "reboot_device\"");
+	uint32_t full = strlen(payload);
+	uint32_t cmd_len = cmd_end - payload + sizeof("reboot_device\"") - 1;
+	struct adapter_parse_result res = { 0 };
+
+	for (uint32_t len = 0; len <= full; len++) {
+		enum oob_messages cmd;
+
+		/* Copy so that reading past len would read stale bytes */
+		memset(big_buf, '\"', sizeof(big_buf));
+		memcpy(big_buf, payload, len);
+
+		cmd = adapter_parse_json(&telit_table, big_buf, len, &res);
+		zassert_equal(cmd, len < cmd_len ? IGNORE : REBOOT,
+			      "truncated at %u gave %d", len, cmd);
+		check_bounds(&res, big_buf, len);
+	}
+}
+
+static void test_topic_truncated(void)
+{
+	const char *topic = AZURE_IOT_TOPIC;
+	uint32_t full = strlen(topic);
+	struct adapter_parse_result res = { 0 };
+
+	for (uint32_t len = 0; len <= full; len++) {
+		memset(big_buf, '/', sizeof(big_buf));
+		memcpy(big_buf, topic, len);
+
+		adapter_parse_topic(&azure_iot_table, big_buf, len, &res);
+		check_bounds(&res, big_buf, len);
+	}
+}
+
+static void test_json_oversized(void)
+{
+	static const char tail[] = "\"method\":\"decommision_device\"}";
+	uint32_t pos = 0;
+	struct adapter_parse_result res = { 0 };
+
+	/* Filler of key/value pairs with the command at the very end */
+	big_buf[pos++] = '{';
+	while (pos + 16 + sizeof(tail) < sizeof(big_buf)) {
+		memcpy(&big_buf[pos], "\"k\":\"vvvvvvvv\",", 15);
+		pos += 15;
+	}
+	memcpy(&big_buf[pos], tail, sizeof(tail) - 1);
+	pos += sizeof(tail) - 1;
+
+	zassert_equal(adapter_parse_json(&telit_table, big_buf, pos, &res),
+		      DECOMMISSION, "command at end of big payload lost");
+	check_bounds(&res, big_buf, pos);
+
+	/* Token longer than 255 bytes must not alias a short command */
+	memset(big_buf, 'x', sizeof(big_buf));
+	big_buf[0] = '\"';
+	memcpy(&big_buf[1], "reboot_device", 13);
+	big_buf[1 + 13 + 256] = '\"';
+	zassert_equal(adapter_parse_json(&telit_table, big_buf,
+					 13 + 256 + 2, &res),
+		      IGNORE, "long token matched a command");
+
+	/* Oversized id value is still bounded by the payload */
+	memset(big_buf, 'a', sizeof(big_buf));
+	memcpy(big_buf, "{\"id\":\"", 7);
+	big_buf[sizeof(big_buf) - 1] = '\"';
+	adapter_parse_json(&telit_table, big_buf, sizeof(big_buf), &res);
+	zassert_equal(res.req_id_len, sizeof(big_buf) - 8,
+		      "long request id length");
+	check_bounds(&res, big_buf, sizeof(big_buf));
+}
+
+static void test_json_nul_terminates(void)
+{
+	static const uint8_t buf[] = "{\"x\":\"\0reboot_device\"}";
+	struct adapter_parse_result res = { 0 };
+
+	zassert_equal(adapter_parse_json(&telit_table, buf, sizeof(buf) - 1,
+					 &res),
+		      IGNORE, "parse ran past NUL");
+}
+
+static void test_fuzz(void)
+{
+	static const char * const frags[] = {
+		"\"", "\\", "{", "}", ":", ",", " ", "/", "id", "\"id\":",
+		"method.exec", "reboot_device", "powerup_device", "x"
+	};
+	uint32_t seed = 0x1234567;
+
+	for (int round = 0; round < FUZZ_ROUNDS; round++) {
+		struct adapter_parse_result res = { 0 };
+		uint32_t len = 0;
+
+		memset(big_buf, '\"', FUZZ_MAX_LEN + 16);
+		while (true) {
+			const char *frag;
+			uint32_t frag_len;
+
+			seed = seed * 1103515245 + 12345;
+			frag = frags[(seed >> 16) % ARRAY_SIZE(frags)];
+			frag_len = strlen(frag);
+			if (len + frag_len > FUZZ_MAX_LEN) {
+				break;
+			}
+			memcpy(&big_buf[len], frag, frag_len);
+			len += frag_len;
+		}
+
+		adapter_parse_json(&telit_table, big_buf, len, &res);
+		check_bounds(&res, big_buf, len);
+		adapter_parse_topic(&azure_iot_table, big_buf, len, &res);
+		check_bounds(&res, big_buf, len);
+	}
+}
+
+/** Parse time over the recorded payloads, printed for comparison */
+static void test_parse_bench(void)
+{
+	struct adapter_parse_result res = { 0 };
+	uint32_t start, cycles;
+
+	start = bench_cycles();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		adapter_parse_json(&telit_table,
+				   (const uint8_t *)TELIT_PAYLOAD,
+				   sizeof(TELIT_PAYLOAD) - 1, &res);
+		adapter_parse_json(&thingsboard_table,
+				   (const uint8_t *)THINGSBOARD_PAYLOAD,
+				   sizeof(THINGSBOARD_PAYLOAD) - 1, &res);
+		adapter_parse_topic(&azure_iot_table,
+				    (const uint8_t *)AZURE_IOT_TOPIC,
+				    sizeof(AZURE_IOT_TOPIC) - 1, &res);
+	}
+	cycles = bench_cycles() - start;
+
+	TC_PRINT("adapter parse: %u cycles per 3 payloads\n",
+		 cycles / BENCH_ROUNDS);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(oob_adapter_parser,
+			 ztest_unit_test(test_json_recorded),
+			 ztest_unit_test(test_topic_recorded),
+			 ztest_unit_test(test_json_malformed),
+			 ztest_unit_test(test_json_truncated),
+			 ztest_unit_test(test_topic_truncated),
+			 ztest_unit_test(test_json_oversized),
+			 ztest_unit_test(test_json_nul_terminates),
+			 ztest_unit_test(test_fuzz),
+			 ztest_unit_test(test_parse_bench));
+	ztest_run_test_suite(oob_adapter_parser);
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file bench_cycles.h
+ *
+ * \brief Cycle counter for the OOB unit test benchmarks. On native_posix
+ * kernel time is simulated and only advances while idle, so the host
+ * time stamp counter is read instead of k_cycle_get_32.
+ *
+ */
+
+#ifndef _BENCH_CYCLES_H_
+#define _BENCH_CYCLES_H_
+
+#include <zephyr.h>
+
+static inline uint32_t bench_cycles(void)
+{
+#if defined(CONFIG_BOARD_NATIVE_POSIX) && \
+	(defined(__i386__) || defined(__x86_64__))
+	uint32_t lo, hi;
+
+	__asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+	return lo;
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+#endif
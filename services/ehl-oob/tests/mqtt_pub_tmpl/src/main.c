@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2021 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/**
+ * \file main.c
+ *
+ * \brief Unit tests and publish preparation benchmark for the mqtt
+ * client payload templates. Skeletons are produced the way the cloud
+ * adapters do at connect, filled payloads must match what the adapter
+ * would format per publish, and both paths are timed.
+ *
+ */
+
+#include <ztest.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <mqtt_client/mqtt_pub_tmpl.h>
+#include <bench_cycles.h>
+
+/** Payload formats as in adapter/telit.h and adapter/thingsboard.h */
+#define TELIT_ATTRIBUTE_TEMPLATE					\
+	"{\"cmd\":{\"command\":\"attribute.publish\","			\
+	"\"params\":{\"thingKey\":\"%s\",\"key\":\"%s\",\"value\":\"%s\"}}}"
+#define THINGSBOARD_EVENT_TEMPLATE "{\"event\":\"%s\"}"
+
+#define TEST_THING_KEY  "pse-ehl-0001"
+#define TEST_KEY        "CONFIG_BOARD"
+#define TEST_VALUE      "ehl_pse_crb"
+#define TEST_EVENT      "Static Telemetry published..."
+
+#define PUB_BUF_SIZE    1024
+#define BENCH_ROUNDS    1000
+
+static struct pub_payload_tmpl attrib_tmpl, event_tmpl;
+static char pub_buf[PUB_BUF_SIZE];
+static char ref_buf[PUB_BUF_SIZE];
+
+/** Build skeletons the way pub_cache_init does through the adapter */
+static void tmpl_setup(void)
+{
+	memset(&attrib_tmpl, 0, sizeof(attrib_tmpl));
+	snprintf(attrib_tmpl.skel, sizeof(attrib_tmpl.skel),
+		 TELIT_ATTRIBUTE_TEMPLATE, TEST_THING_KEY,
+		 PUB_TMPL_SLOT_0, PUB_TMPL_SLOT_1);
+	pub_tmpl_compile(&attrib_tmpl, 2);
+
+	memset(&event_tmpl, 0, sizeof(event_tmpl));
+	snprintf(event_tmpl.skel, sizeof(event_tmpl.skel),
+		 THINGSBOARD_EVENT_TEMPLATE, PUB_TMPL_SLOT_0);
+	pub_tmpl_compile(&event_tmpl, 1);
+}
+
+static void test_fill_matches_format(void)
+{
+	const char *const attrib_values[] = { TEST_KEY, TEST_VALUE };
+	const char *const event_values[] = { TEST_EVENT };
+	uint32_t len;
+
+	tmpl_setup();
+	zassert_true(attrib_tmpl.valid, "attribute template not compiled");
+	zassert_true(event_tmpl.valid, "event template not compiled");
+
+	len = pub_tmpl_fill(&attrib_tmpl, attrib_values, pub_buf,
+			    sizeof(pub_buf));
+	snprintf(ref_buf, sizeof(ref_buf), TELIT_ATTRIBUTE_TEMPLATE,
+		 TEST_THING_KEY, TEST_KEY, TEST_VALUE);
+	zassert_equal(len, strlen(ref_buf), "attribute length");
+	zassert_mem_equal(pub_buf, ref_buf, len + 1, "attribute payload");
+
+	len = pub_tmpl_fill(&event_tmpl, event_values, pub_buf,
+			    sizeof(pub_buf));
+	snprintf(ref_buf, sizeof(ref_buf), THINGSBOARD_EVENT_TEMPLATE,
+		 TEST_EVENT);
+	zassert_equal(len, strlen(ref_buf), "event length");
+	zassert_mem_equal(pub_buf, ref_buf, len + 1, "event payload");
+}
+
+static void test_compile_rejects(void)
+{
+	struct pub_payload_tmpl tmpl;
+
+	/* Slots out of order */
+	memset(&tmpl, 0, sizeof(tmpl));
+	strcpy(tmpl.skel, "{" PUB_TMPL_SLOT_1 ":" PUB_TMPL_SLOT_0 "}");
+	zassert_equal(pub_tmpl_compile(&tmpl, 2), -EINVAL,
+		      "out of order slots accepted");
+	zassert_false(tmpl.valid, "out of order slots valid");
+
+	/* Slot missing */
+	memset(&tmpl, 0, sizeof(tmpl));
+	strcpy(tmpl.skel, "{" PUB_TMPL_SLOT_0 "}");
+	zassert_equal(pub_tmpl_compile(&tmpl, 2), -EINVAL,
+		      "missing slot accepted");
+	zassert_false(tmpl.valid, "missing slot valid");
+
+	/* Slot repeated, eg. adapter printing the value twice */
+	memset(&tmpl, 0, sizeof(tmpl));
+	strcpy(tmpl.skel, PUB_TMPL_SLOT_0 PUB_TMPL_SLOT_0);
+	zassert_equal(pub_tmpl_compile(&tmpl, 1), -EINVAL,
+		      "repeated slot accepted");
+	zassert_false(tmpl.valid, "repeated slot valid");
+
+	/* Skeleton without terminator */
+	memset(tmpl.skel, 'x', sizeof(tmpl.skel));
+	tmpl.skel[0] = PUB_TMPL_SLOT_0[0];
+	zassert_equal(pub_tmpl_compile(&tmpl, 1), -E2BIG,
+		      "unterminated skeleton accepted");
+	zassert_false(tmpl.valid, "unterminated skeleton valid");
+}
+
+static void test_compile_length(void)
+{
+	struct pub_payload_tmpl tmpl;
+	char thing_key[MAX_MQTT_PUB_TMPL_LEN];
+	size_t fixed;
+	int ret;
+
+	/* Adapter output truncated to the skeleton buffer */
+	memset(thing_key, 'k', sizeof(thing_key) - 1);
+	thing_key[sizeof(thing_key) - 1] = '\0';
+	memset(&tmpl, 0, sizeof(tmpl));
+	ret = snprintf(tmpl.skel, sizeof(tmpl.skel), TELIT_ATTRIBUTE_TEMPLATE,
+		       thing_key, PUB_TMPL_SLOT_0, PUB_TMPL_SLOT_1);
+	zassert_true(ret >= sizeof(tmpl.skel), "skeleton not truncated");
+	zassert_equal(pub_tmpl_compile(&tmpl, 2), -E2BIG,
+		      "truncated skeleton accepted");
+	zassert_false(tmpl.valid, "truncated skeleton valid");
+
+	/* Longest skeleton that is known to be complete */
+	fixed = strlen(TELIT_ATTRIBUTE_TEMPLATE) - 6 + 2;
+	thing_key[sizeof(tmpl.skel) - 2 - fixed] = '\0';
+	memset(&tmpl, 0, sizeof(tmpl));
+	ret = snprintf(tmpl.skel, sizeof(tmpl.skel), TELIT_ATTRIBUTE_TEMPLATE,
+		       thing_key, PUB_TMPL_SLOT_0, PUB_TMPL_SLOT_1);
+	zassert_equal(ret, sizeof(tmpl.skel) - 2, "skeleton length");
+	zassert_equal(pub_tmpl_compile(&tmpl, 2), 0,
+		      "longest skeleton rejected");
+	zassert_true(tmpl.valid, "longest skeleton not valid");
+
+	/* One more byte fills the buffer */
+	strcat(tmpl.skel, "}");
+	zassert_equal(pub_tmpl_compile(&tmpl, 2), -E2BIG,
+		      "full skeleton accepted");
+}
+
+static void test_fill_overflow(void)
+{
+	const char *const values[] = { TEST_KEY, TEST_VALUE };
+	uint32_t full;
+
+	tmpl_setup();
+	full = pub_tmpl_fill(&attrib_tmpl, values, pub_buf, sizeof(pub_buf));
+
+	/* Needs full + 1 bytes for the terminator, anything less fails */
+	zassert_equal(pub_tmpl_fill(&attrib_tmpl, values, pub_buf, full),
+		      0, "overflow not detected");
+	zassert_equal(pub_tmpl_fill(&attrib_tmpl, values, pub_buf, full + 1),
+		      full, "exact fit rejected");
+	zassert_equal(pub_tmpl_fill(&attrib_tmpl, values, pub_buf, 1),
+		      0, "tiny buffer not rejected");
+}
+
+/** Publish preparation cost per message: adapter formatting plus
+ * strlen as done before the cache, against the template fill.
+ */
+static void test_pub_prep_bench(void)
+{
+	const char *const values[] = { TEST_KEY, TEST_VALUE };
+	uint32_t start, fmt_cycles, tmpl_cycles;
+	volatile uint32_t len = 0;
+
+	tmpl_setup();
+
+	start = bench_cycles();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		snprintf(pub_buf, sizeof(pub_buf), TELIT_ATTRIBUTE_TEMPLATE,
+			 TEST_THING_KEY, TEST_KEY, TEST_VALUE);
+		len = strlen(pub_buf);
+	}
+	fmt_cycles = bench_cycles() - start;
+
+	start = bench_cycles();
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		len = pub_tmpl_fill(&attrib_tmpl, values, pub_buf,
+				    sizeof(pub_buf));
+	}
+	tmpl_cycles = bench_cycles() - start;
+
+	zassert_not_equal(len, 0, "template fill failed");
+	TC_PRINT("publish prep: format %u cycles, template %u cycles\n",
+		 fmt_cycles / BENCH_ROUNDS, tmpl_cycles / BENCH_ROUNDS);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(oob_mqtt_pub_tmpl,
+			 ztest_unit_test(test_fill_matches_format),
+			 ztest_unit_test(test_compile_rejects),
+			 ztest_unit_test(test_compile_length),
+			 ztest_unit_test(test_fill_overflow),
+			 ztest_unit_test(test_pub_prep_bench));
+	ztest_run_test_suite(oob_mqtt_pub_tmpl);
+}
@@ -0,0 +1,408 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (c) 2021 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Local mock cloud broker for the EHL OOB service
+
+Speaks just enough MQTT 3.1.1 to serve one OOB device and mimics the
+topic and payload dialect of the Telit, Azure IoT and ThingsBoard
+adapters. A scenario file drives cloud commands and the broker reports
+end-to-end command latency and device publish throughput. Optionally it
+checks the per key publish rate of device telemetry.
+
+Usage:
+    python3 oob_mock_broker.py --adapter telit|azure|thingsboard
+        [--port 8883] [--cert server.pem --key server.key]
+        [--scenario scenario.json] [--thing-key device_id]
+Output:
+    JSON summary on stdout, exit code 2 if a telemetry check failed
+"""
+
+import argparse
+import json
+import logging
+import socket
+import ssl
+import struct
+import sys
+import threading
+import time
+
+logging.basicConfig(level=logging.INFO, format="%(asctime)s %(message)s")
+logger = logging.getLogger(__name__)
+
+# MQTT control packet types
+CONNECT, CONNACK, PUBLISH, PUBACK, PUBREC, PUBREL, PUBCOMP = 1, 2, 3, 4, 5, 6, 7
+SUBSCRIBE, SUBACK, PINGREQ, PINGRESP, DISCONNECT = 8, 9, 12, 13, 14
+
+DEFAULT_SCENARIO = {
+    "warmup": 10,
+    "steps": [
+        # powerup_device is a no-op on a host already in S0, so the
+        # default scenario is safe to run against real hardware.
+        {"command": "powerup_device", "count": 10, "interval": 2.0}
+    ]
+}
+
+
+def _encode_len(length):
+    out = bytearray()
+    while True:
+        byte = length % 128
+        length //= 128
+        if length:
+            byte |= 0x80
+        out.append(byte)
+        if not length:
+            return bytes(out)
+
+
+def _encode_str(value):
+    data = value.encode()
+    return struct.pack("!H", len(data)) + data
+
+
+class Dialect(object):
+    """Cloud side of an adapter: how commands are sent and how the
+    device's reply to them is recognised."""
+
+    def __init__(self, thing_key):
+        self.thing_key = thing_key
+        self.rid = 0
+
+    def command(self, method):
+        """@return: list of (topic, payload) to send for a command"""
+        raise NotImplementedError
+
+    def on_publish(self, topic, payload):
+        """@return: (list of (topic, payload) to send back,
+                     True if this publish completes a command)"""
+        raise NotImplementedError
+
+    def telemetry(self, topic, payload):
+        """@return: list of (key, value) telemetry in a publish"""
+        if not topic.endswith(self.telemetry_topic):
+            return []
+        try:
+            data = json.loads(payload)
+        except ValueError:
+            return []
+        if not isinstance(data, dict):
+            return []
+        return [(key, value) for key, value in data.items()
+                if key != "event"]
+
+
+class TelitDialect(Dialect):
+    def command(self, method):
+        self.rid += 1
+        self.pending = method
+        return [("notify/mailbox_activity", "{}")]
+
+    def on_publish(self, topic, payload):
+        if "mailbox.check" in payload:
+            msg_id = "%024x" % self.rid
+            reply = {"cmd": {"success": True, "params": {"messages": [{
+                "id": msg_id,
+                "command": "method.exec",
+                "params": {"thingKey": self.thing_key,
+                           "method": self.pending,
+                           "params": {}}}]}}}
+            return [("reply", json.dumps(reply))], False
+        if "mailbox.ack" in payload:
+            return [("reply", '{"cmd":{"success":true}}')], True
+        return [], False
+
+    def telemetry(self, topic, payload):
+        if "attribute.publish" not in payload:
+            return []
+        try:
+            params = json.loads(payload)["cmd"]["params"]
+            return [(params["key"], params["value"])]
+        except (ValueError, KeyError, TypeError):
+            return []
+
+
+class AzureDialect(Dialect):
+    telemetry_topic = "/messages/events/"
+
+    def command(self, method):
+        self.rid += 1
+        return [("$iothub/methods/POST/%s/?$rid=%d" % (method, self.rid),
+                 "{}")]
+
+    def on_publish(self, topic, payload):
+        return [], topic.startswith("$iothub/methods/res/")
+
+
+class ThingsboardDialect(Dialect):
+    telemetry_topic = "v1/devices/me/telemetry"
+
+    def command(self, method):
+        self.rid += 1
+        return [("v1/devices/me/rpc/request/%d" % self.rid,
+                 json.dumps({"method": method, "params": {}}))]
+
+    def on_publish(self, topic, payload):
+        return [], (topic.startswith("v1/devices/me/rpc/response") or
+                    topic == "v1/devices/me/attributes" and
+                    '"status"' in payload)
+
+
+DIALECTS = {
+    "telit": TelitDialect,
+    "azure": AzureDialect,
+    "thingsboard": ThingsboardDialect,
+}
+
+
+class MockBroker(object):
+    def __init__(self, conn, dialect):
+        self.conn = conn
+        self.dialect = dialect
+        self.lock = threading.Lock()
+        self.connected = threading.Event()
+        self.subscribed = threading.Event()
+        self.done = threading.Event()
+        self.cmd_start = None
+        self.latencies = []
+        self.publishes = []
+        self.telemetry = {}
+        self.bytes_rx = 0
+
+    def _send(self, ptype, flags, body):
+        with self.lock:
+            self.conn.sendall(bytes([(ptype << 4) | flags]) +
+                              _encode_len(len(body)) + body)
+
+    def publish(self, topic, payload):
+        """Publish to the device at QoS0"""
+        self._send(PUBLISH, 0, _encode_str(topic) + payload.encode())
+
+    def _recv_exact(self, size):
+        data = b""
+        while len(data) < size:
+            chunk = self.conn.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("device closed the connection")
+            data += chunk
+        return data
+
+    def _recv_packet(self):
+        header = self._recv_exact(1)[0]
+        length, mult = 0, 1
+        while True:
+            byte = self._recv_exact(1)[0]
+            length += (byte & 0x7f) * mult
+            mult *= 128
+            if not byte & 0x80:
+                break
+        self.bytes_rx += length
+        return header >> 4, header & 0x0f, self._recv_exact(length)
+
+    def _handle_publish(self, flags, body):
+        qos = (flags >> 1) & 0x3
+        tlen = struct.unpack("!H", body[:2])[0]
+        topic = body[2:2 + tlen].decode(errors="replace")
+        pos = 2 + tlen
+        if qos:
+            pid = body[pos:pos + 2]
+            pos += 2
+            self._send(PUBACK if qos == 1 else PUBREC, 0, pid)
+        payload = body[pos:].decode(errors="replace")
+        now = time.monotonic()
+        self.publishes.append(now)
+        logger.debug("device -> %s: %s", topic, payload)
+
+        for key, value in self.dialect.telemetry(topic, payload):
+            self.telemetry.setdefault(key, []).append((now, value))
+
+        replies, complete = self.dialect.on_publish(topic, payload)
+        for rtopic, rpayload in replies:
+            self.publish(rtopic, rpayload)
+        if complete and self.cmd_start is not None:
+            self.latencies.append(time.monotonic() - self.cmd_start)
+            self.cmd_start = None
+            self.done.set()
+
+    def serve(self):
+        try:
+            while True:
+                ptype, flags, body = self._recv_packet()
+                if ptype == CONNECT:
+                    self._send(CONNACK, 0, b"\x00\x00")
+                    self.connected.set()
+                elif ptype == SUBSCRIBE:
+                    count = 0
+                    pos = 2
+                    while pos < len(body):
+                        tlen = struct.unpack("!H", body[pos:pos + 2])[0]
+                        pos += 2 + tlen + 1
+                        count += 1
+                    self._send(SUBACK, 0, body[:2] + b"\x01" * count)
+                    self.subscribed.set()
+                elif ptype == PUBLISH:
+                    self._handle_publish(flags, body)
+                elif ptype == PUBREL:
+                    self._send(PUBCOMP, 0, body[:2])
+                elif ptype == PINGREQ:
+                    self._send(PINGRESP, 0, b"")
+                elif ptype == DISCONNECT:
+                    break
+        except (ConnectionError, OSError) as err:
+            logger.info("Connection closed: %s", err)
+        self.done.set()
+
+    def run_command(self, method, timeout):
+        self.done.clear()
+        self.cmd_start = time.monotonic()
+        for topic, payload in self.dialect.command(method):
+            self.publish(topic, payload)
+        if not self.done.wait(timeout):
+            logger.warning("No reply to %s within %ss", method, timeout)
+            self.cmd_start = None
+            return False
+        return True
+
+
+def _percentile(values, pct):
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * pct / 100))]
+
+
+def check_telemetry(broker, check, since):
+    """Per key publish gaps of telemetry seen after since against
+    the minimum interval the device was built with."""
+    prefix = check.get("prefix", "")
+    min_gap_ms = check["min_interval_ms"] - check.get("tolerance_ms", 100)
+    keys = {}
+    violations = []
+    for key, samples in sorted(broker.telemetry.items()):
+        if not key.startswith(prefix):
+            continue
+        times = [t for t, _ in samples if t >= since]
+        gaps = [(b - a) * 1000 for a, b in zip(times, times[1:])]
+        keys[key] = {
+            "publishes": len(times),
+            "min_gap_ms": min(gaps) if gaps else None,
+        }
+        if gaps and min(gaps) < min_gap_ms:
+            violations.append(key)
+    missing = ["%s%d" % (prefix, i)
+               for i in range(check.get("keys", 0))
+               if "%s%d" % (prefix, i) not in keys]
+    return {
+        "keys": keys,
+        "publishes": sum(k["publishes"] for k in keys.values()),
+        "rate_violations": violations,
+        "missing_keys": missing,
+        "passed": not violations and not missing,
+    }
+
+
+def run_scenario(broker, scenario, timeout):
+    if not broker.subscribed.wait(timeout):
+        raise RuntimeError("device did not subscribe")
+
+    # Let the device finish its start-up telemetry first
+    time.sleep(scenario.get("warmup", 0))
+
+    start = time.monotonic()
+    first_pub = len(broker.publishes)
+    sent = 0
+    for step in scenario["steps"]:
+        if "command" not in step:
+            # Only listen, e.g. to let telemetry flow
+            time.sleep(step.get("wait", 0))
+            continue
+        for _ in range(step.get("count", 1)):
+            sent += 1
+            broker.run_command(step["command"], timeout)
+            time.sleep(step.get("interval", 0))
+    elapsed = time.monotonic() - start
+
+    lat_ms = [lat * 1000 for lat in broker.latencies]
+    pubs = len(broker.publishes) - first_pub
+    result = {
+        "commands_sent": sent,
+        "commands_completed": len(lat_ms),
+        "latency_ms": {
+            "min": min(lat_ms) if lat_ms else None,
+            "avg": sum(lat_ms) / len(lat_ms) if lat_ms else None,
+            "p50": _percentile(lat_ms, 50),
+            "p95": _percentile(lat_ms, 95),
+            "max": max(lat_ms) if lat_ms else None,
+        },
+        "device_publishes": pubs,
+        "publish_rate_per_s": pubs / elapsed if elapsed else 0,
+        "bytes_from_device": broker.bytes_rx,
+        "duration_s": elapsed,
+    }
+    if "telemetry" in scenario:
+        result["telemetry"] = check_telemetry(broker, scenario["telemetry"],
+                                              start)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="EHL OOB mock cloud broker")
+    parser.add_argument("--adapter", choices=sorted(DIALECTS), required=True)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8883)
+    parser.add_argument("--cert", help="server certificate (PEM), enables TLS")
+    parser.add_argument("--key", help="server private key (PEM)")
+    parser.add_argument("--scenario", help="scenario file (JSON)")
+    parser.add_argument("--thing-key", default="device_id",
+                        help="device id provisioned on the device (Telit)")
+    parser.add_argument("--timeout", type=float, default=30.0)
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+
+    if args.verbose:
+        logger.setLevel(logging.DEBUG)
+
+    scenario = DEFAULT_SCENARIO
+    if args.scenario:
+        with open(args.scenario) as fp:
+            scenario = json.load(fp)
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((args.host, args.port))
+    server.listen(1)
+    logger.info("Waiting for OOB device on %s:%d", args.host, args.port)
+
+    conn, addr = server.accept()
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    if args.cert:
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        ctx.load_cert_chain(args.cert, args.key)
+        conn = ctx.wrap_socket(conn, server_side=True)
+    logger.info("Device connected from %s", addr[0])
+
+    broker = MockBroker(conn, DIALECTS[args.adapter](args.thing_key))
+    rx_thread = threading.Thread(target=broker.serve, daemon=True)
+    rx_thread.start()
+
+    try:
+        result = run_scenario(broker, scenario, args.timeout)
+    except RuntimeError as err:
+        logger.error("%s", err)
+        sys.exit(1)
+
+    result["adapter"] = args.adapter
+    result["tls"] = bool(args.cert)
+    print(json.dumps(result, indent=2))
+    conn.close()
+    if not result.get("telemetry", {}).get("passed", True):
+        sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()